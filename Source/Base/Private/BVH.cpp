@@ -0,0 +1,558 @@
+#include "BVH.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "JobSystem.h"
+
+namespace cube
+{
+    namespace
+    {
+        constexpr int NUM_SAH_BINS = 16;
+        // The subtrees with more items are built in the other jobs.
+        constexpr Uint64 PARALLEL_BUILD_THRESHOLD = 1024;
+        // Deeper nodes are split at the median, so the recursion depth stays bounded with the skewed inputs.
+        constexpr Uint32 MAX_SAH_BUILD_DEPTH = 64;
+
+        struct FrustumStackEntry
+        {
+            Uint32 nodeIndex;
+            Uint32 planeMask;
+        };
+
+        struct RayStackEntry
+        {
+            Uint32 nodeIndex;
+            float distance;
+        };
+
+        // Reused in the queries of each thread.
+        thread_local Vector<FrustumStackEntry> thlFrustumStack;
+        thread_local Vector<RayStackEntry> thlRayStack;
+        thread_local Vector<Uint32> thlSubtreeStack;
+
+        float GetAxis(const Float3& v, int axis)
+        {
+            return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+        }
+
+        bool IsSameBounds(const AABB& a, const AABB& b)
+        {
+            return a.min == b.min && a.max == b.max;
+        }
+
+        // Slab test with the precomputed inverse direction.
+        bool IntersectsRay(const AABB& bounds, const Float3& origin, const Float3& invDirection, float maxDistance, float& outDistance)
+        {
+            const Float3 t0 = (bounds.min - origin) * invDirection;
+            const Float3 t1 = (bounds.max - origin) * invDirection;
+
+            const float tEnter = std::max({ std::min(t0.x, t1.x), std::min(t0.y, t1.y), std::min(t0.z, t1.z), 0.0f });
+            const float tExit = std::min({ std::max(t0.x, t1.x), std::max(t0.y, t1.y), std::max(t0.z, t1.z), maxDistance });
+            if (tEnter > tExit)
+            {
+                return false;
+            }
+
+            outDistance = tEnter;
+            return true;
+        }
+    } // namespace
+
+    void BVH::Clear()
+    {
+        mNodes.clear();
+        mRootIndex = INVALID_INDEX;
+        mNumItems = 0;
+        mItemLeafNodes.clear();
+        mDirtyLeafNodes.clear();
+    }
+
+    void BVH::Build(ArrayView<const AABB> itemBounds, JobSystem* jobSystem)
+    {
+        Clear();
+
+        Vector<BuildItem> items;
+        items.reserve(itemBounds.size());
+        for (Uint32 i = 0; i < static_cast<Uint32>(itemBounds.size()); ++i)
+        {
+            if (itemBounds[i].IsValid())
+            {
+                items.push_back({ .bounds = itemBounds[i], .centroid = itemBounds[i].GetCenter(), .itemId = i });
+            }
+        }
+        mItemLeafNodes.assign(itemBounds.size(), INVALID_INDEX);
+        if (items.empty())
+        {
+            return;
+        }
+
+        // A subtree of n items has 2n - 1 nodes, so the node indices of each subtree are known before building it
+        // and the subtrees can be built in parallel without synchronization.
+        mNumItems = items.size();
+        mNodes.resize(2 * items.size() - 1);
+        mRootIndex = 0;
+        BuildNode(items, 0, INVALID_INDEX, 0, jobSystem);
+    }
+
+    void BVH::BuildNode(ArrayView<BuildItem> items, Uint32 nodeIndex, Uint32 parentIndex, Uint32 depth, JobSystem* jobSystem)
+    {
+        Node& node = mNodes[nodeIndex];
+        node.parent = parentIndex;
+
+        if (items.size() == 1)
+        {
+            node.bounds = items[0].bounds;
+            node.itemId = items[0].itemId;
+            mItemLeafNodes[node.itemId] = nodeIndex;
+            return;
+        }
+
+        AABB bounds;
+        AABB centroidBounds;
+        for (const BuildItem& item : items)
+        {
+            bounds.Merge(item.bounds);
+            centroidBounds.Merge(item.centroid);
+        }
+        node.bounds = bounds;
+
+        const Float3 centroidExtent = centroidBounds.max - centroidBounds.min;
+        int largestAxis = 0;
+        if (GetAxis(centroidExtent, 1) > GetAxis(centroidExtent, largestAxis)) largestAxis = 1;
+        if (GetAxis(centroidExtent, 2) > GetAxis(centroidExtent, largestAxis)) largestAxis = 2;
+
+        Uint64 numLeft = 0;
+        if (depth < MAX_SAH_BUILD_DEPTH)
+        {
+            // Binned SAH: bin the centroids in each axis, and find the split between the bins with the lowest cost.
+            // (cost = number of items * surface area, for each side)
+            int bestAxis = -1;
+            int bestSplit = -1;
+            float bestCost = FLT_MAX;
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                const float axisExtent = GetAxis(centroidExtent, axis);
+                if (axisExtent <= 0.0f)
+                {
+                    continue;
+                }
+                const float axisMin = GetAxis(centroidBounds.min, axis);
+                const float binScale = NUM_SAH_BINS / axisExtent;
+
+                struct Bin
+                {
+                    AABB bounds;
+                    Uint32 count = 0;
+                };
+                Bin bins[NUM_SAH_BINS];
+                for (const BuildItem& item : items)
+                {
+                    const int binIndex = std::min(static_cast<int>((GetAxis(item.centroid, axis) - axisMin) * binScale), NUM_SAH_BINS - 1);
+                    bins[binIndex].bounds.Merge(item.bounds);
+                    bins[binIndex].count++;
+                }
+
+                // Right sides first, then sweep from the left.
+                float rightCosts[NUM_SAH_BINS];
+                Uint32 rightCounts[NUM_SAH_BINS];
+                AABB rightBounds;
+                Uint32 rightCount = 0;
+                for (int i = NUM_SAH_BINS - 1; i > 0; --i)
+                {
+                    rightBounds.Merge(bins[i].bounds);
+                    rightCount += bins[i].count;
+                    rightCosts[i] = rightCount * rightBounds.GetSurfaceArea();
+                    rightCounts[i] = rightCount;
+                }
+
+                AABB leftBounds;
+                Uint32 leftCount = 0;
+                for (int i = 0; i < NUM_SAH_BINS - 1; ++i)
+                {
+                    leftBounds.Merge(bins[i].bounds);
+                    leftCount += bins[i].count;
+                    if (leftCount == 0 || rightCounts[i + 1] == 0)
+                    {
+                        continue;
+                    }
+
+                    const float cost = leftCount * leftBounds.GetSurfaceArea() + rightCosts[i + 1];
+                    if (cost < bestCost)
+                    {
+                        bestCost = cost;
+                        bestAxis = axis;
+                        bestSplit = i;
+                    }
+                }
+            }
+
+            if (bestAxis != -1)
+            {
+                const float axisMin = GetAxis(centroidBounds.min, bestAxis);
+                const float binScale = NUM_SAH_BINS / GetAxis(centroidExtent, bestAxis);
+                BuildItem* middle = std::partition(items.data(), items.data() + items.size(), [=](const BuildItem& item)
+                {
+                    const int binIndex = std::min(static_cast<int>((GetAxis(item.centroid, bestAxis) - axisMin) * binScale), NUM_SAH_BINS - 1);
+                    return binIndex <= bestSplit;
+                });
+                numLeft = middle - items.data();
+            }
+        }
+        if (numLeft == 0 || numLeft == items.size())
+        {
+            // Too deep or all centroids are at the same position. Split at the median.
+            numLeft = items.size() / 2;
+            std::nth_element(items.data(), items.data() + numLeft, items.data() + items.size(), [largestAxis](const BuildItem& a, const BuildItem& b)
+            {
+                return GetAxis(a.centroid, largestAxis) < GetAxis(b.centroid, largestAxis);
+            });
+        }
+
+        const ArrayView<BuildItem> leftItems = items.subspan(0, numLeft);
+        const ArrayView<BuildItem> rightItems = items.subspan(numLeft);
+        const Uint32 leftIndex = nodeIndex + 1;
+        const Uint32 rightIndex = nodeIndex + static_cast<Uint32>(2 * numLeft);
+        node.left = leftIndex;
+        node.right = rightIndex;
+
+        if (jobSystem != nullptr && items.size() >= PARALLEL_BUILD_THRESHOLD)
+        {
+            jobSystem->ParallelFor(0, 2, 1, [&](Uint64 childIndex)
+            {
+                if (childIndex == 0)
+                {
+                    BuildNode(leftItems, leftIndex, nodeIndex, depth + 1, jobSystem);
+                }
+                else
+                {
+                    BuildNode(rightItems, rightIndex, nodeIndex, depth + 1, jobSystem);
+                }
+            });
+        }
+        else
+        {
+            BuildNode(leftItems, leftIndex, nodeIndex, depth + 1, nullptr);
+            BuildNode(rightItems, rightIndex, nodeIndex, depth + 1, nullptr);
+        }
+    }
+
+    void BVH::Insert(Uint32 itemId, const AABB& bounds)
+    {
+        assert(!Contains(itemId));
+        assert(bounds.IsValid());
+
+        if (itemId >= mItemLeafNodes.size())
+        {
+            mItemLeafNodes.resize(itemId + 1, INVALID_INDEX);
+        }
+        const Uint32 leafIndex = static_cast<Uint32>(mNodes.size());
+        mNodes.push_back({ .bounds = bounds, .itemId = itemId });
+        mItemLeafNodes[itemId] = leafIndex;
+        mNumItems++;
+
+        if (mRootIndex == INVALID_INDEX)
+        {
+            mRootIndex = leafIndex;
+            return;
+        }
+
+        // Find the sibling by descending to the child with the lower SAH cost. (Same as the dynamic AABB tree in Box2D)
+        Uint32 index = mRootIndex;
+        while (!mNodes[index].IsLeaf())
+        {
+            const Node& node = mNodes[index];
+            AABB combinedBounds = node.bounds;
+            combinedBounds.Merge(bounds);
+            const float area = node.bounds.GetSurfaceArea();
+            const float combinedArea = combinedBounds.GetSurfaceArea();
+
+            // Cost of making a new parent of this node and the leaf
+            const float cost = 2.0f * combinedArea;
+            // Minimum cost of pushing the leaf further down. The ancestors grow by it.
+            const float inheritanceCost = 2.0f * (combinedArea - area);
+
+            auto GetDescendCost = [this, &bounds, inheritanceCost](Uint32 childIndex)
+            {
+                const Node& child = mNodes[childIndex];
+                AABB childCombinedBounds = child.bounds;
+                childCombinedBounds.Merge(bounds);
+                if (child.IsLeaf())
+                {
+                    return childCombinedBounds.GetSurfaceArea() + inheritanceCost;
+                }
+                return childCombinedBounds.GetSurfaceArea() - child.bounds.GetSurfaceArea() + inheritanceCost;
+            };
+            const float leftCost = GetDescendCost(node.left);
+            const float rightCost = GetDescendCost(node.right);
+
+            if (cost < leftCost && cost < rightCost)
+            {
+                break;
+            }
+            index = leftCost < rightCost ? node.left : node.right;
+        }
+
+        const Uint32 siblingIndex = index;
+        const Uint32 oldParentIndex = mNodes[siblingIndex].parent;
+        const Uint32 newParentIndex = static_cast<Uint32>(mNodes.size());
+        AABB newParentBounds = mNodes[siblingIndex].bounds;
+        newParentBounds.Merge(bounds);
+        mNodes.push_back({ .bounds = newParentBounds, .parent = oldParentIndex, .left = siblingIndex, .right = leafIndex });
+        mNodes[siblingIndex].parent = newParentIndex;
+        mNodes[leafIndex].parent = newParentIndex;
+
+        if (oldParentIndex == INVALID_INDEX)
+        {
+            mRootIndex = newParentIndex;
+        }
+        else
+        {
+            Node& oldParent = mNodes[oldParentIndex];
+            if (oldParent.left == siblingIndex)
+            {
+                oldParent.left = newParentIndex;
+            }
+            else
+            {
+                oldParent.right = newParentIndex;
+            }
+            RefitFrom(oldParentIndex);
+        }
+    }
+
+    void BVH::UpdateItem(Uint32 itemId, const AABB& bounds)
+    {
+        assert(Contains(itemId));
+        assert(bounds.IsValid());
+
+        const Uint32 leafIndex = mItemLeafNodes[itemId];
+        mNodes[leafIndex].bounds = bounds;
+        mDirtyLeafNodes.push_back(leafIndex);
+    }
+
+    void BVH::Refit()
+    {
+        for (Uint32 leafIndex : mDirtyLeafNodes)
+        {
+            RefitFrom(mNodes[leafIndex].parent);
+        }
+        mDirtyLeafNodes.clear();
+    }
+
+    void BVH::RefitFrom(Uint32 nodeIndex)
+    {
+        // Stop if a node does not change. Its ancestors are already up to date.
+        while (nodeIndex != INVALID_INDEX)
+        {
+            Node& node = mNodes[nodeIndex];
+            AABB newBounds = mNodes[node.left].bounds;
+            newBounds.Merge(mNodes[node.right].bounds);
+            if (IsSameBounds(newBounds, node.bounds))
+            {
+                break;
+            }
+
+            node.bounds = newBounds;
+            nodeIndex = node.parent;
+        }
+    }
+
+    float BVH::GetSAHCost() const
+    {
+        if (mRootIndex == INVALID_INDEX)
+        {
+            return 0.0f;
+        }
+
+        float sumArea = 0.0f;
+        for (const Node& node : mNodes)
+        {
+            if (!node.IsLeaf())
+            {
+                sumArea += node.bounds.GetSurfaceArea();
+            }
+        }
+        const float rootArea = mNodes[mRootIndex].bounds.GetSurfaceArea();
+        return rootArea > 0.0f ? sumArea / rootArea : 0.0f;
+    }
+
+    Uint64 BVH::QueryFrustum(const Frustum& frustum, Vector<Uint32>& outItemIds) const
+    {
+        if (mRootIndex == INVALID_INDEX)
+        {
+            return 0;
+        }
+
+        Vector<FrustumStackEntry>& stack = thlFrustumStack;
+        stack.clear();
+        stack.push_back({ .nodeIndex = mRootIndex, .planeMask = Frustum::ALL_PLANES_MASK });
+
+        Uint64 numTestedNodes = 0;
+        while (!stack.empty())
+        {
+            const FrustumStackEntry entry = stack.back();
+            stack.pop_back();
+
+            const Node& node = mNodes[entry.nodeIndex];
+            Uint32 planeMask = entry.planeMask;
+            numTestedNodes++;
+
+            switch (frustum.Classify(node.bounds, planeMask))
+            {
+            case FrustumTestResult::Outside:
+                break;
+            case FrustumTestResult::Inside:
+                AppendSubtreeItems(entry.nodeIndex, outItemIds);
+                break;
+            case FrustumTestResult::Intersecting:
+                if (node.IsLeaf())
+                {
+                    outItemIds.push_back(node.itemId);
+                }
+                else
+                {
+                    // The children only test the planes the node intersects.
+                    stack.push_back({ .nodeIndex = node.right, .planeMask = planeMask });
+                    stack.push_back({ .nodeIndex = node.left, .planeMask = planeMask });
+                }
+                break;
+            }
+        }
+
+        return numTestedNodes;
+    }
+
+    void BVH::AppendSubtreeItems(Uint32 nodeIndex, Vector<Uint32>& outItemIds) const
+    {
+        Vector<Uint32>& stack = thlSubtreeStack;
+        stack.clear();
+        stack.push_back(nodeIndex);
+
+        while (!stack.empty())
+        {
+            const Node& node = mNodes[stack.back()];
+            stack.pop_back();
+
+            if (node.IsLeaf())
+            {
+                outItemIds.push_back(node.itemId);
+            }
+            else
+            {
+                stack.push_back(node.right);
+                stack.push_back(node.left);
+            }
+        }
+    }
+
+    void BVH::QueryRay(const Ray& ray, Vector<Uint32>& outItemIds) const
+    {
+        if (mRootIndex == INVALID_INDEX)
+        {
+            return;
+        }
+
+        const Float3 invDirection = { 1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z };
+
+        Vector<Uint32>& stack = thlSubtreeStack;
+        stack.clear();
+        stack.push_back(mRootIndex);
+
+        while (!stack.empty())
+        {
+            const Node& node = mNodes[stack.back()];
+            stack.pop_back();
+
+            float distance;
+            if (!IntersectsRay(node.bounds, ray.origin, invDirection, ray.maxDistance, distance))
+            {
+                continue;
+            }
+
+            if (node.IsLeaf())
+            {
+                outItemIds.push_back(node.itemId);
+            }
+            else
+            {
+                stack.push_back(node.right);
+                stack.push_back(node.left);
+            }
+        }
+    }
+
+    bool BVH::Raycast(const Ray& ray, RayHit& outHit) const
+    {
+        if (mRootIndex == INVALID_INDEX)
+        {
+            return false;
+        }
+
+        const Float3 invDirection = { 1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z };
+
+        RayHit closestHit = { .distance = ray.maxDistance };
+        float rootDistance;
+        if (!IntersectsRay(mNodes[mRootIndex].bounds, ray.origin, invDirection, ray.maxDistance, rootDistance))
+        {
+            return false;
+        }
+
+        Vector<RayStackEntry>& stack = thlRayStack;
+        stack.clear();
+        stack.push_back({ .nodeIndex = mRootIndex, .distance = rootDistance });
+
+        while (!stack.empty())
+        {
+            const RayStackEntry entry = stack.back();
+            stack.pop_back();
+
+            // A closer hit is found after this node is pushed.
+            if (entry.distance > closestHit.distance)
+            {
+                continue;
+            }
+
+            const Node& node = mNodes[entry.nodeIndex];
+            if (node.IsLeaf())
+            {
+                closestHit = { .itemId = node.itemId, .distance = entry.distance };
+                continue;
+            }
+
+            // Visit the nearer child first.
+            float leftDistance, rightDistance;
+            const bool isLeftHit = IntersectsRay(mNodes[node.left].bounds, ray.origin, invDirection, closestHit.distance, leftDistance);
+            const bool isRightHit = IntersectsRay(mNodes[node.right].bounds, ray.origin, invDirection, closestHit.distance, rightDistance);
+            if (isLeftHit && isRightHit)
+            {
+                if (leftDistance <= rightDistance)
+                {
+                    stack.push_back({ .nodeIndex = node.right, .distance = rightDistance });
+                    stack.push_back({ .nodeIndex = node.left, .distance = leftDistance });
+                }
+                else
+                {
+                    stack.push_back({ .nodeIndex = node.left, .distance = leftDistance });
+                    stack.push_back({ .nodeIndex = node.right, .distance = rightDistance });
+                }
+            }
+            else if (isLeftHit)
+            {
+                stack.push_back({ .nodeIndex = node.left, .distance = leftDistance });
+            }
+            else if (isRightHit)
+            {
+                stack.push_back({ .nodeIndex = node.right, .distance = rightDistance });
+            }
+        }
+
+        if (closestHit.itemId == INVALID_INDEX)
+        {
+            return false;
+        }
+        outHit = closestHit;
+        return true;
+    }
+} // namespace cube
@@ -0,0 +1,348 @@
+#include "BoundingVolume.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cmath>
+
+// SSE2 is the baseline of x64, so the SSE path is used even if the vector types are not built with SIMD.
+#if CUBE_VECTOR_USE_AVX2
+#define CUBE_CULLING_USE_AVX2 1
+#include <immintrin.h>
+#elif CUBE_VECTOR_USE_SSE || defined(_M_X64) || defined(__SSE2__)
+#define CUBE_CULLING_USE_SSE 1
+#include <immintrin.h>
+#endif
+
+namespace cube
+{
+    namespace
+    {
+        Float3 Min(const Float3& a, const Float3& b)
+        {
+            return { std::min(a.x, b.x), std::min(a.y, b.y), std::min(a.z, b.z) };
+        }
+
+        Float3 Max(const Float3& a, const Float3& b)
+        {
+            return { std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z) };
+        }
+
+        bool IsBoxInsidePlane(const Float4& plane, const Float3& center, const Float3& extent)
+        {
+            const float distance = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+            const float radius = std::abs(plane.x) * extent.x + std::abs(plane.y) * extent.y + std::abs(plane.z) * extent.z;
+            return distance + radius >= 0.0f;
+        }
+    } // namespace
+
+    void AABB::Merge(const Float3& point)
+    {
+        min = Min(min, point);
+        max = Max(max, point);
+    }
+
+    void AABB::Merge(const AABB& other)
+    {
+        min = Min(min, other.min);
+        max = Max(max, other.max);
+    }
+
+    AABB AABB::Transformed(const Matrix& matrix) const
+    {
+        if (!IsValid())
+        {
+            return *this;
+        }
+
+        // Transform the center, and project the extent onto the transformed axes.
+        const Float3 center = GetCenter();
+        const Float3 extent = GetExtent();
+        const Float4 row0 = matrix.GetRow(0).GetFloat4();
+        const Float4 row1 = matrix.GetRow(1).GetFloat4();
+        const Float4 row2 = matrix.GetRow(2).GetFloat4();
+        const Float4 row3 = matrix.GetRow(3).GetFloat4();
+
+        const Float3 newCenter = {
+            center.x * row0.x + center.y * row1.x + center.z * row2.x + row3.x,
+            center.x * row0.y + center.y * row1.y + center.z * row2.y + row3.y,
+            center.x * row0.z + center.y * row1.z + center.z * row2.z + row3.z
+        };
+        const Float3 newExtent = {
+            extent.x * std::abs(row0.x) + extent.y * std::abs(row1.x) + extent.z * std::abs(row2.x),
+            extent.x * std::abs(row0.y) + extent.y * std::abs(row1.y) + extent.z * std::abs(row2.y),
+            extent.x * std::abs(row0.z) + extent.y * std::abs(row1.z) + extent.z * std::abs(row2.z)
+        };
+
+        return {
+            .min = newCenter - newExtent,
+            .max = newCenter + newExtent
+        };
+    }
+
+    float AABB::GetSurfaceArea() const
+    {
+        if (!IsValid())
+        {
+            return 0.0f;
+        }
+
+        const Float3 size = max - min;
+        return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+
+    bool AABB::IntersectsRay(const Ray& ray, float& outDistance) const
+    {
+        // Slab test. The division by zero makes infinity, so the axis parallel to the ray is handled by the comparisons.
+        const Float3 invDirection = { 1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z };
+        const Float3 t0 = (min - ray.origin) * invDirection;
+        const Float3 t1 = (max - ray.origin) * invDirection;
+
+        const float tEnter = std::max({ std::min(t0.x, t1.x), std::min(t0.y, t1.y), std::min(t0.z, t1.z), 0.0f });
+        const float tExit = std::min({ std::max(t0.x, t1.x), std::max(t0.y, t1.y), std::max(t0.z, t1.z), ray.maxDistance });
+        if (tEnter > tExit)
+        {
+            return false;
+        }
+
+        outDistance = tEnter;
+        return true;
+    }
+
+    void AABBBatch::Clear()
+    {
+        mCenterX.clear();
+        mCenterY.clear();
+        mCenterZ.clear();
+        mExtentX.clear();
+        mExtentY.clear();
+        mExtentZ.clear();
+    }
+
+    void AABBBatch::Reserve(Uint64 size)
+    {
+        mCenterX.reserve(size);
+        mCenterY.reserve(size);
+        mCenterZ.reserve(size);
+        mExtentX.reserve(size);
+        mExtentY.reserve(size);
+        mExtentZ.reserve(size);
+    }
+
+    void AABBBatch::Add(const AABB& box)
+    {
+        const Float3 center = box.GetCenter();
+        const Float3 extent = box.GetExtent();
+        mCenterX.push_back(center.x);
+        mCenterY.push_back(center.y);
+        mCenterZ.push_back(center.z);
+        mExtentX.push_back(extent.x);
+        mExtentY.push_back(extent.y);
+        mExtentZ.push_back(extent.z);
+    }
+
+    Frustum Frustum::FromViewProjection(const Matrix& viewProjection)
+    {
+        // clip = (p, 1) * viewProjection, so each clip component is the dot with a column.
+        // Inside: -w <= x <= w, -w <= y <= w, 0 <= z <= w
+        const Float4 col0 = viewProjection.GetCol(0).GetFloat4();
+        const Float4 col1 = viewProjection.GetCol(1).GetFloat4();
+        const Float4 col2 = viewProjection.GetCol(2).GetFloat4();
+        const Float4 col3 = viewProjection.GetCol(3).GetFloat4();
+
+        Frustum frustum;
+        frustum.mPlanes[0] = col3 + col0;
+        frustum.mPlanes[1] = col3 - col0;
+        frustum.mPlanes[2] = col3 + col1;
+        frustum.mPlanes[3] = col3 - col1;
+        frustum.mPlanes[4] = col2;
+        frustum.mPlanes[5] = col3 - col2;
+
+        for (Float4& plane : frustum.mPlanes)
+        {
+            const float length = std::sqrt(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z);
+            if (length > 0.0f)
+            {
+                plane /= length;
+            }
+        }
+
+        return frustum;
+    }
+
+    bool Frustum::Intersects(const AABB& box) const
+    {
+        const Float3 center = box.GetCenter();
+        const Float3 extent = box.GetExtent();
+        for (const Float4& plane : mPlanes)
+        {
+            if (!IsBoxInsidePlane(plane, center, extent))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    FrustumTestResult Frustum::Classify(const AABB& box, Uint32& inOutPlaneMask) const
+    {
+        const Float3 center = box.GetCenter();
+        const Float3 extent = box.GetExtent();
+        for (int i = 0; i < NUM_PLANES; ++i)
+        {
+            if ((inOutPlaneMask & (1 << i)) == 0)
+            {
+                continue;
+            }
+
+            const Float4& plane = mPlanes[i];
+            const float distance = plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w;
+            const float radius = std::abs(plane.x) * extent.x + std::abs(plane.y) * extent.y + std::abs(plane.z) * extent.z;
+            if (distance + radius < 0.0f)
+            {
+                return FrustumTestResult::Outside;
+            }
+            if (distance - radius >= 0.0f)
+            {
+                inOutPlaneMask &= ~(1 << i);
+            }
+        }
+
+        return inOutPlaneMask == 0 ? FrustumTestResult::Inside : FrustumTestResult::Intersecting;
+    }
+
+    bool Frustum::Intersects(const Sphere& sphere) const
+    {
+        for (const Float4& plane : mPlanes)
+        {
+            const float distance = plane.x * sphere.center.x + plane.y * sphere.center.y + plane.z * sphere.center.z + plane.w;
+            if (distance < -sphere.radius)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    Uint64 Frustum::CullAABBs(const AABBBatch& boxes, ArrayView<Uint8> outIsVisible) const
+    {
+        const Uint64 numBoxes = boxes.GetSize();
+        assert(outIsVisible.size() >= numBoxes);
+
+        Uint64 numVisible = 0;
+        Uint64 i = 0;
+
+#if CUBE_CULLING_USE_AVX2
+        // 8 boxes per iteration. The planes are broadcasted once.
+        __m256 planeX[NUM_PLANES], planeY[NUM_PLANES], planeZ[NUM_PLANES], planeW[NUM_PLANES];
+        __m256 absPlaneX[NUM_PLANES], absPlaneY[NUM_PLANES], absPlaneZ[NUM_PLANES];
+        for (int p = 0; p < NUM_PLANES; ++p)
+        {
+            planeX[p] = _mm256_set1_ps(mPlanes[p].x);
+            planeY[p] = _mm256_set1_ps(mPlanes[p].y);
+            planeZ[p] = _mm256_set1_ps(mPlanes[p].z);
+            planeW[p] = _mm256_set1_ps(mPlanes[p].w);
+            absPlaneX[p] = _mm256_set1_ps(std::abs(mPlanes[p].x));
+            absPlaneY[p] = _mm256_set1_ps(std::abs(mPlanes[p].y));
+            absPlaneZ[p] = _mm256_set1_ps(std::abs(mPlanes[p].z));
+        }
+        const __m256 zero = _mm256_setzero_ps();
+
+        for (; i + 8 <= numBoxes; i += 8)
+        {
+            const __m256 centerX = _mm256_loadu_ps(boxes.mCenterX.data() + i);
+            const __m256 centerY = _mm256_loadu_ps(boxes.mCenterY.data() + i);
+            const __m256 centerZ = _mm256_loadu_ps(boxes.mCenterZ.data() + i);
+            const __m256 extentX = _mm256_loadu_ps(boxes.mExtentX.data() + i);
+            const __m256 extentY = _mm256_loadu_ps(boxes.mExtentY.data() + i);
+            const __m256 extentZ = _mm256_loadu_ps(boxes.mExtentZ.data() + i);
+
+            __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+            for (int p = 0; p < NUM_PLANES; ++p)
+            {
+                __m256 distance = _mm256_add_ps(_mm256_mul_ps(planeX[p], centerX), _mm256_mul_ps(planeY[p], centerY));
+                distance = _mm256_add_ps(distance, _mm256_mul_ps(planeZ[p], centerZ));
+                distance = _mm256_add_ps(distance, planeW[p]);
+
+                __m256 radius = _mm256_add_ps(_mm256_mul_ps(absPlaneX[p], extentX), _mm256_mul_ps(absPlaneY[p], extentY));
+                radius = _mm256_add_ps(radius, _mm256_mul_ps(absPlaneZ[p], extentZ));
+
+                inside = _mm256_and_ps(inside, _mm256_cmp_ps(_mm256_add_ps(distance, radius), zero, _CMP_GE_OQ));
+            }
+
+            const int mask = _mm256_movemask_ps(inside);
+            for (int lane = 0; lane < 8; ++lane)
+            {
+                outIsVisible[i + lane] = static_cast<Uint8>((mask >> lane) & 1);
+            }
+            numVisible += std::popcount(static_cast<Uint32>(mask));
+        }
+#elif CUBE_CULLING_USE_SSE
+        // 4 boxes per iteration. The planes are broadcasted once.
+        __m128 planeX[NUM_PLANES], planeY[NUM_PLANES], planeZ[NUM_PLANES], planeW[NUM_PLANES];
+        __m128 absPlaneX[NUM_PLANES], absPlaneY[NUM_PLANES], absPlaneZ[NUM_PLANES];
+        for (int p = 0; p < NUM_PLANES; ++p)
+        {
+            planeX[p] = _mm_set1_ps(mPlanes[p].x);
+            planeY[p] = _mm_set1_ps(mPlanes[p].y);
+            planeZ[p] = _mm_set1_ps(mPlanes[p].z);
+            planeW[p] = _mm_set1_ps(mPlanes[p].w);
+            absPlaneX[p] = _mm_set1_ps(std::abs(mPlanes[p].x));
+            absPlaneY[p] = _mm_set1_ps(std::abs(mPlanes[p].y));
+            absPlaneZ[p] = _mm_set1_ps(std::abs(mPlanes[p].z));
+        }
+        const __m128 zero = _mm_setzero_ps();
+
+        for (; i + 4 <= numBoxes; i += 4)
+        {
+            const __m128 centerX = _mm_loadu_ps(boxes.mCenterX.data() + i);
+            const __m128 centerY = _mm_loadu_ps(boxes.mCenterY.data() + i);
+            const __m128 centerZ = _mm_loadu_ps(boxes.mCenterZ.data() + i);
+            const __m128 extentX = _mm_loadu_ps(boxes.mExtentX.data() + i);
+            const __m128 extentY = _mm_loadu_ps(boxes.mExtentY.data() + i);
+            const __m128 extentZ = _mm_loadu_ps(boxes.mExtentZ.data() + i);
+
+            __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for (int p = 0; p < NUM_PLANES; ++p)
+            {
+                __m128 distance = _mm_add_ps(_mm_mul_ps(planeX[p], centerX), _mm_mul_ps(planeY[p], centerY));
+                distance = _mm_add_ps(distance, _mm_mul_ps(planeZ[p], centerZ));
+                distance = _mm_add_ps(distance, planeW[p]);
+
+                __m128 radius = _mm_add_ps(_mm_mul_ps(absPlaneX[p], extentX), _mm_mul_ps(absPlaneY[p], extentY));
+                radius = _mm_add_ps(radius, _mm_mul_ps(absPlaneZ[p], extentZ));
+
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(_mm_add_ps(distance, radius), zero));
+            }
+
+            const int mask = _mm_movemask_ps(inside);
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                outIsVisible[i + lane] = static_cast<Uint8>((mask >> lane) & 1);
+            }
+            numVisible += std::popcount(static_cast<Uint32>(mask));
+        }
+#endif
+
+        // Remaining boxes (or all boxes without SIMD)
+        for (; i < numBoxes; ++i)
+        {
+            const Float3 center = { boxes.mCenterX[i], boxes.mCenterY[i], boxes.mCenterZ[i] };
+            const Float3 extent = { boxes.mExtentX[i], boxes.mExtentY[i], boxes.mExtentZ[i] };
+
+            bool isVisible = true;
+            for (const Float4& plane : mPlanes)
+            {
+                if (!IsBoxInsidePlane(plane, center, extent))
+                {
+                    isVisible = false;
+                    break;
+                }
+            }
+            outIsVisible[i] = isVisible ? 1 : 0;
+            numVisible += isVisible ? 1 : 0;
+        }
+
+        return numVisible;
+    }
+} // namespace cube
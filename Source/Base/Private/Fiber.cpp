@@ -0,0 +1,246 @@
+#if !CUBE_PLATFORM_WINDOWS && defined(__APPLE__)
+// ucontext is deprecated in macOS, but still available with _XOPEN_SOURCE.
+#define _XOPEN_SOURCE 600
+#endif
+
+#include "Fiber.h"
+
+#include <cassert>
+
+#if CUBE_PLATFORM_WINDOWS
+#include <Windows.h>
+#else
+#include <pthread.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+#endif
+
+#if defined(__has_feature)
+#if __has_feature(address_sanitizer)
+#define CUBE_FIBER_ASAN 1
+#endif
+#if __has_feature(thread_sanitizer)
+#define CUBE_FIBER_TSAN 1
+#endif
+#endif
+#if defined(__SANITIZE_ADDRESS__)
+#define CUBE_FIBER_ASAN 1
+#endif
+#if defined(__SANITIZE_THREAD__)
+#define CUBE_FIBER_TSAN 1
+#endif
+
+#if CUBE_FIBER_ASAN
+#include <sanitizer/common_interface_defs.h>
+#endif
+#if CUBE_FIBER_TSAN
+#include <sanitizer/tsan_interface.h>
+#endif
+
+namespace cube
+{
+#if CUBE_PLATFORM_WINDOWS
+
+    namespace
+    {
+        VOID WINAPI FiberStartRoutine(LPVOID parameter)
+        {
+            Fiber::RunEntryFunction(static_cast<Fiber*>(parameter));
+        }
+    } // namespace
+
+    void Fiber::Create(Uint64 stackSize, EntryFunction entryFunction, void* userData)
+    {
+        assert(mHandle == nullptr);
+
+        mEntryFunction = entryFunction;
+        mUserData = userData;
+        // Only the stack size is reserved. The pages are committed on use and the system puts a guard page below them.
+        mHandle = CreateFiberEx(0, stackSize, 0, &FiberStartRoutine, this);
+        mIsThreadFiber = false;
+    }
+
+    void Fiber::CreateFromCurrentThread()
+    {
+        assert(mHandle == nullptr);
+
+        mHandle = ConvertThreadToFiber(nullptr);
+        mIsThreadFiber = true;
+    }
+
+    void Fiber::Destroy()
+    {
+        if (mHandle == nullptr)
+        {
+            return;
+        }
+
+        if (mIsThreadFiber)
+        {
+            ConvertFiberToThread();
+        }
+        else
+        {
+            DeleteFiber(mHandle);
+        }
+        mHandle = nullptr;
+    }
+
+    void Fiber::Switch(Fiber& from, Fiber& to)
+    {
+        SwitchToFiber(to.mHandle);
+    }
+
+#else // ucontext
+
+    namespace
+    {
+        struct FiberContext
+        {
+            ucontext_t context;
+            // Mapping of the stack with the guard page at the bottom
+            void* mapping = nullptr;
+            Uint64 mappingSize = 0;
+
+#if CUBE_FIBER_ASAN
+            const void* asanStackBottom = nullptr;
+            SizeType asanStackSize = 0;
+#endif
+#if CUBE_FIBER_TSAN
+            void* tsanFiber = nullptr;
+#endif
+        };
+
+        // makecontext only passes the int arguments, so the pointer is split into two.
+        void FiberEntry(int fiberPtrHigh, int fiberPtrLow)
+        {
+            const Uint64 fiberPtr = (static_cast<Uint64>(static_cast<Uint32>(fiberPtrHigh)) << 32) | static_cast<Uint32>(fiberPtrLow);
+#if CUBE_FIBER_ASAN
+            __sanitizer_finish_switch_fiber(nullptr, nullptr, nullptr);
+#endif
+            Fiber::RunEntryFunction(reinterpret_cast<Fiber*>(fiberPtr));
+        }
+    } // namespace
+
+    void Fiber::Create(Uint64 stackSize, EntryFunction entryFunction, void* userData)
+    {
+        assert(mHandle == nullptr);
+
+        mEntryFunction = entryFunction;
+        mUserData = userData;
+        mIsThreadFiber = false;
+
+        // The stack grows down, so an overflow hits the inaccessible page below it instead of the other memory.
+        // The pages are committed on use, so a large stack only reserves the address space.
+        const Uint64 pageSize = static_cast<Uint64>(sysconf(_SC_PAGESIZE));
+        stackSize = (stackSize + pageSize - 1) / pageSize * pageSize;
+
+        FiberContext* context = new FiberContext();
+        context->mappingSize = stackSize + pageSize;
+        context->mapping = mmap(nullptr, context->mappingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        assert(context->mapping != MAP_FAILED);
+        mprotect(context->mapping, pageSize, PROT_NONE);
+        void* stack = static_cast<Uint8*>(context->mapping) + pageSize;
+#if CUBE_FIBER_ASAN
+        context->asanStackBottom = stack;
+        context->asanStackSize = stackSize;
+#endif
+#if CUBE_FIBER_TSAN
+        context->tsanFiber = __tsan_create_fiber(0);
+#endif
+
+        getcontext(&context->context);
+        context->context.uc_stack.ss_sp = stack;
+        context->context.uc_stack.ss_size = stackSize;
+        context->context.uc_link = nullptr;
+
+        const Uint64 fiberPtr = reinterpret_cast<Uint64>(this);
+        makecontext(&context->context, reinterpret_cast<void (*)()>(&FiberEntry), 2,
+            static_cast<int>(static_cast<Uint32>(fiberPtr >> 32)), static_cast<int>(static_cast<Uint32>(fiberPtr)));
+
+        mHandle = context;
+    }
+
+    void Fiber::CreateFromCurrentThread()
+    {
+        assert(mHandle == nullptr);
+
+        mIsThreadFiber = true;
+
+        // The context is saved at the first switch.
+        FiberContext* context = new FiberContext();
+#if CUBE_FIBER_ASAN
+#if defined(__APPLE__)
+        context->asanStackSize = pthread_get_stacksize_np(pthread_self());
+        context->asanStackBottom = static_cast<Uint8*>(pthread_get_stackaddr_np(pthread_self())) - context->asanStackSize;
+#else
+        pthread_attr_t attr;
+        pthread_getattr_np(pthread_self(), &attr);
+        void* stackAddr = nullptr;
+        SizeType stackSize = 0;
+        pthread_attr_getstack(&attr, &stackAddr, &stackSize);
+        pthread_attr_destroy(&attr);
+        context->asanStackBottom = stackAddr;
+        context->asanStackSize = stackSize;
+#endif
+#endif
+#if CUBE_FIBER_TSAN
+        context->tsanFiber = __tsan_get_current_fiber();
+#endif
+
+        mHandle = context;
+    }
+
+    void Fiber::Destroy()
+    {
+        if (mHandle == nullptr)
+        {
+            return;
+        }
+
+        FiberContext* context = static_cast<FiberContext*>(mHandle);
+        if (!mIsThreadFiber)
+        {
+#if CUBE_FIBER_TSAN
+            __tsan_destroy_fiber(context->tsanFiber);
+#endif
+            munmap(context->mapping, context->mappingSize);
+        }
+        delete context;
+        mHandle = nullptr;
+    }
+
+    void Fiber::Switch(Fiber& from, Fiber& to)
+    {
+        FiberContext* fromContext = static_cast<FiberContext*>(from.mHandle);
+        FiberContext* toContext = static_cast<FiberContext*>(to.mHandle);
+
+#if CUBE_FIBER_ASAN
+        void* fakeStack = nullptr;
+        __sanitizer_start_switch_fiber(&fakeStack, toContext->asanStackBottom, toContext->asanStackSize);
+#endif
+#if CUBE_FIBER_TSAN
+        __tsan_switch_to_fiber(toContext->tsanFiber, 0);
+#endif
+
+        swapcontext(&fromContext->context, &toContext->context);
+
+#if CUBE_FIBER_ASAN
+        __sanitizer_finish_switch_fiber(fakeStack, nullptr, nullptr);
+#endif
+    }
+
+#endif
+
+    Fiber::~Fiber()
+    {
+        Destroy();
+    }
+
+    void Fiber::RunEntryFunction(Fiber* fiber)
+    {
+        fiber->mEntryFunction(fiber->mUserData);
+        assert(false && "The fiber entry function should not return.");
+    }
+} // namespace cube
@@ -0,0 +1,632 @@
+#include "JobSystem.h"
+
+#include <cassert>
+
+namespace cube
+{
+    namespace internal
+    {
+        struct JobFiber
+        {
+            JobSystem* system = nullptr;
+            Fiber fiber = {};
+            void* localData = nullptr;
+            Job* job = nullptr; // First job to run after the switch
+        };
+    } // namespace internal
+
+    namespace
+    {
+        constexpr int NUM_SPINS_BEFORE_SLEEP = 64;
+
+        struct ThreadState
+        {
+            const JobSystem* workerJobSystem = nullptr;
+            Int32 workerIndex = -1;
+            // Depth of the running jobs. The jobs run inside Wait() are nested.
+            Uint32 jobDepth = 0;
+            Uint32 randomState = 0;
+
+            // Fiber running in the worker thread. nullptr in the scheduler.
+            internal::JobFiber* currentFiber = nullptr;
+        };
+        thread_local ThreadState thlThreadState;
+
+        // A fiber can be resumed in another thread, so the address of the thread-local variable should not be cached across the switch.
+        // The volatile read keeps the compiler from merging the calls.
+        NO_INLINE ThreadState& GetThreadState()
+        {
+            ThreadState* volatile state = &thlThreadState;
+            return *state;
+        }
+
+        Uint32 NextRandom()
+        {
+            // xorshift32
+            ThreadState& state = GetThreadState();
+            Uint32 x = state.randomState;
+            if (x == 0)
+            {
+                x = static_cast<Uint32>(std::hash<std::thread::id>()(std::this_thread::get_id())) | 1;
+            }
+            x ^= x << 13;
+            x ^= x >> 17;
+            x ^= x << 5;
+            state.randomState = x;
+            return x;
+        }
+    } // namespace
+
+    void JobHandle::Reset()
+    {
+        if (mCounter)
+        {
+            mCounter->system->ReleaseCounter(mCounter);
+            mCounter = nullptr;
+        }
+    }
+
+    JobSystem::~JobSystem()
+    {
+        assert(mWorkers.empty() && "JobSystem is not shut down.");
+    }
+
+    void JobSystem::Initialize(const JobSystemInitializeInfo& initInfo)
+    {
+        mOnWorkerThreadBegin = initInfo.onWorkerThreadBegin;
+        mOnWorkerThreadEnd = initInfo.onWorkerThreadEnd;
+        mOnJobFinished = initInfo.onJobFinished;
+
+        mUseFibers = initInfo.useFibers;
+        mFiberStackSize = initInfo.fiberStackSize;
+        mCreateFiberLocalData = initInfo.createFiberLocalData;
+        mDestroyFiberLocalData = initInfo.destroyFiberLocalData;
+        mOnFiberSwitched = initInfo.onFiberSwitched;
+
+        mIsShuttingDown.store(false, std::memory_order_relaxed);
+
+        Uint32 numWorkerThreads = initInfo.numWorkerThreads;
+        if (numWorkerThreads == 0)
+        {
+            numWorkerThreads = std::max(std::thread::hardware_concurrency(), 1u) - 1;
+        }
+
+        // Create all deques before starting the threads because the workers steal from each other.
+        mWorkers.resize(numWorkerThreads);
+        for (UniquePtr<Worker>& worker : mWorkers)
+        {
+            worker = std::make_unique<Worker>();
+        }
+        for (Uint32 i = 0; i < numWorkerThreads; ++i)
+        {
+            mWorkers[i]->thread = std::thread(&JobSystem::WorkerThreadMain, this, i);
+        }
+    }
+
+    void JobSystem::Shutdown()
+    {
+        {
+            std::unique_lock<std::mutex> lock(mSleepMutex);
+            mIsShuttingDown.store(true, std::memory_order_release);
+            mSleepCV.notify_all();
+        }
+        for (UniquePtr<Worker>& worker : mWorkers)
+        {
+            worker->thread.join();
+        }
+        mWorkers.clear();
+
+        assert(mSharedQueue.empty() && "Some jobs are not finished.");
+        assert(mReadyFibers.fibers.empty() && mYieldedFibers.fibers.empty() && mFreeFibers.size() == mFibers.size() && "Some fibers are still parked.");
+
+        for (internal::JobFiber* fiber : mFibers)
+        {
+            if (mDestroyFiberLocalData)
+            {
+                mDestroyFiberLocalData(fiber->localData);
+            }
+            fiber->fiber.Destroy();
+            delete fiber;
+        }
+        mFibers.clear();
+        mFreeFibers.clear();
+    }
+
+    Int32 JobSystem::GetCurrentWorkerIndex() const
+    {
+        const ThreadState& state = GetThreadState();
+        return state.workerJobSystem == this ? state.workerIndex : -1;
+    }
+
+    Uint32 JobSystem::GetNumFibers() const
+    {
+        std::unique_lock<std::mutex> lock(mFibersMutex);
+        return static_cast<Uint32>(mFibers.size());
+    }
+
+    void JobSystem::Wait(const JobHandle& handle)
+    {
+        if (handle.IsFinished())
+        {
+            return;
+        }
+
+        ThreadState& state = GetThreadState();
+        if (state.workerJobSystem == this && state.currentFiber != nullptr)
+        {
+            SwitchToScheduler(state.currentFiber, FiberSwitchAction::Park, handle.mCounter);
+            assert(handle.IsFinished());
+            return;
+        }
+
+        const Int32 workerIndex = GetCurrentWorkerIndex();
+        while (!handle.IsFinished())
+        {
+            if (internal::Job* job = FindJob(workerIndex))
+            {
+                RunJob(job);
+            }
+            else
+            {
+                // The remaining jobs are running in the other threads.
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    void JobSystem::YieldCurrentJob()
+    {
+        ThreadState& state = GetThreadState();
+        if (state.workerJobSystem == this && state.currentFiber != nullptr)
+        {
+            SwitchToScheduler(state.currentFiber, FiberSwitchAction::Yield);
+        }
+        else
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    internal::Job* JobSystem::AllocateJob()
+    {
+        return static_cast<internal::Job*>(mJobPool.Allocate());
+    }
+
+    internal::JobCounter* JobSystem::AllocateCounter(Uint32 numPendingJobs)
+    {
+        internal::JobCounter* counter = mCounterPool.New();
+        counter->system = this;
+        counter->numPendingJobs.store(numPendingJobs, std::memory_order_relaxed);
+        counter->refCount.store(1, std::memory_order_relaxed);
+        counter->waitingJobs = nullptr;
+        return counter;
+    }
+
+    void JobSystem::ReleaseCounter(internal::JobCounter* counter)
+    {
+        if (counter->refCount.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            mCounterPool.Delete(counter);
+        }
+    }
+
+    void JobSystem::SubmitJob(internal::Job* job, ArrayView<const JobHandle> dependencies)
+    {
+        // One extra count prevents pushing the job while registering it in the dependencies.
+        job->numRemainingDependencies.store(static_cast<Uint32>(dependencies.size()) + 1, std::memory_order_relaxed);
+
+        Uint32 numFinishedDependencies = 1;
+        for (const JobHandle& dependency : dependencies)
+        {
+            internal::JobCounter* counter = dependency.mCounter;
+            if (counter == nullptr)
+            {
+                numFinishedDependencies++;
+                continue;
+            }
+            assert(counter->system == this);
+
+            // The counter is checked in the lock, so the waiting list is not released between the check and the registration.
+            std::unique_lock<std::mutex> lock(counter->waitingJobsMutex);
+            if (counter->numPendingJobs.load(std::memory_order_acquire) == 0)
+            {
+                numFinishedDependencies++;
+                continue;
+            }
+
+            counter->waitingJobs = mWaitNodePool.New(internal::JobWaitNode{ .job = job, .fiber = nullptr, .next = counter->waitingJobs });
+        }
+
+        if (job->numRemainingDependencies.fetch_sub(numFinishedDependencies, std::memory_order_acq_rel) == numFinishedDependencies)
+        {
+            PushJob(job);
+        }
+    }
+
+    void JobSystem::PushJob(internal::Job* job)
+    {
+        PushJobs({ &job, 1 });
+    }
+
+    void JobSystem::PushJobs(ArrayView<internal::Job*> jobs)
+    {
+        if (jobs.empty())
+        {
+            return;
+        }
+
+        Uint64 pushedIndex = 0;
+        const Int32 workerIndex = GetCurrentWorkerIndex();
+        if (workerIndex != -1)
+        {
+            internal::WorkStealingDeque& deque = mWorkers[workerIndex]->deque;
+            while (pushedIndex < jobs.size() && deque.Push(jobs[pushedIndex]))
+            {
+                pushedIndex++;
+            }
+        }
+        if (pushedIndex < jobs.size())
+        {
+            std::unique_lock<std::mutex> lock(mSharedQueueMutex);
+            mSharedQueue.insert(mSharedQueue.end(), jobs.begin() + pushedIndex, jobs.end());
+            mSharedQueueSize.store(mSharedQueue.size(), std::memory_order_relaxed);
+        }
+
+        WakeWorkers(jobs.size());
+    }
+
+    void JobSystem::WakeWorkers(Uint64 numJobs)
+    {
+        mWorkVersion.fetch_add(1, std::memory_order_seq_cst);
+        if (mNumSleepingWorkers.load(std::memory_order_seq_cst) > 0)
+        {
+            std::unique_lock<std::mutex> lock(mSleepMutex);
+            if (numJobs == 1)
+            {
+                mSleepCV.notify_one();
+            }
+            else
+            {
+                mSleepCV.notify_all();
+            }
+        }
+    }
+
+    internal::Job* JobSystem::FindJob(Int32 workerIndex)
+    {
+        if (workerIndex != -1)
+        {
+            if (internal::Job* job = mWorkers[workerIndex]->deque.Pop())
+            {
+                return job;
+            }
+        }
+
+        if (mSharedQueueSize.load(std::memory_order_relaxed) > 0)
+        {
+            std::unique_lock<std::mutex> lock(mSharedQueueMutex);
+            if (!mSharedQueue.empty())
+            {
+                internal::Job* job = mSharedQueue.front();
+                mSharedQueue.pop_front();
+                mSharedQueueSize.store(mSharedQueue.size(), std::memory_order_relaxed);
+                return job;
+            }
+        }
+
+        // Steal from the random victim first to spread the thieves.
+        const Uint32 numWorkers = static_cast<Uint32>(mWorkers.size());
+        if (numWorkers == 0)
+        {
+            return nullptr;
+        }
+        const Uint32 start = NextRandom() % numWorkers;
+        for (Uint32 i = 0; i < numWorkers; ++i)
+        {
+            const Uint32 victimIndex = (start + i) % numWorkers;
+            if (static_cast<Int32>(victimIndex) == workerIndex)
+            {
+                continue;
+            }
+            if (internal::Job* job = mWorkers[victimIndex]->deque.Steal())
+            {
+                return job;
+            }
+        }
+        return nullptr;
+    }
+
+    void JobSystem::RunJob(internal::Job* job)
+    {
+        ThreadState& state = GetThreadState();
+        state.jobDepth++;
+        ExecuteJob(job);
+        state.jobDepth--;
+
+        if (state.jobDepth == 0 && mOnJobFinished && GetCurrentWorkerIndex() != -1)
+        {
+            mOnJobFinished();
+        }
+    }
+
+    void JobSystem::ExecuteJob(internal::Job* job)
+    {
+        job->invoke(job->functionStorage);
+        job->destroy(job->functionStorage);
+        FinishJob(job);
+    }
+
+    void JobSystem::FinishJob(internal::Job* job)
+    {
+        internal::JobCounter* counter = job->counter;
+        mJobPool.Free(job);
+
+        if (counter->numPendingJobs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            internal::JobWaitNode* node = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(counter->waitingJobsMutex);
+                node = counter->waitingJobs;
+                counter->waitingJobs = nullptr;
+            }
+
+            while (node != nullptr)
+            {
+                internal::JobWaitNode* next = node->next;
+                if (node->fiber != nullptr)
+                {
+                    PushFiber(mReadyFibers, node->fiber);
+                }
+                else if (node->job->numRemainingDependencies.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                {
+                    PushJob(node->job);
+                }
+                mWaitNodePool.Delete(node);
+                node = next;
+            }
+        }
+        ReleaseCounter(counter);
+    }
+
+    void JobSystem::WorkerThreadMain(Uint32 workerIndex)
+    {
+        ThreadState& state = GetThreadState();
+        state.workerJobSystem = this;
+        state.workerIndex = static_cast<Int32>(workerIndex);
+
+        if (mOnWorkerThreadBegin)
+        {
+            mOnWorkerThreadBegin(workerIndex);
+        }
+        if (mUseFibers)
+        {
+            mWorkers[workerIndex]->schedulerFiber.CreateFromCurrentThread();
+        }
+
+        int numSpins = 0;
+        while (!mIsShuttingDown.load(std::memory_order_acquire))
+        {
+            const Uint64 workVersion = mWorkVersion.load(std::memory_order_seq_cst);
+            if (mUseFibers ? RunNextFiber(workerIndex) : RunNextJob(workerIndex))
+            {
+                numSpins = 0;
+                continue;
+            }
+
+            if (numSpins < NUM_SPINS_BEFORE_SLEEP)
+            {
+                numSpins++;
+                std::this_thread::yield();
+                continue;
+            }
+
+            // The version is changed if a job is pushed after it is read, so the job is not missed.
+            std::unique_lock<std::mutex> lock(mSleepMutex);
+            mNumSleepingWorkers.fetch_add(1, std::memory_order_seq_cst);
+            mSleepCV.wait(lock, [this, workVersion]()
+            {
+                return mIsShuttingDown.load(std::memory_order_acquire) || mWorkVersion.load(std::memory_order_seq_cst) != workVersion;
+            });
+            mNumSleepingWorkers.fetch_sub(1, std::memory_order_seq_cst);
+            numSpins = 0;
+        }
+
+        if (mUseFibers)
+        {
+            mWorkers[workerIndex]->schedulerFiber.Destroy();
+        }
+        if (mOnWorkerThreadEnd)
+        {
+            mOnWorkerThreadEnd(workerIndex);
+        }
+
+        state.workerJobSystem = nullptr;
+        state.workerIndex = -1;
+    }
+
+    bool JobSystem::RunNextJob(Uint32 workerIndex)
+    {
+        if (internal::Job* job = FindJob(static_cast<Int32>(workerIndex)))
+        {
+            RunJob(job);
+            return true;
+        }
+        return false;
+    }
+
+    bool JobSystem::RunNextFiber(Uint32 workerIndex)
+    {
+        // The parked fibers first, so the started jobs are finished before starting the new ones and the fibers are reused.
+        Worker& worker = *mWorkers[workerIndex];
+        internal::JobFiber* fiber = PopFiber(mReadyFibers);
+        if (fiber == nullptr)
+        {
+            if (internal::Job* job = FindJob(static_cast<Int32>(workerIndex)))
+            {
+                fiber = AcquireFiber(job);
+            }
+            else
+            {
+                fiber = PopFiber(mYieldedFibers);
+            }
+        }
+
+        if (fiber == nullptr)
+        {
+            return false;
+        }
+        SwitchToFiber(worker, fiber);
+        return true;
+    }
+
+    void JobSystem::FiberMain(void* userData)
+    {
+        internal::JobFiber* self = static_cast<internal::JobFiber*>(userData);
+        JobSystem* system = self->system;
+        while (true)
+        {
+            internal::Job* job = self->job;
+            self->job = nullptr;
+            while (job != nullptr)
+            {
+                system->ExecuteJob(job);
+                if (system->mOnJobFinished)
+                {
+                    system->mOnJobFinished();
+                }
+
+                // Keep running the new jobs in this fiber without switching until some parked fibers are ready.
+                if (system->mReadyFibers.size.load(std::memory_order_relaxed) > 0 || system->mIsShuttingDown.load(std::memory_order_relaxed))
+                {
+                    break;
+                }
+                // The fiber can be in another thread after Wait(), so the worker index is read again.
+                job = system->FindJob(system->GetCurrentWorkerIndex());
+            }
+
+            system->SwitchToScheduler(self, FiberSwitchAction::Release);
+        }
+    }
+
+    internal::JobFiber* JobSystem::AcquireFiber(internal::Job* job)
+    {
+        internal::JobFiber* fiber = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(mFibersMutex);
+            if (!mFreeFibers.empty())
+            {
+                fiber = mFreeFibers.back();
+                mFreeFibers.pop_back();
+            }
+        }
+
+        if (fiber == nullptr)
+        {
+            fiber = new internal::JobFiber{
+                .system = this,
+                .localData = mCreateFiberLocalData ? mCreateFiberLocalData() : nullptr,
+                .job = nullptr
+            };
+            fiber->fiber.Create(mFiberStackSize, &JobSystem::FiberMain, fiber);
+
+            std::unique_lock<std::mutex> lock(mFibersMutex);
+            mFibers.push_back(fiber);
+        }
+
+        fiber->job = job;
+        return fiber;
+    }
+
+    void JobSystem::SwitchToFiber(Worker& worker, internal::JobFiber* fiber)
+    {
+        ThreadState& state = GetThreadState();
+        state.currentFiber = fiber;
+        if (mOnFiberSwitched)
+        {
+            mOnFiberSwitched(fiber->localData);
+        }
+
+        Fiber::Switch(worker.schedulerFiber, fiber->fiber);
+
+        // Back in the scheduler. It is always in the same thread.
+        state.currentFiber = nullptr;
+        if (mOnFiberSwitched)
+        {
+            mOnFiberSwitched(nullptr);
+        }
+
+        internal::JobFiber* switchedFiber = worker.pendingFiber;
+        switch (worker.pendingAction)
+        {
+        case FiberSwitchAction::Release:
+        {
+            std::unique_lock<std::mutex> lock(mFibersMutex);
+            mFreeFibers.push_back(switchedFiber);
+            break;
+        }
+        case FiberSwitchAction::Park:
+        {
+            // Same as the registration in SubmitJob(). If the counter is already finished, resume it immediately.
+            internal::JobCounter* counter = worker.pendingCounter;
+            bool isFinished = false;
+            {
+                std::unique_lock<std::mutex> lock(counter->waitingJobsMutex);
+                isFinished = counter->numPendingJobs.load(std::memory_order_acquire) == 0;
+                if (!isFinished)
+                {
+                    counter->waitingJobs = mWaitNodePool.New(internal::JobWaitNode{ .job = nullptr, .fiber = switchedFiber, .next = counter->waitingJobs });
+                }
+            }
+            if (isFinished)
+            {
+                PushFiber(mReadyFibers, switchedFiber);
+            }
+            break;
+        }
+        case FiberSwitchAction::Yield:
+            PushFiber(mYieldedFibers, switchedFiber);
+            break;
+        }
+        worker.pendingFiber = nullptr;
+        worker.pendingCounter = nullptr;
+    }
+
+    void JobSystem::SwitchToScheduler(internal::JobFiber* fiber, FiberSwitchAction action, internal::JobCounter* waitingCounter)
+    {
+        Worker& worker = *mWorkers[GetThreadState().workerIndex];
+        worker.pendingAction = action;
+        worker.pendingFiber = fiber;
+        worker.pendingCounter = waitingCounter;
+
+        Fiber::Switch(fiber->fiber, worker.schedulerFiber);
+        // Resumed by a scheduler. It can be in another thread.
+    }
+
+    void JobSystem::PushFiber(FiberQueue& queue, internal::JobFiber* fiber)
+    {
+        {
+            std::unique_lock<std::mutex> lock(queue.mutex);
+            queue.fibers.push_back(fiber);
+            queue.size.store(queue.fibers.size(), std::memory_order_relaxed);
+        }
+        WakeWorkers(1);
+    }
+
+    internal::JobFiber* JobSystem::PopFiber(FiberQueue& queue)
+    {
+        if (queue.size.load(std::memory_order_relaxed) == 0)
+        {
+            return nullptr;
+        }
+
+        std::unique_lock<std::mutex> lock(queue.mutex);
+        if (queue.fibers.empty())
+        {
+            return nullptr;
+        }
+        internal::JobFiber* fiber = queue.fibers.front();
+        queue.fibers.pop_front();
+        queue.size.store(queue.fibers.size(), std::memory_order_relaxed);
+        return fiber;
+    }
+} // namespace cube
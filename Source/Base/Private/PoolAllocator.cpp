@@ -0,0 +1,320 @@
+#include "PoolAllocator.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace cube
+{
+    namespace
+    {
+        constexpr int MAX_THREAD_CACHED_POOLS = 64;
+        constexpr Uint32 THREAD_CACHE_SIZE = 32;
+
+        constexpr Uint8 FREED_PATTERN = 0xDD;
+        constexpr Uint8 ALLOCATED_PATTERN = 0xCD;
+
+        struct ThreadCache
+        {
+            const FixedSizePool* owner = nullptr;
+            void* head = nullptr; // Linked with the first pointer in each slot
+            Uint32 count = 0;
+        };
+        thread_local ThreadCache thlThreadCaches[MAX_THREAD_CACHED_POOLS];
+
+        std::atomic<int> gNextThreadCacheIndex = 0;
+
+        Uint64 AlignUp(Uint64 value, Uint64 alignment)
+        {
+            return (value + (alignment - 1)) & ~(alignment - 1);
+        }
+    } // namespace
+
+    FixedSizePool::FixedSizePool(Uint64 elementSize, Uint64 alignment, const PoolAllocatorOptions& options) :
+        mSlabSize(options.slabSize),
+        mFreeList(nullptr),
+        mNumFree(0),
+        mThreadCacheIndex(-1)
+    {
+        assert((alignment & (alignment - 1)) == 0);
+        assert((mSlabSize & (mSlabSize - 1)) == 0);
+
+        alignment = std::max<Uint64>(alignment, alignof(FreeSlot));
+        mElementSize = AlignUp(std::max<Uint64>(elementSize, sizeof(FreeSlot)), alignment);
+        mFirstSlotOffset = AlignUp(sizeof(SlabHeader), alignment);
+
+        // Keep at least a few elements in a slab.
+        while (mFirstSlotOffset + mElementSize * 8 > mSlabSize)
+        {
+            mSlabSize *= 2;
+        }
+        mNumElementsPerSlab = (mSlabSize - mFirstSlotOffset) / mElementSize;
+
+        if (options.useThreadCache)
+        {
+            const int threadCacheIndex = gNextThreadCacheIndex.fetch_add(1, std::memory_order_relaxed);
+            if (threadCacheIndex < MAX_THREAD_CACHED_POOLS)
+            {
+                mThreadCacheIndex = threadCacheIndex;
+            }
+        }
+    }
+
+    FixedSizePool::~FixedSizePool()
+    {
+        for (SlabHeader* slab : mSlabs)
+        {
+            ::operator delete(slab, std::align_val_t(mSlabSize));
+        }
+    }
+
+    void* FixedSizePool::Allocate()
+    {
+        FreeSlot* slot = nullptr;
+        if (mThreadCacheIndex != -1)
+        {
+            ThreadCache& cache = thlThreadCaches[mThreadCacheIndex];
+            if (cache.owner != this)
+            {
+                cache = { .owner = this };
+            }
+
+            if (cache.count == 0)
+            {
+                // Refill the half of the cache at once.
+                std::unique_lock<std::mutex> lock(mMutex);
+                for (Uint32 i = 0; i < THREAD_CACHE_SIZE / 2; ++i)
+                {
+                    FreeSlot* freeSlot = PopFreeSlot();
+                    freeSlot->next = (FreeSlot*)cache.head;
+                    cache.head = freeSlot;
+                    cache.count++;
+                }
+            }
+
+            slot = (FreeSlot*)cache.head;
+            cache.head = slot->next;
+            cache.count--;
+        }
+        else
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            slot = PopFreeSlot();
+        }
+
+        CheckPoisonAndFill(slot);
+        return slot;
+    }
+
+    void FixedSizePool::Free(void* ptr)
+    {
+        if (ptr == nullptr)
+        {
+            return;
+        }
+
+        Poison(ptr);
+
+        FreeSlot* slot = (FreeSlot*)ptr;
+        if (mThreadCacheIndex != -1)
+        {
+            ThreadCache& cache = thlThreadCaches[mThreadCacheIndex];
+            if (cache.owner != this)
+            {
+                cache = { .owner = this };
+            }
+
+            if (cache.count == THREAD_CACHE_SIZE)
+            {
+                // Return the half of the cache at once.
+                std::unique_lock<std::mutex> lock(mMutex);
+                for (Uint32 i = 0; i < THREAD_CACHE_SIZE / 2; ++i)
+                {
+                    FreeSlot* cachedSlot = (FreeSlot*)cache.head;
+                    cache.head = cachedSlot->next;
+                    cache.count--;
+                    PushFreeSlot(cachedSlot);
+                }
+            }
+
+            slot->next = (FreeSlot*)cache.head;
+            cache.head = slot;
+            cache.count++;
+        }
+        else
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            PushFreeSlot(slot);
+        }
+    }
+
+    void FixedSizePool::ReleaseEmptySlabs()
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+
+        // Remove the slots in the empty slabs from the free list.
+        FreeSlot* newFreeList = nullptr;
+        FreeSlot* slot = mFreeList;
+        while (slot)
+        {
+            FreeSlot* next = slot->next;
+            if (GetSlab(slot)->numUsed > 0)
+            {
+                slot->next = newFreeList;
+                newFreeList = slot;
+            }
+            else
+            {
+                mNumFree--;
+            }
+            slot = next;
+        }
+        mFreeList = newFreeList;
+
+        std::erase_if(mSlabs, [this](SlabHeader* slab)
+        {
+            if (slab->numUsed > 0)
+            {
+                return false;
+            }
+
+            ::operator delete(slab, std::align_val_t(mSlabSize));
+            return true;
+        });
+    }
+
+    PoolAllocatorStats FixedSizePool::GetStats() const
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+
+        PoolAllocatorStats stats = {
+            .elementSize = mElementSize,
+            .slabSize = mSlabSize,
+            .numElementsPerSlab = mNumElementsPerSlab,
+            .numSlabs = static_cast<Uint32>(mSlabs.size()),
+            .numAllocated = mSlabs.size() * mNumElementsPerSlab - mNumFree,
+            .numFree = mNumFree
+        };
+        for (const SlabHeader* slab : mSlabs)
+        {
+            if (slab->numUsed == 0)
+            {
+                stats.numEmptySlabs++;
+                continue;
+            }
+
+            const Uint64 bucket = std::min<Uint64>(slab->numUsed * 4 / mNumElementsPerSlab, 3);
+            stats.slabOccupancyHistogram[bucket]++;
+        }
+
+        return stats;
+    }
+
+    FixedSizePool::FreeSlot* FixedSizePool::PopFreeSlot()
+    {
+        if (mFreeList == nullptr)
+        {
+            AllocateSlab();
+        }
+
+        FreeSlot* slot = mFreeList;
+        mFreeList = slot->next;
+        mNumFree--;
+        GetSlab(slot)->numUsed++;
+
+        return slot;
+    }
+
+    void FixedSizePool::PushFreeSlot(FreeSlot* slot)
+    {
+        slot->next = mFreeList;
+        mFreeList = slot;
+        mNumFree++;
+        GetSlab(slot)->numUsed--;
+    }
+
+    void FixedSizePool::AllocateSlab()
+    {
+        SlabHeader* slab = (SlabHeader*)::operator new(mSlabSize, std::align_val_t(mSlabSize));
+        slab->numUsed = 0;
+        mSlabs.push_back(slab);
+
+        // Link in reverse order so the slots are allocated from the lower address.
+        Uint8* slotsStart = (Uint8*)slab + mFirstSlotOffset;
+        for (Uint64 i = mNumElementsPerSlab; i > 0; --i)
+        {
+            FreeSlot* slot = (FreeSlot*)(slotsStart + (i - 1) * mElementSize);
+            Poison(slot);
+
+            slot->next = mFreeList;
+            mFreeList = slot;
+        }
+        mNumFree += mNumElementsPerSlab;
+    }
+
+    void FixedSizePool::Poison(void* ptr) const
+    {
+#if CUBE_POOL_ALLOCATOR_POISON
+        // The first pointer is used by the free list.
+        memset((Uint8*)ptr + sizeof(FreeSlot), FREED_PATTERN, mElementSize - sizeof(FreeSlot));
+#endif
+    }
+
+    void FixedSizePool::CheckPoisonAndFill(void* ptr) const
+    {
+#if CUBE_POOL_ALLOCATOR_POISON
+        const Uint8* bytes = (const Uint8*)ptr;
+        for (Uint64 i = sizeof(FreeSlot); i < mElementSize; ++i)
+        {
+            // The freed slot was written. (Use-after-free)
+            assert(bytes[i] == FREED_PATTERN);
+        }
+        memset(ptr, ALLOCATED_PATTERN, mElementSize);
+#endif
+    }
+
+    void* SizeClassPool::Allocate(Uint64 size, Uint64 alignment)
+    {
+        if (FixedSizePool* pool = GetPool(size, alignment))
+        {
+            return pool->Allocate();
+        }
+        return ::operator new(size, std::align_val_t(alignment));
+    }
+
+    void SizeClassPool::Free(void* ptr, Uint64 size, Uint64 alignment)
+    {
+        if (FixedSizePool* pool = GetPool(size, alignment))
+        {
+            pool->Free(ptr);
+            return;
+        }
+        ::operator delete(ptr, std::align_val_t(alignment));
+    }
+
+    PoolAllocatorStats SizeClassPool::GetStats(int sizeClassIndex)
+    {
+        return GetPool((sizeClassIndex + 1) * SIZE_CLASS_STEP, 1)->GetStats();
+    }
+
+    FixedSizePool* SizeClassPool::GetPool(Uint64 size, Uint64 alignment)
+    {
+        if (size == 0 || size > MAX_SIZE || alignment > SIZE_CLASS_STEP)
+        {
+            return nullptr;
+        }
+
+        // Never destroyed, so the objects released in the static destruction can still be freed.
+        static FixedSizePool** pools = []()
+        {
+            FixedSizePool** res = new FixedSizePool*[NUM_SIZE_CLASSES];
+            for (int i = 0; i < NUM_SIZE_CLASSES; ++i)
+            {
+                res[i] = new FixedSizePool((i + 1) * SIZE_CLASS_STEP, SIZE_CLASS_STEP, { .useThreadCache = true });
+            }
+            return res;
+        }();
+
+        return pools[(size - 1) / SIZE_CLASS_STEP];
+    }
+} // namespace cube
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "MemoryTag.h"
 #include "Types.h"
 
 namespace cube
@@ -11,5 +12,9 @@ namespace cube
 
         virtual void* Allocate(SizeType n) = 0;
         virtual void Free(void* ptr, SizeType n) = 0;
+
+        // The allocators which track the memory attribute the allocation to the tag. Others ignore it.
+        virtual void* AllocateTagged(SizeType n, MemoryTag tag) { return Allocate(n); }
+        virtual void FreeTagged(void* ptr, SizeType n, MemoryTag tag) { Free(ptr, n); }
     };
 } // namespace cube
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "Defines.h"
+#include "Types.h"
+
+#include "BoundingVolume.h"
+
+namespace cube
+{
+    class JobSystem;
+
+    // Bounding volume hierarchy of the items. (An item is an id with an AABB.) Each leaf has one item.
+    // It is built with the binned SAH, or grown by inserting the items one by one.
+    // The moved items are refitted without rebuilding, so rebuild it after many inserts / moves to restore the quality.
+    class BVH
+    {
+    public:
+        static constexpr Uint32 INVALID_INDEX = Uint32InvalidValue;
+
+        struct RayHit
+        {
+            Uint32 itemId = INVALID_INDEX;
+            float distance = FLT_MAX;
+        };
+
+        BVH() = default;
+        ~BVH() = default;
+
+        void Clear();
+
+        // itemBounds[i] is the bounds of the item i. The items with the invalid bounds are not added.
+        // The subtrees are built in parallel if the job system is given.
+        void Build(ArrayView<const AABB> itemBounds, JobSystem* jobSystem = nullptr);
+
+        // The item ids are used as the indices, so keep them dense.
+        void Insert(Uint32 itemId, const AABB& bounds);
+        // The ancestors are updated in Refit().
+        void UpdateItem(Uint32 itemId, const AABB& bounds);
+        // Update the ancestors of the items updated after the last refit.
+        void Refit();
+
+        bool Contains(Uint32 itemId) const { return itemId < mItemLeafNodes.size() && mItemLeafNodes[itemId] != INVALID_INDEX; }
+        Uint64 GetNumItems() const { return mNumItems; }
+        Uint64 GetNumNodes() const { return mNodes.size(); }
+        // Invalid if empty.
+        AABB GetBounds() const { return mRootIndex != INVALID_INDEX ? mNodes[mRootIndex].bounds : AABB(); }
+        // Sum of the surface areas of the internal nodes relative to the root. Lower is better.
+        float GetSAHCost() const;
+
+        // Append the items which intersect with the frustum into outItemIds. (Conservative like Frustum::Intersects())
+        // The subtrees fully inside of the frustum are accepted without testing their nodes.
+        // Return the number of the tested nodes.
+        Uint64 QueryFrustum(const Frustum& frustum, Vector<Uint32>& outItemIds) const;
+        // Append the items whose bounds are hit by the ray into outItemIds.
+        void QueryRay(const Ray& ray, Vector<Uint32>& outItemIds) const;
+        // The item whose bounds are hit first. (ex: Picking)
+        bool Raycast(const Ray& ray, RayHit& outHit) const;
+
+    private:
+        struct Node
+        {
+            AABB bounds;
+            Uint32 parent = INVALID_INDEX;
+            // Both are INVALID_INDEX in the leaf.
+            Uint32 left = INVALID_INDEX;
+            Uint32 right = INVALID_INDEX;
+            Uint32 itemId = INVALID_INDEX;
+
+            bool IsLeaf() const { return left == INVALID_INDEX; }
+        };
+
+        struct BuildItem
+        {
+            AABB bounds;
+            Float3 centroid;
+            Uint32 itemId;
+        };
+
+        void BuildNode(ArrayView<BuildItem> items, Uint32 nodeIndex, Uint32 parentIndex, Uint32 depth, JobSystem* jobSystem);
+        void AppendSubtreeItems(Uint32 nodeIndex, Vector<Uint32>& outItemIds) const;
+        void RefitFrom(Uint32 nodeIndex);
+
+        Vector<Node> mNodes;
+        Uint32 mRootIndex = INVALID_INDEX;
+        Uint64 mNumItems = 0;
+
+        Vector<Uint32> mItemLeafNodes; // Item id -> Leaf node index
+        Vector<Uint32> mDirtyLeafNodes;
+    };
+} // namespace cube
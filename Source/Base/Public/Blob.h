@@ -2,6 +2,7 @@
 
 #include <cassert>
 
+#include "Allocator.h"
 #include "Types.h"
 
 namespace cube
@@ -33,24 +34,33 @@ namespace cube
     public:
         Blob() :
             mSize(0),
-            mData(nullptr)
+            mData(nullptr),
+            mAllocator(nullptr),
+            mTag(MemoryTag::Untagged)
         {}
-        Blob(Uint64 size) :
-            mSize(size)
+        // The data is allocated with malloc if the allocator is nullptr. (The tag is tracked only with the allocator)
+        Blob(Uint64 size, IAllocator* allocator = nullptr, MemoryTag tag = MemoryTag::Untagged) :
+            mSize(size),
+            mAllocator(allocator),
+            mTag(tag)
         {
-            mData = malloc(size);
+            mData = AllocateData();
         }
-        Blob(void* data, Uint64 size) :
-            mSize(size)
+        Blob(void* data, Uint64 size, IAllocator* allocator = nullptr, MemoryTag tag = MemoryTag::Untagged) :
+            mSize(size),
+            mAllocator(allocator),
+            mTag(tag)
         {
-            mData = malloc(size);
+            mData = AllocateData();
             memcpy(mData, data, mSize);
         }
 
         Blob(const Blob& other)
         {
             mSize = other.mSize;
-            mData = malloc(mSize);
+            mAllocator = other.mAllocator;
+            mTag = other.mTag;
+            mData = AllocateData();
             memcpy(mData, other.mData, mSize);
         }
         Blob& operator=(const Blob& rhs)
@@ -59,7 +69,9 @@ namespace cube
             {
                 Release();
                 mSize = rhs.mSize;
-                mData = malloc(mSize);
+                mAllocator = rhs.mAllocator;
+                mTag = rhs.mTag;
+                mData = AllocateData();
                 memcpy(mData, rhs.mData, mSize);
             }
             return *this;
@@ -69,6 +81,8 @@ namespace cube
         {
             mSize = other.mSize;
             mData = other.mData;
+            mAllocator = other.mAllocator;
+            mTag = other.mTag;
 
             other.mSize = 0;
             other.mData = nullptr;
@@ -80,6 +94,8 @@ namespace cube
                 Release();
                 mSize = rhs.mSize;
                 mData = rhs.mData;
+                mAllocator = rhs.mAllocator;
+                mTag = rhs.mTag;
 
                 rhs.mSize = 0;
                 rhs.mData = nullptr;
@@ -96,7 +112,14 @@ namespace cube
         {
             if (mData)
             {
-                free(mData);
+                if (mAllocator)
+                {
+                    mAllocator->FreeTagged(mData, mSize, mTag);
+                }
+                else
+                {
+                    free(mData);
+                }
                 mData = nullptr;
 
                 mSize = 0;
@@ -110,6 +133,8 @@ namespace cube
 
         Uint64 GetSize() const { return mSize; }
         void* GetData() const { return mData; }
+        IAllocator* GetAllocator() const { return mAllocator; }
+        MemoryTag GetTag() const { return mTag; }
 
         BlobView CreateBlobView(Uint64 offset, Uint64 size) const
         {
@@ -125,7 +150,14 @@ namespace cube
     private:
         friend class BlobView;
 
+        void* AllocateData() const
+        {
+            return mAllocator ? mAllocator->AllocateTagged(mSize, mTag) : malloc(mSize);
+        }
+
         Uint64 mSize;
         void* mData;
+        IAllocator* mAllocator;
+        MemoryTag mTag;
     };
 } // namespace cube
@@ -0,0 +1,107 @@
+#pragma once
+
+#include "Defines.h"
+#include "Types.h"
+
+#include <cfloat>
+
+#include "Matrix.h"
+#include "Vector.h"
+
+namespace cube
+{
+    struct Ray
+    {
+        Float3 origin;
+        // Need not be normalized. The distances along the ray are in the unit of the direction length.
+        Float3 direction;
+        float maxDistance = FLT_MAX;
+    };
+
+    struct AABB
+    {
+        Float3 min = { FLT_MAX, FLT_MAX, FLT_MAX };
+        Float3 max = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+
+        // False if nothing is merged.
+        bool IsValid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+
+        Float3 GetCenter() const { return (min + max) * 0.5f; }
+        Float3 GetExtent() const { return (max - min) * 0.5f; }
+
+        void Merge(const Float3& point);
+        void Merge(const AABB& other);
+
+        // AABB of the transformed box. (Row vector: p * matrix)
+        AABB Transformed(const Matrix& matrix) const;
+
+        // Surface area used in the SAH cost.
+        float GetSurfaceArea() const;
+
+        // outDistance is the entry distance. (0 if the origin is inside)
+        bool IntersectsRay(const Ray& ray, float& outDistance) const;
+    };
+
+    struct Sphere
+    {
+        Float3 center = { 0.0f, 0.0f, 0.0f };
+        float radius = 0.0f;
+    };
+
+    // Boxes in the structure of arrays (center / extent per axis), so the frustum test loads several boxes at once.
+    class AABBBatch
+    {
+    public:
+        void Clear();
+        void Reserve(Uint64 size);
+        void Add(const AABB& box);
+
+        Uint64 GetSize() const { return mCenterX.size(); }
+
+    private:
+        friend class Frustum;
+
+        Vector<float> mCenterX;
+        Vector<float> mCenterY;
+        Vector<float> mCenterZ;
+        Vector<float> mExtentX;
+        Vector<float> mExtentY;
+        Vector<float> mExtentZ;
+    };
+
+    enum class FrustumTestResult
+    {
+        Outside,
+        Intersecting,
+        Inside
+    };
+
+    class Frustum
+    {
+    public:
+        // Left, right, bottom, top, near, far (Far, near with the reversed depth)
+        static constexpr int NUM_PLANES = 6;
+
+        // Extract the planes from the view-projection matrix. (Row vector, [0, 1] depth range. Reversed depth also works.)
+        static Frustum FromViewProjection(const Matrix& viewProjection);
+
+        // (normal.xyz, distance). The normals are normalized and point to the inside.
+        const Float4& GetPlane(int index) const { return mPlanes[index]; }
+
+        // Conservative. The boxes near the corners of the frustum can pass even if they are outside.
+        bool Intersects(const AABB& box) const;
+        bool Intersects(const Sphere& sphere) const;
+
+        // Bit i of the plane mask is set if the plane i should be tested. The planes the box is fully inside are cleared,
+        // so the children of the box can skip them. Start with ALL_PLANES_MASK.
+        static constexpr Uint32 ALL_PLANES_MASK = (1 << NUM_PLANES) - 1;
+        FrustumTestResult Classify(const AABB& box, Uint32& inOutPlaneMask) const;
+
+        // Test all boxes and write 1 (visible) / 0 (culled) into outIsVisible. Return the number of the visible boxes.
+        // AVX2: 8 boxes / SSE: 4 boxes per iteration. Same test as Intersects(const AABB&).
+        Uint64 CullAABBs(const AABBBatch& boxes, ArrayView<Uint8> outIsVisible) const;
+
+    private:
+        Float4 mPlanes[NUM_PLANES];
+    };
+} // namespace cube
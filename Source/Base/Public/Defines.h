@@ -22,6 +22,10 @@
 #define FORCE_INLINE
 #endif
 
+#ifndef NO_INLINE
+#define NO_INLINE __attribute__((noinline))
+#endif
+
 #ifndef CUBE_DLL_EXPORT
 #define CUBE_DLL_EXPORT
 #endif
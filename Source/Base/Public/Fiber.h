@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Defines.h"
+#include "Types.h"
+
+namespace cube
+{
+    // User-space execution context with its own stack. Switching the fibers does not go through the OS scheduler.
+    // A fiber can be resumed in another thread, so the thread-local variables read before the switch can be stale after it.
+    // Windows: Win32 fibers / Others: ucontext
+    class Fiber
+    {
+    public:
+        using EntryFunction = void (*)(void* userData);
+
+        Fiber() = default;
+        ~Fiber();
+
+        Fiber(const Fiber& other) = delete;
+        Fiber& operator=(const Fiber& rhs) = delete;
+
+        // The entry function should not return. Switch to another fiber at the end instead.
+        void Create(Uint64 stackSize, EntryFunction entryFunction, void* userData);
+        // Make the current thread a fiber, so it can switch to the other fibers. Destroy it in the same thread.
+        void CreateFromCurrentThread();
+        void Destroy();
+
+        bool IsCreated() const { return mHandle != nullptr; }
+
+        // Save the current context into `from` and run `to`. `from` should be the fiber running in the current thread.
+        static void Switch(Fiber& from, Fiber& to);
+
+        // Called at the start of the fiber by the platform entry routine.
+        static void RunEntryFunction(Fiber* fiber);
+
+    private:
+        void* mHandle = nullptr;
+        bool mIsThreadFiber = false;
+
+        EntryFunction mEntryFunction = nullptr;
+        void* mUserData = nullptr;
+    };
+} // namespace cube
@@ -52,6 +52,11 @@ namespace cube
             mBits |= static_cast<BitsType>(bit);
         }
 
+        BitsType GetBits() const
+        {
+            return mBits;
+        }
+
         // Compare operations
         bool operator==(const Flags& rhs) const
         {
@@ -117,14 +122,14 @@ namespace cube
         Flags operator&(const Flags& rhs) const
         {
             Flags res(*this);
-            res |= rhs;
+            res &= rhs;
 
             return res;
         }
-        Flags& operator&(Enum bit) const
+        Flags operator&(Enum bit) const
         {
             Flags res(*this);
-            res |= static_cast<BitsType>(bit);
+            res &= bit;
 
             return res;
         }
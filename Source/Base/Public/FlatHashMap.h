@@ -0,0 +1,800 @@
+#pragma once
+
+#include "Types.h"
+
+#include <bit>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <tuple>
+#include <utility>
+
+#ifndef CUBE_FLAT_HASH_MAP_USE_SSE2
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#define CUBE_FLAT_HASH_MAP_USE_SSE2 1
+#else
+#define CUBE_FLAT_HASH_MAP_USE_SSE2 0
+#endif
+#endif
+
+#ifndef CUBE_FLAT_HASH_MAP_USE_NEON
+#if defined(__ARM_NEON) || defined(_M_ARM64)
+#define CUBE_FLAT_HASH_MAP_USE_NEON 1
+#else
+#define CUBE_FLAT_HASH_MAP_USE_NEON 0
+#endif
+#endif
+
+#if CUBE_FLAT_HASH_MAP_USE_SSE2
+#include <emmintrin.h>
+#elif CUBE_FLAT_HASH_MAP_USE_NEON
+#include <arm_neon.h>
+#endif
+
+namespace cube
+{
+    // Transparent hash for the string keys. The lookup with a StringView does not create a temporary string.
+    template <typename Char>
+    struct TStringHash
+    {
+        using is_transparent = void;
+
+        SizeType operator()(std::basic_string_view<Char> str) const
+        {
+            return std::hash<std::basic_string_view<Char>>()(str);
+        }
+    };
+
+    namespace internal
+    {
+        // Control byte of each slot.
+        // Full: 0b0xxxxxxx (7 bits of the hash, H2) / Empty: 0b10000000 / Deleted: 0b11111110
+        using FlatHashCtrl = Int8;
+        constexpr FlatHashCtrl FLAT_HASH_CTRL_EMPTY = -128;
+        constexpr FlatHashCtrl FLAT_HASH_CTRL_DELETED = -2;
+
+        constexpr SizeType FLAT_HASH_GROUP_WIDTH = 16;
+
+        // Bits of the matched slots in a group. Each slot has (1 << Shift) bits and only the highest one is set.
+        template <int Shift>
+        class FlatHashBitMask
+        {
+        public:
+            explicit FlatHashBitMask(Uint64 mask) :
+                mMask(mask)
+            {}
+
+            bool HasAny() const { return mMask != 0; }
+            SizeType GetLowest() const { return static_cast<SizeType>(std::countr_zero(mMask)) >> Shift; }
+            void RemoveLowest() { mMask &= mMask - 1; }
+
+        private:
+            Uint64 mMask;
+        };
+
+        // Control bytes of the slots probed at once.
+        class FlatHashGroup
+        {
+        public:
+#if CUBE_FLAT_HASH_MAP_USE_SSE2
+            using BitMask = FlatHashBitMask<0>;
+
+            explicit FlatHashGroup(const FlatHashCtrl* ctrl) :
+                mCtrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl)))
+            {}
+
+            BitMask Match(FlatHashCtrl h2) const
+            {
+                return BitMask(static_cast<Uint32>(_mm_movemask_epi8(_mm_cmpeq_epi8(mCtrl, _mm_set1_epi8(h2)))));
+            }
+            BitMask MatchEmpty() const
+            {
+                return Match(FLAT_HASH_CTRL_EMPTY);
+            }
+            BitMask MatchEmptyOrDeleted() const
+            {
+                // Only the full slots have the zero sign bit.
+                return BitMask(static_cast<Uint32>(_mm_movemask_epi8(mCtrl)));
+            }
+
+        private:
+            __m128i mCtrl;
+#elif CUBE_FLAT_HASH_MAP_USE_NEON
+            // NEON does not have movemask, so narrow each byte to 4 bits.
+            using BitMask = FlatHashBitMask<2>;
+
+            explicit FlatHashGroup(const FlatHashCtrl* ctrl) :
+                mCtrl(vld1q_s8(ctrl))
+            {}
+
+            BitMask Match(FlatHashCtrl h2) const
+            {
+                return ToBitMask(vceqq_s8(mCtrl, vdupq_n_s8(h2)));
+            }
+            BitMask MatchEmpty() const
+            {
+                return Match(FLAT_HASH_CTRL_EMPTY);
+            }
+            BitMask MatchEmptyOrDeleted() const
+            {
+                return ToBitMask(vcltq_s8(mCtrl, vdupq_n_s8(0)));
+            }
+
+        private:
+            static BitMask ToBitMask(uint8x16_t matched)
+            {
+                const uint8x8_t narrowed = vshrn_n_u16(vreinterpretq_u16_u8(matched), 4);
+                return BitMask(vget_lane_u64(vreinterpret_u64_u8(narrowed), 0) & 0x8888888888888888ull);
+            }
+
+            int8x16_t mCtrl;
+#else
+            using BitMask = FlatHashBitMask<0>;
+
+            explicit FlatHashGroup(const FlatHashCtrl* ctrl)
+            {
+                memcpy(mCtrl, ctrl, FLAT_HASH_GROUP_WIDTH);
+            }
+
+            BitMask Match(FlatHashCtrl h2) const
+            {
+                Uint64 mask = 0;
+                for (SizeType i = 0; i < FLAT_HASH_GROUP_WIDTH; ++i)
+                {
+                    mask |= static_cast<Uint64>(mCtrl[i] == h2) << i;
+                }
+                return BitMask(mask);
+            }
+            BitMask MatchEmpty() const
+            {
+                return Match(FLAT_HASH_CTRL_EMPTY);
+            }
+            BitMask MatchEmptyOrDeleted() const
+            {
+                Uint64 mask = 0;
+                for (SizeType i = 0; i < FLAT_HASH_GROUP_WIDTH; ++i)
+                {
+                    mask |= static_cast<Uint64>(mCtrl[i] < 0) << i;
+                }
+                return BitMask(mask);
+            }
+
+        private:
+            FlatHashCtrl mCtrl[FLAT_HASH_GROUP_WIDTH];
+#endif
+        };
+
+        // The lookup functions take the other key types only if both of the hash and the equal are transparent.
+        template <bool IsTransparent>
+        struct FlatHashKeyArg
+        {
+            template <typename K, typename KeyType>
+            using Type = K;
+        };
+        template <>
+        struct FlatHashKeyArg<false>
+        {
+            template <typename K, typename KeyType>
+            using Type = KeyType;
+        };
+
+        template <typename Key, typename Value>
+        struct FlatHashMapPolicy
+        {
+            using KeyType = Key;
+            using ValueType = std::pair<const Key, Value>;
+
+            static const Key& GetKey(const ValueType& value) { return value.first; }
+        };
+
+        template <typename Key>
+        struct FlatHashSetPolicy
+        {
+            using KeyType = Key;
+            using ValueType = Key;
+
+            static const Key& GetKey(const ValueType& value) { return value; }
+        };
+
+        // Open-addressing hash table with the control bytes. (Swiss table)
+        // The slots are split into the groups of 16, and the control bytes of a group are compared
+        // with 7 bits of the hash at once by SIMD. So most lookups touch one group and compare one key.
+        // The groups are probed in the triangular sequence, and the probe stops at a group which has an empty slot.
+        // clear() keeps the capacity, so the tables cleared every frame do not allocate again.
+        template <typename Policy, typename Hash, typename KeyEqual, typename Allocator>
+        class FlatHashTable
+        {
+        public:
+            using key_type = typename Policy::KeyType;
+            using value_type = typename Policy::ValueType;
+            using size_type = SizeType;
+            using difference_type = std::ptrdiff_t;
+            using hasher = Hash;
+            using key_equal = KeyEqual;
+            using allocator_type = Allocator;
+            using reference = value_type&;
+            using const_reference = const value_type&;
+
+            template <bool IsConst>
+            class Iterator
+            {
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = typename Policy::ValueType;
+                using difference_type = std::ptrdiff_t;
+                using pointer = std::conditional_t<IsConst, const value_type*, value_type*>;
+                using reference = std::conditional_t<IsConst, const value_type&, value_type&>;
+
+                Iterator() = default;
+
+                operator Iterator<true>() const
+                {
+                    return Iterator<true>(mCtrl, mSlot, mCtrlEnd);
+                }
+
+                reference operator*() const { return *mSlot; }
+                pointer operator->() const { return mSlot; }
+
+                Iterator& operator++()
+                {
+                    ++mCtrl;
+                    ++mSlot;
+                    SkipNonFullSlots();
+                    return *this;
+                }
+                Iterator operator++(int)
+                {
+                    Iterator res = *this;
+                    ++(*this);
+                    return res;
+                }
+
+                friend bool operator==(const Iterator& lhs, const Iterator& rhs)
+                {
+                    return lhs.mSlot == rhs.mSlot;
+                }
+
+            private:
+                friend class FlatHashTable;
+                friend class Iterator<!IsConst>;
+
+                Iterator(const FlatHashCtrl* ctrl, pointer slot, const FlatHashCtrl* ctrlEnd) :
+                    mCtrl(ctrl),
+                    mSlot(slot),
+                    mCtrlEnd(ctrlEnd)
+                {}
+
+                void SkipNonFullSlots()
+                {
+                    while (mCtrl != mCtrlEnd && *mCtrl < 0)
+                    {
+                        ++mCtrl;
+                        ++mSlot;
+                    }
+                }
+
+                const FlatHashCtrl* mCtrl = nullptr;
+                pointer mSlot = nullptr;
+                const FlatHashCtrl* mCtrlEnd = nullptr;
+            };
+            using iterator = Iterator<false>;
+            using const_iterator = Iterator<true>;
+
+        private:
+            static constexpr bool IS_TRANSPARENT = requires {
+                typename Hash::is_transparent;
+                typename KeyEqual::is_transparent;
+            };
+            template <typename K>
+            using KeyArg = typename FlatHashKeyArg<IS_TRANSPARENT>::template Type<K, key_type>;
+
+            using SlotAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<value_type>;
+            using SlotAllocatorTraits = std::allocator_traits<SlotAllocator>;
+
+            static constexpr SizeType NOT_FOUND = static_cast<SizeType>(-1);
+
+        public:
+            FlatHashTable() = default;
+            explicit FlatHashTable(const Allocator& allocator) :
+                mAllocator(allocator)
+            {}
+            FlatHashTable(std::initializer_list<value_type> values, const Allocator& allocator = Allocator()) :
+                mAllocator(allocator)
+            {
+                insert(values.begin(), values.end());
+            }
+            ~FlatHashTable()
+            {
+                DestroyAndDeallocate();
+            }
+
+            FlatHashTable(const FlatHashTable& other) :
+                mHash(other.mHash),
+                mEqual(other.mEqual),
+                mAllocator(SlotAllocatorTraits::select_on_container_copy_construction(other.mAllocator))
+            {
+                CopyFrom(other);
+            }
+            FlatHashTable& operator=(const FlatHashTable& rhs)
+            {
+                if (this != &rhs)
+                {
+                    // Keep the allocator of this table like std containers.
+                    clear();
+                    CopyFrom(rhs);
+                }
+                return *this;
+            }
+
+            FlatHashTable(FlatHashTable&& other) noexcept :
+                mCtrl(std::exchange(other.mCtrl, nullptr)),
+                mSlots(std::exchange(other.mSlots, nullptr)),
+                mCapacity(std::exchange(other.mCapacity, 0)),
+                mSize(std::exchange(other.mSize, 0)),
+                mGrowthLeft(std::exchange(other.mGrowthLeft, 0)),
+                mHash(std::move(other.mHash)),
+                mEqual(std::move(other.mEqual)),
+                mAllocator(std::move(other.mAllocator))
+            {}
+            FlatHashTable& operator=(FlatHashTable&& rhs) noexcept
+            {
+                if (this == &rhs)
+                {
+                    return *this;
+                }
+
+                if constexpr (!SlotAllocatorTraits::propagate_on_container_move_assignment::value)
+                {
+                    if (!(mAllocator == rhs.mAllocator))
+                    {
+                        // Cannot take the memory allocated by the other allocator.
+                        clear();
+                        reserve(rhs.mSize);
+                        for (value_type& value : rhs)
+                        {
+                            InsertUniqueWithoutCheck(std::move(value));
+                        }
+                        rhs.clear();
+                        return *this;
+                    }
+                }
+
+                DestroyAndDeallocate();
+                mCtrl = std::exchange(rhs.mCtrl, nullptr);
+                mSlots = std::exchange(rhs.mSlots, nullptr);
+                mCapacity = std::exchange(rhs.mCapacity, 0);
+                mSize = std::exchange(rhs.mSize, 0);
+                mGrowthLeft = std::exchange(rhs.mGrowthLeft, 0);
+                mHash = std::move(rhs.mHash);
+                mEqual = std::move(rhs.mEqual);
+                if constexpr (SlotAllocatorTraits::propagate_on_container_move_assignment::value)
+                {
+                    mAllocator = std::move(rhs.mAllocator);
+                }
+                return *this;
+            }
+
+            iterator begin()
+            {
+                iterator it(mCtrl, mSlots, mCtrl + mCapacity);
+                it.SkipNonFullSlots();
+                return it;
+            }
+            const_iterator begin() const
+            {
+                const_iterator it(mCtrl, mSlots, mCtrl + mCapacity);
+                it.SkipNonFullSlots();
+                return it;
+            }
+            const_iterator cbegin() const { return begin(); }
+            iterator end() { return iterator(mCtrl + mCapacity, mSlots + mCapacity, mCtrl + mCapacity); }
+            const_iterator end() const { return const_iterator(mCtrl + mCapacity, mSlots + mCapacity, mCtrl + mCapacity); }
+            const_iterator cend() const { return end(); }
+
+            bool empty() const { return mSize == 0; }
+            size_type size() const { return mSize; }
+            size_type capacity() const { return mCapacity; }
+            allocator_type get_allocator() const { return allocator_type(mAllocator); }
+
+            // Destroy all elements but keep the memory.
+            void clear()
+            {
+                if (mCapacity == 0)
+                {
+                    return;
+                }
+
+                if (mSize > 0)
+                {
+                    DestroySlots();
+                }
+                memset(mCtrl, FLAT_HASH_CTRL_EMPTY, mCapacity);
+                mSize = 0;
+                mGrowthLeft = GetGrowthLimit(mCapacity);
+            }
+
+            void reserve(size_type count)
+            {
+                SizeType newCapacity = FLAT_HASH_GROUP_WIDTH;
+                while (GetGrowthLimit(newCapacity) < count)
+                {
+                    newCapacity *= 2;
+                }
+
+                if (newCapacity > mCapacity)
+                {
+                    Rehash(newCapacity);
+                }
+            }
+
+            std::pair<iterator, bool> insert(const value_type& value)
+            {
+                return EmplaceUnique(Policy::GetKey(value), value);
+            }
+            std::pair<iterator, bool> insert(value_type&& value)
+            {
+                return EmplaceUnique(Policy::GetKey(value), std::move(value));
+            }
+            template <typename InputIterator>
+            void insert(InputIterator first, InputIterator last)
+            {
+                for (; first != last; ++first)
+                {
+                    insert(*first);
+                }
+            }
+
+            template <typename... Args>
+            std::pair<iterator, bool> emplace(Args&&... args)
+            {
+                // The key should be known before finding the slot.
+                value_type value(std::forward<Args>(args)...);
+                return EmplaceUnique(Policy::GetKey(value), std::move(value));
+            }
+
+            iterator erase(const_iterator it)
+            {
+                const SizeType index = it.mSlot - mSlots;
+                iterator next(mCtrl + index, mSlots + index, mCtrl + mCapacity);
+                ++next;
+
+                EraseAt(index);
+                return next;
+            }
+            iterator erase(iterator it)
+            {
+                return erase(const_iterator(it));
+            }
+            template <typename K = key_type>
+            size_type erase(const KeyArg<K>& key)
+            {
+                const SizeType index = FindIndex(key);
+                if (index == NOT_FOUND)
+                {
+                    return 0;
+                }
+
+                EraseAt(index);
+                return 1;
+            }
+
+            template <typename K = key_type>
+            iterator find(const KeyArg<K>& key)
+            {
+                return GetIterator(FindIndex(key));
+            }
+            template <typename K = key_type>
+            const_iterator find(const KeyArg<K>& key) const
+            {
+                return GetIterator(FindIndex(key));
+            }
+            template <typename K = key_type>
+            bool contains(const KeyArg<K>& key) const
+            {
+                return FindIndex(key) != NOT_FOUND;
+            }
+            template <typename K = key_type>
+            size_type count(const KeyArg<K>& key) const
+            {
+                return contains(key) ? 1 : 0;
+            }
+
+        protected:
+            template <typename K, typename... Args>
+            std::pair<iterator, bool> EmplaceUnique(const K& key, Args&&... args)
+            {
+                const Uint64 hash = HashKey(key);
+                if (const SizeType index = FindIndex(key, hash); index != NOT_FOUND)
+                {
+                    return { GetIterator(index), false };
+                }
+
+                const SizeType index = PrepareInsert(hash);
+                SlotAllocatorTraits::construct(mAllocator, mSlots + index, std::forward<Args>(args)...);
+                SetCtrl(index, GetH2(hash));
+                mSize++;
+
+                return { GetIterator(index), true };
+            }
+
+        private:
+            // 7/8 of the slots can be used, so there is always an empty slot which stops the probe.
+            static SizeType GetGrowthLimit(SizeType capacity)
+            {
+                return capacity - capacity / 8;
+            }
+
+            static FlatHashCtrl GetH2(Uint64 hash)
+            {
+                return static_cast<FlatHashCtrl>(hash & 0x7F);
+            }
+
+            template <typename K>
+            Uint64 HashKey(const K& key) const
+            {
+                // Mix the hash because std::hash of the integers is usually the identity.
+                return HashMix(static_cast<Uint64>(mHash(key)));
+            }
+
+            iterator GetIterator(SizeType index)
+            {
+                if (index == NOT_FOUND)
+                {
+                    return end();
+                }
+                return iterator(mCtrl + index, mSlots + index, mCtrl + mCapacity);
+            }
+            const_iterator GetIterator(SizeType index) const
+            {
+                if (index == NOT_FOUND)
+                {
+                    return end();
+                }
+                return const_iterator(mCtrl + index, mSlots + index, mCtrl + mCapacity);
+            }
+
+            template <typename K>
+            SizeType FindIndex(const K& key) const
+            {
+                if (mSize == 0)
+                {
+                    return NOT_FOUND;
+                }
+                return FindIndex(key, HashKey(key));
+            }
+
+            template <typename K>
+            SizeType FindIndex(const K& key, Uint64 hash) const
+            {
+                if (mCapacity == 0)
+                {
+                    return NOT_FOUND;
+                }
+
+                const FlatHashCtrl h2 = GetH2(hash);
+                const SizeType groupMask = mCapacity / FLAT_HASH_GROUP_WIDTH - 1;
+                SizeType groupIndex = (hash >> 7) & groupMask;
+                for (SizeType step = 1;; ++step)
+                {
+                    const SizeType groupStart = groupIndex * FLAT_HASH_GROUP_WIDTH;
+                    const FlatHashGroup group(mCtrl + groupStart);
+                    for (auto matched = group.Match(h2); matched.HasAny(); matched.RemoveLowest())
+                    {
+                        const SizeType index = groupStart + matched.GetLowest();
+                        if (mEqual(Policy::GetKey(mSlots[index]), key))
+                        {
+                            return index;
+                        }
+                    }
+                    if (group.MatchEmpty().HasAny())
+                    {
+                        return NOT_FOUND;
+                    }
+
+                    groupIndex = (groupIndex + step) & groupMask;
+                }
+            }
+
+            SizeType FindFirstNonFull(Uint64 hash) const
+            {
+                const SizeType groupMask = mCapacity / FLAT_HASH_GROUP_WIDTH - 1;
+                SizeType groupIndex = (hash >> 7) & groupMask;
+                for (SizeType step = 1;; ++step)
+                {
+                    const SizeType groupStart = groupIndex * FLAT_HASH_GROUP_WIDTH;
+                    if (auto nonFull = FlatHashGroup(mCtrl + groupStart).MatchEmptyOrDeleted(); nonFull.HasAny())
+                    {
+                        return groupStart + nonFull.GetLowest();
+                    }
+
+                    groupIndex = (groupIndex + step) & groupMask;
+                }
+            }
+
+            SizeType PrepareInsert(Uint64 hash)
+            {
+                if (mCapacity == 0)
+                {
+                    Rehash(FLAT_HASH_GROUP_WIDTH);
+                }
+
+                SizeType index = FindFirstNonFull(hash);
+                // The deleted slot can be reused without the growth.
+                if (mGrowthLeft == 0 && mCtrl[index] == FLAT_HASH_CTRL_EMPTY)
+                {
+                    // Many slots are deleted. Rehash in the same capacity to remove them.
+                    const SizeType newCapacity = mSize < GetGrowthLimit(mCapacity) / 2 ? mCapacity : mCapacity * 2;
+                    Rehash(newCapacity);
+                    index = FindFirstNonFull(hash);
+                }
+
+                if (mCtrl[index] == FLAT_HASH_CTRL_EMPTY)
+                {
+                    mGrowthLeft--;
+                }
+                return index;
+            }
+
+            template <typename V>
+            void InsertUniqueWithoutCheck(V&& value)
+            {
+                const Uint64 hash = HashKey(Policy::GetKey(value));
+                const SizeType index = PrepareInsert(hash);
+                SlotAllocatorTraits::construct(mAllocator, mSlots + index, std::forward<V>(value));
+                SetCtrl(index, GetH2(hash));
+                mSize++;
+            }
+
+            void SetCtrl(SizeType index, FlatHashCtrl ctrl)
+            {
+                mCtrl[index] = ctrl;
+            }
+
+            void EraseAt(SizeType index)
+            {
+                SlotAllocatorTraits::destroy(mAllocator, mSlots + index);
+                mSize--;
+
+                // If the group still has an empty slot, no probe has passed through it, so the slot can be empty again.
+                // Otherwise, mark it as deleted to keep the probes to the next groups.
+                const SizeType groupStart = index & ~(FLAT_HASH_GROUP_WIDTH - 1);
+                if (FlatHashGroup(mCtrl + groupStart).MatchEmpty().HasAny())
+                {
+                    SetCtrl(index, FLAT_HASH_CTRL_EMPTY);
+                    mGrowthLeft++;
+                }
+                else
+                {
+                    SetCtrl(index, FLAT_HASH_CTRL_DELETED);
+                }
+            }
+
+            void Rehash(SizeType newCapacity)
+            {
+                FlatHashCtrl* oldCtrl = mCtrl;
+                value_type* oldSlots = mSlots;
+                const SizeType oldCapacity = mCapacity;
+
+                // Allocate the slots and the control bytes at once. The control bytes are after the slots.
+                mSlots = SlotAllocatorTraits::allocate(mAllocator, GetAllocationCount(newCapacity));
+                mCtrl = reinterpret_cast<FlatHashCtrl*>(mSlots + newCapacity);
+                mCapacity = newCapacity;
+                memset(mCtrl, FLAT_HASH_CTRL_EMPTY, mCapacity);
+                mGrowthLeft = GetGrowthLimit(mCapacity) - mSize;
+
+                for (SizeType i = 0; i < oldCapacity; ++i)
+                {
+                    if (oldCtrl[i] >= 0)
+                    {
+                        const Uint64 hash = HashKey(Policy::GetKey(oldSlots[i]));
+                        const SizeType index = FindFirstNonFull(hash);
+                        SlotAllocatorTraits::construct(mAllocator, mSlots + index, std::move(oldSlots[i]));
+                        SlotAllocatorTraits::destroy(mAllocator, oldSlots + i);
+                        SetCtrl(index, GetH2(hash));
+                    }
+                }
+
+                if (oldSlots)
+                {
+                    SlotAllocatorTraits::deallocate(mAllocator, oldSlots, GetAllocationCount(oldCapacity));
+                }
+            }
+
+            static SizeType GetAllocationCount(SizeType capacity)
+            {
+                return capacity + (capacity + sizeof(value_type) - 1) / sizeof(value_type);
+            }
+
+            void CopyFrom(const FlatHashTable& other)
+            {
+                reserve(other.mSize);
+                for (const value_type& value : other)
+                {
+                    InsertUniqueWithoutCheck(value);
+                }
+            }
+
+            void DestroySlots()
+            {
+                if constexpr (!std::is_trivially_destructible_v<value_type>)
+                {
+                    for (SizeType i = 0; i < mCapacity; ++i)
+                    {
+                        if (mCtrl[i] >= 0)
+                        {
+                            SlotAllocatorTraits::destroy(mAllocator, mSlots + i);
+                        }
+                    }
+                }
+            }
+
+            void DestroyAndDeallocate()
+            {
+                if (mCapacity == 0)
+                {
+                    return;
+                }
+
+                DestroySlots();
+                SlotAllocatorTraits::deallocate(mAllocator, mSlots, GetAllocationCount(mCapacity));
+                mCtrl = nullptr;
+                mSlots = nullptr;
+                mCapacity = 0;
+                mSize = 0;
+                mGrowthLeft = 0;
+            }
+
+            FlatHashCtrl* mCtrl = nullptr;
+            value_type* mSlots = nullptr;
+            SizeType mCapacity = 0; // Power of 2 and multiple of the group width
+            SizeType mSize = 0;
+            SizeType mGrowthLeft = 0; // Number of the empty slots which can be filled before the growth
+
+            [[no_unique_address]] Hash mHash;
+            [[no_unique_address]] KeyEqual mEqual;
+            [[no_unique_address]] SlotAllocator mAllocator;
+        };
+    } // namespace internal
+
+    template <typename Key, typename Value, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>, typename Allocator = std::allocator<std::pair<const Key, Value>>>
+    class FlatHashMap : public internal::FlatHashTable<internal::FlatHashMapPolicy<Key, Value>, Hash, KeyEqual, Allocator>
+    {
+        using Base = internal::FlatHashTable<internal::FlatHashMapPolicy<Key, Value>, Hash, KeyEqual, Allocator>;
+
+    public:
+        using mapped_type = Value;
+        using typename Base::iterator;
+
+        using Base::Base;
+
+        template <typename... Args>
+        std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args)
+        {
+            return this->EmplaceUnique(key, std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...));
+        }
+        template <typename... Args>
+        std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args)
+        {
+            // The key is moved only after the slot is found.
+            return this->EmplaceUnique(key, std::piecewise_construct, std::forward_as_tuple(std::move(key)), std::forward_as_tuple(std::forward<Args>(args)...));
+        }
+
+        Value& operator[](const Key& key)
+        {
+            return try_emplace(key).first->second;
+        }
+        Value& operator[](Key&& key)
+        {
+            return try_emplace(std::move(key)).first->second;
+        }
+    };
+
+    template <typename Key, typename Hash = std::hash<Key>, typename KeyEqual = std::equal_to<Key>, typename Allocator = std::allocator<Key>>
+    class FlatHashSet : public internal::FlatHashTable<internal::FlatHashSetPolicy<Key>, Hash, KeyEqual, Allocator>
+    {
+        using Base = internal::FlatHashTable<internal::FlatHashSetPolicy<Key>, Hash, KeyEqual, Allocator>;
+
+    public:
+        using Base::Base;
+    };
+} // namespace cube
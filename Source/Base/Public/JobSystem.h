@@ -0,0 +1,449 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include "Defines.h"
+#include "Fiber.h"
+#include "PoolAllocator.h"
+#include "Types.h"
+
+namespace cube
+{
+    class JobSystem;
+
+    namespace internal
+    {
+        struct JobCounter;
+        struct JobFiber;
+
+        struct Job
+        {
+            // Small callables are stored in place, so most of the jobs do not allocate.
+            static constexpr Uint64 FUNCTION_STORAGE_SIZE = 64;
+
+            void (*invoke)(void* storage);
+            void (*destroy)(void* storage);
+            alignas(std::max_align_t) Uint8 functionStorage[FUNCTION_STORAGE_SIZE];
+
+            JobCounter* counter; // Decreased when the job is finished
+            std::atomic<Uint32> numRemainingDependencies;
+
+            template <typename F>
+            void SetFunction(F&& function)
+            {
+                using FunctionType = std::decay_t<F>;
+                if constexpr (sizeof(FunctionType) <= FUNCTION_STORAGE_SIZE && alignof(FunctionType) <= alignof(std::max_align_t))
+                {
+                    new (functionStorage) FunctionType(std::forward<F>(function));
+                    invoke = [](void* storage) { (*static_cast<FunctionType*>(storage))(); };
+                    destroy = [](void* storage) { static_cast<FunctionType*>(storage)->~FunctionType(); };
+                }
+                else
+                {
+                    *reinterpret_cast<FunctionType**>(functionStorage) = new FunctionType(std::forward<F>(function));
+                    invoke = [](void* storage) { (**static_cast<FunctionType**>(storage))(); };
+                    destroy = [](void* storage) { delete *static_cast<FunctionType**>(storage); };
+                }
+            }
+        };
+
+        // The job can wait for several counters, so it is linked in their waiting lists with the separate nodes.
+        // In the fiber mode, the fiber parked in Wait() is also linked.
+        struct JobWaitNode
+        {
+            Job* job;
+            JobFiber* fiber;
+            JobWaitNode* next;
+        };
+
+        // Number of the unfinished jobs. It is shared by the handles and the jobs, and freed with the last reference.
+        struct JobCounter
+        {
+            JobSystem* system;
+            std::atomic<Uint32> numPendingJobs;
+            std::atomic<Uint32> refCount;
+
+            std::mutex waitingJobsMutex;
+            JobWaitNode* waitingJobs; // Scheduled when the counter becomes 0
+        };
+
+        // Chase-Lev work-stealing deque. (Lê et al. 2013, "Correct and Efficient Work-Stealing for Weak Memory Models")
+        // The owner thread pushes / pops at the bottom, and the other threads steal from the top.
+        // The capacity is fixed, so Push() fails when it is full.
+        class WorkStealingDeque
+        {
+        public:
+            static constexpr Int64 CAPACITY = 4096;
+
+            WorkStealingDeque() :
+                mTop(0),
+                mBottom(0)
+            {
+                for (std::atomic<Job*>& job : mJobs)
+                {
+                    job.store(nullptr, std::memory_order_relaxed);
+                }
+            }
+
+            // Only in the owner thread
+            bool Push(Job* job)
+            {
+                const Int64 bottom = mBottom.load(std::memory_order_relaxed);
+                const Int64 top = mTop.load(std::memory_order_acquire);
+                if (bottom - top >= CAPACITY)
+                {
+                    return false;
+                }
+
+                mJobs[bottom & (CAPACITY - 1)].store(job, std::memory_order_relaxed);
+                // Release store instead of the release fence. (Same ordering, and the sanitizers understand it)
+                mBottom.store(bottom + 1, std::memory_order_release);
+                return true;
+            }
+
+            // Only in the owner thread
+            Job* Pop()
+            {
+                const Int64 bottom = mBottom.load(std::memory_order_relaxed) - 1;
+                mBottom.store(bottom, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                Int64 top = mTop.load(std::memory_order_relaxed);
+
+                if (top > bottom)
+                {
+                    // Empty
+                    mBottom.store(bottom + 1, std::memory_order_relaxed);
+                    return nullptr;
+                }
+
+                Job* job = mJobs[bottom & (CAPACITY - 1)].load(std::memory_order_relaxed);
+                if (top == bottom)
+                {
+                    // Last job. Race with the thieves.
+                    if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                    {
+                        job = nullptr;
+                    }
+                    mBottom.store(bottom + 1, std::memory_order_relaxed);
+                }
+                return job;
+            }
+
+            Job* Steal()
+            {
+                Int64 top = mTop.load(std::memory_order_acquire);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                const Int64 bottom = mBottom.load(std::memory_order_acquire);
+                if (top >= bottom)
+                {
+                    return nullptr;
+                }
+
+                Job* job = mJobs[top & (CAPACITY - 1)].load(std::memory_order_relaxed);
+                if (!mTop.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                {
+                    // Lost the race with the owner or another thief
+                    return nullptr;
+                }
+                return job;
+            }
+
+        private:
+            // Separate the cache lines of the thieves and the owner.
+            alignas(64) std::atomic<Int64> mTop;
+            alignas(64) std::atomic<Int64> mBottom;
+            alignas(64) std::atomic<Job*> mJobs[CAPACITY];
+        };
+    } // namespace internal
+
+    // Reference of the counter of the scheduled jobs. It is finished when all of the jobs are finished.
+    // The empty handle is always finished.
+    class JobHandle
+    {
+    public:
+        JobHandle() = default;
+        ~JobHandle() { Reset(); }
+
+        JobHandle(const JobHandle& other) :
+            mCounter(other.mCounter)
+        {
+            AddRef();
+        }
+        JobHandle& operator=(const JobHandle& rhs)
+        {
+            if (this != &rhs)
+            {
+                Reset();
+                mCounter = rhs.mCounter;
+                AddRef();
+            }
+            return *this;
+        }
+        JobHandle(JobHandle&& other) noexcept :
+            mCounter(other.mCounter)
+        {
+            other.mCounter = nullptr;
+        }
+        JobHandle& operator=(JobHandle&& rhs) noexcept
+        {
+            if (this != &rhs)
+            {
+                Reset();
+                mCounter = rhs.mCounter;
+                rhs.mCounter = nullptr;
+            }
+            return *this;
+        }
+
+        bool IsValid() const { return mCounter != nullptr; }
+        bool IsFinished() const { return mCounter == nullptr || mCounter->numPendingJobs.load(std::memory_order_acquire) == 0; }
+
+        void Reset();
+
+    private:
+        friend class JobSystem;
+
+        explicit JobHandle(internal::JobCounter* counter) :
+            mCounter(counter)
+        {}
+
+        void AddRef()
+        {
+            if (mCounter)
+            {
+                mCounter->refCount.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        internal::JobCounter* mCounter = nullptr;
+    };
+
+    struct JobSystemInitializeInfo
+    {
+        // 0: Number of the cores - 1 (The thread which waits the jobs also runs them.)
+        Uint32 numWorkerThreads = 0;
+
+        // Called in each worker thread. (ex: Initialize / shutdown the thread-local allocators)
+        std::function<void(Uint32 workerIndex)> onWorkerThreadBegin = nullptr;
+        std::function<void(Uint32 workerIndex)> onWorkerThreadEnd = nullptr;
+        // Called in the worker threads after each top-level job. Not called after the jobs run inside Wait() of another job.
+        std::function<void()> onJobFinished = nullptr;
+
+        // Run the jobs of the workers in the fibers. Wait() in a fiber parks it and the worker runs the other jobs,
+        // so the long dependency chains run on a few threads without blocking them.
+        bool useFibers = false;
+        Uint64 fiberStackSize = 64 * 1024; // 64 KiB
+        // Fiber mode only. A parked fiber can be resumed in another thread, so the per-job state should be in the fiber-local data.
+        // (ex: Frame allocator per fiber)
+        std::function<void*()> createFiberLocalData = nullptr;
+        std::function<void(void* data)> destroyFiberLocalData = nullptr;
+        // Called in a worker thread when it starts to run a fiber. nullptr when it returns to the scheduler.
+        std::function<void(void* data)> onFiberSwitched = nullptr;
+    };
+
+    // Fixed pool of the worker threads with the work-stealing deques.
+    // The jobs scheduled in a worker are pushed into its deque, and the jobs from the other threads go to the shared queue.
+    // Idle workers steal from the top of the other deques, so the large / old jobs are stolen first.
+    // In the fiber mode, each worker thread runs a scheduler which switches to the pooled fibers to run the jobs.
+    class JobSystem
+    {
+    public:
+        JobSystem() = default;
+        ~JobSystem();
+
+        JobSystem(const JobSystem& other) = delete;
+        JobSystem& operator=(const JobSystem& rhs) = delete;
+
+        void Initialize(const JobSystemInitializeInfo& initInfo);
+        // All of the scheduled jobs should be finished.
+        void Shutdown();
+
+        Uint32 GetNumWorkerThreads() const { return static_cast<Uint32>(mWorkers.size()); }
+        bool IsUsingFibers() const { return mUseFibers; }
+        // Number of the created fibers. The pool grows when all fibers are parked.
+        Uint32 GetNumFibers() const;
+        // -1 if the current thread is not a worker of this job system.
+        Int32 GetCurrentWorkerIndex() const;
+
+        // The job runs after all of the dependencies are finished.
+        template <typename F>
+        JobHandle Schedule(F&& function, ArrayView<const JobHandle> dependencies = {})
+        {
+            internal::Job* job = AllocateJob();
+            job->SetFunction(std::forward<F>(function));
+
+            internal::JobCounter* counter = AllocateCounter(1);
+            job->counter = counter;
+            // One reference for the job and one for the handle
+            counter->refCount.store(2, std::memory_order_relaxed);
+
+            SubmitJob(job, dependencies);
+            return JobHandle(counter);
+        }
+
+        // Wait until the handle is finished. It can be called in a job.
+        // In a fiber, the fiber is parked and resumed after the handle is finished. Otherwise, the current thread runs the other jobs while waiting.
+        void Wait(const JobHandle& handle);
+        // Let the other jobs run while polling a non-job wait. (ex: GPU fence, IO)
+        // In a fiber, the fiber goes back to the ready queue. Otherwise, it only yields the thread.
+        void YieldCurrentJob();
+
+        // Call function(index) for each index in [begin, end) and wait until all are finished.
+        // The range is split into the jobs of grainSize indices, and the current thread runs the first one.
+        template <typename F>
+        void ParallelFor(Uint64 begin, Uint64 end, Uint64 grainSize, F&& function)
+        {
+            if (begin >= end)
+            {
+                return;
+            }
+            grainSize = std::max<Uint64>(grainSize, 1);
+            const Uint64 numChunks = (end - begin + grainSize - 1) / grainSize;
+
+            auto runChunk = [&function, begin, end, grainSize](Uint64 chunkIndex)
+            {
+                const Uint64 chunkBegin = begin + chunkIndex * grainSize;
+                const Uint64 chunkEnd = std::min(chunkBegin + grainSize, end);
+                for (Uint64 i = chunkBegin; i < chunkEnd; ++i)
+                {
+                    function(i);
+                }
+            };
+
+            if (numChunks > 1 && !mWorkers.empty())
+            {
+                // All of the chunk jobs share a counter. The function is referenced because this waits for them.
+                internal::JobCounter* counter = AllocateCounter(static_cast<Uint32>(numChunks - 1));
+                counter->refCount.store(static_cast<Uint32>(numChunks), std::memory_order_relaxed);
+
+                // Pushed in the batches, so the job list is not allocated.
+                Array<internal::Job*, 64> jobs;
+                Uint64 numJobs = 0;
+                for (Uint64 chunkIndex = 1; chunkIndex < numChunks; ++chunkIndex)
+                {
+                    internal::Job* job = AllocateJob();
+                    job->SetFunction([&runChunk, chunkIndex]() { runChunk(chunkIndex); });
+                    job->counter = counter;
+                    job->numRemainingDependencies.store(0, std::memory_order_relaxed);
+                    jobs[numJobs++] = job;
+                    if (numJobs == jobs.size())
+                    {
+                        PushJobs({ jobs.data(), numJobs });
+                        numJobs = 0;
+                    }
+                }
+                PushJobs({ jobs.data(), numJobs });
+
+                runChunk(0);
+                Wait(JobHandle(counter));
+            }
+            else
+            {
+                for (Uint64 chunkIndex = 0; chunkIndex < numChunks; ++chunkIndex)
+                {
+                    runChunk(chunkIndex);
+                }
+            }
+        }
+
+    private:
+        friend class JobHandle;
+
+        // Done by the scheduler after the fiber is switched out, so the fiber is not resumed while it is still running.
+        enum class FiberSwitchAction
+        {
+            Release, // Finished the jobs. Return to the pool.
+            Park, // Wait for the counter
+            Yield // Push to the yielded queue
+        };
+
+        struct FiberQueue
+        {
+            std::mutex mutex;
+            std::deque<internal::JobFiber*> fibers;
+            std::atomic<Uint64> size = 0;
+        };
+
+        struct Worker
+        {
+            internal::WorkStealingDeque deque;
+            std::thread thread;
+
+            // Fiber mode only
+            Fiber schedulerFiber;
+            // Set by the fiber before it switches to the scheduler
+            FiberSwitchAction pendingAction = FiberSwitchAction::Release;
+            internal::JobFiber* pendingFiber = nullptr;
+            internal::JobCounter* pendingCounter = nullptr;
+        };
+
+        internal::Job* AllocateJob();
+        internal::JobCounter* AllocateCounter(Uint32 numPendingJobs);
+        void ReleaseCounter(internal::JobCounter* counter);
+
+        void SubmitJob(internal::Job* job, ArrayView<const JobHandle> dependencies);
+        void PushJob(internal::Job* job);
+        void PushJobs(ArrayView<internal::Job*> jobs);
+        void WakeWorkers(Uint64 numJobs);
+
+        internal::Job* FindJob(Int32 workerIndex);
+        void RunJob(internal::Job* job);
+        void ExecuteJob(internal::Job* job);
+        void FinishJob(internal::Job* job);
+
+        void WorkerThreadMain(Uint32 workerIndex);
+        bool RunNextJob(Uint32 workerIndex);
+        bool RunNextFiber(Uint32 workerIndex);
+
+        // Fiber mode
+        static void FiberMain(void* userData);
+        internal::JobFiber* AcquireFiber(internal::Job* job);
+        void SwitchToFiber(Worker& worker, internal::JobFiber* fiber);
+        void SwitchToScheduler(internal::JobFiber* fiber, FiberSwitchAction action, internal::JobCounter* waitingCounter = nullptr);
+        void PushFiber(FiberQueue& queue, internal::JobFiber* fiber);
+        internal::JobFiber* PopFiber(FiberQueue& queue);
+
+        Vector<UniquePtr<Worker>> mWorkers;
+        std::atomic<bool> mIsShuttingDown = false;
+
+        std::function<void(Uint32)> mOnWorkerThreadBegin;
+        std::function<void(Uint32)> mOnWorkerThreadEnd;
+        std::function<void()> mOnJobFinished;
+
+        bool mUseFibers = false;
+        Uint64 mFiberStackSize = 0;
+        std::function<void*()> mCreateFiberLocalData;
+        std::function<void(void*)> mDestroyFiberLocalData;
+        std::function<void(void*)> mOnFiberSwitched;
+
+        mutable std::mutex mFibersMutex;
+        Vector<internal::JobFiber*> mFibers;
+        Vector<internal::JobFiber*> mFreeFibers;
+
+        // Fibers resumed from Wait() run before the new jobs to finish the started ones first.
+        // Fibers from YieldCurrentJob() run after the new jobs.
+        FiberQueue mReadyFibers;
+        FiberQueue mYieldedFibers;
+
+        // Jobs scheduled from the non-worker threads, or overflowed from the deques
+        std::mutex mSharedQueueMutex;
+        std::deque<internal::Job*> mSharedQueue;
+        std::atomic<Uint64> mSharedQueueSize = 0;
+
+        // Sleeping workers wait until the version is changed.
+        std::mutex mSleepMutex;
+        std::condition_variable mSleepCV;
+        std::atomic<Uint64> mWorkVersion = 0;
+        std::atomic<Uint32> mNumSleepingWorkers = 0;
+
+        // Allocated and freed in the different threads, so the thread caches are not used.
+        PoolAllocator<internal::Job> mJobPool;
+        PoolAllocator<internal::JobCounter> mCounterPool;
+        PoolAllocator<internal::JobWaitNode> mWaitNodePool;
+    };
+} // namespace cube
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Types.h"
+
+namespace cube
+{
+    // Subsystem which owns the memory. Used to attribute the CPU memory in MemoryTracker.
+    enum class MemoryTag : Uint8
+    {
+        Untagged,
+        FrameAllocator,
+        Mesh,
+        Texture,
+        Shader,
+        Logger,
+
+        Count
+    };
+    constexpr int NUM_MEMORY_TAGS = static_cast<int>(MemoryTag::Count);
+
+    constexpr const char* MemoryTagToString(MemoryTag tag)
+    {
+        switch (tag)
+        {
+        case MemoryTag::Untagged:
+            return "Untagged";
+        case MemoryTag::FrameAllocator:
+            return "FrameAllocator";
+        case MemoryTag::Mesh:
+            return "Mesh";
+        case MemoryTag::Texture:
+            return "Texture";
+        case MemoryTag::Shader:
+            return "Shader";
+        case MemoryTag::Logger:
+            return "Logger";
+        default:
+            return "Unknown";
+        }
+    }
+} // namespace cube
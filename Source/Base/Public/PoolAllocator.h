@@ -0,0 +1,190 @@
+#pragma once
+
+#include <atomic>
+#include <mutex>
+
+#include "Defines.h"
+#include "Types.h"
+
+// Fill the freed slots with a pattern and check it in the next allocation to find use-after-free.
+#ifndef CUBE_POOL_ALLOCATOR_POISON
+#define CUBE_POOL_ALLOCATOR_POISON CUBE_DEBUG
+#endif
+
+namespace cube
+{
+    struct PoolAllocatorOptions
+    {
+        // Slabs are aligned to their size, so it should be power of 2.
+        Uint64 slabSize = 64 * 1024; // 64 KiB
+        // Keep a few free slots per thread to allocate / free without the lock.
+        // The slots in the thread caches are counted as allocated in the stats.
+        bool useThreadCache = false;
+    };
+
+    struct PoolAllocatorStats
+    {
+        Uint64 elementSize = 0;
+        Uint64 slabSize = 0;
+        Uint64 numElementsPerSlab = 0;
+
+        Uint32 numSlabs = 0;
+        Uint64 numAllocated = 0;
+        Uint64 numFree = 0;
+
+        // Fragmentation report. Slabs by the occupancy: empty, (0%, 25%), [25%, 50%), [50%, 75%), [75%, 100%]
+        Uint32 numEmptySlabs = 0;
+        Array<Uint32, 4> slabOccupancyHistogram = {};
+
+        Uint64 GetReservedSize() const { return numSlabs * slabSize; }
+        // Allocated size / reserved size
+        double GetUtilization() const
+        {
+            const Uint64 reservedSize = GetReservedSize();
+            return reservedSize > 0 ? static_cast<double>(numAllocated * elementSize) / static_cast<double>(reservedSize) : 1.0;
+        }
+    };
+
+    // Pool of the fixed size slots. It is thread-safe.
+    // The slots are carved from the slabs aligned to the slab size, and the free slots are linked with the intrusive list.
+    class FixedSizePool
+    {
+    public:
+        FixedSizePool(Uint64 elementSize, Uint64 alignment, const PoolAllocatorOptions& options = {});
+        ~FixedSizePool();
+
+        FixedSizePool(const FixedSizePool& other) = delete;
+        FixedSizePool& operator=(const FixedSizePool& rhs) = delete;
+
+        void* Allocate();
+        void Free(void* ptr);
+
+        // Release the slabs which do not have any allocated slot.
+        void ReleaseEmptySlabs();
+
+        PoolAllocatorStats GetStats() const;
+
+        Uint64 GetElementSize() const { return mElementSize; }
+
+    private:
+        struct FreeSlot
+        {
+            FreeSlot* next;
+        };
+        struct SlabHeader
+        {
+            Uint64 numUsed;
+        };
+
+        SlabHeader* GetSlab(void* ptr) const { return (SlabHeader*)((Uint64)ptr & ~(mSlabSize - 1)); }
+
+        // Called with the lock.
+        FreeSlot* PopFreeSlot();
+        void PushFreeSlot(FreeSlot* slot);
+        void AllocateSlab();
+
+        void Poison(void* ptr) const;
+        void CheckPoisonAndFill(void* ptr) const;
+
+        Uint64 mElementSize;
+        Uint64 mSlabSize;
+        Uint64 mFirstSlotOffset;
+        Uint64 mNumElementsPerSlab;
+
+        mutable std::mutex mMutex;
+        FreeSlot* mFreeList;
+        Uint64 mNumFree;
+        Vector<SlabHeader*> mSlabs;
+
+        // Index of the thread cache of this pool. It is not reused by other pools. (-1 if it does not use the thread cache)
+        int mThreadCacheIndex;
+    };
+
+    // Pool of the objects with the type T.
+    template <typename T>
+    class PoolAllocator
+    {
+    public:
+        PoolAllocator(const PoolAllocatorOptions& options = {}) :
+            mPool(sizeof(T), alignof(T), options)
+        {}
+
+        template <typename... Args>
+        T* New(Args&&... args)
+        {
+            return new (mPool.Allocate()) T(std::forward<Args>(args)...);
+        }
+
+        void Delete(T* ptr)
+        {
+            if (ptr == nullptr)
+            {
+                return;
+            }
+
+            ptr->~T();
+            mPool.Free(ptr);
+        }
+
+        void* Allocate() { return mPool.Allocate(); }
+        void Free(void* ptr) { mPool.Free(ptr); }
+
+        void ReleaseEmptySlabs() { mPool.ReleaseEmptySlabs(); }
+        PoolAllocatorStats GetStats() const { return mPool.GetStats(); }
+
+    private:
+        FixedSizePool mPool;
+    };
+
+    // Shared pools for the size classes. (Multiples of 16 bytes up to MAX_SIZE)
+    // Allocations larger than it or with the alignment over 16 bytes use the global heap.
+    class SizeClassPool
+    {
+    public:
+        static constexpr Uint64 SIZE_CLASS_STEP = 16;
+        static constexpr Uint64 MAX_SIZE = 512;
+        static constexpr int NUM_SIZE_CLASSES = static_cast<int>(MAX_SIZE / SIZE_CLASS_STEP);
+
+        static void* Allocate(Uint64 size, Uint64 alignment);
+        static void Free(void* ptr, Uint64 size, Uint64 alignment);
+
+        static PoolAllocatorStats GetStats(int sizeClassIndex);
+
+    private:
+        static FixedSizePool* GetPool(Uint64 size, Uint64 alignment);
+    };
+
+    // Std allocator using the size class pools. It can be used in std::allocate_shared, which allocates its control block together.
+    template <typename T>
+    class PoolStdAllocator
+    {
+    public:
+        using value_type = T;
+
+        PoolStdAllocator() = default;
+        template <typename U>
+        PoolStdAllocator(const PoolStdAllocator<U>& other) noexcept
+        {}
+
+        T* allocate(size_t n)
+        {
+            return (T*)SizeClassPool::Allocate(sizeof(T) * n, alignof(T));
+        }
+
+        void deallocate(T* p, size_t n)
+        {
+            SizeClassPool::Free(p, sizeof(T) * n, alignof(T));
+        }
+    };
+
+    template <typename T1, typename T2>
+    bool operator==(const PoolStdAllocator<T1>& lhs, const PoolStdAllocator<T2>& rhs) noexcept
+    {
+        return true;
+    }
+    template <typename T1, typename T2>
+    bool operator!=(const PoolStdAllocator<T1>& lhs, const PoolStdAllocator<T2>& rhs) noexcept
+    {
+        return false;
+    }
+} // namespace cube
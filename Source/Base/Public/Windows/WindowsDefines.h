@@ -11,6 +11,7 @@
 #endif
 
 #define FORCE_INLINE __forceinline
+#define NO_INLINE __declspec(noinline)
 
 #define CUBE_DLL_EXPORT __declspec(dllexport)
 #define CUBE_DLL_IMPORT __declspec(dllimport)
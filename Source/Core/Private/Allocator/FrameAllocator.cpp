@@ -6,10 +6,24 @@
 namespace cube
 {
     thread_local FrameAllocator thlFrameAllocator;
+    thread_local FrameAllocator* thlFiberFrameAllocator = nullptr;
 
-    FrameAllocator& GetMyThreadFrameAllocator()
+    // A job fiber can be resumed in another thread, so the thread-local variables are read through the volatile pointer
+    // to keep the compiler from caching their address across the calls.
+    NO_INLINE FrameAllocator& GetMyThreadFrameAllocator()
     {
-        return thlFrameAllocator;
+        FrameAllocator* volatile fiberFrameAllocator = thlFiberFrameAllocator;
+        if (fiberFrameAllocator != nullptr)
+        {
+            return *fiberFrameAllocator;
+        }
+        FrameAllocator* volatile threadFrameAllocator = &thlFrameAllocator;
+        return *threadFrameAllocator;
+    }
+
+    void SetCurrentFiberFrameAllocator(FrameAllocator* allocator)
+    {
+        thlFiberFrameAllocator = allocator;
     }
 
     FrameAllocator::MemoryBlock::MemoryBlock(Uint64 size) :
@@ -21,7 +35,7 @@ namespace cube
             return;
         }
 
-        mStartPtr = platform::Platform::Allocate(size);
+        mStartPtr = platform::Platform::Allocate(size, MemoryTag::FrameAllocator);
 
         mCurrentPtr = mStartPtr;
     }
@@ -33,14 +47,37 @@ namespace cube
             return;
         }
 
-        platform::Platform::Free(mStartPtr);
+        platform::Platform::Free(mStartPtr, MemoryTag::FrameAllocator);
+    }
+
+    FrameAllocator::MemoryBlock& FrameAllocator::MemoryBlock::operator=(MemoryBlock&& rhs) noexcept
+    {
+        if (this == &rhs)
+        {
+            return *this;
+        }
+
+        if (mSize != 0)
+        {
+            platform::Platform::Free(mStartPtr, MemoryTag::FrameAllocator);
+        }
+
+        mSize = rhs.mSize;
+        mStartPtr = rhs.mStartPtr;
+        mCurrentPtr = rhs.mCurrentPtr;
+
+        rhs.mSize = 0;
+        rhs.mStartPtr = nullptr;
+        rhs.mCurrentPtr = nullptr;
+
+        return *this;
     }
 
     void* FrameAllocator::MemoryBlock::Allocate(Uint64 size)
     {
 #ifdef CUBE_FRAME_ALLOCATOR_TRACK_ALLOCATION
         // Uint64: allocated size
-        size += sizeof(Uint64);
+        size += ALLOCATION_HEADER_SIZE;
 #endif
 
         Uint64 allocatedSize = (Uint64)mCurrentPtr - (Uint64)mStartPtr;
@@ -54,7 +91,7 @@ namespace cube
         Uint64* storedSize = (Uint64*)ptr;
         *storedSize = size;
 
-        return (Uint8*)ptr + sizeof(Uint64);
+        return (Uint8*)ptr + ALLOCATION_HEADER_SIZE;
 #else
         return ptr;
 #endif
@@ -65,7 +102,7 @@ namespace cube
         // It doesn't store alignGap because the allocation isn't freed individually.
 #ifdef CUBE_FRAME_ALLOCATOR_TRACK_ALLOCATION
         // Uint64: allocated size
-        size += sizeof(Uint64);
+        size += ALLOCATION_HEADER_SIZE;
 #endif
 
         Uint64 currentOffset = (Uint64)mCurrentPtr;
@@ -75,7 +112,7 @@ namespace cube
         //       |            |                  |                       |
         // currentOffset                   alignedOffset
 
-        Uint64 addedOffset = currentOffset + sizeof(Uint64);
+        Uint64 addedOffset = currentOffset + ALLOCATION_HEADER_SIZE;
 
         Uint64 alignedOffset = Align(addedOffset, alignment);
         Uint8 alignGap = (Uint8)(alignedOffset - addedOffset);
@@ -92,7 +129,7 @@ namespace cube
         mCurrentPtr = (Uint8*)mCurrentPtr + alignGap + size;
 
 #ifdef CUBE_FRAME_ALLOCATOR_TRACK_ALLOCATION
-        Uint64* storedSize = (Uint64*)((Uint8*)ptr - sizeof(Uint64));
+        Uint64* storedSize = (Uint64*)((Uint8*)ptr - ALLOCATION_HEADER_SIZE);
         *storedSize = alignGap + size;
 #endif
 
@@ -104,9 +141,17 @@ namespace cube
         mCurrentPtr = mStartPtr;
     }
 
+    void FrameAllocator::MemoryBlock::RewindTo(void* ptr)
+    {
+        CHECK_FORMAT((Uint8*)mStartPtr <= (Uint8*)ptr && (Uint8*)ptr <= (Uint8*)mCurrentPtr, "Cannot rewind to the pointer which is not allocated in the memory block.");
+
+        mCurrentPtr = ptr;
+    }
+
     FrameAllocator::FrameAllocator() :
         mInitialized(false),
         mMemoryBlock(0),
+        mCurrentMemBlock(nullptr),
         mStdAllocator(*this)
     {}
 
@@ -133,6 +178,12 @@ namespace cube
 #endif
         mBlockSize = blockSize;
         mMemoryBlock = MemoryBlock(blockSize);
+        mCurrentMemBlock = &mMemoryBlock;
+        mStats = {
+            .blockSize = blockSize
+        };
+        mFramePeakUsedSize = 0;
+        mNumFrameAdditionalBlocks = 0;
 
         mInitialized = true;
     }
@@ -152,50 +203,37 @@ namespace cube
 
         mAdditionalMemBlocks.clear();
         mMemoryBlock = MemoryBlock(0);
+        mCurrentMemBlock = nullptr;
 
         mInitialized = false;
     }
 
-    void* FrameAllocator::Allocate(Uint64 size)
+    template <typename AllocateFunction>
+    void* FrameAllocator::AllocateInCurrentBlock(Uint64 requiredSize, AllocateFunction allocateFunction)
     {
-        EnsureInitialization();
-
-        void* ptr = mMemoryBlock.Allocate(size);
-
-        if (ptr != nullptr)
+        void* ptr = allocateFunction(*mCurrentMemBlock);
+        if (ptr == nullptr)
         {
-#ifdef CUBE_FRAME_ALLOCATOR_TRACK_ALLOCATION
-            mAllocatedSize += *(Uint64*)((Uint8*)ptr - sizeof(Uint64));
-#endif
-            return ptr;
+            AllocateAdditionalBlock(requiredSize);
+            ptr = allocateFunction(*mCurrentMemBlock);
         }
 
-        // Try to allocate in additional blocks
-        for (MemoryBlock& block : mAdditionalMemBlocks)
-        {
-            ptr = block.Allocate(size);
-
-            if (ptr != nullptr)
-            {
 #ifdef CUBE_FRAME_ALLOCATOR_TRACK_ALLOCATION
-                mAllocatedSize += *(Uint64*)((Uint8*)ptr - sizeof(Uint64));
+        mAllocatedSize += *(Uint64*)((Uint8*)ptr - ALLOCATION_HEADER_SIZE);
 #endif
-                return ptr;
-            }
-        }
+        return ptr;
+    }
 
-        // Allocate new additional block
-#ifdef CUBE_FRAME_ALLOCATOR_TRACK_ALLOCATION
-        AllocateAdditionalBlock(size + sizeof(Uint64));
-#else
-        AllocateAdditionalBlock(size);
-#endif
-        ptr = mAdditionalMemBlocks.back().Allocate(size);
+    void* FrameAllocator::Allocate(Uint64 size)
+    {
+        EnsureInitialization();
 
 #ifdef CUBE_FRAME_ALLOCATOR_TRACK_ALLOCATION
-        mAllocatedSize += *(Uint64*)((Uint8*)ptr - sizeof(Uint64));
+        const Uint64 requiredSize = size + ALLOCATION_HEADER_SIZE;
+#else
+        const Uint64 requiredSize = size;
 #endif
-        return ptr;
+        return AllocateInCurrentBlock(requiredSize, [size](MemoryBlock& block) { return block.Allocate(size); });
     }
 
     void FrameAllocator::Free(void* ptr)
@@ -204,7 +242,7 @@ namespace cube
 #ifdef CUBE_FRAME_ALLOCATOR_TRACK_ALLOCATION
         EnsureInitialization();
 
-        mAllocatedSize -= *(Uint64*)((Uint8*)ptr - sizeof(Uint64));
+        mAllocatedSize -= *(Uint64*)((Uint8*)ptr - ALLOCATION_HEADER_SIZE);
 #endif
     }
 
@@ -212,55 +250,86 @@ namespace cube
     {
         EnsureInitialization();
 
-        void* ptr = mMemoryBlock.AllocateAligned(size, alignment);
+#ifdef CUBE_FRAME_ALLOCATOR_TRACK_ALLOCATION
+        const Uint64 requiredSize = size + alignment + alignment + ALLOCATION_HEADER_SIZE;
+#else
+        const Uint64 requiredSize = size + alignment;
+#endif
+        return AllocateInCurrentBlock(requiredSize, [size, alignment](MemoryBlock& block) { return block.AllocateAligned(size, alignment); });
+    }
 
-        if (ptr != nullptr)
-        {
+    void FrameAllocator::FreeAligned(void* ptr)
+    {
+        // Do nothing except for debugging
 #ifdef CUBE_FRAME_ALLOCATOR_TRACK_ALLOCATION
-            mAllocatedSize += *(Uint64*)((Uint8*)ptr - sizeof(Uint64));
+        EnsureInitialization();
+
+        mAllocatedSize -= *(Uint64*)((Uint8*)ptr - ALLOCATION_HEADER_SIZE);
 #endif
-            return ptr;
-        }
+    }
 
-        // Try to allocate in additional blocks
-        for (MemoryBlock& block : mAdditionalMemBlocks)
+    void FrameAllocator::DiscardAllocations()
+    {
+        if (!mInitialized)
         {
-            ptr = block.AllocateAligned(size, alignment);
+            return;
+        }
 
-            if (ptr != nullptr)
-            {
 #ifdef CUBE_FRAME_ALLOCATOR_TRACK_ALLOCATION
-                mAllocatedSize += *(Uint64*)((Uint8*)ptr - sizeof(Uint64));
-#endif
-                return ptr;
-            }
+        {
+            LoggerUseDefaultAllocatorScope scope;
+
+            CHECK_FORMAT(mAllocatedSize == 0, "Not all allocations were freed in the frame allocator.");
         }
+#endif
+
+        const Uint64 usedSize = std::max(mFramePeakUsedSize, GetUsedSize());
+        mStats.lastFrameUsedSize = usedSize;
+        mStats.highWaterMark = std::max(mStats.highWaterMark, usedSize);
+        mStats.numLastFrameAdditionalBlocks = mNumFrameAdditionalBlocks;
+
+        if (mNumFrameAdditionalBlocks > 0)
+        {
+            // Release the additional blocks and grow the primary block to the high-water mark.
+            mAdditionalMemBlocks.clear();
+
+            mBlockSize = Align<Uint64>(mStats.highWaterMark, 64 * 1024);
+            mMemoryBlock = MemoryBlock(mBlockSize);
+            mStats.blockSize = mBlockSize;
+            mStats.numBlockGrowths++;
 
-        // Allocate new additional block
 #ifdef CUBE_FRAME_ALLOCATOR_TRACK_ALLOCATION
-        AllocateAdditionalBlock(size + alignment + alignment + sizeof(Uint64));
-#else
-        AllocateAdditionalBlock(size + alignment);
+            LoggerUseDefaultAllocatorScope scope;
+
+            CUBE_LOG(Info, Allocator, "Grow the block of the frame allocator '{0}' to the high-water mark. ({1})", mDebugName, mBlockSize);
 #endif
-        ptr = mAdditionalMemBlocks.back().AllocateAligned(size, alignment);
+        }
+        else
+        {
+            mMemoryBlock.DiscardAllocations();
+        }
+        mCurrentMemBlock = &mMemoryBlock;
 
+        mFramePeakUsedSize = 0;
+        mNumFrameAdditionalBlocks = 0;
 #ifdef CUBE_FRAME_ALLOCATOR_TRACK_ALLOCATION
-        mAllocatedSize += *(Uint64*)((Uint8*)ptr - sizeof(Uint64));
+        mFrameIndex++;
 #endif
-        return ptr;
     }
 
-    void FrameAllocator::FreeAligned(void* ptr)
+    FrameAllocator::Marker FrameAllocator::GetMarker() const
     {
-        // Do nothing except for debugging
+        return {
+            .numAdditionalBlocks = static_cast<int>(mAdditionalMemBlocks.size()),
+            .currentPtr = mCurrentMemBlock ? mCurrentMemBlock->GetCurrentPtr() : nullptr,
 #ifdef CUBE_FRAME_ALLOCATOR_TRACK_ALLOCATION
-        EnsureInitialization();
-
-        mAllocatedSize -= *(Uint64*)((Uint8*)ptr - sizeof(Uint64));
+            .allocatedSize = mAllocatedSize,
+            .frameIndex = mFrameIndex
 #endif
+        };
     }
 
-    void FrameAllocator::DiscardAllocations()
+    void FrameAllocator::RewindTo(const Marker& marker)
     {
         if (!mInitialized)
         {
@@ -271,28 +340,53 @@ namespace cube
         {
             LoggerUseDefaultAllocatorScope scope;
 
-            CHECK_FORMAT(mAllocatedSize == 0, "Not all allocations were freed in the frame allocator.");
+            CHECK_FORMAT(marker.frameIndex == mFrameIndex, "The marker of the frame allocator was taken in the previous frame.");
+            CHECK_FORMAT(mAllocatedSize == marker.allocatedSize, "Not all allocations after the marker were freed in the frame allocator. ({0} bytes are alive)", mAllocatedSize - marker.allocatedSize);
         }
 #endif
+        CHECK(marker.numAdditionalBlocks <= static_cast<int>(mAdditionalMemBlocks.size()));
+
+        mFramePeakUsedSize = std::max(mFramePeakUsedSize, GetUsedSize());
 
-        mMemoryBlock.DiscardAllocations();
+        // Release the blocks added after the marker. They are counted at DiscardAllocations() to grow the primary block.
+        mAdditionalMemBlocks.erase(mAdditionalMemBlocks.begin() + marker.numAdditionalBlocks, mAdditionalMemBlocks.end());
+        mCurrentMemBlock = mAdditionalMemBlocks.empty() ? &mMemoryBlock : &mAdditionalMemBlocks.back();
 
-        for (auto& block : mAdditionalMemBlocks)
+        if (marker.currentPtr)
         {
-            block.DiscardAllocations();
+            mCurrentMemBlock->RewindTo(marker.currentPtr);
+        }
+        else
+        {
+            mCurrentMemBlock->DiscardAllocations();
         }
     }
 
+    Uint64 FrameAllocator::GetUsedSize() const
+    {
+        Uint64 usedSize = mMemoryBlock.GetUsedSize();
+        for (const MemoryBlock& block : mAdditionalMemBlocks)
+        {
+            usedSize += block.GetUsedSize();
+        }
+        return usedSize;
+    }
+
     void FrameAllocator::AllocateAdditionalBlock(Uint64 size)
     {
+        if (mNumFrameAdditionalBlocks == 0)
         {
             LoggerUseDefaultAllocatorScope scope;
-            
-            CUBE_LOG(Warning, Allocator, "Allocate additional block in FrameAllocation. It has performance cost. Try to increase default block size in FrameAllocator.");
+
+            CUBE_LOG(Warning, Allocator, "Allocate additional block in FrameAllocation. The block will be grown at the end of the frame. Try to increase default block size in FrameAllocator.");
             CUBE_LOG(Warning, Allocator, "Default size: {0} / Size to allocate: {1}", mBlockSize, size);
         }
 
-        mAdditionalMemBlocks.emplace_back(size);
+        // Grow geometrically so the frame with many overflows does not make many blocks.
+        const Uint64 lastBlockSize = mAdditionalMemBlocks.empty() ? mBlockSize : mAdditionalMemBlocks.back().GetSize();
+        mAdditionalMemBlocks.emplace_back(std::max(size, lastBlockSize * 2));
+        mCurrentMemBlock = &mAdditionalMemBlocks.back();
+        mNumFrameAdditionalBlocks++;
     }
 
     void FrameAllocator::EnsureInitialization()
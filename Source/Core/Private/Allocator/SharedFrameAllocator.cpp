@@ -0,0 +1,266 @@
+#include "Allocator/SharedFrameAllocator.h"
+
+#include "Allocator/AllocatorUtility.h"
+#include "Checker.h"
+#include "Logger.h"
+#include "Platform.h"
+
+namespace cube
+{
+    SharedFrameAllocator gSharedFrameAllocator;
+
+    SharedFrameAllocator& GetSharedFrameAllocator()
+    {
+        return gSharedFrameAllocator;
+    }
+
+    namespace
+    {
+        // Unique in all allocators, so a chunk cannot be reused in the allocator re-initialized at the same address.
+        std::atomic<Uint64> gNextGeneration = 1;
+    } // namespace
+
+    SharedFrameAllocator::SharedFrameAllocator() :
+        mInitialized(false),
+        mBlockSize(0),
+        mChunkSize(0),
+        mBlockStartPtr(nullptr),
+        mBlockOffset(0),
+        mGeneration(0),
+        mNumOverflowAllocations(0)
+    {}
+
+    SharedFrameAllocator::~SharedFrameAllocator()
+    {
+        if (mInitialized)
+        {
+            Shutdown();
+        }
+    }
+
+    void SharedFrameAllocator::Initialize(const char* debugName, Uint64 blockSize, Uint64 chunkSize)
+    {
+#ifdef CUBE_FRAME_ALLOCATOR_TRACK_ALLOCATION
+        if (mInitialized)
+        {
+            LoggerUseDefaultAllocatorScope scope;
+
+            CUBE_LOG(Warning, Allocator, "The shared frame allocator is already initialized. (name: {} / blockSize: {}) Skip the initialization.", debugName, blockSize);
+
+            return;
+        }
+        mDebugName = debugName;
+#endif
+        CHECK_FORMAT(chunkSize > 0 && chunkSize <= blockSize, "Invalid chunk size. (chunkSize: {0} / blockSize: {1})", chunkSize, blockSize);
+
+        mBlockSize = blockSize;
+        mChunkSize = chunkSize;
+        mBlockStartPtr = (Uint8*)platform::Platform::Allocate(blockSize, MemoryTag::FrameAllocator);
+        mBlockOffset.store(0, std::memory_order_relaxed);
+        mGeneration.store(gNextGeneration.fetch_add(1, std::memory_order_relaxed), std::memory_order_relaxed);
+        mNumOverflowAllocations.store(0, std::memory_order_relaxed);
+
+        mInitialized.store(true, std::memory_order_release);
+    }
+
+    void SharedFrameAllocator::Shutdown()
+    {
+#ifdef CUBE_FRAME_ALLOCATOR_TRACK_ALLOCATION
+        if (!mInitialized)
+        {
+            LoggerUseDefaultAllocatorScope scope;
+
+            CUBE_LOG(Warning, Allocator, "The shared frame allocator is not initialized but shutdown was triggered.");
+
+            return;
+        }
+#endif
+
+        for (void* overflowBlock : mOverflowBlocks)
+        {
+            platform::Platform::Free(overflowBlock, MemoryTag::FrameAllocator);
+        }
+        mOverflowBlocks.clear();
+
+        platform::Platform::Free(mBlockStartPtr, MemoryTag::FrameAllocator);
+        mBlockStartPtr = nullptr;
+        mBlockSize = 0;
+        mGeneration.store(0, std::memory_order_relaxed);
+
+        mInitialized.store(false, std::memory_order_release);
+    }
+
+    void* SharedFrameAllocator::Allocate(Uint64 size)
+    {
+        // Keep the alignment of the stored size.
+        return AllocateAligned(size, alignof(Uint64));
+    }
+
+    void SharedFrameAllocator::Free(void* ptr)
+    {
+        FreeAligned(ptr);
+    }
+
+    void* SharedFrameAllocator::AllocateAligned(Uint64 size, Uint64 alignment)
+    {
+        EnsureInitialization();
+
+        thread_local ThreadChunk thlChunk;
+
+        // Fast path: bump the chunk of this thread.
+        const Uint64 generation = mGeneration.load(std::memory_order_relaxed);
+        Uint8* ptr = nullptr;
+        if (thlChunk.owner == this && thlChunk.generation == generation)
+        {
+            ptr = AllocateInChunk(thlChunk, size, alignment);
+        }
+
+        if (ptr == nullptr)
+        {
+#ifdef CUBE_FRAME_ALLOCATOR_TRACK_ALLOCATION
+            // Uint64: allocated size
+            const Uint64 requiredSize = sizeof(Uint64) + size + alignment;
+#else
+            const Uint64 requiredSize = size + alignment;
+#endif
+            if (requiredSize > mChunkSize / 4)
+            {
+                // Large allocation is handed out directly so it does not waste the rest of the chunk.
+                ThreadChunk largeChunk = {
+                    .owner = this,
+                    .generation = generation
+                };
+                largeChunk.current = AllocateFromBlock(requiredSize);
+                largeChunk.end = largeChunk.current + requiredSize;
+                ptr = AllocateInChunk(largeChunk, size, alignment);
+            }
+            else
+            {
+                thlChunk.owner = this;
+                thlChunk.generation = generation;
+                thlChunk.current = AllocateFromBlock(mChunkSize);
+                thlChunk.end = thlChunk.current + mChunkSize;
+                ptr = AllocateInChunk(thlChunk, size, alignment);
+            }
+        }
+        CHECK(ptr);
+
+#ifdef CUBE_FRAME_ALLOCATOR_TRACK_ALLOCATION
+        Uint64* storedSize = (Uint64*)(ptr - sizeof(Uint64));
+        *storedSize = size;
+        mAllocatedSize.fetch_add(size, std::memory_order_relaxed);
+#endif
+
+        return ptr;
+    }
+
+    void SharedFrameAllocator::FreeAligned(void* ptr)
+    {
+        // Do nothing except for debugging
+#ifdef CUBE_FRAME_ALLOCATOR_TRACK_ALLOCATION
+        EnsureInitialization();
+
+        mAllocatedSize.fetch_sub(*(Uint64*)((Uint8*)ptr - sizeof(Uint64)), std::memory_order_relaxed);
+#endif
+    }
+
+    void SharedFrameAllocator::DiscardAllocations()
+    {
+        if (!mInitialized)
+        {
+            return;
+        }
+
+#ifdef CUBE_FRAME_ALLOCATOR_TRACK_ALLOCATION
+        {
+            LoggerUseDefaultAllocatorScope scope;
+
+            CHECK_FORMAT(mAllocatedSize.load(std::memory_order_relaxed) == 0, "Not all allocations were freed in the shared frame allocator.");
+        }
+#endif
+
+        // The chunks of all threads become invalid by the new generation.
+        mGeneration.store(gNextGeneration.fetch_add(1, std::memory_order_relaxed), std::memory_order_relaxed);
+        mBlockOffset.store(0, std::memory_order_relaxed);
+
+        for (void* overflowBlock : mOverflowBlocks)
+        {
+            platform::Platform::Free(overflowBlock, MemoryTag::FrameAllocator);
+        }
+        mOverflowBlocks.clear();
+        mNumOverflowAllocations.store(0, std::memory_order_relaxed);
+    }
+
+    Uint8* SharedFrameAllocator::AllocateInChunk(ThreadChunk& chunk, Uint64 size, Uint64 alignment)
+    {
+        // It doesn't store alignGap because the allocation isn't freed individually.
+#ifdef CUBE_FRAME_ALLOCATOR_TRACK_ALLOCATION
+        //       |            |<-sizeof(Uint64)->|<--------size-------->|
+        //       |<-alignGap->|                  |                      |
+        //       |            |                  |                      |
+        //    current                      alignedOffset
+
+        const Uint64 alignedOffset = Align((Uint64)chunk.current + sizeof(Uint64), alignment);
+#else
+        const Uint64 alignedOffset = Align((Uint64)chunk.current, alignment);
+#endif
+        if (alignedOffset + size > (Uint64)chunk.end)
+        {
+            return nullptr;
+        }
+
+        chunk.current = (Uint8*)(alignedOffset + size);
+        return (Uint8*)alignedOffset;
+    }
+
+    Uint8* SharedFrameAllocator::AllocateFromBlock(Uint64 size)
+    {
+        // Keep the chunks aligned to the cache line so the threads do not share it.
+        size = Align<Uint64>(size, 64);
+
+        const Uint64 offset = mBlockOffset.fetch_add(size, std::memory_order_relaxed);
+        if (offset + size <= mBlockSize)
+        {
+            return mBlockStartPtr + offset;
+        }
+
+        return AllocateOverflow(size);
+    }
+
+    Uint8* SharedFrameAllocator::AllocateOverflow(Uint64 size)
+    {
+        std::unique_lock<std::mutex> lock(mOverflowMutex);
+
+        if (mNumOverflowAllocations.fetch_add(1, std::memory_order_relaxed) == 0)
+        {
+            LoggerUseDefaultAllocatorScope scope;
+
+            CUBE_LOG(Warning, Allocator, "The memory block of the shared frame allocator is full. Allocations take the lock until the end of the frame. Try to increase the block size in SharedFrameAllocator.");
+            CUBE_LOG(Warning, Allocator, "Block size: {0} / Size to allocate: {1}", mBlockSize, size);
+        }
+
+        void* overflowBlock = platform::Platform::Allocate(size, MemoryTag::FrameAllocator);
+        mOverflowBlocks.push_back(overflowBlock);
+
+        return (Uint8*)overflowBlock;
+    }
+
+    void SharedFrameAllocator::EnsureInitialization()
+    {
+        if (mInitialized.load(std::memory_order_acquire))
+        {
+            return;
+        }
+
+        // Several threads can use it first at the same time, so only one of them initializes.
+        std::unique_lock<std::mutex> lock(mInitializeMutex);
+        if (!mInitialized.load(std::memory_order_relaxed))
+        {
+            Initialize("SharedFrameAllocator (auto initialized)");
+
+            LoggerUseDefaultAllocatorScope scope;
+
+            CUBE_LOG(Warning, Allocator, "Shared frame allocator was used before initialized. Auto-initialized with default settings.");
+        }
+    }
+} // namespace cube
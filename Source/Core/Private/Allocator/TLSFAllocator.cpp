@@ -0,0 +1,412 @@
+#include "Allocator/TLSFAllocator.h"
+
+#include <bit>
+
+#include "Allocator/AllocatorUtility.h"
+#include "Checker.h"
+#include "Logger.h"
+#include "MemoryTracker.h"
+#include "Platform.h"
+
+namespace cube
+{
+    TLSFAllocator gAssetHeapAllocator;
+
+    TLSFAllocator& GetAssetHeapAllocator()
+    {
+        return gAssetHeapAllocator;
+    }
+
+    TLSFAllocator::TLSFAllocator() :
+        mInitialized(false),
+        mUseVirtualMemory(false),
+        mPoolSize(0),
+        mDebugName(""),
+        mFLBitmap(0),
+        mSLBitmaps{},
+        mFreeLists{},
+        mNumAllocations(0),
+        mUsedSize(0),
+        mPeakUsedSize(0)
+    {}
+
+    TLSFAllocator::~TLSFAllocator()
+    {
+        if (mInitialized)
+        {
+            Shutdown();
+        }
+    }
+
+    void TLSFAllocator::Initialize(const char* debugName, Uint64 poolSize, bool useVirtualMemory)
+    {
+        if (mInitialized)
+        {
+            LoggerUseDefaultAllocatorScope scope;
+
+            CUBE_LOG(Warning, Allocator, "The TLSF allocator is already initialized. (name: {} / poolSize: {}) Skip the initialization.", debugName, poolSize);
+
+            return;
+        }
+
+        mDebugName = debugName;
+        mPoolSize = poolSize;
+        mUseVirtualMemory = useVirtualMemory;
+
+        mFLBitmap = 0;
+        memset(mSLBitmaps, 0, sizeof(mSLBitmaps));
+        memset(mFreeLists, 0, sizeof(mFreeLists));
+        mNumAllocations = 0;
+        mUsedSize = 0;
+        mPeakUsedSize = 0;
+
+        mInitialized = true;
+    }
+
+    void TLSFAllocator::Shutdown()
+    {
+        if (!mInitialized)
+        {
+            LoggerUseDefaultAllocatorScope scope;
+
+            CUBE_LOG(Warning, Allocator, "The TLSF allocator is not initialized but shutdown was triggered.");
+
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(mMutex);
+
+        if (mNumAllocations > 0)
+        {
+            LoggerUseDefaultAllocatorScope scope;
+
+            // Keep the pools because the remaining allocations may still be freed later.
+            CUBE_LOG(Warning, Allocator, "Not all allocations were freed in the TLSF allocator '{}'. (numAllocations: {} / usedSize: {}) Its memory pools are not released.", mDebugName, mNumAllocations, mUsedSize);
+        }
+        else
+        {
+            for (const Pool& pool : mPools)
+            {
+                if (mUseVirtualMemory)
+                {
+                    platform::Platform::FreeVirtualMemory(pool.memory, pool.size);
+                }
+                else
+                {
+                    platform::Platform::FreeAligned(pool.memory);
+                }
+            }
+        }
+        mPools.clear();
+
+        mInitialized = false;
+    }
+
+    void* TLSFAllocator::Allocate(SizeType n)
+    {
+        return AllocateAligned(n, ALIGN_SIZE);
+    }
+
+    void TLSFAllocator::Free(void* ptr, SizeType n)
+    {
+        FreeAligned(ptr);
+    }
+
+    void* TLSFAllocator::AllocateTagged(SizeType n, MemoryTag tag)
+    {
+        return AllocateAligned(n, ALIGN_SIZE, tag);
+    }
+
+    void TLSFAllocator::FreeTagged(void* ptr, SizeType n, MemoryTag tag)
+    {
+        FreeAligned(ptr);
+    }
+
+    void* TLSFAllocator::AllocateAligned(Uint64 size, Uint64 alignment, MemoryTag tag)
+    {
+        EnsureInitialization();
+
+        alignment = std::max(alignment, ALIGN_SIZE);
+        const Uint64 adjustedSize = Align(std::max(size, MIN_BLOCK_SIZE), ALIGN_SIZE);
+        // Reserve the space to move the payload forward with a free block in front of it.
+        const Uint64 minAlignGap = BLOCK_HEADER_OVERHEAD + MIN_BLOCK_SIZE;
+        const Uint64 searchSize = alignment > ALIGN_SIZE ? adjustedSize + alignment + minAlignGap : adjustedSize;
+        CHECK_FORMAT(searchSize < (1ull << FL_INDEX_MAX), "Too large allocation in the TLSF allocator. (size: {0})", size);
+
+        std::unique_lock<std::mutex> lock(mMutex);
+
+        BlockHeader* block = FindFreeBlock(searchSize);
+        if (block == nullptr)
+        {
+            if (!AddPool(searchSize))
+            {
+                return nullptr;
+            }
+            block = FindFreeBlock(searchSize);
+            CHECK(block);
+        }
+        RemoveFreeBlock(block);
+
+        if (alignment > ALIGN_SIZE)
+        {
+            const Uint64 payload = (Uint64)block->GetPayload();
+            Uint64 alignedPayload = Align(payload, alignment);
+            if (alignedPayload != payload && alignedPayload - payload < minAlignGap)
+            {
+                alignedPayload = Align(payload + minAlignGap, alignment);
+            }
+
+            const Uint64 gap = alignedPayload - payload;
+            if (gap > 0)
+            {
+                // The gap becomes the free block in front.
+                BlockHeader* alignedBlock = SplitBlock(block, gap - BLOCK_HEADER_OVERHEAD);
+                InsertFreeBlock(block);
+                block = alignedBlock;
+            }
+        }
+
+        if (block->GetSize() >= adjustedSize + BLOCK_HEADER_OVERHEAD + MIN_BLOCK_SIZE)
+        {
+            // The next block is not free because the free blocks are always merged,
+            // so the remaining block can be inserted without merging.
+            BlockHeader* remaining = SplitBlock(block, adjustedSize);
+            InsertFreeBlock(remaining);
+        }
+        block->SetFree(false);
+        block->SetTag(tag);
+        MemoryTracker::OnAllocate(tag, block->GetSize());
+
+        mNumAllocations++;
+        mUsedSize += block->GetSize();
+        mPeakUsedSize = std::max(mPeakUsedSize, mUsedSize);
+
+        return block->GetPayload();
+    }
+
+    void TLSFAllocator::FreeAligned(void* ptr)
+    {
+        if (ptr == nullptr)
+        {
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(mMutex);
+
+        BlockHeader* block = BlockHeader::FromPayload(ptr);
+        CHECK_FORMAT(!block->IsFree(), "The block is already freed in the TLSF allocator '{0}'.", mDebugName);
+
+        mNumAllocations--;
+        mUsedSize -= block->GetSize();
+        MemoryTracker::OnFree(block->GetTag(), block->GetSize());
+
+        block->SetFree(true);
+        block->SetTag(MemoryTag::Untagged);
+
+        BlockHeader* prev = block->prevPhysBlock;
+        if (prev && prev->IsFree())
+        {
+            RemoveFreeBlock(prev);
+            MergeBlock(prev, block);
+            block = prev;
+        }
+        BlockHeader* next = block->GetNextPhysBlock();
+        if (next->IsFree())
+        {
+            RemoveFreeBlock(next);
+            MergeBlock(block, next);
+        }
+
+        InsertFreeBlock(block);
+    }
+
+    TLSFAllocatorStats TLSFAllocator::GetStats() const
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+
+        TLSFAllocatorStats stats = {
+            .numPools = static_cast<Uint32>(mPools.size()),
+            .numAllocations = mNumAllocations,
+            .usedSize = mUsedSize,
+            .peakUsedSize = mPeakUsedSize
+        };
+        for (const Pool& pool : mPools)
+        {
+            stats.reservedSize += pool.size;
+        }
+        for (Uint32 fl = 0; fl < FL_INDEX_COUNT; ++fl)
+        {
+            for (Uint32 sl = 0; sl < SL_INDEX_COUNT; ++sl)
+            {
+                for (const BlockHeader* block = mFreeLists[fl][sl]; block; block = block->nextFree)
+                {
+                    stats.freeSize += block->GetSize();
+                    stats.largestFreeBlockSize = std::max(stats.largestFreeBlockSize, block->GetSize());
+                }
+            }
+        }
+
+        return stats;
+    }
+
+    void TLSFAllocator::EnsureInitialization()
+    {
+        if (!mInitialized)
+        {
+            Initialize("TLSFAllocator (auto initialized)");
+
+            LoggerUseDefaultAllocatorScope scope;
+
+            CUBE_LOG(Warning, Allocator, "TLSF allocator was used before initialized. Auto-initialized with default settings.");
+        }
+    }
+
+    bool TLSFAllocator::AddPool(Uint64 minBlockSize)
+    {
+        // The found block should be in the list of the size rounded up in MappingSearch().
+        const Uint64 requiredSize = minBlockSize + (minBlockSize >> SL_INDEX_COUNT_LOG2) + BLOCK_HEADER_OVERHEAD * 2;
+        const Uint64 poolSize = std::max(mPoolSize, Align<Uint64>(requiredSize, 64 * 1024));
+
+        void* memory = mUseVirtualMemory ? platform::Platform::AllocateVirtualMemory(poolSize) : platform::Platform::AllocateAligned(poolSize, 64);
+        if (memory == nullptr)
+        {
+            LoggerUseDefaultAllocatorScope scope;
+
+            CUBE_LOG(Error, Allocator, "Failed to allocate the memory pool in the TLSF allocator '{}'. (poolSize: {})", mDebugName, poolSize);
+
+            return false;
+        }
+        mPools.push_back({ .memory = memory, .size = poolSize });
+
+        // |<-header->|<------------free block payload------------>|<-sentinel header->|
+        BlockHeader* block = (BlockHeader*)memory;
+        block->prevPhysBlock = nullptr;
+        block->sizeAndFlags = (poolSize - BLOCK_HEADER_OVERHEAD * 2) | BlockHeader::FREE_FLAG;
+
+        BlockHeader* sentinel = block->GetNextPhysBlock();
+        sentinel->prevPhysBlock = block;
+        sentinel->sizeAndFlags = 0;
+
+        InsertFreeBlock(block);
+
+        return true;
+    }
+
+    void TLSFAllocator::MappingInsert(Uint64 size, Uint32& outFL, Uint32& outSL)
+    {
+        if (size < SMALL_BLOCK_SIZE)
+        {
+            // Linear size classes in the small blocks
+            outFL = 0;
+            outSL = static_cast<Uint32>(size / (SMALL_BLOCK_SIZE / SL_INDEX_COUNT));
+        }
+        else
+        {
+            const Uint32 msb = static_cast<Uint32>(std::bit_width(size)) - 1;
+            outSL = static_cast<Uint32>((size >> (msb - SL_INDEX_COUNT_LOG2)) ^ SL_INDEX_COUNT);
+            outFL = msb - static_cast<Uint32>(FL_INDEX_SHIFT - 1);
+        }
+    }
+
+    void TLSFAllocator::MappingSearch(Uint64 size, Uint32& outFL, Uint32& outSL)
+    {
+        // Round up to the next list so any block in the found list fits.
+        if (size >= SMALL_BLOCK_SIZE)
+        {
+            const Uint32 msb = static_cast<Uint32>(std::bit_width(size)) - 1;
+            size += (1ull << (msb - SL_INDEX_COUNT_LOG2)) - 1;
+        }
+        MappingInsert(size, outFL, outSL);
+    }
+
+    TLSFAllocator::BlockHeader* TLSFAllocator::FindFreeBlock(Uint64 size)
+    {
+        Uint32 fl, sl;
+        MappingSearch(size, fl, sl);
+        if (fl >= FL_INDEX_COUNT)
+        {
+            return nullptr;
+        }
+
+        Uint32 slMap = mSLBitmaps[fl] & (~0u << sl);
+        if (slMap == 0)
+        {
+            // Find in the larger first-levels.
+            const Uint32 flMap = (fl + 1 < FL_INDEX_COUNT) ? mFLBitmap & (~0u << (fl + 1)) : 0;
+            if (flMap == 0)
+            {
+                return nullptr;
+            }
+
+            fl = std::countr_zero(flMap);
+            slMap = mSLBitmaps[fl];
+        }
+        sl = std::countr_zero(slMap);
+
+        return mFreeLists[fl][sl];
+    }
+
+    void TLSFAllocator::InsertFreeBlock(BlockHeader* block)
+    {
+        Uint32 fl, sl;
+        MappingInsert(block->GetSize(), fl, sl);
+
+        BlockHeader* head = mFreeLists[fl][sl];
+        block->nextFree = head;
+        block->prevFree = nullptr;
+        if (head)
+        {
+            head->prevFree = block;
+        }
+        mFreeLists[fl][sl] = block;
+
+        mFLBitmap |= 1u << fl;
+        mSLBitmaps[fl] |= 1u << sl;
+    }
+
+    void TLSFAllocator::RemoveFreeBlock(BlockHeader* block)
+    {
+        Uint32 fl, sl;
+        MappingInsert(block->GetSize(), fl, sl);
+
+        if (block->prevFree)
+        {
+            block->prevFree->nextFree = block->nextFree;
+        }
+        else
+        {
+            mFreeLists[fl][sl] = block->nextFree;
+        }
+        if (block->nextFree)
+        {
+            block->nextFree->prevFree = block->prevFree;
+        }
+
+        if (mFreeLists[fl][sl] == nullptr)
+        {
+            mSLBitmaps[fl] &= ~(1u << sl);
+            if (mSLBitmaps[fl] == 0)
+            {
+                mFLBitmap &= ~(1u << fl);
+            }
+        }
+    }
+
+    TLSFAllocator::BlockHeader* TLSFAllocator::SplitBlock(BlockHeader* block, Uint64 size)
+    {
+        BlockHeader* remaining = (BlockHeader*)(block->GetPayload() + size);
+        remaining->prevPhysBlock = block;
+        remaining->sizeAndFlags = (block->GetSize() - size - BLOCK_HEADER_OVERHEAD) | BlockHeader::FREE_FLAG;
+        remaining->GetNextPhysBlock()->prevPhysBlock = remaining;
+
+        block->SetSize(size);
+
+        return remaining;
+    }
+
+    void TLSFAllocator::MergeBlock(BlockHeader* block, BlockHeader* next)
+    {
+        block->SetSize(block->GetSize() + BLOCK_HEADER_OVERHEAD + next->GetSize());
+        block->GetNextPhysBlock()->prevPhysBlock = block;
+    }
+} // namespace cube
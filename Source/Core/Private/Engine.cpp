@@ -5,9 +5,13 @@
 #include "implot.h"
 
 #include "Allocator/FrameAllocator.h"
+#include "Allocator/SharedFrameAllocator.h"
+#include "Allocator/TLSFAllocator.h"
 #include "Checker.h"
 #include "FileSystem.h"
+#include "JobSystem.h"
 #include "Logger.h"
+#include "MemoryTracker.h"
 #include "Platform.h"
 #include "PlatformDebug.h"
 #include "Renderer/Renderer.h"
@@ -77,6 +81,7 @@ namespace cube
     EventFunction<void(Uint32, Uint32)> Engine::mOnResizeEventFunc;
 
     UniquePtr<Renderer> Engine::mRenderer;
+    UniquePtr<JobSystem> Engine::mJobSystem;
     bool Engine::mDrawImGUI;
 
     ImGUIContext Engine::mImGUIContext;
@@ -119,6 +124,8 @@ namespace cube
         }
 
         GetMyThreadFrameAllocator().Initialize("Main thread frame allocator", 100u * 1024 * 1024); // 100 MiB
+        GetSharedFrameAllocator().Initialize("Shared frame allocator", 16u * 1024 * 1024); // 16 MiB
+        GetAssetHeapAllocator().Initialize("Asset heap allocator", 256u * 1024 * 1024, true); // 256 MiB
 
         Logger::Init(&frameAllocatorAdapter);
         Logger::SetFilePathSeparator(platform::FileSystem::GetSeparator());
@@ -132,6 +139,36 @@ namespace cube
 
         CUBE_LOG(Info, Engine, "Initialize CubeEngine.");
 
+        mJobSystem = std::make_unique<JobSystem>();
+        mJobSystem->Initialize({
+            .onWorkerThreadBegin = [](Uint32) {
+                GetMyThreadFrameAllocator().Initialize("Job worker thread frame allocator", 1 * 1024 * 1024); // 1 MiB
+            },
+            .onWorkerThreadEnd = [](Uint32) {
+                GetMyThreadFrameAllocator().Shutdown();
+            },
+            // The frame allocations in a job should not outlive the job.
+            .onJobFinished = []() {
+                GetMyThreadFrameAllocator().DiscardAllocations();
+            },
+            // Each fiber has its own frame allocator because a parked fiber can be resumed in another thread.
+            .useFibers = true,
+            // The model loader jobs (tinygltf, image decoding) need deep stacks. Only the used pages of a fiber stack are committed.
+            .fiberStackSize = 2 * 1024 * 1024, // 2 MiB
+            .createFiberLocalData = []() -> void* {
+                FrameAllocator* allocator = new FrameAllocator();
+                allocator->Initialize("Job fiber frame allocator", 256 * 1024); // 256 KiB
+                return allocator;
+            },
+            .destroyFiberLocalData = [](void* data) {
+                delete static_cast<FrameAllocator*>(data);
+            },
+            .onFiberSwitched = [](void* data) {
+                SetCurrentFiberFrameAllocator(static_cast<FrameAllocator*>(data));
+            }
+        });
+        CUBE_LOG(Info, Engine, "Job system: {0} worker threads. (Fibers: {1})", mJobSystem->GetNumWorkerThreads(), mJobSystem->IsUsingFibers());
+
         if (!mCommandLineArgs.empty())
         {
             FrameAnsiString params;
@@ -223,11 +260,23 @@ namespace cube
         platform::Platform::GetClosingEvent().RemoveListener(mOnClosingEventFunc);
         platform::Platform::GetLoopEvent().RemoveListener(mOnLoopEventFunc);
 
+        mJobSystem->Shutdown();
+        mJobSystem = nullptr;
+
+        CUBE_LOG(Info, Memory, "{0}", MemoryTracker::GetReport());
+
+        GetAssetHeapAllocator().Shutdown();
+        GetSharedFrameAllocator().Shutdown();
         GetMyThreadFrameAllocator().Shutdown();
 
         platform::Platform::Shutdown();
     }
 
+    JobSystem& Engine::GetJobSystem()
+    {
+        return *mJobSystem;
+    }
+
     void Engine::SetScene(SharedPtr<Scene> scene)
     {
         mRenderer->SetScene(scene);
@@ -236,6 +285,8 @@ namespace cube
     void Engine::OnLoop()
     {
         GetMyThreadFrameAllocator().DiscardAllocations();
+        // The jobs which allocate in it are waited in the frame, so no other thread uses it here.
+        GetSharedFrameAllocator().DiscardAllocations();
 
         mLastTime = mCurrentTime;
         mCurrentTime = GetNow();
@@ -244,13 +295,15 @@ namespace cube
 
         CameraSystem::OnLoop(deltaTimeSec);
         StatsSystem::OnLoop(deltaTimeSec);
+        ModelLoaderSystem::OnLoop(deltaTimeSec);
 
         LoopImGUI();
 
         mRenderer->RenderAndPresent();
 
         mLoopCount++;
-        if (platform::Debug::IsTestMode() && mLoopCount >= 20)
+        // Keep running until the model requested in the command line is loaded.
+        if (platform::Debug::IsTestMode() && mLoopCount >= 20 && !ModelLoaderSystem::IsLoading())
         {
             CUBE_LOG(Info, Engine, "Test mode: Auto-closing after {0} rendering loops.", mLoopCount);
             platform::Platform::TriggerClose();
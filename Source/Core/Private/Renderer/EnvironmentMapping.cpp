@@ -147,6 +147,10 @@ namespace cube
             mGeneratePrefilterMapPipelineInfo = {
                 .shader = mGeneratePrefilterMapShader
             };
+            for (Uint32 mipLevel = 0; mipLevel < NUM_PREFILTER_MAP_MIP_LEVELS; ++mipLevel)
+            {
+                mGeneratePrefilterMapPassNames[mipLevel] = Name(Format<FrameString>(CUBE_T("GeneratePrefilterMap [{0}]"), mipLevel));
+            }
 
             mPrefilterMapSampler = mRenderer.GetSamplerManager().GetSampler({
                 .minFilter = gapi::SamplerFilterType::Linear,
@@ -356,7 +360,7 @@ namespace cube
             .debugName = CUBE_T("SkyboxPipeline")
         });
 
-        builder.AddPass(CUBE_T("Skybox"), skyboxPipeline, skyboxParams,
+        builder.AddPass(CUBE_NAME("Skybox"), skyboxPipeline, skyboxParams,
         [](gapi::CommandList& commandList)
         {
             // 6 faces * 2 triangles * 3 vertices.
@@ -534,13 +538,13 @@ namespace cube
                 .debugName = CUBE_T("GenerateIrradianceMap Pipeline")
             });
 
-            builder.AddPass(CUBE_T("GenerateIrradianceMap"),
+            builder.AddPass(CUBE_NAME("GenerateIrradianceMap"),
                 generateIrradianceMapPipeline,
                 params,
                 [width, height](gapi::CommandList& commandList)
             {
                 commandList.DispatchThreads(width, height, 6);
-            });
+            }, false, true);
         }
         builder.ExecuteAndSubmit(*mCommandList, true);
     }
@@ -576,13 +580,13 @@ namespace cube
                 .pipelineInfo = mGenerateIntegratedBRDFLUTPipelineInfo,
                 .debugName = CUBE_T("GenerateIntegratedBRDFLUT Pipeline")
             });
-            builder.AddPass(CUBE_T("Generate IntegratedBRDFLUT"),
+            builder.AddPass(CUBE_NAME("Generate IntegratedBRDFLUT"),
                 generateIntegratedBRDFLUTPipeline,
                 params,
                 [width](gapi::CommandList& commandList)
             {
                 commandList.DispatchThreads(width, width, 1);
-            });
+            }, false, true);
         }
         builder.ExecuteAndSubmit(*mCommandList, true);
     }
@@ -595,7 +599,7 @@ namespace cube
 
         const gapi::ElementFormat format = gapi::ElementFormat::RGBA16_Float;
         const Uint32 width = 256;
-        const Uint32 mipLevels = 5;
+        const Uint32 mipLevels = NUM_PREFILTER_MAP_MIP_LEVELS;
 
         mPrefilterMap = mRenderer.GetGAPI().CreateTexture({
             .usage = gapi::ResourceUsage::GPUOnly,
@@ -635,13 +639,14 @@ namespace cube
                 params->Get()->srcIBL = srcIBLSRV;
                 params->Get()->dstPrefilterMap = dstPrefilterMapUAV;
 
-                builder.AddPass(Format<FrameString>(CUBE_T("GeneratePrefilterMap [{0}]"), mipLevel),
+                builder.AddPass(mGeneratePrefilterMapPassNames[mipLevel],
                     generatePrefilterMapPipeline,
                     params,
                     [mipWidth](gapi::CommandList& commandList)
                     {
                         commandList.DispatchThreads(mipWidth, mipWidth, 6);
-                    }
+                    },
+                    false, true
                 );
             }
         }
@@ -2,6 +2,7 @@
 
 #include "CoreHeader.h"
 
+#include "Name.h"
 #include "Renderer/RenderGraphTypes.h"
 #include "Pipeline.h"
 
@@ -100,6 +101,9 @@ namespace cube
         ComputePipelineInfo mGenerateIntegratedBRDFLUTPipelineInfo;
         SharedPtr<Shader> mGeneratePrefilterMapShader;
         ComputePipelineInfo mGeneratePrefilterMapPipelineInfo;
+        static constexpr Uint32 NUM_PREFILTER_MAP_MIP_LEVELS = 5;
+        // Names of the passes for each mip, interned in Initialize().
+        Array<Name, NUM_PREFILTER_MAP_MIP_LEVELS> mGeneratePrefilterMapPassNames;
         SharedPtr<gapi::CommandList> mCommandList;
 
         SharedPtr<gapi::Texture> mDiffuseIrradianceMap;
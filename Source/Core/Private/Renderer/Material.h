@@ -2,6 +2,7 @@
 
 #include "CoreHeader.h"
 
+#include "FlatHashMap.h"
 #include "GAPI_Pipeline.h"
 #include "Renderer/RenderGraphTypes.h"
 #include "Renderer/RenderTypes.h"
@@ -134,6 +135,6 @@ namespace cube
         PipelineManager& mPipelineManager;
 
         HashMap<Uint64, SharedPtr<Shader>> mMaterialVertexShaders;
-        HashMap<Uint64, SharedPtr<Shader>> mMaterialPixelShaders;
+        FlatHashMap<Uint64, SharedPtr<Shader>> mMaterialPixelShaders;
     };
 } // namespace cube
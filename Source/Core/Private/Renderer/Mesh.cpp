@@ -2,6 +2,7 @@
 
 
 #include "Allocator/FrameAllocator.h"
+#include "Allocator/TLSFAllocator.h"
 #include "Engine.h"
 #include "GAPI_Buffer.h"
 #include "Platform.h"
@@ -16,11 +17,39 @@ namespace cube
     {
         Uint64 dataSize = sizeof(Vertex) * mNumVertices + sizeof(Index) * mNumIndices;
         mIndexOffset = sizeof(Vertex) * mNumVertices;
-        mData = Blob(dataSize);
+        mData = Blob(dataSize, &GetAssetHeapAllocator(), MemoryTag::Mesh);
         memcpy(mData.GetData(), vertices.data(), sizeof(Vertex) * mNumVertices);
         memcpy((Byte*)mData.GetData() + mIndexOffset, indices.data(), sizeof(Index) * mNumIndices);
 
         mSubMeshes = Vector<SubMesh>(subMeshes.begin(), subMeshes.end());
+
+        // Bounds. The sphere is centered at the box and encloses the vertices referenced by the sub mesh.
+        for (const Vertex& vertex : vertices)
+        {
+            mBounds.Merge(vertex.position.GetFloat3());
+        }
+        for (SubMesh& subMesh : mSubMeshes)
+        {
+            const ArrayView<Index> subMeshIndices = indices.subspan(subMesh.indexOffset, subMesh.numIndices);
+
+            subMesh.bounds = {};
+            for (Index index : subMeshIndices)
+            {
+                subMesh.bounds.Merge(vertices[subMesh.vertexOffset + index].position.GetFloat3());
+            }
+
+            const Float3 center = subMesh.bounds.GetCenter();
+            float maxSquareDistance = 0.0f;
+            for (Index index : subMeshIndices)
+            {
+                const Float3 d = vertices[subMesh.vertexOffset + index].position.GetFloat3() - center;
+                maxSquareDistance = std::max(maxSquareDistance, d.x * d.x + d.y * d.y + d.z * d.z);
+            }
+            subMesh.boundingSphere = {
+                .center = center,
+                .radius = std::sqrt(maxSquareDistance)
+            };
+        }
     }
 
     MeshData::~MeshData()
@@ -96,6 +125,11 @@ namespace cube
             memcpy(pIndexBufferData, indexData.GetData(), indexData.GetSize());
             mIndexBuffer->Unmap();
         }
+
+        for (const SubMesh& subMesh : meshData->GetSubMeshes())
+        {
+            mSubMeshPassNames.push_back(Name(Format<FrameString>(CUBE_T("Mesh: {0}[{1}]"), meshData->GetDebugName(), subMesh.debugName)));
+        }
     }
 
     Mesh::~Mesh()
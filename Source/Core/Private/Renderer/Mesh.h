@@ -3,6 +3,8 @@
 #include "CoreHeader.h"
 
 #include "Blob.h"
+#include "BoundingVolume.h"
+#include "Name.h"
 #include "Renderer/RenderTypes.h"
 #include "Vector.h"
 
@@ -21,6 +23,10 @@ namespace cube
         int materialIndex;
 
         String debugName;
+
+        // Local space. Calculated in MeshData.
+        AABB bounds;
+        Sphere boundingSphere;
     };
 
     struct MeshMetadata
@@ -45,6 +51,8 @@ namespace cube
         BlobView GetData() const { return mData; }
 
         const Vector<SubMesh>& GetSubMeshes() const { return mSubMeshes; }
+        // Local space bounds of all vertices.
+        const AABB& GetBounds() const { return mBounds; }
 
         StringView GetDebugName() const { return mDebugName; }
 
@@ -54,6 +62,7 @@ namespace cube
         Blob mData;
         Uint64 mIndexOffset;
         Vector<SubMesh> mSubMeshes;
+        AABB mBounds;
 
         String mDebugName;
     };
@@ -67,6 +76,9 @@ namespace cube
         SharedPtr<gapi::Buffer> GetVertexBuffer() const { return mVertexBuffer; }
         SharedPtr<gapi::Buffer> GetIndexBuffer() const { return mIndexBuffer; }
         const Vector<SubMesh>& GetSubMeshes() const { return mMeshData->GetSubMeshes(); }
+        const AABB& GetBounds() const { return mMeshData->GetBounds(); }
+        // Name of the pass which draws the sub mesh. It is interned once, so the passes do not build it every frame.
+        Name GetSubMeshPassName(int subMeshIndex) const { return mSubMeshPassNames[subMeshIndex]; }
 
         const StringView GetDebugName() const { return mMeshData->GetDebugName(); }
         const MeshMetadata& GetMeta() const { return mMeta; }
@@ -76,6 +88,7 @@ namespace cube
 
         SharedPtr<MeshData> mMeshData;
         MeshMetadata mMeta;
+        Vector<Name> mSubMeshPassNames;
 
         SharedPtr<gapi::Buffer> mVertexBuffer;
         SharedPtr<gapi::Buffer> mIndexBuffer;
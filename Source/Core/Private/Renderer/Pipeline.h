@@ -2,6 +2,7 @@
 
 #include "CoreHeader.h"
 
+#include "FlatHashMap.h"
 #include "GAPI_Pipeline.h"
 #include "GAPI_ShaderReflection.h"
 #include "Shader.h"
@@ -125,7 +126,7 @@ namespace cube
     private:
         Renderer& mRenderer;
 
-        HashMap<Uint64, SharedPtr<GraphicsPipeline>> mCachedGraphicsPipelines;
-        HashMap<Uint64, SharedPtr<ComputePipeline>> mCachedComputePipelines;
+        FlatHashMap<Uint64, SharedPtr<GraphicsPipeline>> mCachedGraphicsPipelines;
+        FlatHashMap<Uint64, SharedPtr<ComputePipeline>> mCachedComputePipelines;
     };
 } // namespace cube
@@ -1,8 +1,12 @@
 #include "Renderer/RenderGraph.h"
 
+#include <chrono>
+
+#include "Allocator/AllocatorUtility.h"
 #include "Allocator/FrameAllocator.h"
 #include "Checker.h"
 #include "GAPI_CommandList.h"
+#include "JobSystem.h"
 #include "Pipeline.h"
 #include "Texture.h"
 #include "Renderer/RenderGraphTypes.h"
@@ -12,8 +16,45 @@ namespace cube
 {
     // ===== Resources =====
 
-    RGResource::RGResource(Int32 index, StringView debugName)
-        : mIsTransient(false)
+    namespace
+    {
+        RGResourceKind GetBufferViewKind(RGViewType type)
+        {
+            switch (type)
+            {
+            case RGViewType::SRV:
+                return RGResourceKind::BufferSRV;
+            case RGViewType::UAV:
+                return RGResourceKind::BufferUAV;
+            default:
+                NO_ENTRY_FORMAT("Invalid buffer view type.");
+                return RGResourceKind::BufferSRV;
+            }
+        }
+
+        RGResourceKind GetTextureViewKind(RGViewType type)
+        {
+            switch (type)
+            {
+            case RGViewType::SRV:
+                return RGResourceKind::TextureSRV;
+            case RGViewType::UAV:
+                return RGResourceKind::TextureUAV;
+            case RGViewType::RTV:
+                return RGResourceKind::TextureRTV;
+            case RGViewType::DSV:
+                return RGResourceKind::TextureDSV;
+            default:
+                NO_ENTRY_FORMAT("Invalid texture view type.");
+                return RGResourceKind::TextureSRV;
+            }
+        }
+    } // namespace
+
+    RGResource::RGResource(Int32 index, RGResourceKind kind, StringView debugName)
+        : mKind(kind)
+        , mIsTransient(false)
+        , mIsOutput(false)
         , mIndex(index)
         , mBeginPass(-1)
         , mEndPass(-1)
@@ -28,13 +69,14 @@ namespace cube
             mBuffer = gapi.CreateBuffer({
                 .usage = gapi::ResourceUsage::Transient,
                 .bufferInfo = mBufferInfo,
-                .debugName = mDebugName
+                .debugName = mDebugName,
+                .placedMemory = mPlacedMemory
             });
         }
     }
 
     RGBuffer::RGBuffer(int index, const gapi::BufferInfo& bufferInfo, StringView debugName)
-        : RGResource(index, debugName)
+        : RGResource(index, RGResourceKind::Buffer, debugName)
         , mBuffer(nullptr)
         , mBufferInfo(bufferInfo)
     {
@@ -42,7 +84,7 @@ namespace cube
     }
 
     RGBuffer::RGBuffer(int index, SharedPtr<gapi::Buffer> buffer)
-        : RGResource(index, buffer->GetDebugName())
+        : RGResource(index, RGResourceKind::Buffer, buffer->GetDebugName())
         , mBuffer(buffer)
     {
         mIsTransient = buffer->GetUsage() == gapi::ResourceUsage::Transient;
@@ -58,7 +100,7 @@ namespace cube
     }
 
     RGBufferView::RGBufferView(int index, RGBufferHandle rgBuffer, RGViewType type, gapi::ElementFormat format, Uint64 firstElement, Uint64 numElements)
-        : RGResource(index, rgBuffer->GetDebugName())
+        : RGResource(index, GetBufferViewKind(type), rgBuffer->GetDebugName())
         , mRGBuffer(rgBuffer)
         , mType(type)
         , mFormat(format)
@@ -114,7 +156,8 @@ namespace cube
             mTexture = gapi.CreateTexture({
                 .usage = gapi::ResourceUsage::Transient,
                 .textureInfo = mTextureInfo,
-                .debugName = mDebugName
+                .debugName = mDebugName,
+                .placedMemory = mPlacedMemory
             });
         }
     }
@@ -131,7 +174,7 @@ namespace cube
     }
 
     RGTexture::RGTexture(int index, const gapi::TextureInfo& textureInfo, StringView debugName)
-        : RGResource(index, debugName)
+        : RGResource(index, RGResourceKind::Texture, debugName)
         , mTexture(nullptr)
         , mTextureInfo(textureInfo)
     {
@@ -139,7 +182,7 @@ namespace cube
     }
 
     RGTexture::RGTexture(int index, SharedPtr<gapi::Texture> texture)
-        : RGResource(index, texture->GetDebugName())
+        : RGResource(index, RGResourceKind::Texture, texture->GetDebugName())
         , mTexture(texture)
         , mTextureInfo(texture->GetInfo())
     {
@@ -148,7 +191,7 @@ namespace cube
     }
 
     RGTextureView::RGTextureView(int index, RGTextureHandle rgTexture, RGViewType type, const gapi::SubresourceRangeInput& subresourceRange)
-        : RGResource(index, rgTexture->GetDebugName())
+        : RGResource(index, GetTextureViewKind(type), rgTexture->GetDebugName())
         , mRGTexture(rgTexture)
         , mType(type)
         , mSubresourceRange(subresourceRange.Clamp(rgTexture->GetTextureInfo()))
@@ -241,16 +284,588 @@ namespace cube
     }
 
     RGShaderParameterListBase::RGShaderParameterListBase(int index, const ShaderParameterListInfo& parameterListInfo, SharedPtr<ShaderParameterList> parameterList)
-        : RGResource(index, parameterListInfo.name)
+        : RGResource(index, RGResourceKind::ShaderParameterList, parameterListInfo.name.ToString())
         , mParameterListInfo(parameterListInfo)
         , mParameterList(std::move(parameterList))
     {
     }
 
+    // ===== State cache =====
+
+    gapi::ResourceStateFlags RGTextureStateCache::ConsumeState(const SharedPtr<gapi::Texture>& texture)
+    {
+        auto findIt = mStates.find(texture.get());
+        if (findIt == mStates.end())
+        {
+            return gapi::ResourceStateFlag::Common;
+        }
+
+        // The address can be reused by a new texture after the stored one was destroyed.
+        const bool isSameTexture = (findIt->second.texture.lock() == texture);
+        const gapi::ResourceStateFlags state = findIt->second.state;
+        // Keep the entry as expired instead of erasing it, so storing the state again does not allocate.
+        // The expired entries are removed in RemoveExpiredStates().
+        findIt->second = {};
+
+        return isSameTexture ? state : gapi::ResourceStateFlags(gapi::ResourceStateFlag::Common);
+    }
+
+    gapi::ResourceStateFlags RGTextureStateCache::GetState(const SharedPtr<gapi::Texture>& texture) const
+    {
+        auto findIt = mStates.find(texture.get());
+        if (findIt == mStates.end() || findIt->second.texture.lock() != texture)
+        {
+            return gapi::ResourceStateFlag::Common;
+        }
+        return findIt->second.state;
+    }
+
+    void RGTextureStateCache::StoreState(const SharedPtr<gapi::Texture>& texture, gapi::ResourceStateFlags state)
+    {
+        mStates[texture.get()] = { texture, state };
+    }
+
+    void RGTextureStateCache::RemoveExpiredStates()
+    {
+        std::erase_if(mStates, [](const auto& pair) { return pair.second.texture.expired(); });
+    }
+
+    // ===== Async compute =====
+
+    template <template <typename> typename VectorType>
+    static void ScheduleAsyncComputeInternal(ConstArrayView<RGAsyncComputePassInfo> passes, TRGAsyncComputePlan<VectorType>& outPlan)
+    {
+        const int numPasses = static_cast<int>(passes.size());
+        outPlan.isAsyncCompute.assign(numPasses, false);
+        outPlan.syncPoints.clear();
+
+        auto IsGraphicsPass = [&passes, &outPlan](int passIndex)
+        {
+            return !passes[passIndex].isCulled && !outPlan.isAsyncCompute[passIndex];
+        };
+        auto IsSharingResource = [&passes](int passIndexA, int passIndexB)
+        {
+            for (int resource : passes[passIndexA].resources)
+            {
+                if (std::find(passes[passIndexB].resources.begin(), passes[passIndexB].resources.end(), resource) != passes[passIndexB].resources.end())
+                {
+                    return true;
+                }
+            }
+            return false;
+        };
+
+        // Pick the async compute passes and the last graphics pass before each of them.
+        FrameVector<int> signalGraphicsPasses(numPasses, -1);
+        int lastGraphicsPass = -1;
+        for (int i = 0; i < numPasses; ++i)
+        {
+            if (passes[i].isCulled)
+            {
+                continue;
+            }
+
+            if (passes[i].requestsAsyncCompute && lastGraphicsPass != -1)
+            {
+                outPlan.isAsyncCompute[i] = true;
+                signalGraphicsPasses[i] = lastGraphicsPass;
+            }
+            else
+            {
+                lastGraphicsPass = i;
+            }
+        }
+
+        // The last async compute pass which the graphics queue should wait for before each pass. (Index numPasses: end of the graph)
+        FrameVector<int> waitAsyncComputePasses(numPasses + 1, -1);
+        for (int i = 0; i < numPasses; ++i)
+        {
+            if (!outPlan.isAsyncCompute[i])
+            {
+                continue;
+            }
+
+            int waitPass = numPasses;
+            for (int j = i + 1; j < numPasses; ++j)
+            {
+                if (IsGraphicsPass(j) && IsSharingResource(i, j))
+                {
+                    waitPass = j;
+                    break;
+                }
+            }
+            while (waitPass < numPasses && !passes[waitPass].canBeginSegment)
+            {
+                int prevPass = waitPass - 1;
+                while (prevPass > i && !IsGraphicsPass(prevPass))
+                {
+                    prevPass--;
+                }
+                if (prevPass <= i)
+                {
+                    NO_ENTRY_FORMAT("Cannot find the graphics pass which waits for the async compute pass {0}.", i);
+                    break;
+                }
+                waitPass = prevPass;
+            }
+            waitAsyncComputePasses[waitPass] = std::max(waitAsyncComputePasses[waitPass], i);
+        }
+
+        // Each queue executes in order, so a wait covers all previous passes in the other queue.
+        int lastWaitedGraphicsPass = -1;
+        int lastWaitedAsyncComputePass = -1;
+        for (int i = 0; i <= numPasses; ++i)
+        {
+            if (i < numPasses && outPlan.isAsyncCompute[i] && signalGraphicsPasses[i] > lastWaitedGraphicsPass)
+            {
+                outPlan.syncPoints.push_back({
+                    .waitingQueue = gapi::CommandListType::Compute,
+                    .signalPass = signalGraphicsPasses[i],
+                    .waitPass = i
+                });
+                lastWaitedGraphicsPass = signalGraphicsPasses[i];
+            }
+            if (waitAsyncComputePasses[i] > lastWaitedAsyncComputePass)
+            {
+                outPlan.syncPoints.push_back({
+                    .waitingQueue = gapi::CommandListType::Graphics,
+                    .signalPass = waitAsyncComputePasses[i],
+                    .waitPass = i
+                });
+                lastWaitedAsyncComputePass = waitAsyncComputePasses[i];
+            }
+        }
+    }
+
+    void ScheduleAsyncCompute(ConstArrayView<RGAsyncComputePassInfo> passes, RGAsyncComputePlan& outPlan)
+    {
+        ScheduleAsyncComputeInternal(passes, outPlan);
+    }
+
+    void ScheduleAsyncCompute(ConstArrayView<RGAsyncComputePassInfo> passes, RGFrameAsyncComputePlan& outPlan)
+    {
+        ScheduleAsyncComputeInternal(passes, outPlan);
+    }
+
+    // ===== Mesh draw grouping =====
+
+    void GroupDrawMeshes(ConstArrayView<RGDrawMeshGroupingInfo> draws, FrameVector<RGDrawMeshGroup>& outGroups, FrameVector<Uint32>& outInstanceIndices)
+    {
+        // The hash is only for the bucketing. The keys are compared field by field.
+        struct DrawKeyHash
+        {
+            Uint64 operator()(const RGDrawMeshGroupingInfo* key) const
+            {
+                Uint64 hash = HashCombine(
+                    reinterpret_cast<Uint64>(key->mesh),
+                    static_cast<Uint64>(key->rasterizerState.fillMode),
+                    static_cast<Uint64>(key->rasterizerState.cullMode),
+                    static_cast<Uint64>(key->rasterizerState.frontFace),
+                    static_cast<Uint64>(key->depthStencilState.enableDepth),
+                    static_cast<Uint64>(key->depthStencilState.depthFunction),
+                    static_cast<Uint64>(key->depthStencilState.enableStencil)
+                );
+                for (const Material* material : key->materials)
+                {
+                    hash = HashCombine(hash, reinterpret_cast<Uint64>(material));
+                }
+                return hash;
+            }
+        };
+        struct DrawKeyEqual
+        {
+            bool operator()(const RGDrawMeshGroupingInfo* lhs, const RGDrawMeshGroupingInfo* rhs) const
+            {
+                return lhs->mesh == rhs->mesh
+                    && lhs->rasterizerState == rhs->rasterizerState
+                    && lhs->depthStencilState == rhs->depthStencilState
+                    && std::equal(lhs->materials.begin(), lhs->materials.end(), rhs->materials.begin(), rhs->materials.end());
+            }
+        };
+
+        outGroups.clear();
+        outInstanceIndices.resize(draws.size());
+
+        // The keys are the first draws of the groups.
+        FrameVector<Uint32> drawGroupIndices(draws.size());
+        FlatHashMap<const RGDrawMeshGroupingInfo*, Uint32, DrawKeyHash, DrawKeyEqual, FrameAllocator::StdAllocator<std::pair<const RGDrawMeshGroupingInfo* const, Uint32>>> groupIndices;
+        for (Uint32 i = 0; i < draws.size(); ++i)
+        {
+            auto [it, isInserted] = groupIndices.try_emplace(&draws[i], static_cast<Uint32>(outGroups.size()));
+            if (isInserted)
+            {
+                outGroups.push_back({ .firstDrawIndex = i, .instanceOffset = 0, .numInstances = 0 });
+            }
+            drawGroupIndices[i] = it->second;
+            outGroups[it->second].numInstances++;
+        }
+
+        Uint32 numInstances = 0;
+        for (RGDrawMeshGroup& group : outGroups)
+        {
+            group.instanceOffset = numInstances;
+            numInstances += group.numInstances;
+            group.numInstances = 0;
+        }
+        for (Uint32 i = 0; i < draws.size(); ++i)
+        {
+            RGDrawMeshGroup& group = outGroups[drawGroupIndices[i]];
+            outInstanceIndices[i] = group.instanceOffset + group.numInstances;
+            group.numInstances++;
+        }
+    }
+
+    // ===== Command list pool =====
+
+    void RGCommandListPool::Initialize(GAPI& gapi)
+    {
+        mGAPI = &gapi;
+    }
+
+    void RGCommandListPool::Shutdown()
+    {
+        for (TypePool& pool : mTypePools)
+        {
+            pool.commandLists.clear();
+            pool.numAcquired = 0;
+        }
+        mGAPI = nullptr;
+    }
+
+    gapi::CommandList& RGCommandListPool::Acquire(gapi::CommandListType type)
+    {
+        CHECK(mGAPI);
+
+        TypePool& pool = mTypePools[static_cast<int>(type)];
+        if (pool.numAcquired == pool.commandLists.size())
+        {
+            const Character* typeName = (type == gapi::CommandListType::Compute) ? CUBE_T("Compute") : CUBE_T("Graphics");
+            pool.commandLists.push_back(mGAPI->CreateCommandList({
+                .type = type,
+                .debugName = Format<String>(CUBE_T("RG{0}CommandList[{1}]"), typeName, pool.commandLists.size())
+            }));
+        }
+
+        return *pool.commandLists[pool.numAcquired++];
+    }
+
+    void RGCommandListPool::ReleaseAll()
+    {
+        for (TypePool& pool : mTypePools)
+        {
+            pool.numAcquired = 0;
+        }
+    }
+
+    // ===== Compile cache =====
+
+    void RGCompileCache::Clear()
+    {
+        mIsValid = false;
+        mStructuralHash = 0;
+
+        mPasses.clear();
+        mResourceLifetimes.clear();
+        mAsyncComputePlan = {};
+        mTransientAllocations.clear();
+        mTransientMemorySize = 0;
+        mTransientMemoryAlignment = 1;
+        mSegments.clear();
+        mTransitions.clear();
+        mConsumedTextureStates.clear();
+        mStoredTextureStates.clear();
+        mStats = {};
+    }
+
+    // ===== Transient memory =====
+
+    Uint64 PlaceTransientAllocations(ArrayView<RGTransientAllocation> allocations)
+    {
+        // Place larger resources first to reduce fragmentation.
+        std::sort(allocations.begin(), allocations.end(), [](const RGTransientAllocation& lhs, const RGTransientAllocation& rhs)
+        {
+            if (lhs.size != rhs.size)
+            {
+                return lhs.size > rhs.size;
+            }
+            if (lhs.beginPass != rhs.beginPass)
+            {
+                return lhs.beginPass < rhs.beginPass;
+            }
+            return lhs.rgResourceIndex < rhs.rgResourceIndex;
+        });
+
+        auto IsLifetimeOverlap = [](const RGTransientAllocation& lhs, const RGTransientAllocation& rhs)
+        {
+            return lhs.beginPass <= rhs.endPass && rhs.beginPass <= lhs.endPass;
+        };
+        // The aliased resource is kept only if it is the only one which used the memory before.
+        auto AddAliasedResource = [](RGTransientAllocation& allocation, const RGTransientAllocation& aliased)
+        {
+            allocation.aliasedResourceIndex = allocation.needAliasingBarrier ? -1 : aliased.rgResourceIndex;
+            allocation.needAliasingBarrier = true;
+        };
+
+        // Placed allocations are kept sorted by the offset, so each placement scans them once without sorting them again.
+        FrameVector<RGTransientAllocation*> placedAllocations;
+        placedAllocations.reserve(allocations.size());
+        Uint64 totalSize = 0;
+        for (RGTransientAllocation& current : allocations)
+        {
+            current.needAliasingBarrier = false;
+            current.aliasedResourceIndex = -1;
+
+            // First-fit placement. A resource can share memory with the placed resources whose lifetimes do not overlap.
+            Uint64 offset = 0;
+            for (const RGTransientAllocation* placed : placedAllocations)
+            {
+                if (!IsLifetimeOverlap(current, *placed))
+                {
+                    continue;
+                }
+
+                offset = Align(offset, current.alignment);
+                if (offset + current.size <= placed->offset)
+                {
+                    break;
+                }
+                offset = std::max(offset, placed->offset + placed->size);
+            }
+            current.offset = Align(offset, current.alignment);
+            totalSize = std::max(totalSize, current.offset + current.size);
+
+            // The placed resources in the same memory are not alive with it, so one of them uses the memory first.
+            for (RGTransientAllocation* placed : placedAllocations)
+            {
+                if (placed->offset >= current.offset + current.size)
+                {
+                    break;
+                }
+                if (placed->offset + placed->size <= current.offset)
+                {
+                    continue;
+                }
+
+                if (placed->endPass < current.beginPass)
+                {
+                    AddAliasedResource(current, *placed);
+                }
+                else if (current.endPass < placed->beginPass)
+                {
+                    AddAliasedResource(*placed, current);
+                }
+            }
+
+            auto insertIt = std::upper_bound(placedAllocations.begin(), placedAllocations.end(), current.offset, [](Uint64 offset, const RGTransientAllocation* placed)
+            {
+                return offset < placed->offset;
+            });
+            placedAllocations.insert(insertIt, &current);
+        }
+
+        return totalSize;
+    }
+
     // ===== Builder =====
 
+    namespace
+    {
+        bool IsWriteState(gapi::ResourceStateFlags state)
+        {
+            const gapi::ResourceStateFlags writeStates = gapi::ResourceStateFlag::RenderTarget | gapi::ResourceStateFlag::UAV | gapi::ResourceStateFlag::DepthWrite
+                | gapi::ResourceStateFlag::CopyDst | gapi::ResourceStateFlag::ResolveDst;
+            return (state & writeStates) != gapi::ResourceStateFlag::Common;
+        }
+
+        struct SubresourceTransition
+        {
+            gapi::ResourceStateFlags src;
+            gapi::ResourceStateFlags dst;
+
+            bool operator==(const SubresourceTransition& rhs) const { return src == rhs.src && dst == rhs.dst; }
+        };
+
+        // Collapse the transitions of the subresources in the range into as few ranges as possible.
+        // Contiguous mips with the same transition in a slice are merged, and the following slices with the same mip runs are merged into them.
+        // addRange is called with each collapsed range whose src and dst are different.
+        template <typename GetTransitionFunction, typename AddRangeFunction>
+        void CollapseSubresourceTransitions(const gapi::Texture& texture, const gapi::SubresourceRange& range,
+            GetTransitionFunction&& getTransition, AddRangeFunction&& addRange)
+        {
+            struct Run
+            {
+                gapi::SubresourceRange range;
+                SubresourceTransition transition;
+            };
+            FrameVector<Run> openRuns; // Runs continued from the previous slices
+            FrameVector<Run> sliceRuns;
+            auto FlushOpenRuns = [&]()
+            {
+                for (const Run& run : openRuns)
+                {
+                    if (run.transition.src != run.transition.dst)
+                    {
+                        addRange(run.range, run.transition.src, run.transition.dst);
+                    }
+                }
+            };
+
+            for (Uint32 sliceIndex = range.firstSliceIndex; sliceIndex < range.firstSliceIndex + range.sliceSize; ++sliceIndex)
+            {
+                sliceRuns.clear();
+                for (Uint32 mipLevel = range.firstMipLevel; mipLevel < range.firstMipLevel + range.mipLevels; ++mipLevel)
+                {
+                    const SubresourceTransition transition = getTransition(texture.GetSubresourceIndex(sliceIndex, mipLevel));
+                    if (!sliceRuns.empty() && sliceRuns.back().transition == transition)
+                    {
+                        sliceRuns.back().range.mipLevels++;
+                    }
+                    else
+                    {
+                        sliceRuns.push_back({
+                            .range = { .firstMipLevel = mipLevel, .mipLevels = 1, .firstSliceIndex = sliceIndex, .sliceSize = 1 },
+                            .transition = transition
+                        });
+                    }
+                }
+
+                const bool isSameRuns = std::equal(openRuns.begin(), openRuns.end(), sliceRuns.begin(), sliceRuns.end(), [](const Run& lhs, const Run& rhs)
+                {
+                    return lhs.range.firstMipLevel == rhs.range.firstMipLevel && lhs.range.mipLevels == rhs.range.mipLevels && lhs.transition == rhs.transition;
+                });
+                if (isSameRuns)
+                {
+                    for (Run& run : openRuns)
+                    {
+                        run.range.sliceSize++;
+                    }
+                }
+                else
+                {
+                    FlushOpenRuns();
+                    std::swap(openRuns, sliceRuns);
+                }
+            }
+            FlushOpenRuns();
+        }
+
+        const char* RGResourceKindToString(RGResourceKind kind)
+        {
+            switch (kind)
+            {
+            case RGResourceKind::Buffer:
+                return "Buffer";
+            case RGResourceKind::BufferSRV:
+                return "BufferSRV";
+            case RGResourceKind::BufferUAV:
+                return "BufferUAV";
+            case RGResourceKind::Texture:
+                return "Texture";
+            case RGResourceKind::TextureSRV:
+                return "TextureSRV";
+            case RGResourceKind::TextureUAV:
+                return "TextureUAV";
+            case RGResourceKind::TextureRTV:
+                return "TextureRTV";
+            case RGResourceKind::TextureDSV:
+                return "TextureDSV";
+            case RGResourceKind::ShaderParameterList:
+                return "ShaderParameterList";
+            default:
+                return "Unknown";
+            }
+        }
+
+        FrameAnsiString ResourceStateFlagsToString(gapi::ResourceStateFlags state)
+        {
+            struct StateName
+            {
+                gapi::ResourceStateFlag flag;
+                const char* name;
+            };
+            static constexpr StateName stateNames[] = {
+                { gapi::ResourceStateFlag::Vertex, "Vertex" },
+                { gapi::ResourceStateFlag::Index, "Index" },
+                { gapi::ResourceStateFlag::RenderTarget, "RenderTarget" },
+                { gapi::ResourceStateFlag::SRV_Pixel, "SRV_Pixel" },
+                { gapi::ResourceStateFlag::SRV_NonPixel, "SRV_NonPixel" },
+                { gapi::ResourceStateFlag::UAV, "UAV" },
+                { gapi::ResourceStateFlag::DepthRead, "DepthRead" },
+                { gapi::ResourceStateFlag::DepthWrite, "DepthWrite" },
+                { gapi::ResourceStateFlag::IndirectArgs, "IndirectArgs" },
+                { gapi::ResourceStateFlag::CopySrc, "CopySrc" },
+                { gapi::ResourceStateFlag::CopyDst, "CopyDst" },
+                { gapi::ResourceStateFlag::ResolveSrc, "ResolveSrc" },
+                { gapi::ResourceStateFlag::ResolveDst, "ResolveDst" },
+                { gapi::ResourceStateFlag::Present, "Present" }
+            };
+
+            if (state == gapi::ResourceStateFlag::Common)
+            {
+                return "Common";
+            }
+
+            FrameAnsiString res;
+            for (const StateName& stateName : stateNames)
+            {
+                if (state.IsSet(stateName.flag))
+                {
+                    if (!res.empty())
+                    {
+                        res += '|';
+                    }
+                    res += stateName.name;
+                }
+            }
+            return res;
+        }
+
+        // Escape the characters which cannot be in the quoted string of JSON / DOT.
+        FrameAnsiString ToEscapedAnsiString(StringView str)
+        {
+            FrameAnsiString converted;
+            String_ConvertAndAppend(converted, str);
+
+            FrameAnsiString res;
+            res.reserve(converted.size());
+            for (char c : converted)
+            {
+                switch (c)
+                {
+                case '"':
+                    res += "\\\"";
+                    break;
+                case '\\':
+                    res += "\\\\";
+                    break;
+                case '\n':
+                    res += "\\n";
+                    break;
+                default:
+                    if (static_cast<unsigned char>(c) >= 0x20)
+                    {
+                        res += c;
+                    }
+                    break;
+                }
+            }
+            return res;
+        }
+    } // namespace
+
     RGBuilder::RGBuilder(Renderer& renderer)
-        : mRenderer(renderer)
+        : mRenderer(&renderer)
+        , mGAPI(renderer.GetGAPI())
+        , mTextureStateCache(renderer.GetRGTextureStateCache())
+        , mAllocator(GetMyThreadFrameAllocator())
+    {
+    }
+
+    RGBuilder::RGBuilder(GAPI& gapi, RGTextureStateCache& textureStateCache)
+        : mRenderer(nullptr)
+        , mGAPI(gapi)
+        , mTextureStateCache(textureStateCache)
+        , mAllocator(GetMyThreadFrameAllocator())
     {
     }
 
@@ -266,7 +881,7 @@ namespace cube
             return findIt->second;
         }
 
-        RGBufferHandle rgBuffer(new RGBuffer(mResources.size(), buffer));
+        RGBufferHandle rgBuffer(AllocateResource<RGBuffer>(buffer));
         mResources.push_back(rgBuffer);
 
         mRegisteredBuffers.insert({ buffer.get(), rgBuffer });
@@ -276,7 +891,7 @@ namespace cube
 
     RGBufferHandle RGBuilder::CreateBuffer(const gapi::BufferInfo& bufferInfo, StringView debugName)
     {
-        RGBufferHandle rgBuffer(new RGBuffer(mResources.size(), bufferInfo, debugName));
+        RGBufferHandle rgBuffer(AllocateResource<RGBuffer>(bufferInfo, debugName));
         mResources.push_back(rgBuffer);
 
         return rgBuffer;
@@ -290,7 +905,7 @@ namespace cube
             return findIt->second.Cast<RGBufferSRV>();
         }
 
-        RGBufferSRVHandle rgSRV(new RGBufferSRV(mResources.size(), rgBuffer, createInfo));
+        RGBufferSRVHandle rgSRV(AllocateResource<RGBufferSRV>(rgBuffer, createInfo));
         mResources.push_back(rgSRV);
         CHECK(cacheKey == rgSRV->GetViewHashKey());
         mCachedBufferViews.insert({ cacheKey, rgSRV });
@@ -306,7 +921,7 @@ namespace cube
             return findIt->second.Cast<RGBufferUAV>();
         }
 
-        RGBufferUAVHandle rgUAV(new RGBufferUAV(mResources.size(), rgBuffer, createInfo));
+        RGBufferUAVHandle rgUAV(AllocateResource<RGBufferUAV>(rgBuffer, createInfo));
         mResources.push_back(rgUAV);
         CHECK(cacheKey == rgUAV->GetViewHashKey());
         mCachedBufferViews.insert({ cacheKey, rgUAV });
@@ -323,7 +938,7 @@ namespace cube
             return findIt->second;
         }
 
-        RGTextureHandle rgTexture(new RGTexture(mResources.size(), texture));
+        RGTextureHandle rgTexture(AllocateResource<RGTexture>(texture));
         mResources.push_back(rgTexture);
 
         mRegisteredTextures.insert({ texture.get(), rgTexture });
@@ -333,7 +948,7 @@ namespace cube
 
     RGTextureHandle RGBuilder::CreateTexture(const gapi::TextureInfo& textureInfo, StringView debugName)
     {
-        RGTextureHandle rgTexture(new RGTexture(mResources.size(), textureInfo, debugName));
+        RGTextureHandle rgTexture(AllocateResource<RGTexture>(textureInfo, debugName));
         mResources.push_back(rgTexture);
 
         return rgTexture;
@@ -347,7 +962,7 @@ namespace cube
             return findIt->second.Cast<RGTextureSRV>();
         }
 
-        RGTextureSRVHandle rgSRV(new RGTextureSRV(mResources.size(), rgTexture, createInfo));
+        RGTextureSRVHandle rgSRV(AllocateResource<RGTextureSRV>(rgTexture, createInfo));
         mResources.push_back(rgSRV);
         CHECK(cacheKey == rgSRV->GetViewHashKey());
         mCachedTextureViews.insert({ cacheKey, rgSRV });
@@ -366,7 +981,7 @@ namespace cube
             return findIt->second.Cast<RGTextureUAV>();
         }
 
-        RGTextureUAVHandle rgUAV(new RGTextureUAV(mResources.size(), rgTexture, createInfo));
+        RGTextureUAVHandle rgUAV(AllocateResource<RGTextureUAV>(rgTexture, createInfo));
         mResources.push_back(rgUAV);
         CHECK(cacheKey == rgUAV->GetViewHashKey());
         mCachedTextureViews.insert({ cacheKey, rgUAV });
@@ -385,7 +1000,7 @@ namespace cube
             return findIt->second.Cast<RGTextureRTV>();
         }
 
-        RGTextureRTVHandle rgRTV(new RGTextureRTV(mResources.size(), rgTexture, createInfo));
+        RGTextureRTVHandle rgRTV(AllocateResource<RGTextureRTV>(rgTexture, createInfo));
         mResources.push_back(rgRTV);
         CHECK(cacheKey == rgRTV->GetViewHashKey());
         mCachedTextureViews.insert({ cacheKey, rgRTV });
@@ -404,7 +1019,7 @@ namespace cube
             return findIt->second.Cast<RGTextureDSV>();
         }
 
-        RGTextureDSVHandle rgDSV(new RGTextureDSV(mResources.size(), rgTexture, createInfo));
+        RGTextureDSVHandle rgDSV(AllocateResource<RGTextureDSV>(rgTexture, createInfo));
         mResources.push_back(rgDSV);
         CHECK(cacheKey == rgDSV->GetViewHashKey());
         mCachedTextureViews.insert({ cacheKey, rgDSV });
@@ -416,7 +1031,8 @@ namespace cube
     {
         if (!mDummyBlackTexture2D.IsValid())
         {
-            RGTextureHandle rgTexture = RegisterTexture(mRenderer.GetDummyBlackTexture2D());
+            CHECK_FORMAT(mRenderer, "Dummy textures need the renderer.");
+            RGTextureHandle rgTexture = RegisterTexture(mRenderer->GetDummyBlackTexture2D());
             mDummyBlackTexture2D = CreateSRV(rgTexture);
         }
 
@@ -427,7 +1043,8 @@ namespace cube
     {
         if (!mDummyBlackTextureCube.IsValid())
         {
-            RGTextureHandle rgTexture = RegisterTexture(mRenderer.GetDummyBlackTextureCube());
+            CHECK_FORMAT(mRenderer, "Dummy textures need the renderer.");
+            RGTextureHandle rgTexture = RegisterTexture(mRenderer->GetDummyBlackTextureCube());
             mDummyBlackTextureCube = CreateSRV(rgTexture);
         }
 
@@ -438,7 +1055,8 @@ namespace cube
     {
         if (!mDummyWhiteTexture2D.IsValid())
         {
-            RGTextureHandle rgTexture = RegisterTexture(mRenderer.GetDummyWhiteTexture2D());
+            CHECK_FORMAT(mRenderer, "Dummy textures need the renderer.");
+            RGTextureHandle rgTexture = RegisterTexture(mRenderer->GetDummyWhiteTexture2D());
             mDummyWhiteTexture2D = CreateSRV(rgTexture);
         }
 
@@ -465,31 +1083,11 @@ namespace cube
             mRenderPassDepthStencilFormat = gapi::ElementFormat::Unknown;
         }
 
-        AddPass(CUBE_T("##BeginRenderPass"), [info](gapi::CommandList& commandList)
+        // The render pass is begun in RecordPass() because it can be continued in multiple segments.
+        AddPassInternal(CUBE_NAME("##BeginRenderPass"), nullptr, nullptr, {}, nullptr,
+        [info](RGBuilder& builder)
         {
-            FrameVector<gapi::ColorAttachment> colors(info.colors.size());
-            for (int i = 0; i < colors.size(); ++i)
-            {
-                colors[i] = {
-                    .rtv = info.colors[i].color->GetRTV(),
-                    .loadOperation = info.colors[i].loadOperation,
-                    .storeOperation = info.colors[i].storeOperation,
-                    .clearColor = info.colors[i].clearColor
-                };
-            }
-
-            gapi::DepthStencilAttachment depthStencil = {
-                .dsv = info.depthStencil.dsv.IsValid() ? info.depthStencil.dsv->GetDSV() : nullptr,
-                .loadOperation = info.depthStencil.loadOperation,
-                .storeOperation = info.depthStencil.storeOperation,
-                .clearDepth = info.depthStencil.clearDepth
-            };
-
-            commandList.BeginRenderPass(colors, depthStencil);
-        },
-        [info](RGBuilder& builder)
-        {
-            for (const RenderPassInfo::ColorAttachment& color : info.colors)
+            for (const RenderPassInfo::ColorAttachment& color : info.colors)
             {
                 builder.UseResource(color.color);
             }
@@ -506,9 +1104,14 @@ namespace cube
             builder.mAttachedDSVInRenderPass = info.depthStencil.dsv;
             builder.mRenderPassIndex = builder.mCurrentPassIndex;
             builder.mIsInRenderPass = true;
-        });
+        },
+        false);
 
         mIsInRenderPass = true;
+        mCurrentRenderPassBeginIndex = mPasses.back().index;
+        mPasses.back().type = PassType::BeginRenderPass;
+        mPasses.back().renderPassBeginIndex = mCurrentRenderPassBeginIndex;
+        mRenderPassInfos[mCurrentRenderPassBeginIndex] = info;
     }
 
     void RGBuilder::EndRenderPass()
@@ -519,29 +1122,30 @@ namespace cube
         mRenderPassRenderTargetFormats.clear();
         mRenderPassDepthStencilFormat = gapi::ElementFormat::Unknown;
 
-        AddPass(CUBE_T("##EndRenderPass"), [](gapi::CommandList& commandList)
-        {
-            commandList.EndRenderPass();
-        },
+        AddPassInternal(CUBE_NAME("##EndRenderPass"), nullptr, nullptr, {}, nullptr,
         [](RGBuilder& builder)
         {
-            // Just mark use in RG resource to prevent duplicated transition.
+            // Just extend the lifetime of attached resources to prevent duplicated transition.
+            PassInfo& pass = builder.mPasses[builder.mCurrentPassIndex];
             for (const RGTextureRTVHandle attachedRTV : builder.mAttachedRTVsInRenderPass)
             {
-                attachedRTV->UpdateUsePassIndex(builder.mCurrentPassIndex);
+                pass.lifetimeOnlyResourceIndices.push_back(attachedRTV->mIndex);
             }
             if (builder.mAttachedDSVInRenderPass.IsValid())
             {
-                builder.mAttachedDSVInRenderPass->UpdateUsePassIndex(builder.mCurrentPassIndex);
+                pass.lifetimeOnlyResourceIndices.push_back(builder.mAttachedDSVInRenderPass->mIndex);
             }
 
             builder.mAttachedDSVInRenderPass = {};
             builder.mAttachedRTVsInRenderPass.clear();
             builder.mRenderPassIndex = -1;
             builder.mIsInRenderPass = false;
-        });
+        },
+        false);
+        mPasses.back().type = PassType::EndRenderPass;
 
         mIsInRenderPass = false;
+        mCurrentRenderPassBeginIndex = -1;
     }
 
     void RGBuilder::SetRenderTargetFormatsFromCurrentRenderPass(GraphicsPipelineInfo& inOutGraphicsPipelineInfo) const
@@ -570,10 +1174,87 @@ namespace cube
         inOutMaterialPipelineInfo.depthStencilFormat = mRenderPassDepthStencilFormat;
     }
 
-    void RGBuilder::AddDrawMeshPass(StringView name, ArrayView<DrawMeshInfo> drawMeshInfos, ConstArrayView<RGShaderParameterListBaseHandle> parameterLists)
+    void RGBuilder::AddRenderStatePass(Name name, PassFunction&& passFunction)
+    {
+        CHECK(mState == State::Init);
+
+        AddPassInternal(name, nullptr, nullptr, {}, std::move(passFunction), nullptr, false);
+        mPasses.back().type = PassType::RenderState;
+    }
+
+    void RGBuilder::AddDrawMeshPass(Name name, ArrayView<DrawMeshInfo> drawMeshInfos, ConstArrayView<RGShaderParameterListBaseHandle> parameterLists)
     {
         CHECK(mState == State::Init);
         CHECK(mIsInRenderPass);
+        CHECK_FORMAT(mRenderer, "Mesh draws need the renderer.");
+
+        if (drawMeshInfos.empty())
+        {
+            return;
+        }
+
+        // Resolve the material of each sub mesh. They are kept until the passes are added.
+        Uint64 numTotalSubMeshes = 0;
+        for (const DrawMeshInfo& drawMeshInfo : drawMeshInfos)
+        {
+            numTotalSubMeshes += drawMeshInfo.mesh->GetSubMeshes().size();
+        }
+        FrameVector<SharedPtr<Material>> drawMaterials;
+        drawMaterials.reserve(numTotalSubMeshes);
+        FrameVector<const Material*> drawMaterialPtrs;
+        drawMaterialPtrs.reserve(numTotalSubMeshes);
+        FrameVector<Uint32> drawMaterialsOffsets(drawMeshInfos.size());
+        FrameVector<RGDrawMeshGroupingInfo> groupingInfos(drawMeshInfos.size());
+        for (Uint64 i = 0; i < drawMeshInfos.size(); ++i)
+        {
+            const DrawMeshInfo& drawMeshInfo = drawMeshInfos[i];
+            const Vector<SubMesh>& subMeshes = drawMeshInfo.mesh->GetSubMeshes();
+
+            drawMaterialsOffsets[i] = static_cast<Uint32>(drawMaterials.size());
+            for (const SubMesh& subMesh : subMeshes)
+            {
+                SharedPtr<Material> material = nullptr;
+                if (0 <= subMesh.materialIndex && subMesh.materialIndex < drawMeshInfo.materials.size())
+                {
+                    material = drawMeshInfo.materials[subMesh.materialIndex].lock();
+                }
+                if (!material)
+                {
+                    material = mRenderer->GetDefaultMaterial();
+                }
+                drawMaterialPtrs.push_back(material.get());
+                drawMaterials.push_back(std::move(material));
+            }
+
+            groupingInfos[i] = {
+                .mesh = drawMeshInfo.mesh.get(),
+                .rasterizerState = drawMeshInfo.rasterizerState,
+                .depthStencilState = drawMeshInfo.depthStencilState,
+                .materials = ConstArrayView<const Material*>(drawMaterialPtrs.data() + drawMaterialsOffsets[i], subMeshes.size())
+            };
+        }
+
+        FrameVector<RGDrawMeshGroup> groups;
+        FrameVector<Uint32> instanceIndices;
+        GroupDrawMeshes(groupingInfos, groups, instanceIndices);
+
+        const Renderer::InstanceBuffer instanceBuffer = mRenderer->AllocateInstanceBuffer(static_cast<Uint32>(drawMeshInfos.size()));
+        InstanceData* instances = instanceBuffer.data;
+        for (Uint64 i = 0; i < drawMeshInfos.size(); ++i)
+        {
+            const Matrix& model = drawMeshInfos[i].model;
+            const Matrix modelInverseTranspose = model.Inversed().Transposed();
+
+            InstanceData& instance = instances[instanceIndices[i]];
+            for (int row = 0; row < 4; ++row)
+            {
+                instance.model[row] = model.GetRow(row).GetFloat4();
+                instance.modelInverseTranspose[row] = modelInverseTranspose.GetRow(row).GetFloat4();
+            }
+        }
+
+        RGBufferHandle rgInstanceBuffer = RegisterBuffer(instanceBuffer.buffer);
+        RGBufferSRVHandle rgInstanceBufferSRV = CreateSRV(rgInstanceBuffer);
 
         MaterialPipelineStateInfo materialStateInfo = {};
         SetRenderTargetFormatsFromCurrentRenderPass(materialStateInfo);
@@ -581,8 +1262,9 @@ namespace cube
         FrameVector<RGShaderParameterListBaseHandle> paramListArray(3);
         paramListArray.insert(paramListArray.end(), parameterLists.begin(), parameterLists.end());
 
-        for (const DrawMeshInfo& drawMeshInfo : drawMeshInfos)
+        for (const RGDrawMeshGroup& group : groups)
         {
+            const DrawMeshInfo& drawMeshInfo = drawMeshInfos[group.firstDrawIndex];
             materialStateInfo.rasterizerState = drawMeshInfo.rasterizerState;
             materialStateInfo.depthStencilState = drawMeshInfo.depthStencilState;
 
@@ -592,14 +1274,13 @@ namespace cube
             RGBufferSRVHandle rgVertexBufferSRV = CreateSRV(rgVertexBuffer);
 
             RGShaderParameterListHandle<ObjectShaderParameterList> objectShaderParameterList = CreateShaderParameterList<ObjectShaderParameterList>();
-            objectShaderParameterList->Get()->model = drawMeshInfo.model;
-            objectShaderParameterList->Get()->modelInverse = drawMeshInfo.model.Inversed();
-            objectShaderParameterList->Get()->modelInverseTranspose = drawMeshInfo.model.Inversed().Transposed();
+            objectShaderParameterList->Get()->instanceBuffer = rgInstanceBufferSRV;
+            objectShaderParameterList->Get()->instanceOffset = group.instanceOffset;
             objectShaderParameterList->Get()->vertexBuffer = rgVertexBufferSRV;
             objectShaderParameterList->Get()->useFP16 = meshMeta.useFloat16;
             paramListArray[0] = objectShaderParameterList;
 
-            AddPassInternal(CUBE_T("##DrawMeshPass - Bind Index buffer"), nullptr, nullptr, {},
+            AddPassInternal(CUBE_NAME("##DrawMeshPass - Bind Index buffer"), nullptr, nullptr, {},
                 [mesh = drawMeshInfo.mesh](gapi::CommandList& commandList){
                     commandList.BindIndexBuffer(mesh->GetIndexBuffer(), 0);
                 },
@@ -608,18 +1289,11 @@ namespace cube
             );
 
             const Vector<SubMesh>& subMeshes = drawMeshInfo.mesh->GetSubMeshes();
-            for (const SubMesh& subMesh : subMeshes)
+            for (int subMeshIndex = 0; subMeshIndex < static_cast<int>(subMeshes.size()); ++subMeshIndex)
             {
-                SharedPtr<Material> material = nullptr;
-                if (0 <= subMesh.materialIndex && subMesh.materialIndex < drawMeshInfo.materials.size())
-                {
-                    material = drawMeshInfo.materials[subMesh.materialIndex].lock();
-                }
-                if (!material)
-                {
-                    material = mRenderer.GetDefaultMaterial();
-                }
-                SharedPtr<GraphicsPipeline> pipeline = mRenderer.GetShaderManager().GetMaterialShaderManager().GetOrCreateMaterialPipeline(material, materialStateInfo);
+                const SubMesh& subMesh = subMeshes[subMeshIndex];
+                const SharedPtr<Material>& material = drawMaterials[drawMaterialsOffsets[group.firstDrawIndex] + subMeshIndex];
+                SharedPtr<GraphicsPipeline> pipeline = mRenderer->GetShaderManager().GetMaterialShaderManager().GetOrCreateMaterialPipeline(material, materialStateInfo);
                 RGShaderParameterListHandle<MaterialShaderParameterList> materialShaderParameterList = material->GenerateShaderParameterList(*this);
                 paramListArray[1] = materialShaderParameterList;
 
@@ -627,21 +1301,27 @@ namespace cube
                 // So transfer it via shader parameter and set 0 in DrawIndexed.
                 // Metal apply it in vertex_id.
                 // (See https://github.com/microsoft/DirectXShaderCompiler/pull/5770)
+                // SV_InstanceID does not include the base instance either, so the instance offset is in ObjectShaderParameterList.
                 auto subMeshShaderParameterList = CreateShaderParameterList<SubMeshShaderParameterList>();
                 subMeshShaderParameterList->Get()->vertexBufferOffset = subMesh.vertexOffset;
                 paramListArray[2] = subMeshShaderParameterList;
 
-                AddPassInternal(Format<FrameString>(CUBE_T("Mesh: {0}[{1}] / Material: {2}"), drawMeshInfo.mesh->GetDebugName(), subMesh.debugName, material->GetDebugName()),
+                AddPassInternal(drawMeshInfo.mesh->GetSubMeshPassName(subMeshIndex),
                     pipeline,
                     nullptr,
                     paramListArray,
-                    [subMesh](gapi::CommandList& commandList)
+                    [subMesh, numInstances = group.numInstances](gapi::CommandList& commandList)
                     {
-                        commandList.DrawIndexed(subMesh.numIndices, subMesh.indexOffset, 0);
+                        commandList.DrawIndexed(subMesh.numIndices, subMesh.indexOffset, 0, numInstances);
                     },
                     nullptr,
                     false
                 );
+                // Use the index buffer bound in the previous pass.
+                mPasses.back().keepWithPreviousPass = true;
+
+                mNumMeshDraws++;
+                mNumMeshInstances += group.numInstances;
             }
         }
     }
@@ -725,101 +1405,233 @@ namespace cube
         });
     }
 
+    void RGBuilder::MarkAsOutput(RGBufferHandle rgBuffer)
+    {
+        CHECK(mState == State::Init);
+        CHECK(rgBuffer.IsValid());
+
+        rgBuffer->mIsOutput = true;
+    }
+
+    void RGBuilder::MarkAsOutput(RGTextureHandle rgTexture)
+    {
+        CHECK(mState == State::Init);
+        CHECK(rgTexture.IsValid());
+
+        rgTexture->mIsOutput = true;
+    }
+
     void RGBuilder::ExecuteAndSubmit(gapi::CommandList& commandList, bool waitUntilFinished)
+    {
+        ExecuteAndSubmitInternal(nullptr, &commandList, nullptr, nullptr, waitUntilFinished);
+    }
+
+    void RGBuilder::ExecuteAndSubmit(RGCommandListPool& commandListPool, JobSystem* jobSystem, RGCompileCache* compileCache, bool waitUntilFinished)
+    {
+        ExecuteAndSubmitInternal(&commandListPool, nullptr, jobSystem, compileCache, waitUntilFinished);
+    }
+
+    void RGBuilder::RequestDump(AnsiString* outJSON, AnsiString* outDOT, const gapi::TimestampRangeList* timestampRangeList)
+    {
+        CHECK(mState == State::Init);
+
+        mDumpJSON = outJSON;
+        mDumpDOT = outDOT;
+        mDumpTimestampRangeList = timestampRangeList;
+    }
+
+    void RGBuilder::ExecuteAndSubmitInternal(RGCommandListPool* commandListPool, gapi::CommandList* commandList, JobSystem* jobSystem, RGCompileCache* compileCache, bool waitUntilFinished)
     {
         CHECK(mState == State::Init);
         CHECK(!mIsInRenderPass);
+        CHECK((commandListPool == nullptr) != (commandList == nullptr));
 
         mState = State::ResourceTracking;
+        mStats = {};
 
-        UpdateResourceUsages();
-        CreateAllResources();
-        ResolveTransitions();
-
-        mState = State::Executing;
+        // Only one segment can be recorded into the given command list.
+        int maxNumSegments = 1;
+        if (commandListPool && jobSystem)
+        {
+            maxNumSegments = std::min(static_cast<int>(jobSystem->GetNumWorkerThreads()) + 1, MAX_NUM_RECORDING_SEGMENTS);
+        }
 
-        commandList.Reset();
-        commandList.Begin();
+        const bool enableAsyncCompute = (commandListPool != nullptr);
 
-        commandList.BeginTimestamp(CUBE_T("RGBuilder"));
+        // Resource usages are always updated because they come from the parameter lists of this frame.
+        UpdateResourceUsages();
 
-        for (PassInfo& pass : mPasses)
+        bool isCompileCacheHit = false;
+        Uint64 structuralHash = 0;
+        if (compileCache)
         {
-            const bool addGPUEvent = !pass.name.starts_with(CUBE_T("##"));
+            structuralHash = CalculateStructuralHash(enableAsyncCompute, maxNumSegments);
+            isCompileCacheHit = compileCache->mIsValid && compileCache->mStructuralHash == structuralHash
+                && compileCache->mPasses.size() == mPasses.size() && compileCache->mResourceLifetimes.size() == mResources.size();
 
-            if (addGPUEvent)
+            compileCache->mNumLookups++;
+            if (isCompileCacheHit)
             {
-                commandList.BeginEvent(pass.name);
+                compileCache->mNumHits++;
             }
+        }
+
+        if (isCompileCacheHit)
+        {
+            LoadCompileResults(*compileCache);
+            AllocateTransientMemory();
+            CreateAllResources();
+            UpdateSegmentCarryOvers();
+            ReplayTransitions(*compileCache);
 
-            if (pass.addTimestamp)
+            mStats = compileCache->mStats;
+        }
+        else
+        {
+            CullPasses();
+            ScheduleAsyncComputePasses(enableAsyncCompute);
+            UpdateResourceLifetimes();
+            PlanTransientMemory();
+            AllocateTransientMemory();
+            CreateAllResources();
+            PlanRecordingSegments(maxNumSegments);
+            UpdateSegmentCarryOvers();
+            ResolveTransitions();
+
+            if (compileCache)
             {
-                commandList.BeginTimestamp(pass.name);
+                SaveCompileResults(*compileCache, structuralHash);
             }
+        }
+        mStats.numMeshDraws = mNumMeshDraws;
+        mStats.numMeshInstances = mNumMeshInstances;
+        if (compileCache)
+        {
+            mStats.isCompileCacheHit = isCompileCacheHit;
+            mStats.numCompileCacheLookups = compileCache->mNumLookups;
+            mStats.numCompileCacheHits = compileCache->mNumHits;
+        }
 
-            ResolveShaderParameterListsAndPipeline(pass, commandList);
-            MarkUseResources(pass, commandList);
+        mState = State::Executing;
 
-            if (!pass.transitions.empty())
-            {
-                commandList.ResourceTransition(pass.transitions);
-            }
+        const int numSegments = static_cast<int>(mRecordingSegments.size());
+        FrameVector<gapi::CommandList*> commandLists(numSegments);
+        for (int i = 0; i < numSegments; ++i)
+        {
+            commandLists[i] = commandList ? commandList : &commandListPool->Acquire(mRecordingSegments[i].queueType);
+        }
 
-            if (pass.passFunction)
+        if (jobSystem && numSegments > 1)
+        {
+            // The sync points can split the passes into more segments than the maximum, so it is not bound to the workers.
+            jobSystem->ParallelFor(0, numSegments, 1, [this, &commandLists](Uint64 segmentIndex)
             {
-                pass.passFunction(commandList);
-            }
-
-            if (pass.addTimestamp)
+                RecordSegment(static_cast<int>(segmentIndex), *commandLists[segmentIndex]);
+            });
+        }
+        else
+        {
+            for (int i = 0; i < numSegments; ++i)
             {
-                commandList.EndTimestamp();
+                RecordSegment(i, *commandLists[i]);
             }
+        }
 
-            if (addGPUEvent)
+        // Submit in order so the transitions in the previous segments are applied before the next ones.
+        // The segments waited for are always before the waiting segment.
+        FrameVector<Uint64> fenceValues(numSegments, 0);
+        for (int i = 0; i < numSegments; ++i)
+        {
+            for (int waitSegmentIndex : mRecordingSegments[i].waitSegments)
             {
-                commandList.EndEvent();
+                commandLists[i]->WaitQueue(mRecordingSegments[waitSegmentIndex].queueType, fenceValues[waitSegmentIndex]);
             }
+            fenceValues[i] = commandLists[i]->Submit(waitUntilFinished && (i == numSegments - 1));
         }
+        mStats.numRecordingSegments = static_cast<Uint32>(numSegments);
 
-        commandList.ResourceTransition(mLastPass.transitions);
-
-        commandList.EndTimestamp();
+        if (mDumpJSON)
+        {
+            WriteDumpJSON(*mDumpJSON);
+        }
+        if (mDumpDOT)
+        {
+            WriteDumpDOT(*mDumpDOT);
+        }
 
-        commandList.End();
-        commandList.Submit(waitUntilFinished);
+        if (commandListPool)
+        {
+            commandListPool->ReleaseAll();
+        }
 
         mState = State::Submitted;
 
         Reset();
     }
 
-    void RGBuilder::BindShaderParameterListInternal(StringView name, RGShaderParameterListBaseHandle parameterList)
+    void RGBuilder::BindShaderParameterListInternal(RGShaderParameterListBaseHandle parameterList)
     {
         CHECK(mState == State::Init);
 
         // Add pass that just store parameter list. Resources in the parameter list will be tracked automatically.
-        AddPassInternal(Format<String>(CUBE_T("##BindShaderParameterList: {0}"), parameterList->mParameterListInfo.name),
+        AddPassInternal(CUBE_NAME("##BindShaderParameterList"),
             nullptr, nullptr, { &parameterList, 1 },
             nullptr, nullptr,
             false
         );
+        // Shown in the dump instead of the pass name.
+        mPasses.back().scopeName = parameterList->mParameterListInfo.name;
+    }
+
+    void RGBuilder::AddScopePass(PassType type, Name name)
+    {
+        CHECK(mState == State::Init);
+
+        Name passName;
+        switch (type)
+        {
+        case PassType::BeginGPUEvent:
+            passName = CUBE_NAME("##BeginGPUEventScope");
+            break;
+        case PassType::EndGPUEvent:
+            passName = CUBE_NAME("##EndGPUEventScope");
+            break;
+        case PassType::BeginGPUTimestamp:
+            passName = CUBE_NAME("##BeginGPUTimestampScope");
+            break;
+        case PassType::EndGPUTimestamp:
+            passName = CUBE_NAME("##EndGPUTimestampScope");
+            break;
+        default:
+            NO_ENTRY_FORMAT("Pass type {0} is not a scope.", static_cast<int>(type));
+            return;
+        }
+
+        // The scope is opened / closed in RecordPass() because it can be continued in multiple segments.
+        AddPassInternal(passName, nullptr, nullptr, {}, nullptr, nullptr, false);
+        mPasses.back().type = type;
+        mPasses.back().scopeName = name;
     }
 
-    void RGBuilder::AddPassInternal(StringView name, SharedPtr<GraphicsPipeline> graphicsPipeline, SharedPtr<ComputePipeline> computePipeline, ConstArrayView<RGShaderParameterListBaseHandle> parameterLists,
+    void RGBuilder::AddPassInternal(Name name, SharedPtr<GraphicsPipeline> graphicsPipeline, SharedPtr<ComputePipeline> computePipeline, ConstArrayView<RGShaderParameterListBaseHandle> parameterLists,
         PassFunction&& passFunction, UseResourceFunction&& useResourceFunction,
-        bool addTimestamp
+        bool addTimestamp, bool isAsyncCompute
     )
     {
         CHECK(mState == State::Init);
 
         CHECK(!graphicsPipeline || !computePipeline);
         CHECK_FORMAT(!computePipeline || !mIsInRenderPass, "Cannot add compute pass in render pass.");
+        CHECK_FORMAT(!isAsyncCompute || !graphicsPipeline, "Cannot run graphics pipeline in async compute.");
+        CHECK_FORMAT(!isAsyncCompute || !mIsInRenderPass, "Cannot add async compute pass in render pass.");
 
         int index = static_cast<int>(mPasses.size());
         mPasses.push_back({
-            .name = String(name),
+            .name = name,
             .addTimestamp = addTimestamp,
             .index = index,
+            .renderPassBeginIndex = mIsInRenderPass ? mCurrentRenderPassBeginIndex : -1,
+            .requestsAsyncCompute = isAsyncCompute,
             .shaderParameterLists = { parameterLists.begin(), parameterLists.end() },
             .graphicsPipeline = std::move(graphicsPipeline),
             .computePipeline = std::move(computePipeline),
@@ -828,27 +1640,34 @@ namespace cube
         });
     }
 
-    void RGBuilder::ResolveShaderParameterListsAndPipeline(PassInfo& pass, gapi::CommandList& commandList)
+    void RGBuilder::RegisterShaderParameterLists(const PassInfo& pass, FrameFlatHashMap<Name, ShaderParameterListBindInfo>& inOutBindInfos) const
     {
-        CHECK(mState == State::Executing);
-
-        // Register shader parameter lists in the pass.
-        for (RGShaderParameterListBaseHandle& params : pass.shaderParameterLists)
+        for (const RGShaderParameterListBaseHandle& params : pass.shaderParameterLists)
         {
-            const Character* name = params->mParameterListInfo.name;
-            auto findIt = mShaderParameterListBindInfos.find(name);
-            if (findIt == mShaderParameterListBindInfos.end())
+            const Name name = params->mParameterListInfo.name;
+            auto findIt = inOutBindInfos.find(name);
+            if (findIt == inOutBindInfos.end())
             {
-                findIt = mShaderParameterListBindInfos.insert({ name, {} }).first;
+                findIt = inOutBindInfos.insert({ name, {} }).first;
             }
 
-            SharedPtr<ShaderParameterList> parameterList = params->mParameterList;
+            const SharedPtr<ShaderParameterList>& parameterList = params->mParameterList;
             if (findIt->second.GPUBuffer != parameterList->GetBuffer())
             {
                 // Reset bind index because it is a new buffer.
                 findIt->second = { parameterList->GetBuffer(), parameterList->GetSRV(), -1 };
             }
         }
+    }
+
+    void RGBuilder::ResolveShaderParameterListsAndPipeline(PassInfo& pass, RecordingContext& context)
+    {
+        CHECK(mState == State::Executing);
+
+        gapi::CommandList& commandList = context.commandList;
+        FrameFlatHashMap<Name, ShaderParameterListBindInfo>& bindInfos = context.shaderParameterListBindInfos;
+
+        RegisterShaderParameterLists(pass, bindInfos);
 
         // Resolve shader parameter bind index.
         const gapi::ShaderReflection* pReflection = nullptr;
@@ -864,7 +1683,7 @@ namespace cube
         {
             for (const gapi::ShaderParameterBlockReflection& block : pReflection->blocks)
             {
-                if (auto findIt = mShaderParameterListBindInfos.find(block.typeName); findIt != mShaderParameterListBindInfos.end())
+                if (auto findIt = bindInfos.find(block.typeName); findIt != bindInfos.end())
                 {
                     if (findIt->second.bindIndex != block.index)
                     {
@@ -883,22 +1702,22 @@ namespace cube
         // Bind pipeline.
         if (pass.graphicsPipeline)
         {
-            if (mCurrentBoundGraphicsPipeline != pass.graphicsPipeline)
+            if (context.boundGraphicsPipeline != pass.graphicsPipeline)
             {
-                mCurrentBoundGraphicsPipeline = pass.graphicsPipeline;
-                mCurrentBoundComputePipeline = nullptr;
+                context.boundGraphicsPipeline = pass.graphicsPipeline;
+                context.boundComputePipeline = nullptr;
 
-                commandList.SetGraphicsPipeline(mCurrentBoundGraphicsPipeline->GetGAPIGraphicsPipeline());
+                commandList.SetGraphicsPipeline(context.boundGraphicsPipeline->GetGAPIGraphicsPipeline());
             }
         }
         else if (pass.computePipeline)
         {
-            if (mCurrentBoundComputePipeline != pass.computePipeline)
+            if (context.boundComputePipeline != pass.computePipeline)
             {
-                mCurrentBoundGraphicsPipeline = nullptr;
-                mCurrentBoundComputePipeline = pass.computePipeline;
+                context.boundGraphicsPipeline = nullptr;
+                context.boundComputePipeline = pass.computePipeline;
 
-                commandList.SetComputePipeline(mCurrentBoundComputePipeline->GetGAPIComputePipeline());
+                commandList.SetComputePipeline(context.boundComputePipeline->GetGAPIComputePipeline());
             }
         }
     }
@@ -912,26 +1731,45 @@ namespace cube
             for (const PassInfo::ResourceUseInfo& resourceUseInfo : pass.resourceUseInfos)
             {
                 RGResourceHandle rgResource = mResources[resourceUseInfo.rgResourceIndex];
-                if (RGTextureSRVHandle rgSRV = rgResource.Cast<RGTextureSRV>(); rgSRV.IsValid())
+                switch (rgResource->GetKind())
                 {
-                    commandList.UseResource(rgSRV->GetSRV());
-                }
-                else if (RGTextureUAVHandle rgUAV = rgResource.Cast<RGTextureUAV>(); rgUAV.IsValid())
-                {
-                    commandList.UseResource(rgUAV->GetUAV());
-                }
-                else if (RGBufferSRVHandle rgSRV = rgResource.Cast<RGBufferSRV>(); rgSRV.IsValid())
-                {
-                    commandList.UseResource(rgSRV->GetSRV());
-                }
-                else if (RGBufferUAVHandle rgUAV = rgResource.Cast<RGBufferUAV>(); rgUAV.IsValid())
-                {
-                    commandList.UseResource(rgUAV->GetUAV());
+                case RGResourceKind::TextureSRV:
+                    commandList.UseResource(rgResource.Cast<RGTextureSRV>()->GetSRV());
+                    break;
+                case RGResourceKind::TextureUAV:
+                    commandList.UseResource(rgResource.Cast<RGTextureUAV>()->GetUAV());
+                    break;
+                case RGResourceKind::BufferSRV:
+                    commandList.UseResource(rgResource.Cast<RGBufferSRV>()->GetSRV());
+                    break;
+                case RGResourceKind::BufferUAV:
+                    commandList.UseResource(rgResource.Cast<RGBufferUAV>()->GetUAV());
+                    break;
+                default:
+                    break;
                 }
             }
         }
     }
 
+    int RGBuilder::GetTrackedResourceIndex(int rgResourceIndex) const
+    {
+        RGResourceHandle resource = mResources[rgResourceIndex];
+        switch (resource->GetKind())
+        {
+        case RGResourceKind::TextureSRV:
+        case RGResourceKind::TextureUAV:
+        case RGResourceKind::TextureRTV:
+        case RGResourceKind::TextureDSV:
+            return resource.Cast<RGTextureView>()->mRGTexture->mIndex;
+        case RGResourceKind::BufferSRV:
+        case RGResourceKind::BufferUAV:
+            return resource.Cast<RGBufferView>()->mRGBuffer->mIndex;
+        default:
+            return rgResourceIndex;
+        }
+    }
+
     void RGBuilder::UpdateResourceUsages()
     {
         CHECK(mState == State::ResourceTracking);
@@ -1035,177 +1873,1748 @@ namespace cube
         mCurrentPassIndex = -1;
     }
 
-    void RGBuilder::CreateAllResources()
+    void RGBuilder::CullPasses()
     {
         CHECK(mState == State::ResourceTracking);
 
-        GAPI& gapi = mRenderer.GetGAPI();
-
+        // Visit the passes in reverse order and keep the passes writing the resources needed later.
+        // The passes writing registered or output resources are the roots.
+        // A render pass is kept or culled as a whole. (##BeginRenderPass ~ ##EndRenderPass)
+        FrameVector<bool> isResourceNeeded(mResources.size(), false);
         const int numPasses = static_cast<int>(mPasses.size());
-        for (int i = 0; i < numPasses; ++i)
+        int lastIndex = numPasses - 1;
+        while (lastIndex >= 0)
         {
-            PassInfo& pass = mPasses[i];
-            mCurrentPassIndex = i;
+            const int firstIndex = (mPasses[lastIndex].renderPassBeginIndex != -1) ? mPasses[lastIndex].renderPassBeginIndex : lastIndex;
 
-            for (const PassInfo::ResourceUseInfo& resourceUseInfo : pass.resourceUseInfos)
+            bool hasWrite = false;
+            bool isNeeded = false;
+            for (int i = firstIndex; i <= lastIndex; ++i)
             {
-                RGResourceHandle resource = mResources[resourceUseInfo.rgResourceIndex];
-                resource->CreateResource(gapi);
-                resource->UpdateUsePassIndex(i);
+                for (const PassInfo::ResourceUseInfo& resourceUseInfo : mPasses[i].resourceUseInfos)
+                {
+                    if (!IsWriteState(resourceUseInfo.state))
+                    {
+                        continue;
+                    }
+                    hasWrite = true;
+
+                    RGResourceHandle resource = mResources[GetTrackedResourceIndex(resourceUseInfo.rgResourceIndex)];
+                    if (!resource->IsTransient() || resource->IsOutput() || isResourceNeeded[resource->mIndex])
+                    {
+                        isNeeded = true;
+                    }
+                }
             }
-        }
-        mCurrentPassIndex = -1;
 
-        // All RG resources were created, so write shader parameter lists at this time.
-        for (RGResourceHandle resource : mResources)
-        {
-            if (RGShaderParameterListBaseHandle shaderParameterList = resource.Cast<RGShaderParameterListBase>(); shaderParameterList.IsValid())
+            // Keep the passes without any write such as GPU event or timestamp because the side effect is unknown.
+            if (!hasWrite || isNeeded)
             {
-                shaderParameterList->mParameterList->WriteAllParametersToGPUBuffer();
+                // Written resources are also marked as needed because the pass may not overwrite whole contents.
+                for (int i = firstIndex; i <= lastIndex; ++i)
+                {
+                    for (const PassInfo::ResourceUseInfo& resourceUseInfo : mPasses[i].resourceUseInfos)
+                    {
+                        isResourceNeeded[GetTrackedResourceIndex(resourceUseInfo.rgResourceIndex)] = true;
+                    }
+                }
+            }
+            else
+            {
+                for (int i = firstIndex; i <= lastIndex; ++i)
+                {
+                    mPasses[i].isCulled = true;
+                    mStats.numCulledPasses++;
+                }
             }
+
+            lastIndex = firstIndex - 1;
         }
+        mStats.numPasses = static_cast<Uint32>(numPasses);
     }
 
-    void RGBuilder::ResolveTransitions()
+    void RGBuilder::ScheduleAsyncComputePasses(bool enableAsyncCompute)
     {
         CHECK(mState == State::ResourceTracking);
 
-        struct SubresourceKey
+        const int numPasses = static_cast<int>(mPasses.size());
+        FrameVector<FrameVector<int>> passResources(numPasses);
+        FrameVector<RGAsyncComputePassInfo> passInfos(numPasses);
+        for (int i = 0; i < numPasses; ++i)
         {
-            SharedPtr<gapi::Texture> texture;
-            Uint32 subresourceIndex;
-            bool needRollback;
-            bool operator<(const SubresourceKey& rhs) const
+            const PassInfo& pass = mPasses[i];
+
+            FrameVector<int>& resources = passResources[i];
+            for (const PassInfo::ResourceUseInfo& resourceUseInfo : pass.resourceUseInfos)
             {
-                return (texture == rhs.texture) ? subresourceIndex < rhs.subresourceIndex : texture < rhs.texture;
+                resources.push_back(GetTrackedResourceIndex(resourceUseInfo.rgResourceIndex));
             }
-        };
-        FrameMap<SubresourceKey, gapi::ResourceStateFlags> currentSubresourceStates;
-        struct BufferKey
-        {
-            SharedPtr<gapi::Buffer> buffer;
-            bool needRollback;
-            bool operator<(const BufferKey& rhs) const
+            for (int rgResourceIndex : pass.lifetimeOnlyResourceIndices)
             {
-                return buffer < rhs.buffer;
+                resources.push_back(GetTrackedResourceIndex(rgResourceIndex));
             }
-        };
-        FrameMap<BufferKey, gapi::ResourceStateFlags> currentBufferStates;
 
-        int numPasses = static_cast<int>(mPasses.size());
+            passInfos[i] = {
+                .isCulled = pass.isCulled,
+                .requestsAsyncCompute = enableAsyncCompute && pass.requestsAsyncCompute,
+                .canBeginSegment = !pass.keepWithPreviousPass && pass.type != PassType::EndRenderPass,
+                .resources = resources
+            };
+        }
+        ScheduleAsyncCompute(passInfos, mAsyncComputePlan);
+
+        // The async compute pass overlaps the graphics passes from the compute queue wait to the graphics queue wait.
+        int lastSignalPass = -1;
+        auto syncPointIt = mAsyncComputePlan.syncPoints.begin();
         for (int i = 0; i < numPasses; ++i)
         {
-            PassInfo& pass = mPasses[i];
-            mCurrentPassIndex = i;
-
-            for (const PassInfo::ResourceUseInfo& resourceUseInfo : pass.resourceUseInfos)
+            if (!mAsyncComputePlan.isAsyncCompute[i])
             {
-                RGResourceHandle resource = mResources[resourceUseInfo.rgResourceIndex];
+                continue;
+            }
 
-                auto TryTransitionBuffer = [&](RGBufferHandle rgBuffer)
+            PassInfo& pass = mPasses[i];
+            pass.queueType = gapi::CommandListType::Compute;
+            for (; syncPointIt != mAsyncComputePlan.syncPoints.end() && syncPointIt->waitPass <= i; ++syncPointIt)
+            {
+                if (syncPointIt->waitingQueue == gapi::CommandListType::Compute)
                 {
-                    SharedPtr<gapi::Buffer> buffer = rgBuffer->mBuffer;
+                    lastSignalPass = syncPointIt->signalPass;
+                }
+            }
+            pass.asyncSignalPass = lastSignalPass;
 
-                    const BufferKey key = { buffer, !(rgBuffer->IsTransient()) };
-                    auto currentStateIt = currentBufferStates.find(key);
-                    if (currentStateIt == currentBufferStates.end())
-                    {
-                        currentStateIt = currentBufferStates.insert({ key, gapi::ResourceStateFlag::Common }).first;
-                    }
+            auto waitIt = std::find_if(syncPointIt, mAsyncComputePlan.syncPoints.end(), [i](const RGAsyncComputePlan::SyncPoint& syncPoint)
+            {
+                return syncPoint.waitingQueue == gapi::CommandListType::Graphics && syncPoint.signalPass >= i;
+            });
+            CHECK(waitIt != mAsyncComputePlan.syncPoints.end());
+            pass.asyncWaitPass = waitIt->waitPass;
+        }
 
-                    gapi::ResourceStateFlags currentState = currentStateIt->second;
-                    if (currentState != resourceUseInfo.state)
-                    {
-                        gapi::TransitionState& transition = pass.transitions.emplace_back();
-                        transition.resourceType = gapi::TransitionState::ResourceType::Buffer;
-                        transition.buffer = buffer;
-                        transition.src = currentState;
-                        transition.dst = resourceUseInfo.state;
-                    }
-                    currentStateIt->second = resourceUseInfo.state;
-                };
+        mStats.numAsyncComputePasses = mAsyncComputePlan.GetNumAsyncComputePasses();
+        mStats.numQueueSyncs = static_cast<Uint32>(mAsyncComputePlan.syncPoints.size());
+    }
 
-                auto TryTransitionTexture = [&](RGTextureHandle rgTexture, const gapi::SubresourceRange& subresourceRange)
-                {
-                    SharedPtr<gapi::Texture> texture = rgTexture->mTexture;
+    void RGBuilder::UpdateResourceLifetimes()
+    {
+        CHECK(mState == State::ResourceTracking);
 
-                    for (Uint32 sliceIndex = subresourceRange.firstSliceIndex; sliceIndex < subresourceRange.firstSliceIndex + subresourceRange.sliceSize; ++sliceIndex)
-                    {
-                        for (Uint32 mipLevel = subresourceRange.firstMipLevel; mipLevel < subresourceRange.firstMipLevel + subresourceRange.mipLevels; ++mipLevel)
-                        {
-                            const Uint32 subresourceIndex = texture->GetSubresourceIndex(sliceIndex, mipLevel);
-                            const SubresourceKey key = { texture, subresourceIndex, !(rgTexture->IsTransient()) };
-                            auto currentStateIt = currentSubresourceStates.find(key);
-                            if (currentStateIt == currentSubresourceStates.end())
-                            {
-                                currentStateIt = currentSubresourceStates.insert({ key, gapi::ResourceStateFlag::Common }).first;
-                            }
-
-                            gapi::ResourceStateFlags currentState = currentStateIt->second;
-                            if (currentState != resourceUseInfo.state)
-                            {
-                                gapi::TransitionState& transition = pass.transitions.emplace_back();
-                                transition.resourceType = gapi::TransitionState::ResourceType::Texture;
-                                transition.texture = texture;
-                                transition.subresourceIndex = subresourceIndex;
-                                transition.src = currentState;
-                                transition.dst = resourceUseInfo.state;
-                            }
-
-                            currentStateIt->second = resourceUseInfo.state;
-                        }
-                    }
-                };
+        // Update the lifetime of resources used in the remaining passes. It is used to plan the transient memory.
+        const int numPasses = static_cast<int>(mPasses.size());
+        for (int i = 0; i < numPasses; ++i)
+        {
+            const PassInfo& pass = mPasses[i];
+            if (pass.isCulled)
+            {
+                continue;
+            }
 
-                if (RGBufferViewHandle bufferView = resource.Cast<RGBufferView>(); bufferView.IsValid())
-                {
-                    TryTransitionBuffer(bufferView->mRGBuffer);
-                }
-                else if (RGBufferHandle buffer = resource.Cast<RGBuffer>(); buffer.IsValid())
-                {
-                    TryTransitionBuffer(buffer);
-                }
-                else if (RGTextureViewHandle textureView = resource.Cast<RGTextureView>(); textureView.IsValid())
-                {
-                    TryTransitionTexture(textureView->mRGTexture, textureView->GetSubresourceRange());
-                }
-                else if (RGTextureHandle texture = resource.Cast<RGTexture>(); texture.IsValid())
-                {
-                    TryTransitionTexture(texture, resourceUseInfo.subresourceRange);
-                }
-                else
+            auto UpdateUsePassIndex = [&pass, i](RGResourceHandle resource)
+            {
+                resource->UpdateUsePassIndex(i);
+                // Resources in the async compute pass are alive while it can run, so they are not aliased with the overlapped passes.
+                if (pass.queueType == gapi::CommandListType::Compute)
                 {
-                    NO_ENTRY_FORMAT("Transition is not supported in this RGResource.");
+                    resource->UpdateUsePassIndex(pass.asyncSignalPass);
+                    resource->UpdateUsePassIndex(pass.asyncWaitPass - 1);
                 }
+            };
+            for (const PassInfo::ResourceUseInfo& resourceUseInfo : pass.resourceUseInfos)
+            {
+                UpdateUsePassIndex(mResources[resourceUseInfo.rgResourceIndex]);
             }
-        }
-
-        // Rollback transition at the last pass for non-transient resources.
-        for (auto& [key, state] : currentSubresourceStates)
-        {
-            if (key.needRollback)
+            for (int rgResourceIndex : pass.lifetimeOnlyResourceIndices)
             {
-                gapi::TransitionState& transition = mLastPass.transitions.emplace_back();
-                transition.resourceType = gapi::TransitionState::ResourceType::Texture;
-                transition.texture = key.texture;
-                transition.subresourceIndex = key.subresourceIndex;
-                transition.src = state;
-                transition.dst = gapi::ResourceStateFlag::Common;
+                UpdateUsePassIndex(mResources[rgResourceIndex]);
             }
+            for (const RGShaderParameterListBaseHandle& paramList : pass.shaderParameterLists)
+            {
+                paramList->UpdateUsePassIndex(i);
+            }
+        }
+    }
+
+    void RGBuilder::PlanTransientMemory()
+    {
+        CHECK(mState == State::ResourceTracking);
+
+        mTransientAllocations.clear();
+        for (RGResourceHandle resource : mResources)
+        {
+            // Skip the resources not used in any pass. They will not be created.
+            if (!resource->IsTransient() || resource->mBeginPass == -1)
+            {
+                continue;
+            }
+
+            gapi::TransientAllocationInfo allocationInfo;
+            if (RGTextureHandle rgTexture = resource.Cast<RGTexture>(); rgTexture.IsValid())
+            {
+                allocationInfo = mGAPI.GetTransientAllocationInfo(rgTexture->mTextureInfo);
+            }
+            else if (RGBufferHandle rgBuffer = resource.Cast<RGBuffer>(); rgBuffer.IsValid())
+            {
+                allocationInfo = mGAPI.GetTransientAllocationInfo(rgBuffer->mBufferInfo);
+            }
+            else
+            {
+                continue;
+            }
+
+            mTransientAllocations.push_back({
+                .rgResourceIndex = resource->mIndex,
+                .beginPass = resource->mBeginPass,
+                .endPass = resource->mEndPass,
+                .size = allocationInfo.size,
+                .alignment = std::max<Uint64>(allocationInfo.alignment, 1),
+                .offset = 0
+            });
+        }
+        if (mTransientAllocations.empty())
+        {
+            return;
+        }
+
+        mTransientMemorySize = PlaceTransientAllocations(mTransientAllocations);
+        mTransientMemoryAlignment = 1;
+        for (const RGTransientAllocation& allocation : mTransientAllocations)
+        {
+            mTransientMemoryAlignment = std::max(mTransientMemoryAlignment, allocation.alignment);
+            mStats.naiveTransientMemorySize += allocation.size;
+        }
+        mStats.numTransientResources = static_cast<Uint32>(mTransientAllocations.size());
+        mStats.plannedTransientMemorySize = mTransientMemorySize;
+    }
+
+    void RGBuilder::AllocateTransientMemory()
+    {
+        CHECK(mState == State::ResourceTracking);
+
+        if (mTransientAllocations.empty())
+        {
+            return;
+        }
+
+        // Allocate whole memory at once and place each resource in it.
+        // Alignments are power of two, so the offsets aligned with the max alignment are also aligned with each alignment.
+        mTransientMemory = mGAPI.AllocateTransientMemory(mTransientMemorySize, mTransientMemoryAlignment);
+        for (const RGTransientAllocation& allocation : mTransientAllocations)
+        {
+            const gapi::TransientMemory placedMemory = {
+                .pHeap = mTransientMemory.pHeap,
+                .offset = mTransientMemory.offset + allocation.offset,
+                .size = allocation.size
+            };
+
+            RGResourceHandle resource = mResources[allocation.rgResourceIndex];
+            if (RGTextureHandle rgTexture = resource.Cast<RGTexture>(); rgTexture.IsValid())
+            {
+                rgTexture->mPlacedMemory = placedMemory;
+            }
+            else if (RGBufferHandle rgBuffer = resource.Cast<RGBuffer>(); rgBuffer.IsValid())
+            {
+                rgBuffer->mPlacedMemory = placedMemory;
+            }
+        }
+    }
+
+    void RGBuilder::CreateAllResources()
+    {
+        CHECK(mState == State::ResourceTracking);
+
+        const int numPasses = static_cast<int>(mPasses.size());
+        for (int i = 0; i < numPasses; ++i)
+        {
+            PassInfo& pass = mPasses[i];
+            if (pass.isCulled)
+            {
+                continue;
+            }
+            mCurrentPassIndex = i;
+
+            for (const PassInfo::ResourceUseInfo& resourceUseInfo : pass.resourceUseInfos)
+            {
+                RGResourceHandle resource = mResources[resourceUseInfo.rgResourceIndex];
+                resource->CreateResource(mGAPI);
+            }
+        }
+        mCurrentPassIndex = -1;
+
+        // Add aliasing barriers at the first pass of the resources placed in the memory used before.
+        // The content of these resources is undefined, so the first pass should overwrite it. (ex: clear the render target)
+        auto SetAliasingResource = [this](int rgResourceIndex, SharedPtr<gapi::Buffer>& outBuffer, SharedPtr<gapi::Texture>& outTexture)
+        {
+            RGResourceHandle resource = mResources[rgResourceIndex];
+            if (RGTextureHandle rgTexture = resource.Cast<RGTexture>(); rgTexture.IsValid())
+            {
+                outTexture = rgTexture->mTexture;
+            }
+            else if (RGBufferHandle rgBuffer = resource.Cast<RGBuffer>(); rgBuffer.IsValid())
+            {
+                outBuffer = rgBuffer->mBuffer;
+            }
+        };
+        for (const RGTransientAllocation& allocation : mTransientAllocations)
+        {
+            if (!allocation.needAliasingBarrier)
+            {
+                continue;
+            }
+
+            gapi::AliasingState& aliasing = mPasses[allocation.beginPass].aliasings.emplace_back();
+            if (allocation.aliasedResourceIndex != -1)
+            {
+                SetAliasingResource(allocation.aliasedResourceIndex, aliasing.bufferBefore, aliasing.textureBefore);
+            }
+            SetAliasingResource(allocation.rgResourceIndex, aliasing.bufferAfter, aliasing.textureAfter);
+
+            mStats.numAliasingBarriers++;
+
+            // Render targets / depth stencils also need their metadata to be initialized, so discard them after the transition.
+            RGTextureHandle rgTexture = mResources[allocation.rgResourceIndex].Cast<RGTexture>();
+            if (rgTexture.IsValid() && (rgTexture->mTextureInfo.flags.IsSet(gapi::TextureFlag::RenderTarget) || rgTexture->mTextureInfo.flags.IsSet(gapi::TextureFlag::DepthStencil)))
+            {
+                PassInfo& beginPass = mPasses[allocation.beginPass];
+                auto useIt = std::find_if(beginPass.resourceUseInfos.begin(), beginPass.resourceUseInfos.end(), [&](const PassInfo::ResourceUseInfo& useInfo)
+                {
+                    return GetTrackedResourceIndex(useInfo.rgResourceIndex) == allocation.rgResourceIndex;
+                });
+                CHECK_FORMAT(useIt != beginPass.resourceUseInfos.end() && (useIt->state == gapi::ResourceStateFlag::RenderTarget || useIt->state == gapi::ResourceStateFlag::DepthWrite),
+                    "Aliased texture '{0}' should be used as a render target / depth stencil first.", rgTexture->GetDebugName());
+                beginPass.discards.push_back(rgTexture->mTexture);
+            }
+        }
+
+        // All RG resources were created, so write shader parameter lists at this time.
+        // Skip the lists only used in culled passes.
+        for (RGResourceHandle resource : mResources)
+        {
+            if (resource->mBeginPass == -1)
+            {
+                continue;
+            }
+
+            if (RGShaderParameterListBaseHandle shaderParameterList = resource.Cast<RGShaderParameterListBase>(); shaderParameterList.IsValid())
+            {
+                shaderParameterList->mParameterList->WriteAllParametersToGPUBuffer();
+            }
+        }
+    }
+
+    void RGBuilder::PlanRecordingSegments(int maxNumSegments)
+    {
+        CHECK(mState == State::ResourceTracking);
+
+        const int numPasses = static_cast<int>(mPasses.size());
+        auto CanBeginSegment = [this](int passIndex)
+        {
+            return !mPasses[passIndex].keepWithPreviousPass && mPasses[passIndex].type != PassType::EndRenderPass;
+        };
+
+        FrameVector<int> liveGraphicsPasses;
+        liveGraphicsPasses.reserve(numPasses);
+        for (const PassInfo& pass : mPasses)
+        {
+            if (!pass.isCulled && pass.queueType == gapi::CommandListType::Graphics)
+            {
+                liveGraphicsPasses.push_back(pass.index);
+            }
+        }
+        const int numLiveGraphicsPasses = static_cast<int>(liveGraphicsPasses.size());
+
+        // Index numPasses is the empty graphics segment which waits for the async compute at the end of the graph.
+        FrameVector<bool> beginsGraphicsSegment(numPasses + 1, false);
+        FrameVector<bool> beginsComputeSegment(numPasses, false);
+        beginsGraphicsSegment[0] = true;
+
+        // Cut the live graphics passes evenly and move each cut forward until the pass can begin a segment.
+        const int numBalancedSegments = std::clamp(numLiveGraphicsPasses / MIN_NUM_PASSES_PER_SEGMENT, 1, std::max(maxNumSegments, 1));
+        int lastCut = 0;
+        for (int i = 1; i < numBalancedSegments; ++i)
+        {
+            int cut = std::max(numLiveGraphicsPasses * i / numBalancedSegments, lastCut + 1);
+            while (cut < numLiveGraphicsPasses && !CanBeginSegment(liveGraphicsPasses[cut]))
+            {
+                cut++;
+            }
+            if (cut >= numLiveGraphicsPasses)
+            {
+                break;
+            }
+
+            beginsGraphicsSegment[liveGraphicsPasses[cut]] = true;
+            lastCut = cut;
+        }
+
+        // Cut at the sync points. The waiting segment begins at the wait pass and the signaling segment ends after the signal pass.
+        for (const RGAsyncComputePlan::SyncPoint& syncPoint : mAsyncComputePlan.syncPoints)
+        {
+            const gapi::CommandListType signalQueue = (syncPoint.waitingQueue == gapi::CommandListType::Compute) ? gapi::CommandListType::Graphics : gapi::CommandListType::Compute;
+            int nextSignalQueuePass = syncPoint.signalPass + 1;
+            while (nextSignalQueuePass < numPasses
+                && (mPasses[nextSignalQueuePass].isCulled || mPasses[nextSignalQueuePass].queueType != signalQueue || !CanBeginSegment(nextSignalQueuePass)))
+            {
+                nextSignalQueuePass++;
+            }
+
+            if (syncPoint.waitingQueue == gapi::CommandListType::Compute)
+            {
+                beginsComputeSegment[syncPoint.waitPass] = true;
+                if (nextSignalQueuePass < numPasses)
+                {
+                    beginsGraphicsSegment[nextSignalQueuePass] = true;
+                }
+            }
+            else
+            {
+                beginsGraphicsSegment[syncPoint.waitPass] = true;
+                if (nextSignalQueuePass < numPasses)
+                {
+                    beginsComputeSegment[nextSignalQueuePass] = true;
+                }
+            }
+        }
+
+        // Segments are sorted by the begin pass, so a segment is always after the segments it waits for.
+        mRecordingSegments.clear();
+        FrameVector<int> lastSegmentIndices(2, -1); // Index: gapi::CommandListType
+        for (int i = 0; i <= numPasses; ++i)
+        {
+            gapi::CommandListType queueType;
+            if (beginsGraphicsSegment[i])
+            {
+                queueType = gapi::CommandListType::Graphics;
+            }
+            else if (i < numPasses && beginsComputeSegment[i])
+            {
+                queueType = gapi::CommandListType::Compute;
+            }
+            else
+            {
+                continue;
+            }
+
+            const int segmentIndex = static_cast<int>(mRecordingSegments.size());
+            RecordingSegment& segment = mRecordingSegments.emplace_back();
+            segment.beginPass = i;
+            segment.endPass = numPasses;
+            segment.queueType = queueType;
+
+            int& lastSegmentIndex = lastSegmentIndices[static_cast<int>(queueType)];
+            if (lastSegmentIndex != -1)
+            {
+                mRecordingSegments[lastSegmentIndex].endPass = i;
+                mRecordingSegments[lastSegmentIndex].nextSegmentIndex = segmentIndex;
+            }
+            lastSegmentIndex = segmentIndex;
+        }
+
+        FrameVector<int> segmentIndicesByBeginPass(numPasses + 1, -1);
+        for (int segmentIndex = 0; segmentIndex < static_cast<int>(mRecordingSegments.size()); ++segmentIndex)
+        {
+            const RecordingSegment& segment = mRecordingSegments[segmentIndex];
+            segmentIndicesByBeginPass[segment.beginPass] = segmentIndex;
+            for (int i = segment.beginPass; i < segment.endPass; ++i)
+            {
+                if (mPasses[i].queueType == segment.queueType)
+                {
+                    mPasses[i].segmentIndex = segmentIndex;
+                }
+            }
+        }
+        for (const RGAsyncComputePlan::SyncPoint& syncPoint : mAsyncComputePlan.syncPoints)
+        {
+            const int waitSegmentIndex = segmentIndicesByBeginPass[syncPoint.waitPass];
+            CHECK(waitSegmentIndex != -1);
+            mRecordingSegments[waitSegmentIndex].waitSegments.push_back(mPasses[syncPoint.signalPass].segmentIndex);
+        }
+        CHECK_FORMAT(mRecordingSegments.back().queueType == gapi::CommandListType::Graphics, "The last segment should be in the graphics queue to roll back the resource states.");
+    }
+
+    void RGBuilder::UpdateSegmentCarryOvers()
+    {
+        CHECK(mState == State::ResourceTracking);
+
+        const int numPasses = static_cast<int>(mPasses.size());
+
+        // Track the scopes and the parameter lists which are carried over to the next segments in the order of the passes.
+        // Scopes are only in the graphics queue.
+        FrameVector<int> openScopePasses;
+        FrameFlatHashMap<Name, ShaderParameterListBindInfo> shaderParameterListBindInfos;
+        int passIndex = 0;
+        auto AdvancePassesTo = [&](int endPass)
+        {
+            for (; passIndex < endPass; ++passIndex)
+            {
+                const PassInfo& pass = mPasses[passIndex];
+                if (pass.isCulled)
+                {
+                    continue;
+                }
+
+                switch (pass.type)
+                {
+                case PassType::BeginRenderPass:
+                case PassType::BeginGPUEvent:
+                case PassType::BeginGPUTimestamp:
+                    openScopePasses.push_back(pass.index);
+                    break;
+                case PassType::EndRenderPass:
+                case PassType::EndGPUEvent:
+                case PassType::EndGPUTimestamp:
+                    PopScope(openScopePasses, pass.type);
+                    break;
+                default:
+                    break;
+                }
+
+                RegisterShaderParameterLists(pass, shaderParameterListBindInfos);
+            }
+        };
+        for (RecordingSegment& segment : mRecordingSegments)
+        {
+            AdvancePassesTo(segment.beginPass);
+
+            if (segment.queueType == gapi::CommandListType::Graphics)
+            {
+                segment.openScopePasses = openScopePasses;
+            }
+            segment.shaderParameterListBindInfos = shaderParameterListBindInfos;
+        }
+        AdvancePassesTo(numPasses);
+        CHECK_FORMAT(openScopePasses.empty(), "Not all scopes are ended.");
+    }
+
+    void RGBuilder::ResolveTransitions()
+    {
+        CHECK(mState == State::ResourceTracking);
+
+        const gapi::ResourceStateFlags readOnlyStates = gapi::ResourceStateFlag::Vertex | gapi::ResourceStateFlag::Index
+            | gapi::ResourceStateFlag::SRV_Pixel | gapi::ResourceStateFlag::SRV_NonPixel | gapi::ResourceStateFlag::DepthRead
+            | gapi::ResourceStateFlag::IndirectArgs | gapi::ResourceStateFlag::CopySrc | gapi::ResourceStateFlag::ResolveSrc;
+        // SRVs are transitioned to both pixel / non-pixel states to skip the transitions between them.
+        const gapi::ResourceStateFlags combinedSRVState = gapi::ResourceStateFlag::SRV_Pixel | gapi::ResourceStateFlag::SRV_NonPixel;
+        // States which the compute queue can transition from / to.
+        const gapi::ResourceStateFlags computeQueueStates = gapi::ResourceStateFlag::Vertex | gapi::ResourceStateFlag::SRV_NonPixel | gapi::ResourceStateFlag::UAV
+            | gapi::ResourceStateFlag::IndirectArgs | gapi::ResourceStateFlag::CopySrc | gapi::ResourceStateFlag::CopyDst;
+
+        auto IsReadOnlyState = [&readOnlyStates](gapi::ResourceStateFlags state)
+        {
+            return state != gapi::ResourceStateFlag::Common && (state | readOnlyStates) == readOnlyStates;
+        };
+        // Returns the current state if it already covers the requested read state.
+        // In the async compute pass, the state is kept in the states of the compute queue
+        // so the following async compute passes can transition it.
+        auto GetNextState = [&](int passIndex, gapi::ResourceStateFlags currentState, gapi::ResourceStateFlags requestedState) -> gapi::ResourceStateFlags
+        {
+            const bool isAsyncCompute = mPasses[passIndex].queueType == gapi::CommandListType::Compute;
+            if (IsReadOnlyState(currentState) && IsReadOnlyState(requestedState) && (currentState & requestedState) == requestedState
+                && (!isAsyncCompute || (currentState | computeQueueStates) == computeQueueStates))
+            {
+                return currentState;
+            }
+            if (!isAsyncCompute && (requestedState == gapi::ResourceStateFlag::SRV_Pixel || requestedState == gapi::ResourceStateFlag::SRV_NonPixel))
+            {
+                return combinedSRVState;
+            }
+            return requestedState;
+        };
+
+        // States are tracked per RG texture / buffer with its index.
+        // The state of a texture is kept in one value while all subresources are in the same state,
+        // and it is expanded to the per-subresource states only after they diverge.
+        struct ResourceState
+        {
+            bool isUsed = false;
+            bool isUniform = true;
+            gapi::ResourceStateFlags state = gapi::ResourceStateFlag::Common; // Valid if isUniform
+            int subresourceStatesOffset = -1; // Offset in subresourceStates. Allocated at the first divergence.
+            int lastUsePass = -1;
+        };
+        FrameVector<ResourceState> resourceStates(mResources.size());
+
+        // Reserve the subresource states of all textures at once, so they are not reallocated while resolving.
+        Uint32 numAllSubresources = 0;
+        for (RGResourceHandle resource : mResources)
+        {
+            if (RGTextureHandle rgTexture = resource.Cast<RGTexture>(); rgTexture.IsValid() && rgTexture->mBeginPass != -1)
+            {
+                numAllSubresources += rgTexture->mTexture->GetNumSlices() * rgTexture->mTexture->GetMipLevels();
+            }
+        }
+        FrameVector<gapi::ResourceStateFlags> subresourceStates;
+        subresourceStates.reserve(numAllSubresources);
+
+        // The first live pass after each pass. It is used as the begin point of split transitions.
+        const int numPasses = static_cast<int>(mPasses.size());
+        FrameVector<int> nextLivePasses(numPasses + 1, numPasses);
+        for (int i = numPasses - 1; i >= 0; --i)
+        {
+            nextLivePasses[i] = (i + 1 < numPasses && !mPasses[i + 1].isCulled) ? i + 1 : nextLivePasses[i + 1];
+        }
+
+        // Hoist the transition right after the last use of the resource as a split transition,
+        // so the GPU can start it while the passes between them run.
+        auto AddTransition = [&](int passIndex, const ResourceState& resourceState, gapi::TransitionState&& transition)
+        {
+            PassInfo& pass = mPasses[passIndex];
+            if (pass.queueType == gapi::CommandListType::Compute && ((transition.src | transition.dst) | computeQueueStates) != computeQueueStates)
+            {
+                // The state is set in the graphics queue before the async compute pass (src is the graphics state),
+                // so transition it in the graphics pass which the compute queue waits for.
+                mPasses[pass.asyncSignalPass].postTransitions.push_back(std::move(transition));
+                return;
+            }
+
+            if (resourceState.lastUsePass != -1)
+            {
+                const int beginPassIndex = nextLivePasses[resourceState.lastUsePass];
+                // Split transitions cannot be across the command lists or the queues.
+                if (beginPassIndex < passIndex && mPasses[beginPassIndex].segmentIndex == pass.segmentIndex
+                    && mPasses[resourceState.lastUsePass].queueType == pass.queueType)
+                {
+                    gapi::TransitionState& beginTransition = mPasses[beginPassIndex].transitions.emplace_back(transition);
+                    beginTransition.split = gapi::TransitionState::SplitType::Begin;
+                    transition.split = gapi::TransitionState::SplitType::End;
+
+                    mStats.numSplitTransitions++;
+                }
+            }
+            pass.transitions.push_back(std::move(transition));
+        };
+        auto MakeBufferTransition = [](const SharedPtr<gapi::Buffer>& buffer, gapi::ResourceStateFlags src, gapi::ResourceStateFlags dst)
+        {
+            return gapi::TransitionState{
+                .resourceType = gapi::TransitionState::ResourceType::Buffer,
+                .buffer = buffer,
+                .src = src,
+                .dst = dst
+            };
+        };
+        auto MakeTextureTransition = [](const SharedPtr<gapi::Texture>& texture, Uint32 subresourceIndex, gapi::ResourceStateFlags src, gapi::ResourceStateFlags dst)
+        {
+            return gapi::TransitionState{
+                .resourceType = gapi::TransitionState::ResourceType::Texture,
+                .texture = texture,
+                .subresourceIndex = subresourceIndex,
+                .src = src,
+                .dst = dst
+            };
+        };
+        auto MakeTextureRangeTransition = [](const SharedPtr<gapi::Texture>& texture, const gapi::SubresourceRange& subresourceRange, gapi::ResourceStateFlags src, gapi::ResourceStateFlags dst)
+        {
+            return gapi::TransitionState{
+                .resourceType = gapi::TransitionState::ResourceType::Texture,
+                .texture = texture,
+                .useSubresourceRange = true,
+                .subresourceRange = subresourceRange,
+                .src = src,
+                .dst = dst
+            };
+        };
+        // The range with a single subresource is transitioned by its index.
+        auto MakeCollapsedTextureTransition = [&](const SharedPtr<gapi::Texture>& texture, const gapi::SubresourceRange& subresourceRange, gapi::ResourceStateFlags src, gapi::ResourceStateFlags dst)
+        {
+            if (subresourceRange.mipLevels == 1 && subresourceRange.sliceSize == 1)
+            {
+                return MakeTextureTransition(texture, texture->GetSubresourceIndex(subresourceRange.firstSliceIndex, subresourceRange.firstMipLevel), src, dst);
+            }
+            return MakeTextureRangeTransition(texture, subresourceRange, src, dst);
+        };
+
+        auto TryTransitionBuffer = [&](int passIndex, RGBufferHandle rgBuffer, gapi::ResourceStateFlags requestedState)
+        {
+            ResourceState& resourceState = resourceStates[rgBuffer->mIndex];
+            resourceState.isUsed = true;
+
+            // The buffers in the upload heap cannot be transitioned. They are always readable.
+            if (rgBuffer->mBuffer && rgBuffer->mBuffer->GetUsage() == gapi::ResourceUsage::CPUtoGPU)
+            {
+                CHECK_FORMAT(IsReadOnlyState(requestedState), "CPUtoGPU buffer '{0}' can only be read.", rgBuffer->GetDebugName());
+                resourceState.lastUsePass = passIndex;
+                return;
+            }
+
+            const gapi::ResourceStateFlags newState = GetNextState(passIndex, resourceState.state, requestedState);
+            if (resourceState.state != newState)
+            {
+                AddTransition(passIndex, resourceState, MakeBufferTransition(rgBuffer->mBuffer, resourceState.state, newState));
+                resourceState.state = newState;
+            }
+            resourceState.lastUsePass = passIndex;
+        };
+
+        auto TryTransitionTexture = [&](int passIndex, RGTextureHandle rgTexture, const gapi::SubresourceRange& subresourceRange, gapi::ResourceStateFlags requestedState)
+        {
+            const SharedPtr<gapi::Texture>& texture = rgTexture->mTexture;
+            const Uint32 numMipLevels = texture->GetMipLevels();
+            const Uint32 numSlices = texture->GetNumSlices();
+
+            ResourceState& resourceState = resourceStates[rgTexture->mIndex];
+            if (!resourceState.isUsed)
+            {
+                resourceState.isUsed = true;
+                if (!rgTexture->IsTransient())
+                {
+                    resourceState.state = mTextureStateCache.ConsumeState(texture);
+                    mConsumedTextureStates.push_back(rgTexture->mIndex);
+                }
+            }
+
+            const bool isWholeRange = subresourceRange.firstMipLevel == 0 && subresourceRange.mipLevels == numMipLevels
+                && subresourceRange.firstSliceIndex == 0 && subresourceRange.sliceSize == numSlices;
+            if (resourceState.isUniform)
+            {
+                const gapi::ResourceStateFlags newState = GetNextState(passIndex, resourceState.state, requestedState);
+                if (resourceState.state != newState)
+                {
+                    // All subresources in the range have the same state, so transition them at once.
+                    AddTransition(passIndex, resourceState, MakeTextureRangeTransition(texture, subresourceRange, resourceState.state, newState));
+
+                    if (!isWholeRange)
+                    {
+                        // States of subresources diverge. Expand the state to each subresource.
+                        if (resourceState.subresourceStatesOffset == -1)
+                        {
+                            resourceState.subresourceStatesOffset = static_cast<int>(subresourceStates.size());
+                            subresourceStates.resize(subresourceStates.size() + numSlices * numMipLevels);
+                        }
+                        gapi::ResourceStateFlags* pStates = subresourceStates.data() + resourceState.subresourceStatesOffset;
+                        std::fill_n(pStates, numSlices * numMipLevels, resourceState.state);
+                        for (Uint32 sliceIndex = subresourceRange.firstSliceIndex; sliceIndex < subresourceRange.firstSliceIndex + subresourceRange.sliceSize; ++sliceIndex)
+                        {
+                            std::fill_n(pStates + texture->GetSubresourceIndex(sliceIndex, subresourceRange.firstMipLevel), subresourceRange.mipLevels, newState);
+                        }
+                        resourceState.isUniform = false;
+                    }
+                    resourceState.state = newState;
+                }
+                resourceState.lastUsePass = passIndex;
+                return;
+            }
+
+            gapi::ResourceStateFlags* pStates = subresourceStates.data() + resourceState.subresourceStatesOffset;
+
+            // Merge into one range transition if all subresources in the range have the same state.
+            const gapi::ResourceStateFlags firstState = pStates[texture->GetSubresourceIndex(subresourceRange.firstSliceIndex, subresourceRange.firstMipLevel)];
+            bool isSameState = true;
+            for (Uint32 sliceIndex = subresourceRange.firstSliceIndex; sliceIndex < subresourceRange.firstSliceIndex + subresourceRange.sliceSize && isSameState; ++sliceIndex)
+            {
+                for (Uint32 mipLevel = subresourceRange.firstMipLevel; mipLevel < subresourceRange.firstMipLevel + subresourceRange.mipLevels; ++mipLevel)
+                {
+                    if (pStates[texture->GetSubresourceIndex(sliceIndex, mipLevel)] != firstState)
+                    {
+                        isSameState = false;
+                        break;
+                    }
+                }
+            }
+
+            const gapi::ResourceStateFlags firstNewState = GetNextState(passIndex, firstState, requestedState);
+            if (isSameState)
+            {
+                if (firstState != firstNewState)
+                {
+                    AddTransition(passIndex, resourceState, MakeTextureRangeTransition(texture, subresourceRange, firstState, firstNewState));
+                }
+            }
+            else
+            {
+                // Only the subresources in the different states are transitioned, and the contiguous ones with the same transition are merged.
+                CollapseSubresourceTransitions(*texture, subresourceRange,
+                    [&](Uint32 subresourceIndex)
+                    {
+                        return SubresourceTransition{ .src = pStates[subresourceIndex], .dst = GetNextState(passIndex, pStates[subresourceIndex], requestedState) };
+                    },
+                    [&](const gapi::SubresourceRange& range, gapi::ResourceStateFlags src, gapi::ResourceStateFlags dst)
+                    {
+                        AddTransition(passIndex, resourceState, MakeCollapsedTextureTransition(texture, range, src, dst));
+                    });
+            }
+            bool isSameNewState = true;
+            for (Uint32 sliceIndex = subresourceRange.firstSliceIndex; sliceIndex < subresourceRange.firstSliceIndex + subresourceRange.sliceSize; ++sliceIndex)
+            {
+                for (Uint32 mipLevel = subresourceRange.firstMipLevel; mipLevel < subresourceRange.firstMipLevel + subresourceRange.mipLevels; ++mipLevel)
+                {
+                    const Uint32 subresourceIndex = texture->GetSubresourceIndex(sliceIndex, mipLevel);
+                    const gapi::ResourceStateFlags newState = GetNextState(passIndex, pStates[subresourceIndex], requestedState);
+                    pStates[subresourceIndex] = newState;
+                    isSameNewState = isSameNewState && (newState == firstNewState);
+                }
+            }
+
+            // All subresources are in the same state again. (Also after the per-subresource transitions, ex: reading all mips after generating them)
+            if (isWholeRange && isSameNewState)
+            {
+                resourceState.isUniform = true;
+                resourceState.state = firstNewState;
+            }
+            resourceState.lastUsePass = passIndex;
+        };
+
+        for (int i = 0; i < numPasses; ++i)
+        {
+            PassInfo& pass = mPasses[i];
+            if (pass.isCulled)
+            {
+                continue;
+            }
+            mCurrentPassIndex = i;
+
+            for (const PassInfo::ResourceUseInfo& resourceUseInfo : pass.resourceUseInfos)
+            {
+                RGResourceHandle resource = mResources[resourceUseInfo.rgResourceIndex];
+
+                switch (resource->GetKind())
+                {
+                case RGResourceKind::BufferSRV:
+                case RGResourceKind::BufferUAV:
+                    TryTransitionBuffer(i, resource.Cast<RGBufferView>()->mRGBuffer, resourceUseInfo.state);
+                    break;
+                case RGResourceKind::Buffer:
+                    TryTransitionBuffer(i, resource.Cast<RGBuffer>(), resourceUseInfo.state);
+                    break;
+                case RGResourceKind::TextureSRV:
+                case RGResourceKind::TextureUAV:
+                case RGResourceKind::TextureRTV:
+                case RGResourceKind::TextureDSV:
+                {
+                    RGTextureViewHandle textureView = resource.Cast<RGTextureView>();
+                    TryTransitionTexture(i, textureView->mRGTexture, textureView->GetSubresourceRange(), resourceUseInfo.state);
+                    break;
+                }
+                case RGResourceKind::Texture:
+                    TryTransitionTexture(i, resource.Cast<RGTexture>(), resourceUseInfo.subresourceRange, resourceUseInfo.state);
+                    break;
+                default:
+                    NO_ENTRY_FORMAT("Transition is not supported in this RGResource.");
+                    break;
+                }
+            }
+
+            // Attached resources are used until the end of the render pass, so transitions should not be hoisted before it.
+            for (int rgResourceIndex : pass.lifetimeOnlyResourceIndices)
+            {
+                if (RGTextureViewHandle textureView = mResources[rgResourceIndex].Cast<RGTextureView>(); textureView.IsValid())
+                {
+                    resourceStates[textureView->mRGTexture->mIndex].lastUsePass = i;
+                }
+            }
+        }
+
+        // Rollback transition at the last pass for non-transient resources.
+        // Textures in the read state are kept in it and the state is passed to the next RGBuilder.
+        const gapi::ResourceStateFlags rollbackState = gapi::ResourceStateFlag::Common;
+        for (RGResourceHandle resource : mResources)
+        {
+            const ResourceState& resourceState = resourceStates[resource->mIndex];
+            if (!resourceState.isUsed || resource->IsTransient())
+            {
+                continue;
+            }
+
+            if (RGTextureHandle rgTexture = resource.Cast<RGTexture>(); rgTexture.IsValid())
+            {
+                const SharedPtr<gapi::Texture>& texture = rgTexture->mTexture;
+                if (resourceState.isUniform)
+                {
+                    if (resourceState.state == combinedSRVState)
+                    {
+                        mTextureStateCache.StoreState(texture, resourceState.state);
+                        mStoredTextureStates.push_back(rgTexture->mIndex);
+                        mStats.numSkippedRollbacks++;
+                    }
+                    else if (resourceState.state != rollbackState)
+                    {
+                        const gapi::SubresourceRange wholeRange = gapi::SubresourceRangeInput{}.Clamp(texture.get());
+                        mLastPass.transitions.push_back(MakeTextureRangeTransition(texture, wholeRange, resourceState.state, rollbackState));
+                    }
+                }
+                else
+                {
+                    const gapi::ResourceStateFlags* pStates = subresourceStates.data() + resourceState.subresourceStatesOffset;
+                    CollapseSubresourceTransitions(*texture, gapi::SubresourceRangeInput{}.Clamp(texture.get()),
+                        [pStates, rollbackState](Uint32 subresourceIndex)
+                        {
+                            return SubresourceTransition{ .src = pStates[subresourceIndex], .dst = rollbackState };
+                        },
+                        [&](const gapi::SubresourceRange& range, gapi::ResourceStateFlags src, gapi::ResourceStateFlags dst)
+                        {
+                            mLastPass.transitions.push_back(MakeCollapsedTextureTransition(texture, range, src, dst));
+                        });
+                }
+            }
+            else if (RGBufferHandle rgBuffer = resource.Cast<RGBuffer>(); rgBuffer.IsValid())
+            {
+                if (resourceState.state != rollbackState)
+                {
+                    mLastPass.transitions.push_back(MakeBufferTransition(rgBuffer->mBuffer, resourceState.state, rollbackState));
+                }
+            }
+        }
+
+        // Begin and end of split transitions are counted once.
+        for (const PassInfo& pass : mPasses)
+        {
+            mStats.numTransitions += static_cast<Uint32>(pass.transitions.size() + pass.postTransitions.size());
+        }
+        mStats.numTransitions += static_cast<Uint32>(mLastPass.transitions.size());
+        mStats.numTransitions -= mStats.numSplitTransitions;
+
+        mCurrentPassIndex = -1;
+    }
+
+    Uint64 RGBuilder::CalculateStructuralHash(bool enableAsyncCompute, int maxNumSegments) const
+    {
+        CHECK(mState == State::ResourceTracking);
+
+        Uint64 hash = HashCombine(mPasses.size(), mResources.size(), enableAsyncCompute, maxNumSegments);
+        auto Add = [&hash](auto value)
+        {
+            hash = HashCombine(hash, static_cast<Uint64>(value));
+        };
+
+        for (const PassInfo& pass : mPasses)
+        {
+            // The names are interned, so their ids are same in every frame.
+            Add(pass.name.GetId());
+            Add(pass.scopeName.GetId());
+            Add(pass.type);
+            Add(pass.renderPassBeginIndex);
+            Add(pass.keepWithPreviousPass);
+            Add(pass.requestsAsyncCompute);
+            // Only the kind of the pipeline is needed. The pipelines themselves are bound while recording.
+            Add(pass.graphicsPipeline != nullptr);
+            Add(pass.computePipeline != nullptr);
+
+            Add(pass.resourceUseInfos.size());
+            for (const PassInfo::ResourceUseInfo& resourceUseInfo : pass.resourceUseInfos)
+            {
+                Add(resourceUseInfo.rgResourceIndex);
+                Add(resourceUseInfo.state.GetBits());
+                Add(resourceUseInfo.subresourceRange.GetHash());
+            }
+            Add(pass.lifetimeOnlyResourceIndices.size());
+            for (int rgResourceIndex : pass.lifetimeOnlyResourceIndices)
+            {
+                Add(rgResourceIndex);
+            }
+            Add(pass.shaderParameterLists.size());
+            for (const RGShaderParameterListBaseHandle& params : pass.shaderParameterLists)
+            {
+                Add(params->mIndex);
+            }
+        }
+
+        for (RGResourceHandle resource : mResources)
+        {
+            Add(resource->GetKind());
+            Add(resource->IsTransient());
+            Add(resource->IsOutput());
+
+            switch (resource->GetKind())
+            {
+            case RGResourceKind::Buffer:
+            {
+                RGBufferHandle rgBuffer = resource.Cast<RGBuffer>();
+                const gapi::BufferInfo& bufferInfo = rgBuffer->mBufferInfo;
+                Add(bufferInfo.type);
+                Add(bufferInfo.size);
+                Add(bufferInfo.stride);
+                Add(bufferInfo.flags.GetBits());
+                // CPUtoGPU buffers are not transitioned. (See TryTransitionBuffer())
+                if (rgBuffer->mBuffer)
+                {
+                    Add(rgBuffer->mBuffer->GetUsage());
+                }
+                break;
+            }
+            case RGResourceKind::Texture:
+            {
+                RGTextureHandle rgTexture = resource.Cast<RGTexture>();
+                const gapi::TextureInfo& textureInfo = rgTexture->mTextureInfo;
+                Add(textureInfo.format);
+                Add(textureInfo.type);
+                Add(textureInfo.flags.GetBits());
+                Add(textureInfo.width);
+                Add(textureInfo.height);
+                Add(textureInfo.depth);
+                Add(textureInfo.arraySize);
+                Add(textureInfo.mipLevels);
+                // Registered textures begin with the state left by the previous RGBuilder.
+                if (!rgTexture->IsTransient())
+                {
+                    Add(mTextureStateCache.GetState(rgTexture->mTexture).GetBits());
+                }
+                break;
+            }
+            case RGResourceKind::BufferSRV:
+            case RGResourceKind::BufferUAV:
+                Add(resource.Cast<RGBufferView>()->mViewHashKey);
+                break;
+            case RGResourceKind::TextureSRV:
+            case RGResourceKind::TextureUAV:
+            case RGResourceKind::TextureRTV:
+            case RGResourceKind::TextureDSV:
+                Add(resource.Cast<RGTextureView>()->mViewHashKey);
+                break;
+            default:
+                break;
+            }
+        }
+
+        return hash;
+    }
+
+    void RGBuilder::SaveCompileResults(RGCompileCache& compileCache, Uint64 structuralHash) const
+    {
+        CHECK(mState == State::ResourceTracking);
+
+        compileCache.Clear();
+        compileCache.mIsValid = true;
+        compileCache.mStructuralHash = structuralHash;
+
+        compileCache.mPasses.reserve(mPasses.size());
+        for (const PassInfo& pass : mPasses)
+        {
+            compileCache.mPasses.push_back({
+                .isCulled = pass.isCulled,
+                .queueType = pass.queueType,
+                .asyncSignalPass = pass.asyncSignalPass,
+                .asyncWaitPass = pass.asyncWaitPass,
+                .segmentIndex = pass.segmentIndex
+            });
+        }
+        compileCache.mResourceLifetimes.reserve(mResources.size());
+        for (RGResourceHandle resource : mResources)
+        {
+            compileCache.mResourceLifetimes.push_back({ .beginPass = resource->mBeginPass, .endPass = resource->mEndPass });
+        }
+
+        compileCache.mAsyncComputePlan.isAsyncCompute.assign(mAsyncComputePlan.isAsyncCompute.begin(), mAsyncComputePlan.isAsyncCompute.end());
+        compileCache.mAsyncComputePlan.syncPoints.assign(mAsyncComputePlan.syncPoints.begin(), mAsyncComputePlan.syncPoints.end());
+        compileCache.mTransientAllocations.assign(mTransientAllocations.begin(), mTransientAllocations.end());
+        compileCache.mTransientMemorySize = mTransientMemorySize;
+        compileCache.mTransientMemoryAlignment = mTransientMemoryAlignment;
+
+        for (const RecordingSegment& segment : mRecordingSegments)
+        {
+            compileCache.mSegments.push_back({
+                .beginPass = segment.beginPass,
+                .endPass = segment.endPass,
+                .queueType = segment.queueType,
+                .nextSegmentIndex = segment.nextSegmentIndex,
+                .waitSegments = { segment.waitSegments.begin(), segment.waitSegments.end() }
+            });
+        }
+
+        // Transitions have the GAPI resources of this frame, so store their RG resources instead.
+        const FrameHashMap<const void*, int> rgResourceIndices = GetRGResourceIndicesByGAPIResource();
+        auto SaveTransitions = [&](int passIndex, bool isPostTransition, const FrameVector<gapi::TransitionState>& transitions)
+        {
+            for (const gapi::TransitionState& transition : transitions)
+            {
+                const void* pResource = (transition.resourceType == gapi::TransitionState::ResourceType::Texture)
+                    ? static_cast<const void*>(transition.texture.get()) : static_cast<const void*>(transition.buffer.get());
+                auto findIt = rgResourceIndices.find(pResource);
+                CHECK(findIt != rgResourceIndices.end());
+
+                RGCompileCache::TransitionResult& result = compileCache.mTransitions.emplace_back(RGCompileCache::TransitionResult{
+                    .passIndex = passIndex,
+                    .isPostTransition = isPostTransition,
+                    .rgResourceIndex = findIt->second,
+                    .transition = transition
+                });
+                result.transition.buffer = nullptr;
+                result.transition.texture = nullptr;
+            }
+        };
+        for (const PassInfo& pass : mPasses)
+        {
+            SaveTransitions(pass.index, false, pass.transitions);
+            SaveTransitions(pass.index, true, pass.postTransitions);
+        }
+        SaveTransitions(-1, false, mLastPass.transitions);
+
+        compileCache.mConsumedTextureStates.assign(mConsumedTextureStates.begin(), mConsumedTextureStates.end());
+        for (int rgResourceIndex : mStoredTextureStates)
+        {
+            compileCache.mStoredTextureStates.push_back({
+                .rgResourceIndex = rgResourceIndex,
+                .state = mTextureStateCache.GetState(mResources[rgResourceIndex].Cast<RGTexture>()->mTexture)
+            });
+        }
+
+        compileCache.mStats = mStats;
+    }
+
+    void RGBuilder::LoadCompileResults(const RGCompileCache& compileCache)
+    {
+        CHECK(mState == State::ResourceTracking);
+
+        const int numPasses = static_cast<int>(mPasses.size());
+        for (int i = 0; i < numPasses; ++i)
+        {
+            PassInfo& pass = mPasses[i];
+            const RGCompileCache::PassResult& result = compileCache.mPasses[i];
+
+            pass.isCulled = result.isCulled;
+            pass.queueType = result.queueType;
+            pass.asyncSignalPass = result.asyncSignalPass;
+            pass.asyncWaitPass = result.asyncWaitPass;
+            pass.segmentIndex = result.segmentIndex;
+        }
+        for (RGResourceHandle resource : mResources)
+        {
+            const RGCompileCache::ResourceLifetime& lifetime = compileCache.mResourceLifetimes[resource->mIndex];
+            resource->mBeginPass = lifetime.beginPass;
+            resource->mEndPass = lifetime.endPass;
+        }
+
+        mAsyncComputePlan.isAsyncCompute.assign(compileCache.mAsyncComputePlan.isAsyncCompute.begin(), compileCache.mAsyncComputePlan.isAsyncCompute.end());
+        mAsyncComputePlan.syncPoints.assign(compileCache.mAsyncComputePlan.syncPoints.begin(), compileCache.mAsyncComputePlan.syncPoints.end());
+        mTransientAllocations.assign(compileCache.mTransientAllocations.begin(), compileCache.mTransientAllocations.end());
+        mTransientMemorySize = compileCache.mTransientMemorySize;
+        mTransientMemoryAlignment = compileCache.mTransientMemoryAlignment;
+
+        mRecordingSegments.clear();
+        for (const RGCompileCache::SegmentResult& result : compileCache.mSegments)
+        {
+            RecordingSegment& segment = mRecordingSegments.emplace_back();
+            segment.beginPass = result.beginPass;
+            segment.endPass = result.endPass;
+            segment.queueType = result.queueType;
+            segment.nextSegmentIndex = result.nextSegmentIndex;
+            segment.waitSegments.assign(result.waitSegments.begin(), result.waitSegments.end());
+        }
+    }
+
+    void RGBuilder::ReplayTransitions(const RGCompileCache& compileCache)
+    {
+        CHECK(mState == State::ResourceTracking);
+
+        for (const RGCompileCache::TransitionResult& result : compileCache.mTransitions)
+        {
+            gapi::TransitionState transition = result.transition;
+            RGResourceHandle resource = mResources[result.rgResourceIndex];
+            if (transition.resourceType == gapi::TransitionState::ResourceType::Texture)
+            {
+                transition.texture = resource.Cast<RGTexture>()->mTexture;
+            }
+            else
+            {
+                transition.buffer = resource.Cast<RGBuffer>()->mBuffer;
+            }
+
+            PassInfo& pass = (result.passIndex == -1) ? mLastPass : mPasses[result.passIndex];
+            if (result.isPostTransition)
+            {
+                pass.postTransitions.push_back(std::move(transition));
+            }
+            else
+            {
+                pass.transitions.push_back(std::move(transition));
+            }
+        }
+
+        // The initial states were in the structural hash, so the same states are consumed and stored.
+        for (int rgResourceIndex : compileCache.mConsumedTextureStates)
+        {
+            mTextureStateCache.ConsumeState(mResources[rgResourceIndex].Cast<RGTexture>()->mTexture);
+        }
+        for (const RGCompileCache::TextureStateResult& result : compileCache.mStoredTextureStates)
+        {
+            mTextureStateCache.StoreState(mResources[result.rgResourceIndex].Cast<RGTexture>()->mTexture, result.state);
+        }
+    }
+
+    FrameHashMap<const void*, int> RGBuilder::GetRGResourceIndicesByGAPIResource() const
+    {
+        FrameHashMap<const void*, int> rgResourceIndices;
+        for (RGResourceHandle resource : mResources)
+        {
+            if (RGTextureHandle rgTexture = resource.Cast<RGTexture>(); rgTexture.IsValid() && rgTexture->mTexture)
+            {
+                rgResourceIndices[rgTexture->mTexture.get()] = resource->mIndex;
+            }
+            else if (RGBufferHandle rgBuffer = resource.Cast<RGBuffer>(); rgBuffer.IsValid() && rgBuffer->mBuffer)
+            {
+                rgResourceIndices[rgBuffer->mBuffer.get()] = resource->mIndex;
+            }
+        }
+        return rgResourceIndices;
+    }
+
+    void RGBuilder::WriteDumpJSON(AnsiString& out) const
+    {
+        CHECK(mState == State::Executing);
+
+        const FrameHashMap<const void*, int> rgResourceIndices = GetRGResourceIndicesByGAPIResource();
+        FrameHashMap<int, const RGTransientAllocation*> transientAllocations;
+        for (const RGTransientAllocation& allocation : mTransientAllocations)
+        {
+            transientAllocations[allocation.rgResourceIndex] = &allocation;
+        }
+
+        auto Append = [&out]<typename... Args>(std::string_view formatStr, const Args&... args)
+        {
+            out += Format<FrameAnsiString>(formatStr, args...);
+        };
+        auto AppendTransitions = [&](const char* key, const FrameVector<gapi::TransitionState>& transitions)
+        {
+            Append("\"{0}\": [", key);
+            for (int i = 0; i < static_cast<int>(transitions.size()); ++i)
+            {
+                const gapi::TransitionState& transition = transitions[i];
+                const void* pResource = (transition.resourceType == gapi::TransitionState::ResourceType::Texture)
+                    ? static_cast<const void*>(transition.texture.get()) : static_cast<const void*>(transition.buffer.get());
+                auto findIt = rgResourceIndices.find(pResource);
+
+                const char* split = "None";
+                if (transition.split == gapi::TransitionState::SplitType::Begin)
+                {
+                    split = "Begin";
+                }
+                else if (transition.split == gapi::TransitionState::SplitType::End)
+                {
+                    split = "End";
+                }
+
+                Append("{0}{{\"resource\": {1}, \"src\": \"{2}\", \"dst\": \"{3}\", \"split\": \"{4}\"",
+                    (i > 0) ? ", " : "", (findIt != rgResourceIndices.end()) ? findIt->second : -1,
+                    ResourceStateFlagsToString(transition.src).c_str(), ResourceStateFlagsToString(transition.dst).c_str(), split);
+                if (transition.useSubresourceRange)
+                {
+                    Append(", \"firstMipLevel\": {0}, \"mipLevels\": {1}, \"firstSliceIndex\": {2}, \"sliceSize\": {3}}}",
+                        transition.subresourceRange.firstMipLevel, transition.subresourceRange.mipLevels,
+                        transition.subresourceRange.firstSliceIndex, transition.subresourceRange.sliceSize);
+                }
+                else
+                {
+                    Append(", \"subresourceIndex\": {0}}}", transition.subresourceIndex);
+                }
+            }
+            out += "]";
+        };
+
+        out += "{\n";
+
+        // Stats
+        Append("  \"stats\": {{\"numPasses\": {0}, \"numCulledPasses\": {1}, \"numTransientResources\": {2}, \"naiveTransientMemorySize\": {3}, "
+            "\"plannedTransientMemorySize\": {4}, \"numAliasingBarriers\": {5}, \"numTransitions\": {6}, \"numSplitTransitions\": {7}, "
+            "\"numSkippedRollbacks\": {8}, \"numRecordingSegments\": {9}, \"numAsyncComputePasses\": {10}, \"numQueueSyncs\": {11}, "
+            "\"isCompileCacheHit\": {12}}},\n",
+            mStats.numPasses, mStats.numCulledPasses, mStats.numTransientResources, mStats.naiveTransientMemorySize,
+            mStats.plannedTransientMemorySize, mStats.numAliasingBarriers, mStats.numTransitions, mStats.numSplitTransitions,
+            mStats.numSkippedRollbacks, mStats.numRecordingSegments, mStats.numAsyncComputePasses, mStats.numQueueSyncs,
+            mStats.isCompileCacheHit);
+        Append("  \"transientMemorySize\": {0},\n", mTransientMemorySize);
+
+        // Segments
+        out += "  \"segments\": [\n";
+        for (int i = 0; i < static_cast<int>(mRecordingSegments.size()); ++i)
+        {
+            const RecordingSegment& segment = mRecordingSegments[i];
+            Append("    {{\"index\": {0}, \"queue\": \"{1}\", \"beginPass\": {2}, \"endPass\": {3}, \"waitSegments\": [",
+                i, (segment.queueType == gapi::CommandListType::Compute) ? "Compute" : "Graphics", segment.beginPass, segment.endPass);
+            for (int j = 0; j < static_cast<int>(segment.waitSegments.size()); ++j)
+            {
+                Append("{0}{1}", (j > 0) ? ", " : "", segment.waitSegments[j]);
+            }
+            Append("]}}{0}\n", (i + 1 < static_cast<int>(mRecordingSegments.size())) ? "," : "");
         }
-        for (auto& [key, state] : currentBufferStates)
+        out += "  ],\n";
+
+        // Passes
+        out += "  \"passes\": [\n";
+        for (const PassInfo& pass : mPasses)
         {
-            if (key.needRollback)
+            Append("    {{\"index\": {0}, \"name\": \"{1}\", \"type\": {2}, \"queue\": \"{3}\", \"culled\": {4}, \"segment\": {5}",
+                pass.index, ToEscapedAnsiString((pass.scopeName.IsNone() ? pass.name : pass.scopeName).ToString()).c_str(), static_cast<int>(pass.type),
+                (pass.queueType == gapi::CommandListType::Compute) ? "Compute" : "Graphics", pass.isCulled, pass.segmentIndex);
+            if (pass.queueType == gapi::CommandListType::Compute)
+            {
+                Append(", \"asyncSignalPass\": {0}, \"asyncWaitPass\": {1}", pass.asyncSignalPass, pass.asyncWaitPass);
+            }
+            Append(", \"recordTimeUs\": {0:.3f}", static_cast<double>(pass.recordTime) / 1000.0);
+            if (const double gpuTimeMS = FindGPUTimeMS(pass); gpuTimeMS >= 0.0)
+            {
+                Append(", \"gpuTimeMs\": {0:.4f}", gpuTimeMS);
+            }
+
+            out += ", \"resources\": [";
+            for (int i = 0; i < static_cast<int>(pass.resourceUseInfos.size()); ++i)
             {
-                gapi::TransitionState& transition = mLastPass.transitions.emplace_back();
-                transition.resourceType = gapi::TransitionState::ResourceType::Buffer;
-                transition.buffer = key.buffer;
-                transition.src = state;
-                transition.dst = gapi::ResourceStateFlag::Common;
+                const PassInfo::ResourceUseInfo& useInfo = pass.resourceUseInfos[i];
+                Append("{0}{{\"resource\": {1}, \"state\": \"{2}\", \"write\": {3}}}",
+                    (i > 0) ? ", " : "", useInfo.rgResourceIndex, ResourceStateFlagsToString(useInfo.state).c_str(), IsWriteState(useInfo.state));
             }
+            Append("], \"numAliasingBarriers\": {0}, ", pass.aliasings.size());
+            AppendTransitions("transitions", pass.transitions);
+            out += ", ";
+            AppendTransitions("postTransitions", pass.postTransitions);
+            Append("}}{0}\n", (pass.index + 1 < static_cast<int>(mPasses.size())) ? "," : "");
         }
+        out += "  ],\n";
 
-        mCurrentPassIndex = -1;
+        out += "  ";
+        AppendTransitions("finalTransitions", mLastPass.transitions);
+        out += ",\n";
+
+        // Resources
+        out += "  \"resources\": [\n";
+        for (RGResourceHandle resource : mResources)
+        {
+            Append("    {{\"index\": {0}, \"name\": \"{1}\", \"kind\": \"{2}\", \"transient\": {3}, \"output\": {4}, \"beginPass\": {5}, \"endPass\": {6}",
+                resource->mIndex, ToEscapedAnsiString(resource->mDebugName).c_str(), RGResourceKindToString(resource->GetKind()),
+                resource->mIsTransient, resource->mIsOutput, resource->mBeginPass, resource->mEndPass);
+
+            if (const int trackedIndex = GetTrackedResourceIndex(resource->mIndex); trackedIndex != resource->mIndex)
+            {
+                Append(", \"parent\": {0}", trackedIndex);
+            }
+            if (RGTextureHandle rgTexture = resource.Cast<RGTexture>(); rgTexture.IsValid())
+            {
+                const gapi::TextureInfo& info = rgTexture->mTextureInfo;
+                Append(", \"format\": {0}, \"textureType\": {1}, \"width\": {2}, \"height\": {3}, \"depth\": {4}, \"arraySize\": {5}, \"mipLevels\": {6}",
+                    static_cast<int>(info.format), static_cast<int>(info.type), info.width, info.height, info.depth, info.arraySize, info.mipLevels);
+            }
+            else if (RGBufferHandle rgBuffer = resource.Cast<RGBuffer>(); rgBuffer.IsValid())
+            {
+                const gapi::BufferInfo& info = rgBuffer->mBufferInfo;
+                Append(", \"bufferType\": {0}, \"size\": {1}, \"stride\": {2}", static_cast<int>(info.type), info.size, info.stride);
+            }
+            if (auto findIt = transientAllocations.find(resource->mIndex); findIt != transientAllocations.end())
+            {
+                const RGTransientAllocation& allocation = *findIt->second;
+                Append(", \"transientSize\": {0}, \"transientOffset\": {1}, \"needAliasingBarrier\": {2}, \"aliasedResource\": {3}",
+                    allocation.size, allocation.offset, allocation.needAliasingBarrier, allocation.aliasedResourceIndex);
+            }
+            Append("}}{0}\n", (resource->mIndex + 1 < static_cast<int>(mResources.size())) ? "," : "");
+        }
+        out += "  ]\n";
+
+        out += "}\n";
+    }
+
+    void RGBuilder::WriteDumpDOT(AnsiString& out) const
+    {
+        CHECK(mState == State::Executing);
+
+        FrameHashMap<int, const RGTransientAllocation*> transientAllocations;
+        for (const RGTransientAllocation& allocation : mTransientAllocations)
+        {
+            transientAllocations[allocation.rgResourceIndex] = &allocation;
+        }
+
+        auto Append = [&out]<typename... Args>(std::string_view formatStr, const Args&... args)
+        {
+            out += Format<FrameAnsiString>(formatStr, args...);
+        };
+
+        out += "digraph RenderGraph {\n";
+        out += "  rankdir=LR;\n";
+        out += "  node [fontname=\"Helvetica\", fontsize=10];\n";
+
+        // Only the textures / buffers are drawn. Views are merged into them.
+        FrameVector<bool> isResourceUsed(mResources.size(), false);
+        for (const PassInfo& pass : mPasses)
+        {
+            // Scope passes without any resource only make noise in the graph.
+            if (pass.name.ToString().starts_with(CUBE_T("##")) && pass.resourceUseInfos.empty())
+            {
+                continue;
+            }
+
+            const Name label = pass.scopeName.IsNone() ? pass.name : pass.scopeName;
+            Append("  p{0} [shape=box, label=\"{1}\\ncpu: {2:.1f} us", pass.index, ToEscapedAnsiString(label.ToString()).c_str(), static_cast<double>(pass.recordTime) / 1000.0);
+            if (const double gpuTimeMS = FindGPUTimeMS(pass); gpuTimeMS >= 0.0)
+            {
+                Append("\\ngpu: {0:.3f} ms", gpuTimeMS);
+            }
+            const Uint64 numTransitions = pass.transitions.size() + pass.postTransitions.size();
+            if (numTransitions > 0)
+            {
+                Append("\\ntransitions: {0}", numTransitions);
+            }
+            out += "\"";
+            if (pass.isCulled)
+            {
+                out += ", style=dashed";
+            }
+            else if (pass.queueType == gapi::CommandListType::Compute)
+            {
+                out += ", color=blue";
+            }
+            out += "];\n";
+
+            // Edges (Read: resource -> pass, Write: pass -> resource)
+            // Ordered to write the same output in every run.
+            FrameMap<int, bool> edges; // Key: tracked resource index, Value: is write
+            for (const PassInfo::ResourceUseInfo& useInfo : pass.resourceUseInfos)
+            {
+                const int trackedIndex = GetTrackedResourceIndex(useInfo.rgResourceIndex);
+                const RGResourceKind kind = mResources[trackedIndex]->GetKind();
+                if (kind != RGResourceKind::Texture && kind != RGResourceKind::Buffer)
+                {
+                    continue;
+                }
+                isResourceUsed[trackedIndex] = true;
+                edges[trackedIndex] |= IsWriteState(useInfo.state);
+            }
+            for (const auto& [trackedIndex, isWrite] : edges)
+            {
+                if (isWrite)
+                {
+                    Append("  p{0} -> r{1};\n", pass.index, trackedIndex);
+                }
+                else
+                {
+                    Append("  r{0} -> p{1};\n", trackedIndex, pass.index);
+                }
+            }
+        }
+
+        for (RGResourceHandle resource : mResources)
+        {
+            if (!isResourceUsed[resource->mIndex])
+            {
+                continue;
+            }
+
+            Append("  r{0} [shape=ellipse, label=\"{1}", resource->mIndex, ToEscapedAnsiString(resource->mDebugName).c_str());
+            if (auto findIt = transientAllocations.find(resource->mIndex); findIt != transientAllocations.end())
+            {
+                Append("\\n{0:.1f} KiB\", style=filled, fillcolor=lightgray];\n", static_cast<double>(findIt->second->size) / 1024.0);
+            }
+            else
+            {
+                out += "\"];\n";
+            }
+        }
+
+        out += "}\n";
+    }
+
+    double RGBuilder::FindGPUTimeMS(const PassInfo& pass) const
+    {
+        if (mDumpTimestampRangeList == nullptr || mDumpTimestampRangeList->frequency == 0)
+        {
+            return -1.0;
+        }
+
+        StringView name;
+        if (pass.addTimestamp)
+        {
+            name = pass.name.ToString();
+        }
+        else if (pass.type == PassType::BeginGPUTimestamp)
+        {
+            name = pass.scopeName.ToString();
+        }
+        else
+        {
+            return -1.0;
+        }
+
+        for (const gapi::TimestampRange& range : mDumpTimestampRangeList->timestampRanges)
+        {
+            if (range.name == name)
+            {
+                return static_cast<double>(range.endTime - range.beginTime) / static_cast<double>(mDumpTimestampRangeList->frequency) * 1000.0;
+            }
+        }
+        return -1.0;
+    }
+
+    void RGBuilder::RecordSegment(int segmentIndex, gapi::CommandList& commandList)
+    {
+        CHECK(mState == State::Executing);
+
+        const RecordingSegment& segment = mRecordingSegments[segmentIndex];
+        const bool isLastSegment = (segmentIndex == static_cast<int>(mRecordingSegments.size()) - 1);
+
+        // The context is created in the recording thread to allocate in its frame allocator.
+        RecordingContext context = {
+            .segmentIndex = segmentIndex,
+            .commandList = commandList
+        };
+        context.shaderParameterListBindInfos.insert(segment.shaderParameterListBindInfos.begin(), segment.shaderParameterListBindInfos.end());
+
+        commandList.Reset();
+        commandList.Begin();
+
+        if (segmentIndex == 0)
+        {
+            commandList.BeginTimestamp(CUBE_T("RGBuilder"));
+        }
+        else if (segment.queueType == gapi::CommandListType::Compute)
+        {
+            commandList.BeginTimestamp(Format<FrameString>(CUBE_T("RGBuilder (Async Compute Segment {0})"), segmentIndex));
+        }
+        else
+        {
+            commandList.BeginTimestamp(Format<FrameString>(CUBE_T("RGBuilder (Segment {0})"), segmentIndex));
+        }
+
+        for (int beginPassIndex : segment.openScopePasses)
+        {
+            OpenScope(beginPassIndex, context, true);
+        }
+
+        // The states in the command list are not inherited from the previous segments.
+        if (segment.queueType == gapi::CommandListType::Graphics)
+        {
+            for (int i = 0; i < segment.beginPass; ++i)
+            {
+                const PassInfo& pass = mPasses[i];
+                if (pass.type == PassType::RenderState && !pass.isCulled && pass.passFunction)
+                {
+                    pass.passFunction(commandList);
+                }
+            }
+        }
+
+        for (int i = segment.beginPass; i < segment.endPass; ++i)
+        {
+            PassInfo& pass = mPasses[i];
+            if (pass.isCulled)
+            {
+                continue;
+            }
+
+            if (pass.queueType != segment.queueType)
+            {
+                // The parameter lists registered in the other queue are still used in the following passes.
+                RegisterShaderParameterLists(pass, context.shaderParameterListBindInfos);
+                continue;
+            }
+            RecordPass(pass, context);
+        }
+
+        // Close the scopes continued in the next segment.
+        for (auto it = context.openScopePasses.rbegin(); it != context.openScopePasses.rend(); ++it)
+        {
+            CloseScope(*it, context);
+        }
+        context.openScopePasses.clear();
+
+        if (isLastSegment)
+        {
+            commandList.ResourceTransition(mLastPass.transitions);
+        }
+
+        commandList.EndTimestamp();
+
+        commandList.End();
+    }
+
+    void RGBuilder::RecordPass(PassInfo& pass, RecordingContext& context)
+    {
+        CHECK(mState == State::Executing);
+
+        gapi::CommandList& commandList = context.commandList;
+
+        const bool measureRecordTime = IsDumpRequested();
+        std::chrono::steady_clock::time_point recordStartTime;
+        if (measureRecordTime)
+        {
+            recordStartTime = std::chrono::steady_clock::now();
+        }
+
+        const bool addGPUEvent = !pass.name.ToString().starts_with(CUBE_T("##"));
+
+        if (addGPUEvent)
+        {
+            commandList.BeginEvent(pass.name.ToString());
+        }
+
+        if (pass.addTimestamp)
+        {
+            commandList.BeginTimestamp(pass.name.ToString());
+        }
+
+        ResolveShaderParameterListsAndPipeline(pass, context);
+        MarkUseResources(pass, commandList);
+
+        if (!pass.aliasings.empty())
+        {
+            commandList.AliasingBarrier(pass.aliasings);
+        }
+        if (!pass.transitions.empty())
+        {
+            commandList.ResourceTransition(pass.transitions);
+        }
+        for (const SharedPtr<gapi::Texture>& texture : pass.discards)
+        {
+            commandList.DiscardResource(texture);
+        }
+
+        switch (pass.type)
+        {
+        case PassType::Normal:
+        case PassType::RenderState:
+            if (pass.passFunction)
+            {
+                pass.passFunction(commandList);
+            }
+            break;
+        case PassType::BeginRenderPass:
+        case PassType::BeginGPUEvent:
+        case PassType::BeginGPUTimestamp:
+            OpenScope(pass.index, context, false);
+            break;
+        case PassType::EndRenderPass:
+        case PassType::EndGPUEvent:
+        case PassType::EndGPUTimestamp:
+            CloseScope(PopScope(context.openScopePasses, pass.type), context);
+            break;
+        }
+
+        if (!pass.postTransitions.empty())
+        {
+            commandList.ResourceTransition(pass.postTransitions);
+        }
+
+        if (pass.addTimestamp)
+        {
+            commandList.EndTimestamp();
+        }
+
+        if (addGPUEvent)
+        {
+            commandList.EndEvent();
+        }
+
+        if (measureRecordTime)
+        {
+            pass.recordTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - recordStartTime).count();
+        }
+    }
+
+    void RGBuilder::OpenScope(int beginPassIndex, RecordingContext& context, bool isContinued)
+    {
+        const PassInfo& beginPass = mPasses[beginPassIndex];
+        gapi::CommandList& commandList = context.commandList;
+
+        switch (beginPass.type)
+        {
+        case PassType::BeginRenderPass:
+        {
+            auto findIt = mRenderPassInfos.find(beginPassIndex);
+            CHECK(findIt != mRenderPassInfos.end());
+            const RenderPassInfo& info = findIt->second;
+
+            // Load the contents written in the previous segment and store them for the next segment.
+            const bool storeContents = IsScopeOpenAtSegmentEnd(beginPassIndex, context.segmentIndex);
+
+            FrameVector<gapi::ColorAttachment> colors(info.colors.size());
+            for (int i = 0; i < colors.size(); ++i)
+            {
+                colors[i] = {
+                    .rtv = info.colors[i].color->GetRTV(),
+                    .loadOperation = isContinued ? gapi::LoadOperation::Load : info.colors[i].loadOperation,
+                    .storeOperation = storeContents ? gapi::StoreOperation::Store : info.colors[i].storeOperation,
+                    .clearColor = info.colors[i].clearColor
+                };
+            }
+
+            gapi::DepthStencilAttachment depthStencil = {
+                .dsv = info.depthStencil.dsv.IsValid() ? info.depthStencil.dsv->GetDSV() : nullptr,
+                .loadOperation = isContinued ? gapi::LoadOperation::Load : info.depthStencil.loadOperation,
+                .storeOperation = storeContents ? gapi::StoreOperation::Store : info.depthStencil.storeOperation,
+                .clearDepth = info.depthStencil.clearDepth
+            };
+
+            commandList.BeginRenderPass(colors, depthStencil);
+            break;
+        }
+        case PassType::BeginGPUEvent:
+            commandList.BeginEvent(beginPass.scopeName.ToString());
+            break;
+        case PassType::BeginGPUTimestamp:
+            if (isContinued)
+            {
+                commandList.BeginTimestamp(Format<FrameString>(CUBE_T("{0} (Segment {1})"), beginPass.scopeName.ToString(), context.segmentIndex));
+            }
+            else
+            {
+                commandList.BeginTimestamp(beginPass.scopeName.ToString());
+            }
+            break;
+        default:
+            NO_ENTRY_FORMAT("Pass type {0} does not begin a scope.", static_cast<int>(beginPass.type));
+            return;
+        }
+
+        context.openScopePasses.push_back(beginPassIndex);
+    }
+
+    void RGBuilder::CloseScope(int beginPassIndex, RecordingContext& context)
+    {
+        gapi::CommandList& commandList = context.commandList;
+
+        switch (mPasses[beginPassIndex].type)
+        {
+        case PassType::BeginRenderPass:
+            commandList.EndRenderPass();
+            break;
+        case PassType::BeginGPUEvent:
+            commandList.EndEvent();
+            break;
+        case PassType::BeginGPUTimestamp:
+            commandList.EndTimestamp();
+            break;
+        default:
+            NO_ENTRY_FORMAT("Pass type {0} does not begin a scope.", static_cast<int>(mPasses[beginPassIndex].type));
+            break;
+        }
+    }
+
+    int RGBuilder::PopScope(FrameVector<int>& openScopePasses, PassType endType) const
+    {
+        PassType beginType = PassType::Normal;
+        switch (endType)
+        {
+        case PassType::EndRenderPass:
+            beginType = PassType::BeginRenderPass;
+            break;
+        case PassType::EndGPUEvent:
+            beginType = PassType::BeginGPUEvent;
+            break;
+        case PassType::EndGPUTimestamp:
+            beginType = PassType::BeginGPUTimestamp;
+            break;
+        default:
+            NO_ENTRY_FORMAT("Pass type {0} does not end a scope.", static_cast<int>(endType));
+            break;
+        }
+
+        for (int i = static_cast<int>(openScopePasses.size()) - 1; i >= 0; --i)
+        {
+            const int beginPassIndex = openScopePasses[i];
+            if (mPasses[beginPassIndex].type == beginType)
+            {
+                openScopePasses.erase(openScopePasses.begin() + i);
+                return beginPassIndex;
+            }
+        }
+
+        NO_ENTRY_FORMAT("Scope is ended but not begun.");
+        return -1;
+    }
+
+    bool RGBuilder::IsScopeOpenAtSegmentEnd(int beginPassIndex, int segmentIndex) const
+    {
+        const int nextSegmentIndex = mRecordingSegments[segmentIndex].nextSegmentIndex;
+        if (nextSegmentIndex == -1)
+        {
+            return false;
+        }
+
+        const FrameVector<int>& nextOpenScopePasses = mRecordingSegments[nextSegmentIndex].openScopePasses;
+        return std::find(nextOpenScopePasses.begin(), nextOpenScopePasses.end(), beginPassIndex) != nextOpenScopePasses.end();
     }
 
     void RGBuilder::Reset()
@@ -1218,14 +3627,28 @@ namespace cube
         mCachedTextureViews.clear();
         for (RGResourceHandle resource : mResources)
         {
-            delete resource.mResource;
+            resource.mResource->~RGResource();
+            mAllocator.FreeAligned(resource.mResource);
         }
         mResources.clear();
+        mTransientAllocations.clear();
+        mTransientMemorySize = 0;
+        mTransientMemoryAlignment = 1;
+        mTransientMemory = {};
+        mConsumedTextureStates.clear();
+        mStoredTextureStates.clear();
 
         mRenderPassIndex = -1;
         mAttachedDSVInRenderPass = {};
         mAttachedRTVsInRenderPass.clear();
         mIsInRenderPass = false;
+        mCurrentRenderPassBeginIndex = -1;
+        mRenderPassInfos.clear();
+        mRecordingSegments.clear();
+
+        mDumpJSON = nullptr;
+        mDumpDOT = nullptr;
+        mDumpTimestampRangeList = nullptr;
 
         mState = State::Init;
     }
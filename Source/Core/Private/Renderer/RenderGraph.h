@@ -2,27 +2,36 @@
 
 #include "CoreHeader.h"
 
+#include "Allocator/FrameAllocator.h"
 #include "Checker.h"
 #include "Engine.h"
 #include "GAPI_CommandList.h"
+#include "GAPI_Timestamp.h"
+#include "Name.h"
 #include "Renderer/RenderGraphTypes.h"
 #include "Renderer/Renderer.h"
 #include "Renderer/ShaderParameter.h"
 
 namespace cube
 {
+    class JobSystem;
     class RGBuilder;
 
     // ===== Builder =====
 
-    class RGBuilder
+    class CUBE_CORE_EXPORT RGBuilder
     {
+        friend class RGGPUEventScope;
+        friend class RGGPUTimestampScope;
+
     public:
         using UseResourceFunction = std::function<void(RGBuilder& /*builder*/)>;
         using PassFunction = std::function<void(gapi::CommandList& /*commandList*/)>;
 
     public:
         RGBuilder(Renderer& renderer);
+        // Builder without the renderer. Dummy textures and mesh draws cannot be used. (Used in the tests)
+        RGBuilder(GAPI& gapi, RGTextureStateCache& textureStateCache);
         ~RGBuilder();
 
         RGBufferHandle RegisterBuffer(SharedPtr<gapi::Buffer> buffer);
@@ -48,10 +57,10 @@ namespace cube
         RGShaderParameterListHandle<ShaderParameterListType> CreateShaderParameterList()
         {
             ShaderParameterListManager& shaderParameterListManager = Engine::GetRenderer()->GetShaderParameterListManager();
-            SharedPtr<ShaderParameterListType> parameterList = shaderParameterListManager.CreateShaderParameterList<ShaderParameterListType>();
+            SharedPtr<ShaderParameterListType> parameterList = shaderParameterListManager.CreateShaderParameterList<ShaderParameterListType>(FrameAllocator::StdAllocator<ShaderParameterListType>(mAllocator));
             const ShaderParameterListInfo& parameterListInfo = ShaderParameterListManager::GetShaderParameterListInfo<ShaderParameterListType>();
 
-            RGShaderParameterListHandle<ShaderParameterListType> rgParameterList(new RGShaderParameterList<ShaderParameterListType>(mResources.size(), parameterList, parameterListInfo));
+            RGShaderParameterListHandle<ShaderParameterListType> rgParameterList(AllocateResource<RGShaderParameterList<ShaderParameterListType>>(parameterList, parameterListInfo));
             mResources.push_back(rgParameterList);
 
             return rgParameterList;
@@ -95,7 +104,7 @@ namespace cube
             requires std::derived_from<ShaderParameterListType, ShaderParameterList>
         void BindShaderParameterList(RGShaderParameterListHandle<ShaderParameterListType> parameterList)
         {
-            BindShaderParameterListInternal(ShaderParameterListType::GetName(), parameterList);
+            BindShaderParameterListInternal(parameterList);
         }
 
         template <typename... T>
@@ -105,18 +114,20 @@ namespace cube
             return { params... };
         }
 
-        void AddPass(StringView name,
+        // If isCompute is true, the pass function only uses compute / copy commands
+        // and the pass can be run in the async compute queue.
+        void AddPass(Name name,
             PassFunction&& passFunction, UseResourceFunction&& useResourceFunction = [](RGBuilder&) {},
             bool isCompute = false, bool addTimestamp = false
         )
         {
             AddPassInternal(name, nullptr, nullptr, {},
                 std::move(passFunction), std::move(useResourceFunction),
-                addTimestamp
+                addTimestamp, isCompute
             );
         }
 
-        void AddPass(StringView name, SharedPtr<GraphicsPipeline> graphicsPipeline,
+        void AddPass(Name name, SharedPtr<GraphicsPipeline> graphicsPipeline,
              PassFunction&& passFunction,
              bool addTimestamp = false
         )
@@ -127,7 +138,7 @@ namespace cube
             );
         }
 
-        void AddPass(StringView name, SharedPtr<GraphicsPipeline> graphicsPipeline, RGShaderParameterListBaseHandle parameterList,
+        void AddPass(Name name, SharedPtr<GraphicsPipeline> graphicsPipeline, RGShaderParameterListBaseHandle parameterList,
             PassFunction&& passFunction,
             bool addTimestamp = false
         )
@@ -138,7 +149,7 @@ namespace cube
             );
         }
 
-        void AddPass(StringView name, SharedPtr<GraphicsPipeline> graphicsPipeline, ConstArrayView<RGShaderParameterListBaseHandle> parameterLists,
+        void AddPass(Name name, SharedPtr<GraphicsPipeline> graphicsPipeline, ConstArrayView<RGShaderParameterListBaseHandle> parameterLists,
             PassFunction&& passFunction,
             bool addTimestamp = false
         )
@@ -149,29 +160,36 @@ namespace cube
             );
         }
 
-        void AddPass(StringView name, SharedPtr<ComputePipeline> computePipeline, RGShaderParameterListBaseHandle parameterList,
+        // The pass with isAsyncCompute runs in the async compute queue if it is executed with RGCommandListPool.
+        void AddPass(Name name, SharedPtr<ComputePipeline> computePipeline, RGShaderParameterListBaseHandle parameterList,
             PassFunction&& passFunction,
-            bool addTimestamp = false
+            bool addTimestamp = false, bool isAsyncCompute = false
         )
         {
             AddPassInternal(name, nullptr, computePipeline, { &parameterList, 1 },
                 std::move(passFunction), nullptr,
-                addTimestamp
+                addTimestamp, isAsyncCompute
             );
         }
 
-        void AddPass(StringView name, SharedPtr<ComputePipeline> computePipeline, ConstArrayView<RGShaderParameterListBaseHandle> parameterLists,
+        void AddPass(Name name, SharedPtr<ComputePipeline> computePipeline, ConstArrayView<RGShaderParameterListBaseHandle> parameterLists,
             PassFunction&& passFunction,
-            bool addTimestamp = false
+            bool addTimestamp = false, bool isAsyncCompute = false
         )
         {
             AddPassInternal(name, nullptr, computePipeline, parameterLists,
                 std::move(passFunction), nullptr,
-                addTimestamp
+                addTimestamp, isAsyncCompute
             );
         }
 
-        void AddDrawMeshPass(StringView name, ArrayView<DrawMeshInfo> drawMeshInfos, ConstArrayView<RGShaderParameterListBaseHandle> parameterLists);
+        // Pass which only sets states kept in the command list (viewport, scissor, primitive topology).
+        // It is recorded again at the beginning of every following command list segment,
+        // so it should not need a render pass.
+        void AddRenderStatePass(Name name, PassFunction&& passFunction);
+
+        // The meshes with the same mesh, materials and states are drawn with one instanced draw per sub mesh.
+        void AddDrawMeshPass(Name name, ArrayView<DrawMeshInfo> drawMeshInfos, ConstArrayView<RGShaderParameterListBaseHandle> parameterLists);
 
         void UseResource(RGBufferSRVHandle rgSRV);
         void UseResource(RGBufferUAVHandle rgUAV);
@@ -181,17 +199,66 @@ namespace cube
         void UseResource(RGTextureDSVHandle rgDSV);
         void UseResource(RGTextureHandle rgTexture, gapi::SubresourceRangeInput range, gapi::ResourceStateFlags states);
 
+        // Keep the passes writing the resource even if no other pass reads it.
+        // Registered resources are always treated as outputs.
+        void MarkAsOutput(RGBufferHandle rgBuffer);
+        void MarkAsOutput(RGTextureHandle rgTexture);
+
+        // All passes are recorded into the command list. Async compute passes are run in it as well.
         void ExecuteAndSubmit(gapi::CommandList& commandList, bool waitUntilFinished = false);
+        // Split the passes into contiguous segments and record each segment into the command list from the pool.
+        // The segments are recorded in the jobs (or sequentially in the calling thread if it is null)
+        // and submitted in order. Async compute passes are recorded into the compute command lists.
+        // If the compile cache is given and the graph has the same structure as the last one executed with it,
+        // the compile results are replayed from it instead of being built again.
+        void ExecuteAndSubmit(RGCommandListPool& commandListPool, JobSystem* jobSystem, RGCompileCache* compileCache = nullptr, bool waitUntilFinished = false);
+
+        // Dump the compiled graph into JSON / GraphViz DOT in the next ExecuteAndSubmit. Either output can be null.
+        // The CPU record time of each pass is measured while dumping. If the timestamps are given,
+        // the GPU time of the passes with a timestamp is matched by the name.
+        void RequestDump(AnsiString* outJSON, AnsiString* outDOT, const gapi::TimestampRangeList* timestampRangeList = nullptr);
+
+        // Stats of the last ExecuteAndSubmit.
+        const RGBuilderStats& GetStats() const { return mStats; }
+        // Schedule of the async compute passes in the last ExecuteAndSubmit.
+        const RGFrameAsyncComputePlan& GetAsyncComputePlan() const { return mAsyncComputePlan; }
 
     private:
+        // Segments smaller than it are not worth the cost of an additional command list.
+        static constexpr int MIN_NUM_PASSES_PER_SEGMENT = 32;
+        // More segments than it only add the command lists and the submissions.
+        static constexpr int MAX_NUM_RECORDING_SEGMENTS = 4;
+
+        enum class PassType
+        {
+            Normal,
+            RenderState,
+            BeginRenderPass,
+            EndRenderPass,
+            BeginGPUEvent,
+            EndGPUEvent,
+            BeginGPUTimestamp,
+            EndGPUTimestamp
+        };
+
         struct PassInfo
         {
             // Set in AddPass
-            String name;
+            Name name;
+            PassType type = PassType::Normal;
+            // Name of the event / timestamp in BeginGPUEvent / BeginGPUTimestamp.
+            // In ##BindShaderParameterList, name of the parameter list. (Only for the dump)
+            Name scopeName;
             bool addTimestamp = false;
             int index = -1;
+            // Index of ##BeginRenderPass if the pass is in a render pass. (-1 if not)
+            int renderPassBeginIndex = -1;
+            // The pass depends on the command list states set in the previous pass. (ex: index buffer)
+            // A segment does not begin at it.
+            bool keepWithPreviousPass = false;
+            bool requestsAsyncCompute = false;
 
-            Vector<RGShaderParameterListBaseHandle> shaderParameterLists;
+            FrameVector<RGShaderParameterListBaseHandle> shaderParameterLists;
 
             SharedPtr<GraphicsPipeline> graphicsPipeline = nullptr;
             SharedPtr<ComputePipeline> computePipeline = nullptr;
@@ -206,45 +273,155 @@ namespace cube
                 gapi::ResourceStateFlags state;
                 gapi::SubresourceRange subresourceRange;
             };
-            Vector<ResourceUseInfo> resourceUseInfos;
-
-            Vector<gapi::TransitionState> transitions;
+            FrameVector<ResourceUseInfo> resourceUseInfos;
+            // Resources which should be alive in the pass without any transition.
+            FrameVector<int> lifetimeOnlyResourceIndices;
+
+            bool isCulled = false;
+            int segmentIndex = 0;
+
+            gapi::CommandListType queueType = gapi::CommandListType::Graphics;
+            // Only in the async compute pass. The pass overlaps the graphics passes in (asyncSignalPass, asyncWaitPass).
+            int asyncSignalPass = -1; // Graphics pass which the compute queue waits for
+            int asyncWaitPass = -1; // Graphics pass which waits for the pass (The number of passes if it is the end of the graph)
+
+            FrameVector<gapi::AliasingState> aliasings;
+            // Aliased render targets / depth stencils which are discarded after the transitions.
+            FrameVector<SharedPtr<gapi::Texture>> discards;
+            FrameVector<gapi::TransitionState> transitions;
+            // Recorded after the pass function. (Transitions of the async compute passes which the compute queue cannot do)
+            FrameVector<gapi::TransitionState> postTransitions;
+
+            Uint64 recordTime = 0; // In nanoseconds. Only measured while dumping.
         };
 
-        void BindShaderParameterListInternal(StringView name, RGShaderParameterListBaseHandle parameterList);
+        // RG resources are allocated in the frame allocator and destroyed at once in Reset().
+        template <typename RGResourceType, typename... Args>
+        RGResourceType* AllocateResource(Args&&... args)
+        {
+            void* ptr = mAllocator.AllocateAligned(sizeof(RGResourceType), alignof(RGResourceType));
+            return new (ptr) RGResourceType(static_cast<int>(mResources.size()), std::forward<Args>(args)...);
+        }
+
+        void BindShaderParameterListInternal(RGShaderParameterListBaseHandle parameterList);
 
-        void AddPassInternal(StringView name, SharedPtr<GraphicsPipeline> graphicsPipeline, SharedPtr<ComputePipeline> computePipeline, ConstArrayView<RGShaderParameterListBaseHandle> parameterLists,
+        void AddPassInternal(Name name, SharedPtr<GraphicsPipeline> graphicsPipeline, SharedPtr<ComputePipeline> computePipeline, ConstArrayView<RGShaderParameterListBaseHandle> parameterLists,
             PassFunction&& passFunction, UseResourceFunction&& useResourceFunction,
-            bool addTimestamp
+            bool addTimestamp, bool isAsyncCompute = false
         );
 
-        void ResolveShaderParameterListsAndPipeline(PassInfo& pass, gapi::CommandList& commandList);
+        void AddScopePass(PassType type, Name name);
+
+        struct ShaderParameterListBindInfo
+        {
+            SharedPtr<gapi::Buffer> GPUBuffer = nullptr;
+            SharedPtr<gapi::BufferSRV> srv = nullptr;
+            int bindIndex = -1;
+        };
+
+        // Contiguous passes recorded into one command list.
+        struct RecordingSegment
+        {
+            // [beginPass, endPass). Only the passes in the same queue are recorded.
+            int beginPass;
+            int endPass;
+            gapi::CommandListType queueType;
+            int nextSegmentIndex = -1; // Next segment in the same queue (-1 if none)
+            // Segments in the other queue which should be finished before the segment begins.
+            FrameVector<int> waitSegments;
+
+            // Begin passes of the render pass / events / timestamps opened in the previous segments.
+            // They are opened again at the beginning of the segment in order.
+            FrameVector<int> openScopePasses;
+            // Parameter lists registered in the previous segments. Their bind index is not set.
+            FrameFlatHashMap<Name, ShaderParameterListBindInfo> shaderParameterListBindInfos; // Key: name in ShaderParameterListInfo
+        };
+
+        // Binding states of the command list which records a segment.
+        struct RecordingContext
+        {
+            int segmentIndex;
+            gapi::CommandList& commandList;
+
+            FrameFlatHashMap<Name, ShaderParameterListBindInfo> shaderParameterListBindInfos; // Key: name in ShaderParameterListInfo
+            SharedPtr<GraphicsPipeline> boundGraphicsPipeline;
+            SharedPtr<ComputePipeline> boundComputePipeline;
+
+            FrameVector<int> openScopePasses;
+        };
+
+        void ExecuteAndSubmitInternal(RGCommandListPool* commandListPool, gapi::CommandList* commandList, JobSystem* jobSystem, RGCompileCache* compileCache, bool waitUntilFinished);
+
+        void RegisterShaderParameterLists(const PassInfo& pass, FrameFlatHashMap<Name, ShaderParameterListBindInfo>& inOutBindInfos) const;
+        void ResolveShaderParameterListsAndPipeline(PassInfo& pass, RecordingContext& context);
         void MarkUseResources(PassInfo& pass, gapi::CommandList& commandList);
 
+        // Views are tracked by their texture / buffer.
+        int GetTrackedResourceIndex(int rgResourceIndex) const;
+
         void UpdateResourceUsages();
+        void CullPasses();
+        void ScheduleAsyncComputePasses(bool enableAsyncCompute);
+        void UpdateResourceLifetimes();
+        void PlanTransientMemory();
+        void AllocateTransientMemory();
         void CreateAllResources();
+        void PlanRecordingSegments(int maxNumSegments);
+        void UpdateSegmentCarryOvers();
         void ResolveTransitions();
 
+        // Hash of everything the compile results depend on. (passes, resource descriptors, used ranges / states, initial states)
+        // Per-frame data such as the pass functions and the contents of the parameter lists are not included.
+        Uint64 CalculateStructuralHash(bool enableAsyncCompute, int maxNumSegments) const;
+        void SaveCompileResults(RGCompileCache& compileCache, Uint64 structuralHash) const;
+        // Load the results before AllocateTransientMemory() and replay the transitions after CreateAllResources().
+        void LoadCompileResults(const RGCompileCache& compileCache);
+        void ReplayTransitions(const RGCompileCache& compileCache);
+
+        // Index of the RG texture / buffer which has the GAPI resource. Used to find the resources of the transitions.
+        FrameHashMap<const void*, int> GetRGResourceIndicesByGAPIResource() const;
+
+        bool IsDumpRequested() const { return mDumpJSON != nullptr || mDumpDOT != nullptr; }
+        void WriteDumpJSON(AnsiString& out) const;
+        void WriteDumpDOT(AnsiString& out) const;
+        // Returns -1 if there is no matched timestamp.
+        double FindGPUTimeMS(const PassInfo& pass) const;
+
+        void RecordSegment(int segmentIndex, gapi::CommandList& commandList);
+        void RecordPass(PassInfo& pass, RecordingContext& context);
+        void OpenScope(int beginPassIndex, RecordingContext& context, bool isContinued);
+        void CloseScope(int beginPassIndex, RecordingContext& context);
+        // Remove the last open scope matched with the end type and return its begin pass index.
+        int PopScope(FrameVector<int>& openScopePasses, PassType endType) const;
+        bool IsScopeOpenAtSegmentEnd(int beginPassIndex, int segmentIndex) const;
+
         void Reset();
 
-        Renderer& mRenderer;
+        Renderer* mRenderer; // Can be null
+        GAPI& mGAPI;
+        RGTextureStateCache& mTextureStateCache;
+        // All per-frame data of the builder is allocated in it.
+        FrameAllocator& mAllocator;
 
-        Vector<PassInfo> mPasses;
+        FrameVector<PassInfo> mPasses;
         int mCurrentPassIndex = -1;
         PassInfo mLastPass;
 
-        Vector<RGResourceHandle> mResources;
-        Map<gapi::Buffer*, RGBufferHandle> mRegisteredBuffers;
-        Map<gapi::Texture*, RGTextureHandle> mRegisteredTextures;
+        FrameVector<RGResourceHandle> mResources;
+        FrameMap<gapi::Buffer*, RGBufferHandle> mRegisteredBuffers;
+        FrameMap<gapi::Texture*, RGTextureHandle> mRegisteredTextures;
 
         // Caches to avoid creating duplicated views with the same parameters.
         // The view type is encoded into the cache key, so each base map can hold every view kind.
-        HashMap<Uint64, RGBufferViewHandle> mCachedBufferViews;
-        HashMap<Uint64, RGTextureViewHandle> mCachedTextureViews;
+        FrameFlatHashMap<Uint64, RGBufferViewHandle> mCachedBufferViews;
+        FrameFlatHashMap<Uint64, RGTextureViewHandle> mCachedTextureViews;
         RGTextureSRVHandle mDummyBlackTexture2D;
         RGTextureSRVHandle mDummyBlackTextureCube;
         RGTextureSRVHandle mDummyWhiteTexture2D;
 
+        Uint32 mNumMeshDraws = 0;
+        Uint32 mNumMeshInstances = 0;
+
         enum class State
         {
             Init,
@@ -254,23 +431,31 @@ namespace cube
         };
         State mState = State::Init;
         bool mIsInRenderPass = false;
-        Vector<gapi::ElementFormat> mRenderPassRenderTargetFormats;
+        int mCurrentRenderPassBeginIndex = -1;
+        FrameVector<gapi::ElementFormat> mRenderPassRenderTargetFormats;
         gapi::ElementFormat mRenderPassDepthStencilFormat = gapi::ElementFormat::Unknown;
         // TODO: Group variables in each used states.
         int mRenderPassIndex = -1;
-        Vector<RGTextureRTVHandle> mAttachedRTVsInRenderPass;
+        FrameVector<RGTextureRTVHandle> mAttachedRTVsInRenderPass;
         RGTextureDSVHandle mAttachedDSVInRenderPass;
+        FrameHashMap<int, RenderPassInfo> mRenderPassInfos; // Key: index of ##BeginRenderPass
 
-        struct ShaderParameterListBindInfo
-        {
-            SharedPtr<gapi::Buffer> GPUBuffer = nullptr;
-            SharedPtr<gapi::BufferSRV> srv = nullptr;
-            int bindIndex = -1;
-        };
-        Map<String, ShaderParameterListBindInfo> mShaderParameterListBindInfos;
+        FrameVector<RecordingSegment> mRecordingSegments;
+        RGFrameAsyncComputePlan mAsyncComputePlan;
+
+        FrameVector<RGTransientAllocation> mTransientAllocations;
+        Uint64 mTransientMemorySize = 0;
+        Uint64 mTransientMemoryAlignment = 1;
+        gapi::TransientMemory mTransientMemory;
+        // Registered textures whose states are consumed from / stored to RGTextureStateCache in ResolveTransitions().
+        FrameVector<int> mConsumedTextureStates;
+        FrameVector<int> mStoredTextureStates;
+
+        RGBuilderStats mStats;
 
-        SharedPtr<GraphicsPipeline> mCurrentBoundGraphicsPipeline;
-        SharedPtr<ComputePipeline> mCurrentBoundComputePipeline;
+        AnsiString* mDumpJSON = nullptr;
+        AnsiString* mDumpDOT = nullptr;
+        const gapi::TimestampRangeList* mDumpTimestampRangeList = nullptr;
     };
 
     // ===== Utility =====
@@ -278,14 +463,14 @@ namespace cube
     class RGGPUEventScope
 	{
 	public:
-		RGGPUEventScope(RGBuilder& builder, StringView name)
+		RGGPUEventScope(RGBuilder& builder, Name name)
 		    : mCurrentBuilder(builder)
 		{
-            mCurrentBuilder.AddPass(CUBE_T("##BeginGPUEventScope"), [strName = String(name)](gapi::CommandList& commandList){ commandList.BeginEvent(strName); });
+            mCurrentBuilder.AddScopePass(RGBuilder::PassType::BeginGPUEvent, name);
 		}
 		~RGGPUEventScope()
 		{
-            mCurrentBuilder.AddPass(CUBE_T("##EndGPUEventScope"), [](gapi::CommandList& commandList){ commandList.EndEvent(); });
+            mCurrentBuilder.AddScopePass(RGBuilder::PassType::EndGPUEvent, {});
 		}
 
 		RGGPUEventScope(const RGGPUEventScope& other) = delete;
@@ -299,24 +484,14 @@ namespace cube
     class RGGPUTimestampScope
     {
     public:
-        RGGPUTimestampScope(RGBuilder& builder, StringView name)
+        RGGPUTimestampScope(RGBuilder& builder, Name name)
             : mBuilder(builder)
         {
-            mBuilder.AddPass(CUBE_T("##BeginGPUTimestampScope"),
-                [strName = String(name)](gapi::CommandList& commandList)
-                {
-                    commandList.BeginTimestamp(strName);
-                }
-            );
+            mBuilder.AddScopePass(RGBuilder::PassType::BeginGPUTimestamp, name);
         }
         ~RGGPUTimestampScope()
         {
-            mBuilder.AddPass(CUBE_T("##EndGPUTimestampScope"),
-                [](gapi::CommandList& commandList)
-                {
-                    commandList.EndTimestamp();
-                }
-            );
+            mBuilder.AddScopePass(RGBuilder::PassType::EndGPUTimestamp, {});
         }
 
         RGGPUTimestampScope(const RGGPUTimestampScope& other) = delete;
@@ -54,6 +54,7 @@ namespace cube
 
     void RenderUtils::Shutdown()
     {
+        mCopyTexturePSPassNames.clear();
         mCopyTexturePSPipelineInfo = {};
         mCopyTexturePS = nullptr;
 
@@ -89,7 +90,14 @@ namespace cube
             .debugName = CUBE_T("CopyTexturePS Pipeline")
         });
 
-        builder.AddPass(Format<FrameString>(CUBE_T("CopyTexturePS ({0} -> {1})"), src->GetDebugName(), dst->GetDebugName()),
+        const Uint64 passNameKey = HashCombine(CalculateNameHash(src->GetDebugName()), CalculateNameHash(dst->GetDebugName()));
+        auto passNameIt = mCopyTexturePSPassNames.find(passNameKey);
+        if (passNameIt == mCopyTexturePSPassNames.end())
+        {
+            passNameIt = mCopyTexturePSPassNames.insert({ passNameKey, Name(Format<FrameString>(CUBE_T("CopyTexturePS ({0} -> {1})"), src->GetDebugName(), dst->GetDebugName())) }).first;
+        }
+
+        builder.AddPass(passNameIt->second,
             copyTexturePSPipeline,
             params,
             [](gapi::CommandList& commandList){
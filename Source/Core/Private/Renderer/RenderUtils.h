@@ -2,6 +2,8 @@
 
 #include "CoreHeader.h"
 
+#include "FlatHashMap.h"
+#include "Name.h"
 #include "Pipeline.h"
 
 namespace cube
@@ -28,5 +30,7 @@ namespace cube
 
         SharedPtr<Shader> mCopyTexturePS;
         GraphicsPipelineInfo mCopyTexturePSPipelineInfo;
+        // Pass names by the hash of the source and destination names, so each pair is interned once.
+        FlatHashMap<Uint64, Name> mCopyTexturePSPassNames;
     };
 } // namespace cube
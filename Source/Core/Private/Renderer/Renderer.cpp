@@ -1,8 +1,11 @@
 #include "Renderer.h"
 
+#include <bit>
+#include <chrono>
 #include "imguizmo_quat/imGuIZMOquat.h"
 #include "imgui.h"
 
+#include "Allocator/SharedFrameAllocator.h"
 #include "Checker.h"
 #include "Engine.h"
 #include "FileSystem.h"
@@ -10,6 +13,7 @@
 #include "GAPI_Pipeline.h"
 #include "GAPI_Shader.h"
 #include "GAPI_SwapChain.h"
+#include "JobSystem.h"
 #include "Material.h"
 #include "MatrixUtility.h"
 #include "MeshHelper.h"
@@ -43,6 +47,20 @@ namespace cube
 
         mNumGPUSync = numGPUSync;
         mCurrentRenderingFrame = 0;
+        mInstanceBufferPools.resize(mNumGPUSync);
+
+        if (AnsiStringView rgDumpParam = Engine::GetCommandLineParam("rgdump"); !rgDumpParam.empty())
+        {
+            try
+            {
+                mRGDumpFrame = std::stoull(AnsiString(rgDumpParam));
+                CUBE_LOG(Info, Renderer, "The render graph will be dumped in frame {0}.", mRGDumpFrame);
+            }
+            catch (...)
+            {
+                CUBE_LOG(Error, Renderer, "Invalid --rgdump frame ({0}). Must be an integer.", rgDumpParam);
+            }
+        }
 
         // GAPI init
         platform::FilePath dLibPath;
@@ -92,6 +110,8 @@ namespace cube
             .debugName = CUBE_T("MainCommandList")
         });
 
+        mRGCommandListPool.Initialize(*mGAPI);
+
         mViewportWidth = platform::Platform::GetWindowWidth();
         mViewportHeight = platform::Platform::GetWindowHeight();
         mSwapChain = mGAPI->CreateSwapChain({
@@ -133,7 +153,18 @@ namespace cube
         mCurrentBackbuffer = nullptr;
         mSwapChain = nullptr;
 
+        mRGCommandListPool.Shutdown();
         mCommandList = nullptr;
+        mRGTextureStateCache.Clear();
+        mRGCompileCache.Clear();
+        for (InstanceBufferPool& pool : mInstanceBufferPools)
+        {
+            for (InstanceBuffer& instanceBuffer : pool.buffers)
+            {
+                instanceBuffer.buffer->Unmap();
+            }
+        }
+        mInstanceBufferPools.clear();
 
         mPipelineManager.Shutdown();
         mSamplerManager.Shutdown();
@@ -206,6 +237,39 @@ namespace cube
 
             ImGui::Checkbox("Wireframe", &mWireframe);
 
+            static auto GetFrustumCullingModeStr = [](FrustumCullingMode mode) -> const char*
+            {
+                switch (mode)
+                {
+                case FrustumCullingMode::None: return "None";
+                case FrustumCullingMode::Flat: return "Flat";
+                case FrustumCullingMode::BVH: return "BVH";
+                case FrustumCullingMode::Num: return "Num";
+                }
+                return "";
+            };
+
+            ImGui::SetNextItemWidth(160);
+            if (ImGui::BeginCombo("Frustum Culling", GetFrustumCullingModeStr(mFrustumCullingMode)))
+            {
+                for (Uint32 i = 0; i < static_cast<Uint32>(FrustumCullingMode::Num); ++i)
+                {
+                    const bool selected = static_cast<Uint32>(mFrustumCullingMode) == i;
+                    const FrustumCullingMode currentMode = static_cast<FrustumCullingMode>(i);
+                    if (ImGui::Selectable(GetFrustumCullingModeStr(currentMode), selected))
+                    {
+                        mFrustumCullingMode = currentMode;
+                    }
+
+                    if (selected)
+                    {
+                        ImGui::SetItemDefaultFocus();
+                    }
+                }
+
+                ImGui::EndCombo();
+            }
+
             ImGui::SeparatorText("Texture Viewer");
             if (ImGui::Button("Show"))
             {
@@ -222,6 +286,8 @@ namespace cube
         mGAPI->BeginRenderingFrame();
         mShaderParameterListManager.MoveNextFrame();
         mTextureViewer.MoveToNextFrame();
+        mRGTextureStateCache.RemoveExpiredStates();
+        mInstanceBufferPools[mCurrentRenderingFrame % mNumGPUSync].numUsedBuffers = 0;
 
         SetGlobalConstantBuffers();
 
@@ -261,7 +327,7 @@ namespace cube
             mCommandList->ResourceTransition({
                 .resourceType = gapi::TransitionState::ResourceType::Texture,
                 .texture = mCurrentBackbuffer,
-                .src =  gapi::ResourceStateFlag::Common,
+                .src = mRGTextureStateCache.ConsumeState(mCurrentBackbuffer),
                 .dst = gapi::ResourceStateFlag::Present
             });
 
@@ -322,6 +388,40 @@ namespace cube
         }
     }
 
+    Renderer::InstanceBuffer Renderer::AllocateInstanceBuffer(Uint64 numInstances)
+    {
+        InstanceBufferPool& pool = mInstanceBufferPools[mCurrentRenderingFrame % mNumGPUSync];
+        if (pool.numUsedBuffers == pool.buffers.size())
+        {
+            pool.buffers.emplace_back();
+        }
+
+        InstanceBuffer& instanceBuffer = pool.buffers[pool.numUsedBuffers];
+        pool.numUsedBuffers++;
+        if (!instanceBuffer.buffer || instanceBuffer.buffer->GetNumElements() < numInstances)
+        {
+            if (instanceBuffer.buffer)
+            {
+                instanceBuffer.buffer->Unmap();
+            }
+
+            // Grow in power of 2, so the buffer size (which is a part of the render graph structure) rarely changes.
+            const Uint64 capacity = std::bit_ceil(std::max<Uint64>(numInstances, 64));
+            instanceBuffer.buffer = mGAPI->CreateBuffer({
+                .usage = gapi::ResourceUsage::CPUtoGPU,
+                .bufferInfo = {
+                    .type = gapi::BufferType::Structured,
+                    .size = sizeof(InstanceData) * capacity,
+                    .stride = sizeof(InstanceData)
+                },
+                .debugName = CUBE_T("InstanceBuffer")
+            });
+            instanceBuffer.data = static_cast<InstanceData*>(instanceBuffer.buffer->Map());
+        }
+
+        return instanceBuffer;
+    }
+
     void Renderer::SetScene(SharedPtr<Scene> scene)
     {
         mScene = scene;
@@ -345,7 +445,7 @@ namespace cube
         RGBuilder builder(*this);
 
         {
-            RG_GPU_EVENT_SCOPE(builder, CUBE_T("Frame"));
+            RG_GPU_EVENT_SCOPE(builder, CUBE_NAME("Frame"));
 
             gapi::TextureInfo colorTextureInfo = {
                 .format = mColorFormat,
@@ -367,7 +467,7 @@ namespace cube
             RGTextureRTVHandle colorRTV = builder.CreateRTV(color);
             RGTextureDSVHandle depthStencilDSV = builder.CreateDSV(depthStencil);
             {
-                RG_GPU_TIMESTAMP_SCOPE(builder, CUBE_T("MainPass"));
+                RG_GPU_TIMESTAMP_SCOPE(builder, CUBE_NAME("MainPass"));
 
                 gapi::Viewport viewport = {
                     .x = 0.0f,
@@ -412,7 +512,7 @@ namespace cube
                 };
                 builder.BeginRenderPass(renderPassInfo);
 
-                builder.AddPass(CUBE_T("Init global settings"), [viewport, scissor](gapi::CommandList& commandList)
+                builder.AddRenderStatePass(CUBE_NAME("Init global settings"), [viewport, scissor](gapi::CommandList& commandList)
                 {
                     gapi::Viewport vp = viewport;
                     gapi::ScissorRect sr = scissor;
@@ -431,22 +531,104 @@ namespace cube
 
                 if (mScene)
                 {
+                    const std::chrono::steady_clock::time_point cullingStartTime = std::chrono::steady_clock::now();
+
                     FrameVector<RGBuilder::DrawMeshInfo> drawMeshInfos;
-                    for (const UniquePtr<SceneObject>& sceneObject : mScene->GetSceneObjects())
+                    FrustumCullingStats cullingStats;
+                    if (mFrustumCullingMode == FrustumCullingMode::BVH)
                     {
-                        if (SharedPtr<Mesh> mesh = sceneObject->GetMesh())
+                        // The BVH is in the scene space, so the frustum is transformed into it.
+                        mScene->UpdateBVH();
+                        const BVH& bvh = mScene->GetBVH();
+                        const Frustum sceneFrustum = Frustum::FromViewProjection(mModelMatrix * mViewPerspectiveMatirx);
+
+                        mVisibleSceneObjectIndices.clear();
+                        cullingStats.numTestedBVHNodes = bvh.QueryFrustum(sceneFrustum, mVisibleSceneObjectIndices);
+
+                        const Vector<UniquePtr<SceneObject>>& sceneObjects = mScene->GetSceneObjects();
+                        drawMeshInfos.reserve(mVisibleSceneObjectIndices.size());
+                        for (Uint32 index : mVisibleSceneObjectIndices)
                         {
+                            SceneObject* sceneObject = sceneObjects[index].get();
                             drawMeshInfos.push_back({
-                                .mesh = mesh,
+                                .mesh = sceneObject->GetMesh(),
                                 .rasterizerState = mainPassRasterizerState,
                                 .depthStencilState = mainPassDepthStencilState,
                                 .materials = sceneObject->GetMaterials(),
                                 .model = sceneObject->GetModelMatrix() * mModelMatrix
                             });
                         }
+
+                        cullingStats.numObjects = static_cast<Uint32>(bvh.GetNumItems());
+                        cullingStats.numVisibleObjects = static_cast<Uint32>(mVisibleSceneObjectIndices.size());
                     }
+                    else
+                    {
+                        // Test the world bounds of the objects against the view frustum in a batch.
+                        FrameVector<SceneObject*> meshObjects;
+                        FrameVector<Matrix> modelMatrices;
+                        mCullingBounds.Clear();
+                        for (const UniquePtr<SceneObject>& sceneObject : mScene->GetSceneObjects())
+                        {
+                            if (const SharedPtr<Mesh>& mesh = sceneObject->GetMesh())
+                            {
+                                const Matrix model = sceneObject->GetModelMatrix() * mModelMatrix;
+                                meshObjects.push_back(sceneObject.get());
+                                modelMatrices.push_back(model);
+                                mCullingBounds.Add(mesh->GetBounds().Transformed(model));
+                            }
+                        }
 
-                    builder.AddDrawMeshPass(CUBE_T("Draw Scene"), drawMeshInfos, RGBuilder::MakeParameterListArray(envMapShaderParameterList));
+                        mCullingResults.resize(mCullingBounds.GetSize());
+                        Uint64 numVisibleObjects = mCullingBounds.GetSize();
+                        if (mFrustumCullingMode == FrustumCullingMode::Flat)
+                        {
+                            numVisibleObjects = Frustum::FromViewProjection(mViewPerspectiveMatirx).CullAABBs(mCullingBounds, mCullingResults);
+                        }
+                        else
+                        {
+                            std::fill(mCullingResults.begin(), mCullingResults.end(), 1);
+                        }
+
+                        // Gather the draws of the visible objects in the jobs. The number of the visible objects in each chunk is unknown,
+                        // so each job appends to its own list in the shared frame allocator. (The frame allocator of the job is discarded after it)
+                        const Uint64 numChunks = (meshObjects.size() + NUM_DRAW_GATHER_OBJECTS_PER_JOB - 1) / NUM_DRAW_GATHER_OBJECTS_PER_JOB;
+                        FrameVector<SharedFrameVector<RGBuilder::DrawMeshInfo>> chunkDrawMeshInfos(numChunks);
+                        Engine::GetJobSystem().ParallelFor(0, numChunks, 1, [&](Uint64 chunkIndex)
+                        {
+                            SharedFrameVector<RGBuilder::DrawMeshInfo>& chunkInfos = chunkDrawMeshInfos[chunkIndex];
+                            const Uint64 endIndex = std::min((chunkIndex + 1) * NUM_DRAW_GATHER_OBJECTS_PER_JOB, static_cast<Uint64>(meshObjects.size()));
+                            for (Uint64 i = chunkIndex * NUM_DRAW_GATHER_OBJECTS_PER_JOB; i < endIndex; ++i)
+                            {
+                                if (mCullingResults[i])
+                                {
+                                    chunkInfos.push_back({
+                                        .mesh = meshObjects[i]->GetMesh(),
+                                        .rasterizerState = mainPassRasterizerState,
+                                        .depthStencilState = mainPassDepthStencilState,
+                                        .materials = meshObjects[i]->GetMaterials(),
+                                        .model = modelMatrices[i]
+                                    });
+                                }
+                            }
+                        });
+
+                        // Keep the order of the objects.
+                        drawMeshInfos.reserve(numVisibleObjects);
+                        for (const SharedFrameVector<RGBuilder::DrawMeshInfo>& chunkInfos : chunkDrawMeshInfos)
+                        {
+                            drawMeshInfos.insert(drawMeshInfos.end(), chunkInfos.begin(), chunkInfos.end());
+                        }
+
+                        cullingStats.numObjects = static_cast<Uint32>(meshObjects.size());
+                        cullingStats.numVisibleObjects = static_cast<Uint32>(numVisibleObjects);
+                    }
+
+                    cullingStats.numCulledObjects = cullingStats.numObjects - cullingStats.numVisibleObjects;
+                    cullingStats.cullingTimeMS = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - cullingStartTime).count();
+                    mLastFrustumCullingStats = cullingStats;
+
+                    builder.AddDrawMeshPass(CUBE_NAME("Draw Scene"), drawMeshInfos, RGBuilder::MakeParameterListArray(envMapShaderParameterList));
                 }
 
                 if (mShowAxis)
@@ -476,7 +658,7 @@ namespace cube
                         .materials = { &zAxisMaterial, 1 },
                         .model = mZAxisModelMatrix
                     });
-                    builder.AddDrawMeshPass(CUBE_T("Draw Axis"), drawAxisMeshInfos, RGBuilder::MakeParameterListArray(envMapShaderParameterList));
+                    builder.AddDrawMeshPass(CUBE_NAME("Draw Axis"), drawAxisMeshInfos, RGBuilder::MakeParameterListArray(envMapShaderParameterList));
                 }
 
                 mEnvironmentMapping.DrawSkybox(builder);
@@ -498,12 +680,46 @@ namespace cube
             mRenderUtils.CopyTexturePS(builder, tonemappedColor, backbuffer);
 
             {
-                RG_GPU_TIMESTAMP_SCOPE(builder, CUBE_T("Texture Viewer"));
+                RG_GPU_TIMESTAMP_SCOPE(builder, CUBE_NAME("Texture Viewer"));
 
                 mTextureViewer.Update(builder);
             }
         }
-        builder.ExecuteAndSubmit(*mCommandList);
+
+        const bool dumpRenderGraph = (mRGDumpFrame != 0 && mCurrentRenderingFrame == mRGDumpFrame);
+        AnsiString dumpJSON;
+        AnsiString dumpDOT;
+        gapi::TimestampRangeList dumpTimestampRangeList;
+        if (dumpRenderGraph)
+        {
+            // GPU times of this frame are not resolved yet, so use the last ones.
+            dumpTimestampRangeList = mGAPI->GetLastTimestampRangeList();
+            builder.RequestDump(&dumpJSON, &dumpDOT, &dumpTimestampRangeList);
+        }
+
+        builder.ExecuteAndSubmit(mRGCommandListPool, &Engine::GetJobSystem(), &mRGCompileCache);
+        mLastRGBuilderStats = builder.GetStats();
+
+        if (dumpRenderGraph)
+        {
+            WriteRGDumpFile(Format<String>(CUBE_T("RenderGraph_Frame{0}.json"), mCurrentRenderingFrame), dumpJSON);
+            WriteRGDumpFile(Format<String>(CUBE_T("RenderGraph_Frame{0}.dot"), mCurrentRenderingFrame), dumpDOT);
+        }
+    }
+
+    void Renderer::WriteRGDumpFile(StringView fileName, const AnsiString& content)
+    {
+        const platform::FilePath path = Engine::GetRootDirectoryPath() / fileName;
+        SharedPtr<platform::File> file = platform::FileSystem::OpenFile(path, platform::FileAccessModeFlag::Write, true);
+        if (!file)
+        {
+            CUBE_LOG(Error, Renderer, "Failed to open the render graph dump file. ({0})", path.ToString());
+            return;
+        }
+
+        file->Write(const_cast<char*>(content.data()), content.size());
+        file->Truncate();
+        CUBE_LOG(Info, Renderer, "Dumped the render graph. ({0})", path.ToString());
     }
 
     void Renderer::LoadResources()
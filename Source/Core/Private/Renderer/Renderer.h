@@ -2,6 +2,7 @@
 
 #include "CoreHeader.h"
 
+#include "BoundingVolume.h"
 #include "DLib.h"
 #include "EnvironmentMapping.h"
 #include "GAPI.h"
@@ -9,6 +10,7 @@
 #include "Matrix.h"
 #include "Pipeline.h"
 #include "Renderer/Mesh.h"
+#include "Renderer/RenderGraphTypes.h"
 #include "Renderer/ShaderParameter.h"
 #include "RenderUtils.h"
 #include "SamplerManager.h"
@@ -41,14 +43,22 @@ namespace cube
     class ObjectShaderParameterList : public ShaderParameterList
     {
         CUBE_BEGIN_SHADER_PARAMETER_LIST(ObjectShaderParameterList)
-            CUBE_SHADER_PARAMETER(Matrix, model)
-            CUBE_SHADER_PARAMETER(Matrix, modelInverse)
-            CUBE_SHADER_PARAMETER(Matrix, modelInverseTranspose)
+            // Structured buffer of InstanceData. The draws read it from instanceOffset + SV_InstanceID.
+            CUBE_SHADER_PARAMETER(RGBufferSRVHandle, instanceBuffer)
+            CUBE_SHADER_PARAMETER(Uint32, instanceOffset)
             CUBE_SHADER_PARAMETER(RGBufferSRVHandle, vertexBuffer)
             CUBE_SHADER_PARAMETER(bool, useFP16)
         CUBE_END_SHADER_PARAMETER_LIST
     };
 
+    // Per-instance data of the mesh draws. Same layout as InstanceData in MainInterface.slang.
+    struct InstanceData
+    {
+        // Rows of the matrices
+        Float4 model[4];
+        Float4 modelInverseTranspose[4];
+    };
+
     class SubMeshShaderParameterList : public ShaderParameterList
     {
         CUBE_BEGIN_SHADER_PARAMETER_LIST(SubMeshShaderParameterList)
@@ -56,6 +66,26 @@ namespace cube
         CUBE_END_SHADER_PARAMETER_LIST
     };
 
+    enum class FrustumCullingMode
+    {
+        None,
+        // Test all objects in a batch with SIMD.
+        Flat,
+        // Query the BVH of the scene.
+        BVH,
+
+        Num
+    };
+
+    struct FrustumCullingStats
+    {
+        Uint32 numObjects = 0;
+        Uint32 numVisibleObjects = 0;
+        Uint32 numCulledObjects = 0;
+        Uint64 numTestedBVHNodes = 0;
+        double cullingTimeMS = 0.0;
+    };
+
     class Renderer
     {
     public:
@@ -79,6 +109,7 @@ namespace cube
 
         TextureViewer& GetTextureViewer() { return mTextureViewer; }
         RenderUtils& GetRenderUtils() { return mRenderUtils; }
+        RGTextureStateCache& GetRGTextureStateCache() { return mRGTextureStateCache; }
 
         bool IsDrawInWireframe() const { return mWireframe; }
 
@@ -88,6 +119,16 @@ namespace cube
         SharedPtr<gapi::Texture> GetDummyBlackTextureCube() const { return mDummyBlackTextureCube->GetGAPITexture(); }
         SharedPtr<gapi::Texture> GetDummyWhiteTexture2D() const { return mDummyWhiteTexture2D->GetGAPITexture(); }
 
+        struct InstanceBuffer
+        {
+            SharedPtr<gapi::Buffer> buffer;
+            // Persistently mapped
+            InstanceData* data = nullptr;
+        };
+        // Structured buffer of InstanceData for the draws in the current frame. (CPU to GPU)
+        // It is reused after the GPU finishes the frame.
+        InstanceBuffer AllocateInstanceBuffer(Uint64 numInstances);
+
         gapi::ElementFormat GetBackbufferFormat() const { return mBackbufferFormat; }
         gapi::ElementFormat GetDepthStencilFormat() const { return mDepthStencilFormat; }
 
@@ -96,6 +137,8 @@ namespace cube
         void SetPerspectiveMatrix(float fovAngleY, float aspectRatio, float nearZ, float farZ);
 
         float GetGPUTimeMS() const;
+        const RGBuilderStats& GetLastRGBuilderStats() const { return mLastRGBuilderStats; }
+        const FrustumCullingStats& GetLastFrustumCullingStats() const { return mLastFrustumCullingStats; }
         Uint64 GetCurrentRenderingFrame() const { return mCurrentRenderingFrame; };
 
         void SetScene(SharedPtr<Scene> scene);
@@ -103,6 +146,7 @@ namespace cube
     private:
         void SetGlobalConstantBuffers();
         void RenderImpl();
+        void WriteRGDumpFile(StringView fileName, const AnsiString& content);
 
         void LoadResources();
         void ClearResources();
@@ -134,6 +178,21 @@ namespace cube
         bool mIsViewPerspectiveMatrixDirty;
 
         SharedPtr<gapi::CommandList> mCommandList;
+        // Command lists for the render graph segments after the first one. (One per segment)
+        RGCommandListPool mRGCommandListPool;
+        RGBuilderStats mLastRGBuilderStats;
+        RGTextureStateCache mRGTextureStateCache;
+
+        struct InstanceBufferPool
+        {
+            Vector<InstanceBuffer> buffers;
+            Uint32 numUsedBuffers = 0;
+        };
+        Vector<InstanceBufferPool> mInstanceBufferPools; // Index: rendering frame % numGPUSync
+        // Compile results of the frame render graph. It is replayed while the graph has the same structure.
+        RGCompileCache mRGCompileCache;
+        // Frame whose render graph is dumped into JSON / DOT files. (Set by --rgdump=<frame>, 0 if disabled)
+        Uint64 mRGDumpFrame = 0;
 
         Uint32 mViewportWidth;
         Uint32 mViewportHeight;
@@ -151,6 +210,15 @@ namespace cube
         SharedPtr<Material> mDefaultMaterial;
         SharedPtr<Scene> mScene;
 
+        FrustumCullingMode mFrustumCullingMode = FrustumCullingMode::BVH;
+        // World bounds of the scene objects. Kept to reuse the capacity across the frames.
+        AABBBatch mCullingBounds;
+        Vector<Uint8> mCullingResults;
+        Vector<Uint32> mVisibleSceneObjectIndices;
+        FrustumCullingStats mLastFrustumCullingStats;
+        // Objects whose draws are gathered in one job after the flat culling.
+        static constexpr Uint64 NUM_DRAW_GATHER_OBJECTS_PER_JOB = 1024;
+
         SharedPtr<TextureResource> mDummyBlackTexture2D;
         SharedPtr<TextureResource> mDummyWhiteTexture2D;
         SharedPtr<TextureResource> mDummyBlackTextureCube;
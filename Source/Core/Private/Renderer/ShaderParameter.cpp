@@ -10,7 +10,7 @@ namespace cube
     bool ShaderParameterListManager::mIsDeferredInitOverflow = false;
 
     Vector<ShaderParameterListInfo> ShaderParameterListManager::mShaderParameterListInfos;
-    Map<String, int> ShaderParameterListManager::mShaderParameterListTypeNameToIndexMap;
+    FlatHashMap<Name, int> ShaderParameterListManager::mShaderParameterListTypeNameToIndexMap;
 
     void ShaderParameterListManager::AddDeferredInitializingParameterListInfos(const DeferredInitializingParameterListInfos& initInfos)
     {
@@ -32,7 +32,7 @@ namespace cube
         for (int i = 0; i < mDeferredInitializingParameterListInfosIndex; ++i)
         {
             DeferredInitializingParameterListInfos& initInfo = mDeferredInitializingParameterListInfos[i];
-            String typeName = String(initInfo.typeName);
+            const Name typeName(initInfo.typeName);
             if (mShaderParameterListTypeNameToIndexMap.find(typeName) != mShaderParameterListTypeNameToIndexMap.end())
             {
                 CUBE_LOG(Error, ShaderParameter, "Shader parameter list '{0}' is already initialized.", initInfo.typeName);
@@ -47,9 +47,9 @@ namespace cube
         mDeferredInitializingParameterListInfosIndex = 0;
     }
 
-    int ShaderParameterListManager::GetShaderParameterListInfoIndex(StringView parameterListTypeName)
+    int ShaderParameterListManager::GetShaderParameterListInfoIndex(Name parameterListTypeName)
     {
-        auto findIt = mShaderParameterListTypeNameToIndexMap.find(String(parameterListTypeName));
+        auto findIt = mShaderParameterListTypeNameToIndexMap.find(parameterListTypeName);
         if (findIt == mShaderParameterListTypeNameToIndexMap.end())
         {
             return -1;
@@ -130,6 +130,8 @@ namespace cube
 
     bool ShaderParameterListManager::ValidateShaderParameterList(const ShaderParameterListInfo& parameterListInfo, const gapi::ShaderParameterBlockReflection& parameterBlockReflection)
     {
+        FrameScratchScope scratchScope;
+
         FrameMap<FrameString, int> parameterNameToIndexMapInShaderCode;
         FrameVector<bool> checkedParameterInShaderCode(parameterBlockReflection.params.size(), false);
         for (int i = 0; i < parameterBlockReflection.params.size(); ++i)
@@ -210,7 +212,7 @@ namespace cube
         }
 
         parameterList->mGPUSyncIndex = mCurrentIndex;
-        parameterList->mPooledBuffer = AllocateBuffer(bufferSize, parameterListInfo.name);
+        parameterList->mPooledBuffer = AllocateBuffer(bufferSize, parameterListInfo.name.ToString());
     }
 
     ShaderParameterListPooledBuffer ShaderParameterListManager::AllocateBuffer(Uint32 size, StringView debugName)
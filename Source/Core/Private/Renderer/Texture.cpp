@@ -3,6 +3,7 @@
 #include "stb_image.h" // Loaded from tinyobjloader
 
 #include "Allocator/FrameAllocator.h"
+#include "Allocator/TLSFAllocator.h"
 #include "Checker.h"
 #include "Engine.h"
 #include "GAPI_Texture.h"
@@ -92,7 +93,7 @@ namespace cube
         SharedPtr<platform::File> file = platform::FileSystem::OpenFile(path, platform::FileAccessModeFlag::Read);
         CHECK(file);
         const Uint64 fileSize = file->GetFileSize();
-        Blob fileData(fileSize);
+        Blob fileData(fileSize, &GetAssetHeapAllocator(), MemoryTag::Texture);
         file->Read(fileData.GetData(), fileSize);
         file = nullptr;
 
@@ -128,7 +129,7 @@ namespace cube
             bytesPerElement = sizeof(stbi_uc) * desiredChannels;
 
             stbi_uc* data = stbi_load_from_memory(stbiFileData, fileSize, &width, &height, &numChannels, desiredChannels);
-            blobData = Blob(data, width * height * desiredChannels * sizeof(stbi_uc));
+            blobData = Blob(data, width * height * desiredChannels * sizeof(stbi_uc), &GetAssetHeapAllocator(), MemoryTag::Texture);
             stbi_image_free(data);
             break;
         }
@@ -155,7 +156,7 @@ namespace cube
             bytesPerElement = sizeof(stbi_us) * desiredChannels;
 
             stbi_us* data = stbi_load_16_from_memory(stbiFileData, fileSize, &width, &height, &numChannels, desiredChannels);
-            blobData = Blob(data, width * height * desiredChannels * sizeof(stbi_us));
+            blobData = Blob(data, width * height * desiredChannels * sizeof(stbi_us), &GetAssetHeapAllocator(), MemoryTag::Texture);
             stbi_image_free(data);
             break;
         }
@@ -182,7 +183,7 @@ namespace cube
             bytesPerElement = sizeof(float) * desiredChannels;
 
             float* data = stbi_loadf_from_memory(stbiFileData, fileSize, &width, &height, &numChannels, desiredChannels);
-            blobData = Blob(data, width * height * desiredChannels * sizeof(float));
+            blobData = Blob(data, width * height * desiredChannels * sizeof(float), &GetAssetHeapAllocator(), MemoryTag::Texture);
             stbi_image_free(data);
             break;
         }
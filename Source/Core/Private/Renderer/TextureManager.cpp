@@ -44,6 +44,10 @@ namespace cube
             mGenerateMipmapsPipelineInfo = {
                 .shader = mGenerateMipmapsShader
             };
+            for (Uint32 mipIndex = 1; mipIndex < MAX_NUM_MIP_LEVELS; ++mipIndex)
+            {
+                mGenerateMipmapsPassNames[mipIndex - 1] = Name(Format<FrameString>(CUBE_T("GenerateMipmaps ({0}->{1})"), mipIndex - 1, mipIndex));
+            }
         }
 
         mCommandList = mGAPI->CreateCommandList({
@@ -75,11 +79,12 @@ namespace cube
 
         RGBuilder builder(mRenderer);
         {
-            RG_GPU_EVENT_SCOPE(builder, CUBE_T("GenerateMipmaps"));
+            RG_GPU_EVENT_SCOPE(builder, CUBE_NAME("GenerateMipmaps"));
 
             Uint32 width = texture->GetWidth();
             Uint32 height = texture->GetHeight();
             Uint32 mipLevels = texture->GetMipLevels();
+            CHECK(mipLevels <= MAX_NUM_MIP_LEVELS);
 
             RGTextureHandle rgTexture = builder.RegisterTexture(texture);
 
@@ -95,13 +100,13 @@ namespace cube
                 params->Get()->srcTexture = srcSRV;
                 params->Get()->dstTexture = dstUAV;
 
-                builder.AddPass(Format<FrameString>(CUBE_T("GenerateMipmaps ({0}->{1})"), mipIndex - 1, mipIndex),
+                builder.AddPass(mGenerateMipmapsPassNames[mipIndex - 1],
                     generateMipmapsPipeline,
                     params,
                     [width, height](gapi::CommandList& commandList)
                 {
                     commandList.DispatchThreads(width, height, 1);
-                });
+                }, false, true);
             }
         }
 
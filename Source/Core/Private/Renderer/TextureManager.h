@@ -45,6 +45,10 @@ namespace cube
 
         SharedPtr<Shader> mGenerateMipmapsShader;
         ComputePipelineInfo mGenerateMipmapsPipelineInfo;
+        // Up to 16384x16384
+        static constexpr Uint32 MAX_NUM_MIP_LEVELS = 15;
+        // Names of the passes generating each mip, interned in Initialize(). (Index: mip - 1)
+        Array<Name, MAX_NUM_MIP_LEVELS - 1> mGenerateMipmapsPassNames;
 
         SharedPtr<gapi::CommandList> mCommandList;
     };
@@ -414,7 +414,14 @@ namespace cube
 
         CreateNewCanvasTextureIfNeeded(textureInfo);
 
-        mCopiedTextureName = String_Convert<AnsiString>(texture->GetDebugName());
+        AnsiString copiedTextureName = String_Convert<AnsiString>(texture->GetDebugName());
+        if (mCopyToTexturePassName.IsNone() || copiedTextureName != mCopiedTextureName)
+        {
+            mCopiedTextureName = std::move(copiedTextureName);
+            mCopyToTexturePassName = Name(Format<FrameString>(CUBE_T("TextureViewer CopyToTexture - {0}"), mCopiedTextureName));
+            mFetchInfoPassName = Name(Format<FrameString>(CUBE_T("TextureViewer FetchInfo - {0}"), mCopiedTextureName));
+            mCopyToCanvasPassName = Name(Format<FrameString>(CUBE_T("TextureViewer CopyToCanvas - {0}"), mCopiedTextureName));
+        }
         mCopiedRenderingFrame = mRenderer.GetCurrentRenderingFrame();
 
         mCopiedTexture = mRenderer.GetGAPI().CreateTexture({
@@ -424,7 +431,7 @@ namespace cube
         });
 
         RGTextureHandle copiedTexture = builder.RegisterTexture(mCopiedTexture);
-        builder.AddPass(Format<FrameString>(CUBE_T("TextureViewer CopyToTexture - {0}"), mCopiedTextureName),
+        builder.AddPass(mCopyToTexturePassName,
             [src = texture, dst = copiedTexture](gapi::CommandList& commandList)
             {
                 commandList.CopyTexture(src->GetGAPITexture(), dst->GetGAPITexture());
@@ -577,13 +584,14 @@ namespace cube
                 .debugName = CUBE_T("TextureViewerFetchInfo2D Pipeline")
             });
             builder.AddPass(
-                Format<FrameString>(CUBE_T("TextureViewer FetchInfo - {0}"), mCopiedTextureName),
+                mFetchInfoPassName,
                 pipeline,
                 RGBuilder::MakeParameterListArray(params),
                 [](gapi::CommandList& commandList)
                 {
                     commandList.DispatchThreads(1, 1, 1);
-                }
+                },
+                false, true
             );
         }
         else if (textureInfo.type == gapi::TextureType::TextureCube)
@@ -602,13 +610,14 @@ namespace cube
                 .debugName = CUBE_T("TextureViewerFetchInfoCube Pipeline")
             });
             builder.AddPass(
-                Format<FrameString>(CUBE_T("TextureViewer FetchInfo - {0}"), mCopiedTextureName),
+                mFetchInfoPassName,
                 pipeline,
                 RGBuilder::MakeParameterListArray(params),
                 [](gapi::CommandList& commandList)
                 {
                     commandList.DispatchThreads(1, 1, 1);
-                }
+                },
+                false, true
             );
         }
     }
@@ -693,11 +702,12 @@ namespace cube
                 .debugName = CUBE_T("CopyToTextureViewer2D Pipeline")
             });
             builder.AddPass(
-                Format<FrameString>(CUBE_T("TextureViewer CopyToCanvas - {0}"), mCopiedTextureName), copyToTextureViewer2DPipeline,
+                mCopyToCanvasPassName, copyToTextureViewer2DPipeline,
                 RGBuilder::MakeParameterListArray(params),
                 [size = mCanvasTextureSize](gapi::CommandList& commandList){
                     commandList.DispatchThreads(size.x, size.y, 1);
-                }
+                },
+                false, true
             );
         }
         else if (textureInfo.type == gapi::TextureType::TextureCube)
@@ -720,11 +730,12 @@ namespace cube
                 .debugName = CUBE_T("CopyToTextureViewerCube Pipeline")
             });
             builder.AddPass(
-                Format<FrameString>(CUBE_T("TextureViewer CopyToCanvas - {0}"), mCopiedTextureName), copyToTextureViewerCubePipeline,
+                mCopyToCanvasPassName, copyToTextureViewerCubePipeline,
                 RGBuilder::MakeParameterListArray(params),
                 [width = srcWidth, height = srcHeight](gapi::CommandList& commandList){
                     commandList.DispatchThreads(width, height, 6);
-                }
+                },
+                false, true
             );
         }
 
@@ -2,6 +2,7 @@
 
 #include "CoreHeader.h"
 
+#include "Name.h"
 #include "Pipeline.h"
 #include "Renderer/RenderGraphTypes.h"
 
@@ -62,6 +63,10 @@ namespace cube
 
         Uint64 mCopiedRenderingFrame;
         AnsiString mCopiedTextureName;
+        // Interned again only when the copied texture name is changed.
+        Name mCopyToTexturePassName;
+        Name mFetchInfoPassName;
+        Name mCopyToCanvasPassName;
         SharedPtr<gapi::Texture> mCopiedTexture;
 
         Uint2 mCanvasTextureSize;
@@ -107,14 +107,14 @@ namespace cube
             .debugName = CUBE_T("Tonemapping Pipeline")
         });
 
-        builder.AddPass(CUBE_T("Tonemapping"),
+        builder.AddPass(CUBE_NAME("Tonemapping"),
             tonemappingPipeline,
             params,
             [width, height](gapi::CommandList& commandList)
             {
                 commandList.DispatchThreads(width, height, 1);
             },
-            true
+            true, true
         );
     }
 } // namespace cube
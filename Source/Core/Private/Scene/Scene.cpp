@@ -1,9 +1,22 @@
 #include "Scene.h"
 
+#include "Renderer/Mesh.h"
 #include "SceneObject.h"
 
 namespace cube
 {
+    namespace
+    {
+        AABB GetSceneObjectBounds(SceneObject& sceneObject)
+        {
+            if (const SharedPtr<Mesh>& mesh = sceneObject.GetMesh())
+            {
+                return mesh->GetBounds().Transformed(sceneObject.GetModelMatrix());
+            }
+            return AABB();
+        }
+    } // namespace
+
     Scene::Scene()
     {
     }
@@ -15,6 +28,16 @@ namespace cube
 
     void Scene::AddSceneObject(UniquePtr<SceneObject>&& sceneObject)
     {
+        const Uint32 index = static_cast<Uint32>(mSceneObjects.size());
+        sceneObject->mScene = this;
+        sceneObject->mIndexInScene = index;
+
+        const AABB bounds = GetSceneObjectBounds(*sceneObject);
+        if (bounds.IsValid())
+        {
+            mBVH.Insert(index, bounds);
+        }
+
         mSceneObjects.emplace_back(std::move(sceneObject));
     }
 
@@ -22,4 +45,47 @@ namespace cube
     {
         mMaterials.push_back(material);
     }
+
+    void Scene::RebuildBVH(JobSystem* jobSystem)
+    {
+        Vector<AABB> objectBounds(mSceneObjects.size());
+        for (Uint64 i = 0; i < mSceneObjects.size(); ++i)
+        {
+            mSceneObjects[i]->mIsTransformChangedInScene = false;
+            objectBounds[i] = GetSceneObjectBounds(*mSceneObjects[i]);
+        }
+        mTransformChangedObjects.clear();
+
+        mBVH.Build(objectBounds, jobSystem);
+    }
+
+    void Scene::UpdateBVH()
+    {
+        if (mTransformChangedObjects.empty())
+        {
+            return;
+        }
+
+        for (Uint32 index : mTransformChangedObjects)
+        {
+            SceneObject& sceneObject = *mSceneObjects[index];
+            sceneObject.mIsTransformChangedInScene = false;
+            if (mBVH.Contains(index))
+            {
+                mBVH.UpdateItem(index, GetSceneObjectBounds(sceneObject));
+            }
+        }
+        mTransformChangedObjects.clear();
+
+        mBVH.Refit();
+    }
+
+    void Scene::OnSceneObjectTransformChanged(SceneObject& sceneObject)
+    {
+        if (!sceneObject.mIsTransformChangedInScene)
+        {
+            sceneObject.mIsTransformChangedInScene = true;
+            mTransformChangedObjects.push_back(sceneObject.mIndexInScene);
+        }
+    }
 } // namespace cube
@@ -2,8 +2,11 @@
 
 #include "CoreHeader.h"
 
+#include "BVH.h"
+
 namespace cube
 {
+    class JobSystem;
     class Material;
     class SceneObject;
 
@@ -13,13 +16,28 @@ namespace cube
         Scene();
         ~Scene();
 
+        // The object is inserted into the BVH if it has a mesh.
         void AddSceneObject(UniquePtr<SceneObject>&& sceneObject);
         const Vector<UniquePtr<SceneObject>>& GetSceneObjects() const { return mSceneObjects; }
 
         void AddMaterial(SharedPtr<Material> material);
 
+        // Item ids of the BVH are the indices in GetSceneObjects(). The bounds are in the scene space.
+        const BVH& GetBVH() const { return mBVH; }
+        // Build the BVH from all objects. (ex: After loading, since the inserted items are not placed as well as the built ones)
+        void RebuildBVH(JobSystem* jobSystem = nullptr);
+        // Refit the BVH with the objects whose transform is changed.
+        void UpdateBVH();
+
     private:
+        friend class SceneObject;
+
+        void OnSceneObjectTransformChanged(SceneObject& sceneObject);
+
         Vector<UniquePtr<SceneObject>> mSceneObjects;
         Vector<SharedPtr<Material>> mMaterials;
+
+        BVH mBVH;
+        Vector<Uint32> mTransformChangedObjects;
     };
 } // namespace cube
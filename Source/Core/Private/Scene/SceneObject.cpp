@@ -1,5 +1,7 @@
 #include "SceneObject.h"
 
+#include "Scene.h"
+
 namespace cube
 {
     SceneObject::SceneObject(StringView name, const SharedPtr<Mesh>& mesh)
@@ -29,21 +31,31 @@ namespace cube
     {
         mPosition = position;
 
-        mIsModelMatrixDirty = true;
+        OnTransformChanged();
     }
 
     void SceneObject::SetRotation(Vector3 rotation)
     {
         mRotation = rotation;
 
-        mIsModelMatrixDirty = true;
+        OnTransformChanged();
     }
 
     void SceneObject::SetScale(Vector3 scale)
     {
         mScale = scale;
 
+        OnTransformChanged();
+    }
+
+    void SceneObject::OnTransformChanged()
+    {
         mIsModelMatrixDirty = true;
+
+        if (mScene)
+        {
+            mScene->OnSceneObjectTransformChanged(*this);
+        }
     }
 
     void SceneObject::SetMaterials(ArrayView<WeakPtr<Material>> materials)
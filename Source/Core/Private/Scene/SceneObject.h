@@ -8,6 +8,7 @@ namespace cube
 {
     class Material;
     class Mesh;
+    class Scene;
 
     class SceneObject
     {
@@ -20,6 +21,7 @@ namespace cube
 
         Matrix GetModelMatrix();
 
+        // The scene refits its BVH with the changed transforms in Scene::UpdateBVH().
         void SetPosition(Vector3 position);
         void SetRotation(Vector3 rotation);
         void SetScale(Vector3 scale);
@@ -27,6 +29,10 @@ namespace cube
         void SetMaterials(ArrayView<WeakPtr<Material>> materials);
 
     private:
+        friend class Scene;
+
+        void OnTransformChanged();
+
         String mName;
 
         Vector3 mPosition = Vector3::Zero();
@@ -37,5 +43,9 @@ namespace cube
 
         SharedPtr<Mesh> mMesh;
         Vector<WeakPtr<Material>> mMaterials;
+
+        Scene* mScene = nullptr;
+        Uint32 mIndexInScene = Uint32InvalidValue;
+        bool mIsTransformChangedInScene = false;
     };
 } // namespace cube
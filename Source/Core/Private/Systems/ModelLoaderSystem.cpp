@@ -8,7 +8,10 @@
 #define TINYGLTF_IMPLEMENTATION
 #include "tiny_gltf.h"
 
+#include <chrono>
+
 #include "Allocator/FrameAllocator.h"
+#include "Allocator/TLSFAllocator.h"
 #include "Checker.h"
 #include "CubeMath.h"
 #include "CubeString.h"
@@ -26,83 +29,354 @@
 
 namespace cube
 {
-    Vector<ModelPathInfo> ModelLoaderSystem::mModelPathList;
-    int ModelLoaderSystem::mCurrentSelectModelIndex;
+    namespace
+    {
+        Uint64 GetNowNS()
+        {
+            return std::chrono::time_point_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now()).time_since_epoch().count();
+        }
 
-    Float3 ModelLoaderSystem::mModelPosition;
-    Float3 ModelLoaderSystem::mModelRotation;
-    float ModelLoaderSystem::mModelScale;
-    bool ModelLoaderSystem::mUseFloat16Vertices = true;
+        // Keep the encoded image, so the images are decoded in parallel after the parsing.
+        bool KeepEncodedImageData(tinygltf::Image* image, const int imageIndex, AnsiString* error, AnsiString* warning,
+            int requestedWidth, int requestedHeight, const unsigned char* bytes, int size, void* userData)
+        {
+            image->image.assign(bytes, bytes + size);
+            image->as_is = true;
+            return true;
+        }
 
-    void ModelLoaderSystem::Initialize()
-    {
-        mCurrentSelectModelIndex = -1;
-        ResetModelTransform();
+        // Decode to RGBA like the default image loader of tinygltf. 16-bit images keep their precision.
+        bool DecodeImage(const tinygltf::Image& image, TextureRawData& outRawData)
+        {
+            const stbi_uc* pEncoded = image.image.data();
+            const int encodedSize = static_cast<int>(image.image.size());
 
-        // Load model at initialization using parameter.
-        if (AnsiStringView modelParam = Engine::GetCommandLineParam("model"); !modelParam.empty())
+            int width, height, numChannels;
+            if (stbi_is_16_bit_from_memory(pEncoded, encodedSize))
+            {
+                stbi_us* pDecoded = stbi_load_16_from_memory(pEncoded, encodedSize, &width, &height, &numChannels, 4);
+                if (pDecoded == nullptr)
+                {
+                    return false;
+                }
+                outRawData = {
+                    .format = gapi::ElementFormat::RGBA16_UNorm,
+                    .width = static_cast<Uint32>(width),
+                    .height = static_cast<Uint32>(height),
+                    .bytesPerElement = 8,
+                    .data = Blob(pDecoded, static_cast<Uint64>(width) * height * 8, &GetAssetHeapAllocator(), MemoryTag::Texture)
+                };
+                stbi_image_free(pDecoded);
+            }
+            else
+            {
+                stbi_uc* pDecoded = stbi_load_from_memory(pEncoded, encodedSize, &width, &height, &numChannels, 4);
+                if (pDecoded == nullptr)
+                {
+                    return false;
+                }
+                outRawData = {
+                    .format = gapi::ElementFormat::RGBA8_UNorm,
+                    .width = static_cast<Uint32>(width),
+                    .height = static_cast<Uint32>(height),
+                    .bytesPerElement = 4,
+                    .data = Blob(pDecoded, static_cast<Uint64>(width) * height * 4, &GetAssetHeapAllocator(), MemoryTag::Texture)
+                };
+                stbi_image_free(pDecoded);
+            }
+            return true;
+        }
+
+        // Call function(index, pElement) for each element of the accessor.
+        template <typename Function>
+        void ForEachAccessorElement(const tinygltf::Model& model, const tinygltf::Accessor& accessor, Function&& function)
         {
-            // Parse format: <type>_<index> (e.g., gltf_0, default_2)
-            SizeType underscorePos = modelParam.rfind('_');
-            if (underscorePos == AnsiStringView::npos || underscorePos == 0 || underscorePos == modelParam.size() - 1)
+            const tinygltf::BufferView& bufferView = model.bufferViews[accessor.bufferView];
+            const tinygltf::Buffer& buffer = model.buffers[bufferView.buffer];
+
+            const Uint64 stride = accessor.ByteStride(bufferView);
+            const unsigned char* pData = buffer.data.data() + accessor.byteOffset + bufferView.byteOffset;
+            for (Uint64 i = 0; i < accessor.count; ++i)
             {
-                CUBE_LOG(Error, ModelLoaderSystem, "Invalid --model format ({0}). Expected <type>_<index>.", modelParam);
-                return;
+                function(i, pData + stride * i);
             }
+        }
 
-            AnsiStringView modelTypeStr = modelParam.substr(0, underscorePos);
-            AnsiStringView indexStr = modelParam.substr(underscorePos + 1);
+        // Call function(index, values) with the float or normalized integer components. The missing components are (0, 0, 0, 1).
+        // The component type is branched once per accessor, not per element.
+        template <typename Function>
+        void ReadFloatAccessor(const tinygltf::Model& model, int accessorIndex, Function&& function)
+        {
+            const tinygltf::Accessor& accessor = model.accessors[accessorIndex];
+            const int numComponents = tinygltf::GetNumComponentsInType(accessor.type);
+            CHECK(1 <= numComponents && numComponents <= 4);
 
-            int index = -1;
-            try
+            switch (accessor.componentType)
             {
-                index = std::stoi(indexStr.data());
+            case TINYGLTF_COMPONENT_TYPE_FLOAT:
+                ForEachAccessorElement(model, accessor, [&function, numComponents](Uint64 index, const unsigned char* pData)
+                {
+                    float values[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+                    memcpy(values, pData, sizeof(float) * numComponents);
+                    function(index, values);
+                });
+                break;
+            case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+                ForEachAccessorElement(model, accessor, [&function, numComponents](Uint64 index, const unsigned char* pData)
+                {
+                    float values[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+                    for (int i = 0; i < numComponents; ++i)
+                    {
+                        values[i] = static_cast<float>(pData[i]) / 255.0f;
+                    }
+                    function(index, values);
+                });
+                break;
+            case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+                ForEachAccessorElement(model, accessor, [&function, numComponents](Uint64 index, const unsigned char* pData)
+                {
+                    unsigned short raw[4];
+                    memcpy(raw, pData, sizeof(unsigned short) * numComponents);
+
+                    float values[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+                    for (int i = 0; i < numComponents; ++i)
+                    {
+                        values[i] = static_cast<float>(raw[i]) / 65535.0f;
+                    }
+                    function(index, values);
+                });
+                break;
+            default:
+                NO_ENTRY_FORMAT("Unsupported component type. ({0})", accessor.componentType);
+                break;
             }
-            catch (...)
+        }
+
+        void ReadIndexAccessor(const tinygltf::Model& model, int accessorIndex, ArrayView<Index> outIndices)
+        {
+            const tinygltf::Accessor& accessor = model.accessors[accessorIndex];
+            CHECK(accessor.type == TINYGLTF_TYPE_SCALAR);
+            CHECK(accessor.count == outIndices.size());
+
+            switch (accessor.componentType)
             {
-                CUBE_LOG(Error, ModelLoaderSystem, "Invalid --model index ({0}). Must be an integer.", indexStr);
-                return;
+            case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE:
+                ForEachAccessorElement(model, accessor, [outIndices](Uint64 index, const unsigned char* pData)
+                {
+                    outIndices[index] = *pData;
+                });
+                break;
+            case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT:
+                ForEachAccessorElement(model, accessor, [outIndices](Uint64 index, const unsigned char* pData)
+                {
+                    unsigned short v;
+                    memcpy(&v, pData, sizeof(v));
+                    outIndices[index] = v;
+                });
+                break;
+            case TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT:
+                ForEachAccessorElement(model, accessor, [outIndices](Uint64 index, const unsigned char* pData)
+                {
+                    memcpy(&outIndices[index], pData, sizeof(Uint32));
+                });
+                break;
+            default:
+                NO_ENTRY_FORMAT("Unsupported index component type. ({0})", accessor.componentType);
+                break;
+            }
+        }
+
+        int FindAttributeAccessor(const tinygltf::Primitive& prim, const char* name)
+        {
+            if (auto it = prim.attributes.find(name); it != prim.attributes.end())
+            {
+                return it->second;
             }
+            return -1;
+        }
+
+        // Fill the vertices / indices of a primitive. They are the ranges in the arrays of the mesh, so the primitives can be processed in parallel.
+        void ProcessPrimitive(const tinygltf::Model& model, const tinygltf::Primitive& prim, ArrayView<Vertex> vertices, ArrayView<Index> indices)
+        {
+            // Indices first. They are needed to calculate the normals.
+            ReadIndexAccessor(model, prim.indices, indices);
 
-            ModelType type;
-            if (modelTypeStr == "gltf")
+            // POSITION
+            if (const int accessorIndex = FindAttributeAccessor(prim, "POSITION"); accessorIndex != -1)
             {
-                type = ModelType::glTF;
+                CHECK(model.accessors[accessorIndex].type == TINYGLTF_TYPE_VEC3);
+                CHECK(model.accessors[accessorIndex].componentType == TINYGLTF_COMPONENT_TYPE_FLOAT);
+                ReadFloatAccessor(model, accessorIndex, [vertices](Uint64 index, const float* values)
+                {
+                    vertices[index].position = { values[0], values[1], values[2], 1.0f };
+                });
             }
-            else if (modelTypeStr == "default")
+            // NORMAL
+            if (const int accessorIndex = FindAttributeAccessor(prim, "NORMAL"); accessorIndex != -1)
             {
-                type = ModelType::Obj;
+                CHECK(model.accessors[accessorIndex].type == TINYGLTF_TYPE_VEC3);
+                CHECK(model.accessors[accessorIndex].componentType == TINYGLTF_COMPONENT_TYPE_FLOAT);
+                ReadFloatAccessor(model, accessorIndex, [vertices](Uint64 index, const float* values)
+                {
+                    vertices[index].normal = { values[0], values[1], values[2] };
+                });
             }
             else
             {
-                CUBE_LOG(Error, ModelLoaderSystem, "Invalid --model type ({0}). Must be 'gltf' or 'default'.", modelTypeStr);
-                return;
+                CUBE_LOG(Info, ModelLoaderSystem, "No normal data found in the model. Calculate normal from position and index.");
+                MeshHelper::SetNormalVector(vertices, indices);
             }
-
-            LoadModelList();
-
-            int typeCount = 0;
-            for (int i = 0; i < static_cast<int>(mModelPathList.size()); ++i)
+            // TANGENT
+            if (const int accessorIndex = FindAttributeAccessor(prim, "TANGENT"); accessorIndex != -1)
             {
-                if (mModelPathList[i].type == type)
+                CHECK(model.accessors[accessorIndex].type == TINYGLTF_TYPE_VEC4);
+                CHECK(model.accessors[accessorIndex].componentType == TINYGLTF_COMPONENT_TYPE_FLOAT);
+                ReadFloatAccessor(model, accessorIndex, [vertices](Uint64 index, const float* values)
                 {
-                    if (typeCount == index)
-                    {
-                        mCurrentSelectModelIndex = i;
-                        CUBE_LOG(Info, ModelLoaderSystem, "Loading model from command line: {0}", mModelPathList[i].name);
-                        LoadCurrentModelAndSet();
-                        return;
-                    }
-                    ++typeCount;
-                }
+                    vertices[index].tangent = { values[0], values[1], values[2], values[3] };
+                });
+            }
+            else
+            {
+                CUBE_LOG(Info, ModelLoaderSystem, "No tangent data found in the model. Calculate approximate tangent from normal.");
+                MeshHelper::SetApproxTangentVector(vertices);
             }
+            // TEXCOORD
+            if (const int accessorIndex = FindAttributeAccessor(prim, "TEXCOORD_0"); accessorIndex != -1)
+            {
+                CHECK(model.accessors[accessorIndex].type == TINYGLTF_TYPE_VEC2);
+                ReadFloatAccessor(model, accessorIndex, [vertices](Uint64 index, const float* values)
+                {
+                    vertices[index].uv = { values[0], values[1] };
+                });
+            }
+            // COLOR
+            if (const int accessorIndex = FindAttributeAccessor(prim, "COLOR_0"); accessorIndex != -1)
+            {
+                CHECK(model.accessors[accessorIndex].type == TINYGLTF_TYPE_VEC3
+                    || model.accessors[accessorIndex].type == TINYGLTF_TYPE_VEC4);
+                ReadFloatAccessor(model, accessorIndex, [vertices](Uint64 index, const float* values)
+                {
+                    vertices[index].color = { values[0], values[1], values[2], values[3] };
+                });
+            }
+        }
+    } // namespace
 
-            CUBE_LOG(Error, ModelLoaderSystem, "Model index {0} out of range for type ({1}) (size: {2}).", index, modelTypeStr, typeCount);
+    // CPU side result of the load. Built in the job and consumed in the main thread.
+    struct ModelLoadData
+    {
+        struct TextureData
+        {
+            TextureRawData rawData;
+            String debugName;
+        };
+
+        struct MaterialTextureSlot
+        {
+            int materialIndex;
+            int slotIndex;
+            int textureIndex;
+        };
+
+        struct ObjectData
+        {
+            String name;
+            int meshIndex = -1;
+            Vector3 position = Vector3::Zero();
+            Vector3 scale = Vector3(1.0f, 1.0f, 1.0f);
+        };
+
+        Vector<SharedPtr<Material>> materials;
+        Vector<TextureData> textures;
+        Vector<MaterialTextureSlot> materialTextureSlots;
+
+        Vector<SharedPtr<MeshData>> meshes;
+        Vector<Vector<int>> materialIndicesPerMeshes; // -1 if the sub mesh has no material.
+        Vector<ObjectData> objects;
+        Vector<Vector<int>> objectIndicesPerMeshes; // Filled when the scene is published.
+
+        ModelLoadTimings timings;
+    };
+
+    ModelLoadRequest::ModelLoadRequest(const ModelPathInfo& pathInfo, const MeshMetadata& meshMeta) :
+        mPathInfo(pathInfo),
+        mMeshMeta(meshMeta),
+        mStartTime(GetNowNS())
+    {
+    }
+
+    ModelLoadRequest::~ModelLoadRequest()
+    {
+    }
+
+    Vector<ModelPathInfo> ModelLoaderSystem::mModelPathList;
+    int ModelLoaderSystem::mCurrentSelectModelIndex;
+
+    Float3 ModelLoaderSystem::mModelPosition;
+    Float3 ModelLoaderSystem::mModelRotation;
+    float ModelLoaderSystem::mModelScale;
+    bool ModelLoaderSystem::mUseFloat16Vertices = true;
+
+    Vector<SharedPtr<ModelLoadRequest>> ModelLoaderSystem::mLoadRequests;
+    SharedPtr<ModelLoadRequest> ModelLoaderSystem::mCurrentLoadRequest;
+    bool ModelLoaderSystem::mIsCurrentScenePublished = false;
+    float ModelLoaderSystem::mUploadTimeBudgetMS = 4.0f;
+
+    void ModelLoaderSystem::Initialize()
+    {
+        mCurrentSelectModelIndex = -1;
+        ResetModelTransform();
+
+        // Load model at initialization using parameter.
+        if (AnsiStringView modelParam = Engine::GetCommandLineParam("model"); !modelParam.empty())
+        {
+            if (const int modelIndex = FindModelIndexFromParam("model", modelParam); modelIndex != -1)
+            {
+                mCurrentSelectModelIndex = modelIndex;
+                CUBE_LOG(Info, ModelLoaderSystem, "Loading model from command line: {0}", mModelPathList[modelIndex].name);
+                LoadCurrentModelAndSet();
+            }
         }
     }
 
     void ModelLoaderSystem::Shutdown()
     {
+        for (SharedPtr<ModelLoadRequest>& request : mLoadRequests)
+        {
+            request->Cancel();
+            Engine::GetJobSystem().Wait(request->mJobHandle);
+        }
+        mLoadRequests.clear();
+        mCurrentLoadRequest = nullptr;
+    }
+
+    void ModelLoaderSystem::OnLoop(double deltaTimeSec)
+    {
+        const Uint64 uploadEndTime = GetNowNS() + static_cast<Uint64>(static_cast<double>(mUploadTimeBudgetMS) * 1'000'000.0);
+
+        for (auto it = mLoadRequests.begin(); it != mLoadRequests.end();)
+        {
+            ModelLoadRequest& request = **it;
+            request.mMaxFrameTimeMS = std::max(request.mMaxFrameTimeMS, deltaTimeSec * 1000.0);
+
+            const bool isFinished = UpdateLoadRequest(request, uploadEndTime);
+
+            if (*it == mCurrentLoadRequest && !mIsCurrentScenePublished && request.mScene)
+            {
+                Engine::SetScene(request.mScene);
+                mIsCurrentScenePublished = true;
+            }
+
+            if (isFinished)
+            {
+                it = mLoadRequests.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
     }
 
     void ModelLoaderSystem::OnLoopImGUIContent()
@@ -191,21 +465,68 @@ namespace cube
         {
             LoadCurrentModelAndSet(false);
         }
+
+        ImGui::PushItemWidth(65.0f);
+        ImGui::DragFloat("Upload budget (ms)", &mUploadTimeBudgetMS, 0.1f, 0.0f, 100.0f);
+        ImGui::PopItemWidth();
+
+        if (mCurrentLoadRequest)
+        {
+            const ModelLoadRequest& request = *mCurrentLoadRequest;
+            switch (request.GetState())
+            {
+            case ModelLoadState::Processing:
+                ImGui::ProgressBar(request.GetProgress(), { -1.0f, 0.0f }, "Processing...");
+                break;
+            case ModelLoadState::Uploading:
+                ImGui::ProgressBar(request.GetProgress(), { -1.0f, 0.0f }, "Uploading...");
+                break;
+            case ModelLoadState::Completed:
+                ImGui::TextUnformatted("Loaded.");
+                break;
+            case ModelLoadState::Cancelled:
+                ImGui::TextUnformatted("Cancelled.");
+                break;
+            case ModelLoadState::Failed:
+                ImGui::TextUnformatted("Failed to load.");
+                break;
+            }
+            if (!request.IsFinished() && ImGui::Button("Cancel"))
+            {
+                mCurrentLoadRequest->Cancel();
+            }
+            ImGui::Text("Load time: %.1f ms (Max frame time: %.2f ms)", request.GetElapsedTimeMS(), request.GetMaxFrameTimeMS());
+        }
     }
 
-    SharedPtr<Scene> ModelLoaderSystem::LoadModel(const ModelPathInfo& pathInfo)
+    SharedPtr<ModelLoadRequest> ModelLoaderSystem::LoadModel(const ModelPathInfo& pathInfo)
     {
-        switch (pathInfo.type)
-        {
-        case ModelType::glTF:
-            return LoadModel_glTF(pathInfo);
-        case ModelType::Obj:
-            return LoadModel_Obj(pathInfo);
-        default:
-            NOT_IMPLEMENTED();
-        }
+        SharedPtr<ModelLoadRequest> request = std::make_shared<ModelLoadRequest>(pathInfo, GetMeshMetadata());
+
+        // The request is kept in mLoadRequests until the job is finished.
+        ModelLoadRequest* pRequest = request.get();
+        request->mJobHandle = Engine::GetJobSystem().Schedule([pRequest]()
+        {
+            switch (pRequest->mPathInfo.type)
+            {
+            case ModelType::glTF:
+                pRequest->mLoadData = LoadModel_glTF(pRequest->mPathInfo, *pRequest, Engine::GetJobSystem());
+                break;
+            case ModelType::Obj:
+                pRequest->mLoadData = LoadModel_Obj(pRequest->mPathInfo, *pRequest);
+                break;
+            default:
+                NOT_IMPLEMENTED();
+            }
+        });
+        mLoadRequests.push_back(request);
 
-        return nullptr;
+        return request;
+    }
+
+    bool ModelLoaderSystem::IsLoading()
+    {
+        return !mLoadRequests.empty();
     }
 
     void ModelLoaderSystem::LoadModelList()
@@ -314,6 +635,77 @@ namespace cube
         }
     }
 
+    int ModelLoaderSystem::FindModelIndexFromParam(AnsiStringView paramName, AnsiStringView param)
+    {
+        // Parse format: <type>_<index> (e.g., gltf_0, default_2)
+        SizeType underscorePos = param.rfind('_');
+        if (underscorePos == AnsiStringView::npos || underscorePos == 0 || underscorePos == param.size() - 1)
+        {
+            CUBE_LOG(Error, ModelLoaderSystem, "Invalid --{0} format ({1}). Expected <type>_<index>.", paramName, param);
+            return -1;
+        }
+
+        AnsiStringView modelTypeStr = param.substr(0, underscorePos);
+        AnsiStringView indexStr = param.substr(underscorePos + 1);
+
+        int index = -1;
+        try
+        {
+            index = std::stoi(AnsiString(indexStr));
+        }
+        catch (...)
+        {
+            CUBE_LOG(Error, ModelLoaderSystem, "Invalid --{0} index ({1}). Must be an integer.", paramName, indexStr);
+            return -1;
+        }
+
+        ModelType type;
+        if (modelTypeStr == "gltf")
+        {
+            type = ModelType::glTF;
+        }
+        else if (modelTypeStr == "default")
+        {
+            type = ModelType::Obj;
+        }
+        else
+        {
+            CUBE_LOG(Error, ModelLoaderSystem, "Invalid --{0} type ({1}). Must be 'gltf' or 'default'.", paramName, modelTypeStr);
+            return -1;
+        }
+
+        LoadModelList();
+
+        int typeCount = 0;
+        for (int i = 0; i < static_cast<int>(mModelPathList.size()); ++i)
+        {
+            if (mModelPathList[i].type == type)
+            {
+                if (typeCount == index)
+                {
+                    return i;
+                }
+                ++typeCount;
+            }
+        }
+
+        CUBE_LOG(Error, ModelLoaderSystem, "Model index {0} out of range for type ({1}) (size: {2}).", index, modelTypeStr, typeCount);
+        return -1;
+    }
+
+    bool ModelLoaderSystem::LoadModelData_glTF(const ModelPathInfo& pathInfo, JobSystem& jobSystem, ModelLoadTimings& outTimings)
+    {
+        ModelLoadRequest request(pathInfo, GetMeshMetadata());
+        UniquePtr<ModelLoadData> data = LoadModel_glTF(pathInfo, request, jobSystem);
+        if (!data)
+        {
+            return false;
+        }
+
+        outTimings = data->timings;
+        return true;
+    }
+
     void ModelLoaderSystem::LoadCurrentModelAndSet(bool resetTransform)
     {
         if (resetTransform)
@@ -321,11 +713,19 @@ namespace cube
             ResetModelTransform();
         }
 
+        // The previous scene is shown until the new one is published.
+        if (mCurrentLoadRequest)
+        {
+            mCurrentLoadRequest->Cancel();
+            mCurrentLoadRequest = nullptr;
+        }
+
         if (mCurrentSelectModelIndex != -1)
         {
             const ModelPathInfo& info = mModelPathList[mCurrentSelectModelIndex];
 
-            Engine::SetScene(LoadModel(info));
+            mCurrentLoadRequest = LoadModel(info);
+            mIsCurrentScenePublished = false;
         }
         else
         {
@@ -340,12 +740,22 @@ namespace cube
         }
     }
 
-    SharedPtr<Scene> ModelLoaderSystem::LoadModel_glTF(const ModelPathInfo& pathInfo)
+    UniquePtr<ModelLoadData> ModelLoaderSystem::LoadModel_glTF(const ModelPathInfo& pathInfo, ModelLoadRequest& request, JobSystem& jobSystem)
     {
+        Uint64 stageStartTime = GetNowNS();
+        auto EndStage = [&stageStartTime]()
+        {
+            const Uint64 now = GetNowNS();
+            const double elapsedMS = static_cast<double>(now - stageStartTime) / 1'000'000.0;
+            stageStartTime = now;
+            return elapsedMS;
+        };
+
         tinygltf::Model model;
         AnsiString error;
         AnsiString warning;
         tinygltf::TinyGLTF loader;
+        loader.SetImageLoader(&KeepEncodedImageData, nullptr);
 
         AnsiString pathStr = pathInfo.path.ToAnsiString();
         bool res = loader.LoadASCIIFromFile(&model, &error, &warning, pathStr);
@@ -363,86 +773,92 @@ namespace cube
         if (!res)
         {
             CUBE_LOG(Error, ModelLoaderSystem, "Failed to load the model from glTF");
-            return {};
+            return nullptr;
         }
 
-        FrameString modelName = String_Convert<FrameString>(pathInfo.name);
+        UniquePtr<ModelLoadData> data = std::make_unique<ModelLoadData>();
+        data->timings.parseTimeMS = EndStage();
 
-        // Load materials.
-        Vector<SharedPtr<Material>> materials;
-        HashMap<int, SharedPtr<TextureResource>> loadedImageCache;
+        Uint64 numPrimitives = 0;
+        for (const tinygltf::Mesh& mesh : model.meshes)
+        {
+            numPrimitives += mesh.primitives.size();
+        }
+        // Materials are counted as one step, and each image / primitive / mesh is a step.
+        const Uint64 numSteps = 1 + model.images.size() + numPrimitives + model.meshes.size();
+        std::atomic<Uint64> numFinishedSteps = 0;
+        auto FinishStep = [&request, &numFinishedSteps, numSteps]()
+        {
+            const Uint64 numFinished = numFinishedSteps.fetch_add(1, std::memory_order_relaxed) + 1;
+            request.SetProgress(0.5f * numFinished / numSteps);
+        };
+
+        // Load materials. The textures are decoded in parallel after all materials are made, and set in the upload.
+        // loadedImageCache is filled here in a single thread. The decode jobs only write their own slots in data->textures,
+        // so it is not accessed concurrently.
+        Vector<SharedPtr<Material>>& materials = data->materials;
+        HashMap<int, int> loadedImageCache; // Image index -> Texture index
+        Vector<int> textureImageIndices; // Texture index -> Image index
 
         for (const tinygltf::Material& gltfMaterial : model.materials)
         {
-            auto LoadTexture = [&model, &loadedImageCache](StringView materialName, const Character* textureName, int textureIndex) -> SharedPtr<TextureResource>
+            if (request.IsCancelled())
+            {
+                return nullptr;
+            }
+
+            auto LoadTexture = [&model, &loadedImageCache, &textureImageIndices, &data](StringView materialName, const Character* textureName, int textureIndex) -> int
             {
                 FrameString debugName = Format<FrameString>(CUBE_T("[{0}] {1}"), materialName, textureName);
 
                 if (textureIndex == -1)
                 {
                     CUBE_LOG(Warning, ModelLoaderSystem, "Cannot load {0}: invalid texture index", debugName);
-                    return nullptr;
+                    return -1;
                 }
                 int imageIndex = model.textures[textureIndex].source;
                 if (imageIndex == -1)
                 {
                     CUBE_LOG(Warning, ModelLoaderSystem, "Cannot load {0}: invalid image index", debugName);
-                    return nullptr;
+                    return -1;
                 }
-                HashMap<int, SharedPtr<TextureResource>>::iterator cacheIt = loadedImageCache.find(imageIndex);
+                HashMap<int, int>::iterator cacheIt = loadedImageCache.find(imageIndex);
                 if (cacheIt != loadedImageCache.end())
                 {
                     return cacheIt->second;
                 }
-                tinygltf::Image& image = model.images[imageIndex];
+                const tinygltf::Image& image = model.images[imageIndex];
                 if (image.image.empty())
                 {
                     CUBE_LOG(Warning, ModelLoaderSystem, "Cannot load {0}: empty image data", debugName);
-                    return nullptr;
+                    return -1;
                 }
                 // Append file path.
                 debugName = Format<FrameString>(CUBE_T("{0}({1})"), debugName, image.uri);
 
-                gapi::ElementFormat format = gapi::ElementFormat::Unknown;
-                if (image.component == 4)
-                {
-                    if (image.pixel_type == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE)
-                    {
-                        format = gapi::ElementFormat::RGBA8_UNorm;
-                    }
-                    else if (image.pixel_type == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT)
-                    {
-                        format = gapi::ElementFormat::RGBA16_UNorm;
-                    }
-                }
-                if (format == gapi::ElementFormat::Unknown)
-                {
-                    CUBE_LOG(Warning, ModelLoaderSystem, "Cannot load {0}: Unsupported element format (component: {1}, pixel_type: {2})", debugName, image.component, image.pixel_type);
-                    return nullptr;
-                }
-
-                TextureResourceCreateInfo createInfo = {
-                    .textureInfo = {
-                        .format = format,
-                        .type = gapi::TextureType::Texture2D,
-                        .width = static_cast<Uint32>(image.width),
-                        .height = static_cast<Uint32>(image.height),
-                    },
-                    .data = BlobView(image.image.data(), image.image.size()),
-                    .bytesPerElement = static_cast<Uint32>(image.component * image.bits / 8),
-                    .generateMipMaps = true,
-                    .debugName = debugName
-                };
-                SharedPtr<TextureResource> texture = std::make_shared<TextureResource>(createInfo);
-                loadedImageCache.emplace(imageIndex, texture);
+                // The raw data is filled in the decode.
+                const int loadedTextureIndex = static_cast<int>(data->textures.size());
+                data->textures.push_back({
+                    .debugName = String(debugName.begin(), debugName.end())
+                });
+                textureImageIndices.push_back(imageIndex);
+                loadedImageCache.emplace(imageIndex, loadedTextureIndex);
 
-                return texture;
+                return loadedTextureIndex;
             };
 
             FrameString materialName = String_Convert<FrameString>(gltfMaterial.name);
             materials.push_back(std::make_shared<Material>(materialName));
 
+            const int materialIndex = static_cast<int>(materials.size() - 1);
             SharedPtr<Material> material = materials.back();
+            auto SetTexture = [&data, materialIndex](int slotIndex, int textureIndex)
+            {
+                if (textureIndex != -1)
+                {
+                    data->materialTextureSlots.push_back({ .materialIndex = materialIndex, .slotIndex = slotIndex, .textureIndex = textureIndex });
+                }
+            };
 
             if (gltfMaterial.alphaMode == "MASK")
             {
@@ -455,7 +871,7 @@ namespace cube
             FrameString channelMappingCode;
             if (gltfMaterial.pbrMetallicRoughness.baseColorTexture.index != -1)
             {
-                material->SetTexture(0, LoadTexture(materialName, CUBE_T("baseColorTexture"), gltfMaterial.pbrMetallicRoughness.baseColorTexture.index));
+                SetTexture(0, LoadTexture(materialName, CUBE_T("baseColorTexture"), gltfMaterial.pbrMetallicRoughness.baseColorTexture.index));
                 channelMappingCode += CUBE_T("float4 baseColor = materialData.textureSlot0.Sample(GetStaticLinearWrapSampler(), input.uv).rgba;\n");
                 // Encoded in sRGB. Decode to linear.
                 channelMappingCode += CUBE_T("value.albedo = GammaCorrection::sRGBToLinear(baseColor.rgb);\n");
@@ -466,7 +882,7 @@ namespace cube
             }
             if (gltfMaterial.pbrMetallicRoughness.metallicRoughnessTexture.index != -1)
             {
-                material->SetTexture(1, LoadTexture(materialName, CUBE_T("metallicRoughnessTexture"), gltfMaterial.pbrMetallicRoughness.metallicRoughnessTexture.index));
+                SetTexture(1, LoadTexture(materialName, CUBE_T("metallicRoughnessTexture"), gltfMaterial.pbrMetallicRoughness.metallicRoughnessTexture.index));
                 channelMappingCode += CUBE_T("float3 roughnessAndMetallic = materialData.textureSlot1.Sample(GetStaticLinearWrapSampler(), input.uv).rgb;\n");
                 channelMappingCode += CUBE_T("value.metallic = roughnessAndMetallic.b;\n");
                 channelMappingCode += CUBE_T("value.roughness = roughnessAndMetallic.g;\n");
@@ -475,7 +891,7 @@ namespace cube
             }
             if (gltfMaterial.normalTexture.index != -1)
             {
-                material->SetTexture(2, LoadTexture(materialName, CUBE_T("normalTexture"), gltfMaterial.normalTexture.index));
+                SetTexture(2, LoadTexture(materialName, CUBE_T("normalTexture"), gltfMaterial.normalTexture.index));
                 channelMappingCode += CUBE_T("float3 normal = normalize(materialData.textureSlot2.Sample(GetStaticLinearWrapSampler(), input.uv).rgb * 2.0f - 1.0f);\n");
                 channelMappingCode += CUBE_T("value.normal = normal;\n");
 
@@ -483,7 +899,7 @@ namespace cube
             }
             if (gltfMaterial.emissiveTexture.index != -1)
             {
-                material->SetTexture(3, LoadTexture(materialName, CUBE_T("emissiveTexture"), gltfMaterial.emissiveTexture.index));
+                SetTexture(3, LoadTexture(materialName, CUBE_T("emissiveTexture"), gltfMaterial.emissiveTexture.index));
                 // Encoded in sRGB. Decode to linear.
                 channelMappingCode += CUBE_T("float3 emissive = materialData.textureSlot3.Sample(GetStaticLinearWrapSampler(), input.uv).rgb;\n");
                 channelMappingCode += CUBE_T("value.emissive = GammaCorrection::sRGBToLinear(emissive);\n");
@@ -493,7 +909,7 @@ namespace cube
             }
             if (gltfMaterial.occlusionTexture.index != -1)
             {
-                material->SetTexture(4, LoadTexture(materialName, CUBE_T("occlusionTexture"), gltfMaterial.occlusionTexture.index));
+                SetTexture(4, LoadTexture(materialName, CUBE_T("occlusionTexture"), gltfMaterial.occlusionTexture.index));
                 channelMappingCode += CUBE_T("float occlusion = materialData.textureSlot4.Sample(GetStaticLinearWrapSampler(), input.uv).r;\n");
                 channelMappingCode += CUBE_T("value.indirectOcclusion = occlusion;\n");
 
@@ -501,302 +917,177 @@ namespace cube
             }
             material->SetChannelMappingCode(channelMappingCode);
         }
+        FinishStep();
+        data->timings.materialTimeMS = EndStage();
 
-        // Load meshes.
-        FrameVector<SharedPtr<Mesh>> meshes;
-        FrameVector<FrameVector<WeakPtr<Material>>> materialsPerMeshes;
-
-        for (const tinygltf::Mesh& mesh : model.meshes)
+        // Decode the images. One job per image.
+        Vector<Uint8> isTextureDecoded(data->textures.size(), 0);
+        jobSystem.ParallelFor(0, data->textures.size(), 1, [&](Uint64 textureIndex)
         {
-            constexpr int NONE = -1;
-
-            FrameVector<Vertex> vertices;
-            FrameVector<Index> indices;
-            FrameVector<SubMesh> subMeshes;
-
-            FrameVector<WeakPtr<Material>>& materialsPerMesh = materialsPerMeshes.emplace_back();
-
-            for (const tinygltf::Primitive& prim : mesh.primitives)
+            if (request.IsCancelled())
             {
-                int positionAccessor = NONE;
-                int normalAccessor = NONE;
-                int tangentAccessor = NONE;
-                int colorAccessor = NONE;
-                int texCoordAccessor = NONE;
+                return;
+            }
 
-                if (auto posIt = prim.attributes.find("POSITION"); posIt != prim.attributes.end())
-                {
-                    positionAccessor = posIt->second;
-                }
-                if (auto normalIt = prim.attributes.find("NORMAL"); normalIt != prim.attributes.end())
-                {
-                    normalAccessor = normalIt->second;
-                }
-                if (auto tangentIt = prim.attributes.find("TANGENT"); tangentIt != prim.attributes.end())
-                {
-                    tangentAccessor = tangentIt->second;
-                }
-                if (auto colorIt = prim.attributes.find("COLOR_0"); colorIt != prim.attributes.end())
+            const tinygltf::Image& image = model.images[textureImageIndices[textureIndex]];
+            isTextureDecoded[textureIndex] = DecodeImage(image, data->textures[textureIndex].rawData);
+            FinishStep();
+        });
+        if (request.IsCancelled())
+        {
+            return nullptr;
+        }
+        // Remove the textures failed to decode and remap the slots.
+        {
+            Vector<int> remappedTextureIndices(data->textures.size(), -1);
+            int numDecodedTextures = 0;
+            for (int i = 0; i < static_cast<int>(data->textures.size()); ++i)
+            {
+                if (isTextureDecoded[i])
                 {
-                    colorAccessor = colorIt->second;
+                    remappedTextureIndices[i] = numDecodedTextures;
+                    if (i != numDecodedTextures)
+                    {
+                        data->textures[numDecodedTextures] = std::move(data->textures[i]);
+                    }
+                    ++numDecodedTextures;
                 }
-                if (auto texIt = prim.attributes.find("TEXCOORD_0"); texIt != prim.attributes.end())
+                else
                 {
-                    texCoordAccessor = texIt->second;
+                    CUBE_LOG(Warning, ModelLoaderSystem, "Cannot load {0}: failed to decode the image", data->textures[i].debugName);
                 }
+            }
+            data->textures.resize(numDecodedTextures);
+
+            std::erase_if(data->materialTextureSlots, [&remappedTextureIndices](ModelLoadData::MaterialTextureSlot& slot)
+            {
+                slot.textureIndex = remappedTextureIndices[slot.textureIndex];
+                return slot.textureIndex == -1;
+            });
+        }
+        data->timings.imageDecodeTimeMS = EndStage();
+
+        // Load meshes.
+        // The ranges of all primitives are computed first, so each mesh allocates its vertices / indices once
+        // and the primitives are decoded into their ranges in parallel.
+        // The vertices / indices are in the heap, not in the frame allocator, because the job can run in the fiber with the small frame allocator.
+        struct PrimitiveTask
+        {
+            int meshIndex;
+            int primitiveIndex;
+            Uint64 vertexOffset;
+            Uint64 numVertices;
+            Uint64 indexOffset;
+            Uint64 numIndices;
+        };
+        struct MeshBuffer
+        {
+            Vector<Vertex> vertices;
+            Vector<Index> indices;
+            Vector<SubMesh> subMeshes;
+        };
+        Vector<PrimitiveTask> primitiveTasks;
+        primitiveTasks.reserve(numPrimitives);
+        Vector<MeshBuffer> meshBuffers(model.meshes.size());
+        data->materialIndicesPerMeshes.resize(model.meshes.size());
+
+        for (int meshIndex = 0; meshIndex < static_cast<int>(model.meshes.size()); ++meshIndex)
+        {
+            const tinygltf::Mesh& mesh = model.meshes[meshIndex];
+            MeshBuffer& meshBuffer = meshBuffers[meshIndex];
+            Vector<int>& materialsPerMesh = data->materialIndicesPerMeshes[meshIndex];
+
+            Uint64 vertexOffset = 0;
+            Uint64 indexOffset = 0;
+            for (int primitiveIndex = 0; primitiveIndex < static_cast<int>(mesh.primitives.size()); ++primitiveIndex)
+            {
+                const tinygltf::Primitive& prim = mesh.primitives[primitiveIndex];
+                CHECK_FORMAT(prim.mode == TINYGLTF_MODE_TRIANGLES, "Currently only support triangle mode.");
+                CHECK_FORMAT(prim.indices != -1, "Currently only support the primitives with indices.");
 
                 Uint64 numVertices = 0;
-                auto UpdateNumVertices = [&model, &numVertices](int accessorIndex)
+                for (const auto& [attributeName, accessorIndex] : prim.attributes)
                 {
-                    if (accessorIndex != NONE)
+                    if (attributeName != "POSITION" && attributeName != "NORMAL" && attributeName != "TANGENT"
+                        && attributeName != "TEXCOORD_0" && attributeName != "COLOR_0")
                     {
-                        const Uint64 count = model.accessors[accessorIndex].count;
-                        if (numVertices > 0 && numVertices != count)
-                        {
-                            CUBE_LOG(Warning, ModelLoaderSystem, "Mismatch count in vertices ({0} != {1}). Use the greater one.", numVertices, count);
-                        }
-                        numVertices = std::max(numVertices, count);
+                        continue;
                     }
-                };
-                UpdateNumVertices(positionAccessor);
-                UpdateNumVertices(normalAccessor);
-                UpdateNumVertices(tangentAccessor);
-                UpdateNumVertices(colorAccessor);
-                UpdateNumVertices(texCoordAccessor);
-
-                const Uint64 vertexOffset = vertices.size();
-                const Uint64 indexOffset = indices.size();
+
+                    const Uint64 count = model.accessors[accessorIndex].count;
+                    if (numVertices > 0 && numVertices != count)
+                    {
+                        CUBE_LOG(Warning, ModelLoaderSystem, "Mismatch count in vertices ({0} != {1}). Use the greater one.", numVertices, count);
+                    }
+                    numVertices = std::max(numVertices, count);
+                }
                 const Uint64 numIndices = model.accessors[prim.indices].count;
 
-                subMeshes.push_back({
+                meshBuffer.subMeshes.push_back({
                     .vertexOffset = vertexOffset,
                     .indexOffset = indexOffset,
                     .numIndices = numIndices,
                     .materialIndex = static_cast<int>(materialsPerMesh.size()),
                     .debugName = Format<String>(CUBE_T("{0}"), mesh.name)
                 });
-                materialsPerMesh.emplace_back(prim.material != -1 ? materials[prim.material] : nullptr);
-
-                vertices.insert(vertices.end(), numVertices, {});
-
-                auto ProcessData = [&model](int accessorIndex, std::function<void(const tinygltf::Accessor&)> checker, std::function<void(Uint64, const void*, int, int)> onComponent)
-                {
-                    const tinygltf::Accessor& accessor = model.accessors[accessorIndex];
-                    const tinygltf::BufferView& bufferView = model.bufferViews[accessor.bufferView];
-                    const tinygltf::Buffer& buffer = model.buffers[bufferView.buffer];
+                materialsPerMesh.push_back(prim.material);
 
-                    checker(accessor);
-
-                    const Uint64 count = accessor.count;
-                    const Uint64 offset = accessor.byteOffset + bufferView.byteOffset;
-                    CHECK(accessor.ByteStride(bufferView) == std::max((Uint64)bufferView.byteStride, (Uint64)tinygltf::GetComponentSizeInBytes(accessor.componentType) * tinygltf::GetNumComponentsInType(accessor.type)));
-                    const Uint64 stride = accessor.ByteStride(bufferView);
-                    for (Uint64 i = 0; i < count; ++i)
-                    {
-                        onComponent(i, (void*)&(buffer.data[offset + stride * i]), accessor.type, accessor.componentType);
-                    }
-                };
-                // POSITION
-                if (positionAccessor != NONE)
-                {
-                    ProcessData(positionAccessor,
-                        [](const tinygltf::Accessor& accessor)
-                        {
-                            CHECK(accessor.type == TINYGLTF_TYPE_VEC3);
-                            CHECK(accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT);
-                        },
-                        [&vertices, vertexOffset](Uint64 index, const void* pData, int type, int componentType)
-                        {
-                            float xyz[3];
-                            memcpy(xyz, pData, sizeof(xyz));
-
-                            vertices[vertexOffset + index].position = { xyz[0], xyz[1], xyz[2], 1.0f };
-                        }
-                    );
-                }
-                // NORMAL
-                if (normalAccessor != NONE)
-                {
-                    ProcessData(normalAccessor,
-                        [](const tinygltf::Accessor& accessor)
-                        {
-                            CHECK(accessor.type == TINYGLTF_TYPE_VEC3);
-                            CHECK(accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT);
-                        },
-                        [&vertices, vertexOffset](Uint64 index, const void* pData, int type, int componentType)
-                        {
-                            float xyz[3];
-                            memcpy(xyz, pData, sizeof(xyz));
-
-                            vertices[vertexOffset + index].normal = { xyz[0], xyz[1], xyz[2] };
-                        }
-                    );
-                }
-                else
-                {
-                    CUBE_LOG(Info, ModelLoaderSystem, "No normal data found in the model. Calculate normal from position and index.");
-                    MeshHelper::SetNormalVector(ArrayView(vertices.begin() + vertexOffset, numVertices), ArrayView(indices.begin() + indexOffset, numIndices));
-                }
-                // TANGENT
-                if (tangentAccessor != NONE)
-                {
-                    ProcessData(tangentAccessor,
-                        [](const tinygltf::Accessor& accessor)
-                        {
-                            CHECK(accessor.type == TINYGLTF_TYPE_VEC4);
-                            CHECK(accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT);
-                        },
-                        [&vertices, vertexOffset](Uint64 index, const void* pData, int type, int componentType)
-                        {
-                            float xyzw[4];
-                            memcpy(xyzw, pData, sizeof(xyzw));
-
-                            vertices[vertexOffset + index].tangent = { xyzw[0], xyzw[1], xyzw[2], xyzw[3] };
-                        }
-                    );
-                }
-                else
-                {
-                    CUBE_LOG(Info, ModelLoaderSystem, "No tangent data found in the model. Calculate approximate tangent from normal.");
-                    MeshHelper::SetApproxTangentVector(ArrayView(vertices.begin() + vertexOffset, numVertices));
-                }
-                // TEXCOORD
-                if (texCoordAccessor != NONE)
-                {
-                    ProcessData(texCoordAccessor,
-                        [](const tinygltf::Accessor& accessor)
-                        {
-                            CHECK(accessor.type == TINYGLTF_TYPE_VEC2);
-                            CHECK(accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT
-                                || accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE
-                                || accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT);
-                        },
-                        [&vertices, vertexOffset](Uint64 index, const void* pData, int type, int componentType)
-                        {
-                            float uv[2];
-                            if (componentType == TINYGLTF_COMPONENT_TYPE_FLOAT)
-                            {
-                                memcpy(uv, pData, sizeof(uv));
-                            }
-                            else if (componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE)
-                            {
-                                unsigned char uvByte[2];
-                                memcpy(uvByte, pData, sizeof(uvByte));
-                                uv[0] = static_cast<float>(uvByte[0]) / 255.0f;
-                                uv[1] = static_cast<float>(uvByte[1]) / 255.0f;
-                            }
-                            else if (componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT)
-                            {
-                                unsigned short uvShort[2];
-                                memcpy(uvShort, pData, sizeof(uvShort));
-                                uv[0] = static_cast<float>(uvShort[0]) / 65535.0f;
-                                uv[1] = static_cast<float>(uvShort[1]) / 65535.0f;
-                            }
-
-                            vertices[vertexOffset + index].uv = { uv[0], uv[1] };
-                        }
-                    );
-                }
-                // COLOR
-                if (colorAccessor != NONE)
-                {
-                    ProcessData(colorAccessor,
-                        [](const tinygltf::Accessor& accessor)
-                        {
-                            CHECK(accessor.type == TINYGLTF_TYPE_VEC3
-                                || accessor.type == TINYGLTF_TYPE_VEC4);
-                            CHECK(accessor.componentType == TINYGLTF_COMPONENT_TYPE_FLOAT
-                                || accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE
-                                || accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT);
-                        },
-                        [&vertices, vertexOffset](Uint64 index, const void* pData, int type, int componentType)
-                        {
-                            float rgba[4];
-                            rgba[3] = 1.0f;
+                primitiveTasks.push_back({
+                    .meshIndex = meshIndex,
+                    .primitiveIndex = primitiveIndex,
+                    .vertexOffset = vertexOffset,
+                    .numVertices = numVertices,
+                    .indexOffset = indexOffset,
+                    .numIndices = numIndices
+                });
 
-                            int num = 4;
-                            if (type == TINYGLTF_TYPE_VEC3)
-                            {
-                                num = 3;
-                            }
+                vertexOffset += numVertices;
+                indexOffset += numIndices;
+            }
 
-                            if (componentType == TINYGLTF_COMPONENT_TYPE_FLOAT)
-                            {
-                                memcpy(rgba, pData, sizeof(float) * num);
-                            }
-                            else if (componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE)
-                            {
-                                unsigned char rgbaByte[4];
-                                rgbaByte[3] = 255;
-                                memcpy(rgbaByte, pData, sizeof(unsigned char) * num);
-                                rgba[0] = static_cast<float>(rgbaByte[0]) / 255.0f;
-                                rgba[1] = static_cast<float>(rgbaByte[1]) / 255.0f;
-                                rgba[2] = static_cast<float>(rgbaByte[2]) / 255.0f;
-                                rgba[3] = static_cast<float>(rgbaByte[3]) / 255.0f;
-                            }
-                            else if (componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT)
-                            {
-                                unsigned short rgbaShort[4];
-                                rgbaShort[3] = 65535;
-                                memcpy(rgbaShort, pData, sizeof(unsigned short) * num);
-                                rgba[0] = static_cast<float>(rgbaShort[0]) / 65535.0f;
-                                rgba[1] = static_cast<float>(rgbaShort[1]) / 65535.0f;
-                                rgba[2] = static_cast<float>(rgbaShort[2]) / 65535.0f;
-                                rgba[3] = static_cast<float>(rgbaShort[3]) / 65535.0f;
-                            }
+            meshBuffer.vertices.resize(vertexOffset);
+            meshBuffer.indices.resize(indexOffset);
+        }
 
-                            vertices[vertexOffset + index].color = { rgba[0], rgba[1], rgba[2], rgba[3] };
-                        }
-                    );
-                }
+        jobSystem.ParallelFor(0, primitiveTasks.size(), 1, [&](Uint64 taskIndex)
+        {
+            if (request.IsCancelled())
+            {
+                return;
+            }
 
-                // Index
-                {
-                    CHECK_FORMAT(prim.mode == TINYGLTF_MODE_TRIANGLES, "Currently only support triangle mode.");
-                    indices.insert(indices.end(), numIndices, {});
-                    ProcessData(prim.indices,
-                        [](const tinygltf::Accessor& accessor)
-                        {
-                            CHECK(accessor.type == TINYGLTF_TYPE_SCALAR);
-                            CHECK(accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE
-                                || accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT
-                                || accessor.componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT)
-                        },
-                        [&indices, indexOffset](Uint64 index, const void* pData, int type, int componentType)
-                        {
-                            Uint32 v = 0;
-                            if (componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE)
-                            {
-                                unsigned char ch;
-                                memcpy(&ch, pData, sizeof(ch));
-                                v = ch;
-                            }
-                            else if (componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT)
-                            {
-                                unsigned short sh;
-                                memcpy(&sh, pData, sizeof(sh));
-                                v = sh;
-                            }
-                            else if (componentType == TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT)
-                            {
-                                unsigned int in;
-                                memcpy(&in, pData, sizeof(in));
-                                v = in;
-                            }
+            const PrimitiveTask& task = primitiveTasks[taskIndex];
+            MeshBuffer& meshBuffer = meshBuffers[task.meshIndex];
+            ProcessPrimitive(model, model.meshes[task.meshIndex].primitives[task.primitiveIndex],
+                ArrayView<Vertex>(meshBuffer.vertices.data() + task.vertexOffset, task.numVertices),
+                ArrayView<Index>(meshBuffer.indices.data() + task.indexOffset, task.numIndices));
+            FinishStep();
+        });
+        if (request.IsCancelled())
+        {
+            return nullptr;
+        }
 
-                            indices[indexOffset + index] = v;
-                        }
-                    );
-                }
+        data->meshes.resize(model.meshes.size());
+        jobSystem.ParallelFor(0, model.meshes.size(), 1, [&](Uint64 meshIndex)
+        {
+            if (request.IsCancelled())
+            {
+                return;
             }
 
-            SharedPtr<MeshData> meshData = std::make_shared<MeshData>(vertices, indices, subMeshes, String_Convert<String>(mesh.name));
-            meshes.push_back(std::make_shared<Mesh>(meshData, GetMeshMetadata()));
+            MeshBuffer& meshBuffer = meshBuffers[meshIndex];
+            data->meshes[meshIndex] = std::make_shared<MeshData>(meshBuffer.vertices, meshBuffer.indices, meshBuffer.subMeshes, String_Convert<String>(model.meshes[meshIndex].name));
+            meshBuffer = {};
+            FinishStep();
+        });
+        if (request.IsCancelled())
+        {
+            return nullptr;
         }
+        data->timings.meshTimeMS = EndStage();
 
-        // Make scene and scene objects.
-        SharedPtr<Scene> scene = std::make_shared<Scene>();
-
+        // Make scene objects.
         if (model.defaultScene != -1)
         {
             tinygltf::Scene& gltfScene = model.scenes[model.defaultScene];
@@ -804,17 +1095,13 @@ namespace cube
             {
                 tinygltf::Node& node = model.nodes[nodeIndex];
 
-                UniquePtr<SceneObject> obj = std::make_unique<SceneObject>(
-                    String_Convert<FrameString>(node.name),
-                    node.mesh != -1 ? meshes[node.mesh] : nullptr);
-                if (node.mesh != -1)
-                {
-                    obj->SetMaterials(materialsPerMeshes[node.mesh]);
-                }
+                ModelLoadData::ObjectData& obj = data->objects.emplace_back();
+                obj.name = String_Convert<String>(node.name);
+                obj.meshIndex = node.mesh;
 
                 if (!node.translation.empty())
                 {
-                    obj->SetPosition({ (float)node.translation[0], (float)node.translation[1], (float)node.translation[2] });
+                    obj.position = { (float)node.translation[0], (float)node.translation[1], (float)node.translation[2] };
                 }
                 if (!node.rotation.empty())
                 {
@@ -822,22 +1109,15 @@ namespace cube
                 }
                 if (!node.scale.empty())
                 {
-                    obj->SetScale({ (float)node.scale[0], (float)node.scale[1], (float)node.scale[2] });
+                    obj.scale = { (float)node.scale[0], (float)node.scale[1], (float)node.scale[2] };
                 }
-
-                scene->AddSceneObject(std::move(obj));
-            }
-
-            for (SharedPtr<Material>& material : materials)
-            {
-                scene->AddMaterial(material);
             }
         }
 
-        return scene;
+        return data;
     }
 
-    SharedPtr<Scene> ModelLoaderSystem::LoadModel_Obj(const ModelPathInfo& pathInfo)
+    UniquePtr<ModelLoadData> ModelLoaderSystem::LoadModel_Obj(const ModelPathInfo& pathInfo, ModelLoadRequest& request)
     {
         FrameString modelName = String_Convert<FrameString>(pathInfo.name);
 
@@ -855,15 +1135,25 @@ namespace cube
         if (objFiles.empty())
         {
             CUBE_LOG(Error, ModelLoaderSystem, "No .obj files found in folder: {0}", modelName);
-            return {};
+            return nullptr;
         }
 
-        SharedPtr<Scene> scene = std::make_shared<Scene>();
+        UniquePtr<ModelLoadData> data = std::make_unique<ModelLoadData>();
+        Uint64 numFinishedFiles = 0;
 
-        Vector<SharedPtr<Material>> materials;
+        // The textures are uploaded and set later.
+        Vector<SharedPtr<Material>>& materials = data->materials;
 
         for (const String& objFile : objFiles)
         {
+            if (request.IsCancelled())
+            {
+                return nullptr;
+            }
+
+            // Parsing scratch of each file is released before the next one.
+            FrameScratchScope scratchScope;
+
             AnsiString objFilePathAnsi = (pathInfo.path / objFile).ToAnsiString();
 
             tinyobj::ObjReaderConfig readerConfig;
@@ -882,7 +1172,7 @@ namespace cube
                 CUBE_LOG(Warning, ModelLoaderSystem, "Warning while loading obj: {0}", reader.Warning());
             }
 
-            FrameVector<WeakPtr<Material>> materialsPerObject;
+            Vector<int> materialsPerObject;
             // Load materials.
             const std::vector<tinyobj::material_t>& objMaterials = reader.GetMaterials();
 
@@ -890,10 +1180,11 @@ namespace cube
             {
                 FrameString materialName = Format<FrameString>(CUBE_T("{0}({1})"), modelName, objMaterial.name);
                 SharedPtr<Material> material = std::make_shared<Material>(materialName);
+                const int materialIndex = static_cast<int>(materials.size());
 
                 material->SetBaseColor(Vector4(objMaterial.diffuse[0], objMaterial.diffuse[1], objMaterial.diffuse[2], 1.0f));
 
-                auto LoadTexture = [&modelName, &pathInfo](const Character* textureName, AnsiStringView objTextureName) -> SharedPtr<TextureResource>
+                auto LoadTexture = [&modelName, &pathInfo, &data](const Character* textureName, AnsiStringView objTextureName) -> int
                 {
                     // Normalize backslashes to forward slashes for cross-platform
                     AnsiString objTextureNameAnsi = AnsiString(objTextureName);
@@ -912,27 +1203,31 @@ namespace cube
                     {
                         FrameString debugName = Format<FrameString>(CUBE_T("[{0}] {1} ({2})"), modelName, textureName, objTextureNameAnsi);
 
-                        TextureResourceCreateInfo createInfo = {
-                            .textureInfo = {
+                        data->textures.push_back({
+                            .rawData = {
                                 .format = gapi::ElementFormat::RGBA8_UNorm,
-                                .type = gapi::TextureType::Texture2D,
                                 .width = static_cast<Uint32>(width),
                                 .height = static_cast<Uint32>(height),
+                                .bytesPerElement = 4,
+                                .data = Blob(imageData, static_cast<Uint64>(width) * height * 4, &GetAssetHeapAllocator(), MemoryTag::Texture)
                             },
-                            .data = BlobView(imageData, static_cast<Uint64>(width) * height * 4),
-                            .bytesPerElement = 4,
-                            .generateMipMaps = true,
-                            .debugName = debugName
-                        };
-                        SharedPtr<TextureResource> texture = std::make_shared<TextureResource>(createInfo);
+                            .debugName = String(debugName.begin(), debugName.end())
+                        });
                         stbi_image_free(imageData);
 
-                        return texture;
+                        return static_cast<int>(data->textures.size() - 1);
                     }
                     else
                     {
                         CUBE_LOG(Warning, ModelLoaderSystem, "Failed to load texture: {0}", texturePath);
-                        return nullptr;
+                        return -1;
+                    }
+                };
+                auto SetTexture = [&data, materialIndex](int slotIndex, int textureIndex)
+                {
+                    if (textureIndex != -1)
+                    {
+                        data->materialTextureSlots.push_back({ .materialIndex = materialIndex, .slotIndex = slotIndex, .textureIndex = textureIndex });
                     }
                 };
 
@@ -944,14 +1239,14 @@ namespace cube
                 {
                     if (!objMaterial.diffuse_texname.empty())
                     {
-                        material->SetTexture(0, LoadTexture(CUBE_T("baseColorTexture"), objMaterial.diffuse_texname));
+                        SetTexture(0, LoadTexture(CUBE_T("baseColorTexture"), objMaterial.diffuse_texname));
                         channelMappingCode += CUBE_T("value.albedo = materialData.textureSlot0.Sample(GetStaticLinearWrapSampler(), input.uv).rgb;\n");
 
                         material->AddAdditionalModule(CUBE_T("StaticSampler"));
                     }
                     if (!objMaterial.metallic_texname.empty())
                     {
-                        material->SetTexture(1, LoadTexture(CUBE_T("metallicTexture"), objMaterial.metallic_texname));
+                        SetTexture(1, LoadTexture(CUBE_T("metallicTexture"), objMaterial.metallic_texname));
                         channelMappingCode += CUBE_T("float t1 = materialData.textureSlot1.Sample(GetStaticLinearWrapSampler(), input.uv).r;\n");
                         channelMappingCode += CUBE_T("value.metallic = t1;\n");
 
@@ -959,7 +1254,7 @@ namespace cube
                     }
                     if (!objMaterial.roughness_texname.empty())
                     {
-                        material->SetTexture(2, LoadTexture(CUBE_T("roughnessTexture"), objMaterial.roughness_texname));
+                        SetTexture(2, LoadTexture(CUBE_T("roughnessTexture"), objMaterial.roughness_texname));
                         channelMappingCode += CUBE_T("float t2 = materialData.textureSlot2.Sample(GetStaticLinearWrapSampler(), input.uv).r;\n");
                         channelMappingCode += CUBE_T("value.roughness = t2;\n");
 
@@ -967,7 +1262,7 @@ namespace cube
                     }
                     if (!objMaterial.normal_texname.empty())
                     {
-                        material->SetTexture(3, LoadTexture(CUBE_T("normalTexture"), objMaterial.normal_texname));
+                        SetTexture(3, LoadTexture(CUBE_T("normalTexture"), objMaterial.normal_texname));
                         channelMappingCode += CUBE_T("float3 t3 = normalize(materialData.textureSlot3.Sample(GetStaticLinearWrapSampler(), input.uv).rgb * 2.0f - 1.0f);\n");
                         channelMappingCode += CUBE_T("value.normal = t3;\n");
 
@@ -978,7 +1273,7 @@ namespace cube
                 {
                     if (!objMaterial.diffuse_texname.empty())
                     {
-                        material->SetTexture(0, LoadTexture(CUBE_T("diffuseTexture"), objMaterial.diffuse_texname));
+                        SetTexture(0, LoadTexture(CUBE_T("diffuseTexture"), objMaterial.diffuse_texname));
                         channelMappingCode += CUBE_T("value.diffuseColor = materialData.textureSlot0.Sample(GetStaticLinearWrapSampler(), input.uv).rgb;\n");
 
                         material->AddAdditionalModule(CUBE_T("StaticSampler"));
@@ -990,7 +1285,7 @@ namespace cube
                     }
                     if (!objMaterial.specular_texname.empty())
                     {
-                        material->SetTexture(1, LoadTexture(CUBE_T("specularTexture"), objMaterial.specular_texname));
+                        SetTexture(1, LoadTexture(CUBE_T("specularTexture"), objMaterial.specular_texname));
                         channelMappingCode += CUBE_T("value.specularColor = materialData.textureSlot1.Sample(GetStaticLinearWrapSampler(), input.uv).rgb;\n");
 
                         material->AddAdditionalModule(CUBE_T("StaticSampler"));
@@ -1005,7 +1300,7 @@ namespace cube
                     channelMappingCode += CUBE_T("value.shininess = materialData.shininess;\n");
                     if (!objMaterial.normal_texname.empty())
                     {
-                        material->SetTexture(2, LoadTexture(CUBE_T("normalTexture"), objMaterial.normal_texname));
+                        SetTexture(2, LoadTexture(CUBE_T("normalTexture"), objMaterial.normal_texname));
                         channelMappingCode += CUBE_T("value.normal = normalize(materialData.textureSlot2.Sample(GetStaticLinearWrapSampler(), input.uv).rgb * 2.0f - 1.0f);\n");
 
                         material->AddAdditionalModule(CUBE_T("StaticSampler"));
@@ -1014,16 +1309,17 @@ namespace cube
                 material->SetChannelMappingCode(channelMappingCode);
 
                 materials.push_back(material);
-                materialsPerObject.push_back(materials.back());
+                materialsPerObject.push_back(materialIndex);
             }
 
             const tinyobj::attrib_t& attrib = reader.GetAttrib();
             const std::vector<tinyobj::shape_t>& objShapes = reader.GetShapes();
 
             // Load meshes.
-            FrameVector<Vertex> vertices;
-            FrameVector<Index> indices;
-            FrameVector<SubMesh> subMeshes;
+            // The vertices / indices are in the heap, not in the frame allocator, because the job can run in the fiber with the small frame allocator.
+            Vector<Vertex> vertices;
+            Vector<Index> indices;
+            Vector<SubMesh> subMeshes;
 
             // tinyobj loads vertex attributes in each separated buffer. (SoA)
             // To convert AoS, add vertex based on each index keys.
@@ -1153,22 +1449,236 @@ namespace cube
             }
 
             // Make scene object.
-            SharedPtr<Mesh> mesh = std::make_shared<Mesh>(
-                std::make_shared<MeshData>(vertices, indices, subMeshes, objFile),
-                GetMeshMetadata()
-            );
+            data->meshes.push_back(std::make_shared<MeshData>(vertices, indices, subMeshes, objFile));
+            data->materialIndicesPerMeshes.push_back(std::move(materialsPerObject));
 
-            UniquePtr<SceneObject> obj = std::make_unique<SceneObject>(objFile, mesh);
-            obj->SetMaterials(materialsPerObject);
-            scene->AddSceneObject(std::move(obj));
+            ModelLoadData::ObjectData& obj = data->objects.emplace_back();
+            obj.name = objFile;
+            obj.meshIndex = static_cast<int>(data->meshes.size() - 1);
+
+            request.SetProgress(0.5f * ++numFinishedFiles / objFiles.size());
         }
 
-        for (SharedPtr<Material>& material : materials)
+        return data;
+    }
+
+    bool ModelLoaderSystem::UpdateLoadRequest(ModelLoadRequest& request, Uint64 uploadEndTime)
+    {
+        if (request.mState == ModelLoadState::Processing)
         {
-            scene->AddMaterial(material);
+            if (!request.mJobHandle.IsFinished())
+            {
+                JobSystem& jobSystem = Engine::GetJobSystem();
+                if (jobSystem.GetNumWorkerThreads() > 0)
+                {
+                    request.mElapsedTimeMS = static_cast<double>(GetNowNS() - request.mStartTime) / 1'000'000.0;
+                    return false;
+                }
+                // No worker thread runs the job. Run it here.
+                jobSystem.Wait(request.mJobHandle);
+            }
+            request.mJobHandle.Reset();
+
+            if (!request.IsCancelled())
+            {
+                if (!request.mLoadData)
+                {
+                    request.mState = ModelLoadState::Failed;
+                    request.mElapsedTimeMS = static_cast<double>(GetNowNS() - request.mStartTime) / 1'000'000.0;
+                    CUBE_LOG(Error, ModelLoaderSystem, "Failed to load {0}.", request.mPathInfo.name);
+                    return true;
+                }
+
+                PublishScene(request);
+                request.mState = ModelLoadState::Uploading;
+            }
+        }
+
+        request.mElapsedTimeMS = static_cast<double>(GetNowNS() - request.mStartTime) / 1'000'000.0;
+        if (request.IsCancelled())
+        {
+            request.mState = ModelLoadState::Cancelled;
+            request.mLoadData = nullptr;
+            request.mPublishedObjects.clear();
+            CUBE_LOG(Info, ModelLoaderSystem, "Cancelled loading {0}.", request.mPathInfo.name);
+            return true;
+        }
+
+        // Meshes first, so the objects are shown with the placeholder material while the textures are uploaded.
+        // At least one resource is uploaded in a frame, so the load always makes progress.
+        ModelLoadData& data = *request.mLoadData;
+        bool isAnyMaterialReady = false;
+        do
+        {
+            if (request.mNumUploadedMeshes < data.meshes.size())
+            {
+                UploadMesh(request, static_cast<int>(request.mNumUploadedMeshes));
+                request.mNumUploadedMeshes++;
+            }
+            else if (request.mNumUploadedTextures < data.textures.size())
+            {
+                isAnyMaterialReady |= UploadTexture(request, static_cast<int>(request.mNumUploadedTextures));
+                request.mNumUploadedTextures++;
+            }
+            else
+            {
+                break;
+            }
+        } while (GetNowNS() < uploadEndTime);
+
+        if (isAnyMaterialReady)
+        {
+            for (auto& [object, meshIndex] : request.mPublishedObjects)
+            {
+                SetSceneObjectMaterials(request, *object, meshIndex);
+            }
+        }
+
+        const Uint64 numUploads = data.meshes.size() + data.textures.size();
+        const Uint64 numUploaded = request.mNumUploadedMeshes + request.mNumUploadedTextures;
+        request.SetProgress(numUploads > 0 ? 0.5f + 0.5f * numUploaded / numUploads : 1.0f);
+
+        if (numUploaded < numUploads)
+        {
+            return false;
+        }
+
+        // The objects are inserted into the BVH one by one while publishing. Rebuild it with all of them.
+        request.mScene->RebuildBVH(&Engine::GetJobSystem());
+
+        request.mState = ModelLoadState::Completed;
+        request.mElapsedTimeMS = static_cast<double>(GetNowNS() - request.mStartTime) / 1'000'000.0;
+        // The CPU side data is not needed anymore.
+        request.mLoadData = nullptr;
+        request.mPublishedObjects.clear();
+        CUBE_LOG(Info, ModelLoaderSystem, "Loaded {0}. (Time: {1:.1f} ms / Max frame time: {2:.2f} ms)", request.mPathInfo.name, request.mElapsedTimeMS, request.mMaxFrameTimeMS);
+
+        return true;
+    }
+
+    void ModelLoaderSystem::PublishScene(ModelLoadRequest& request)
+    {
+        ModelLoadData& data = *request.mLoadData;
+
+        request.mScene = std::make_shared<Scene>();
+
+        FrameString placeholderName = Format<FrameString>(CUBE_T("[{0}] Placeholder"), request.mPathInfo.name);
+        request.mPlaceholderMaterial = std::make_shared<Material>(placeholderName);
+        request.mPlaceholderMaterial->SetBaseColor(Vector4(0.5f, 0.5f, 0.5f, 1.0f));
+        request.mScene->AddMaterial(request.mPlaceholderMaterial);
+
+        for (SharedPtr<Material>& material : data.materials)
+        {
+            request.mScene->AddMaterial(material);
+        }
+
+        request.mNumRemainingTexturesPerMaterials.assign(data.materials.size(), 0);
+        for (const ModelLoadData::MaterialTextureSlot& slot : data.materialTextureSlots)
+        {
+            request.mNumRemainingTexturesPerMaterials[slot.materialIndex]++;
+        }
+
+        // The objects with the mesh are added when the mesh is uploaded.
+        data.objectIndicesPerMeshes.resize(data.meshes.size());
+        for (int i = 0; i < static_cast<int>(data.objects.size()); ++i)
+        {
+            const int meshIndex = data.objects[i].meshIndex;
+            if (meshIndex == -1)
+            {
+                PublishSceneObject(request, i, nullptr);
+            }
+            else
+            {
+                data.objectIndicesPerMeshes[meshIndex].push_back(i);
+            }
+        }
+    }
+
+    void ModelLoaderSystem::PublishSceneObject(ModelLoadRequest& request, int objectIndex, const SharedPtr<Mesh>& mesh)
+    {
+        const ModelLoadData::ObjectData& objectData = request.mLoadData->objects[objectIndex];
+
+        UniquePtr<SceneObject> obj = std::make_unique<SceneObject>(objectData.name, mesh);
+        obj->SetPosition(objectData.position);
+        obj->SetScale(objectData.scale);
+        if (objectData.meshIndex != -1)
+        {
+            SetSceneObjectMaterials(request, *obj, objectData.meshIndex);
+            request.mPublishedObjects.push_back({ obj.get(), objectData.meshIndex });
+        }
+
+        request.mScene->AddSceneObject(std::move(obj));
+    }
+
+    void ModelLoaderSystem::SetSceneObjectMaterials(ModelLoadRequest& request, SceneObject& object, int meshIndex)
+    {
+        const ModelLoadData& data = *request.mLoadData;
+
+        FrameVector<WeakPtr<Material>> materials;
+        for (int materialIndex : data.materialIndicesPerMeshes[meshIndex])
+        {
+            if (materialIndex == -1)
+            {
+                materials.emplace_back();
+            }
+            else if (request.mNumRemainingTexturesPerMaterials[materialIndex] > 0)
+            {
+                materials.push_back(request.mPlaceholderMaterial);
+            }
+            else
+            {
+                materials.push_back(data.materials[materialIndex]);
+            }
+        }
+        object.SetMaterials(materials);
+    }
+
+    void ModelLoaderSystem::UploadMesh(ModelLoadRequest& request, int meshIndex)
+    {
+        ModelLoadData& data = *request.mLoadData;
+
+        SharedPtr<Mesh> mesh = std::make_shared<Mesh>(data.meshes[meshIndex], request.mMeshMeta);
+        for (int objectIndex : data.objectIndicesPerMeshes[meshIndex])
+        {
+            PublishSceneObject(request, objectIndex, mesh);
+        }
+    }
+
+    bool ModelLoaderSystem::UploadTexture(ModelLoadRequest& request, int textureIndex)
+    {
+        ModelLoadData& data = *request.mLoadData;
+        ModelLoadData::TextureData& textureData = data.textures[textureIndex];
+
+        TextureResourceCreateInfo createInfo = {
+            .textureInfo = {
+                .format = textureData.rawData.format,
+                .type = gapi::TextureType::Texture2D,
+                .width = textureData.rawData.width,
+                .height = textureData.rawData.height,
+            },
+            .data = textureData.rawData.data,
+            .bytesPerElement = textureData.rawData.bytesPerElement,
+            .generateMipMaps = true,
+            .debugName = textureData.debugName
+        };
+        SharedPtr<TextureResource> texture = std::make_shared<TextureResource>(createInfo);
+        textureData.rawData.data = Blob();
+
+        bool isAnyMaterialReady = false;
+        for (const ModelLoadData::MaterialTextureSlot& slot : data.materialTextureSlots)
+        {
+            if (slot.textureIndex == textureIndex)
+            {
+                data.materials[slot.materialIndex]->SetTexture(slot.slotIndex, texture);
+
+                if (--request.mNumRemainingTexturesPerMaterials[slot.materialIndex] == 0)
+                {
+                    isAnyMaterialReady = true;
+                }
+            }
         }
 
-        return scene;
+        return isAnyMaterialReady;
     }
 
     MeshMetadata ModelLoaderSystem::GetMeshMetadata()
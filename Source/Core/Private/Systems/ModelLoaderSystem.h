@@ -2,8 +2,11 @@
 
 #include "CoreHeader.h"
 
+#include <atomic>
+
 #include "CubeString.h"
 #include "FileSystem.h"
+#include "JobSystem.h"
 #include "Vector.h"
 #include "Renderer/Mesh.h"
 
@@ -12,6 +15,8 @@ namespace cube
     class Material;
     class MeshData;
     class Scene;
+    class SceneObject;
+    struct ModelLoadData;
 
     enum class ModelType
     {
@@ -29,6 +34,80 @@ namespace cube
         Vector3 scale = Vector3(1.0f, 1.0f, 1.0f);
     };
 
+    enum class ModelLoadState
+    {
+        Processing, // Parsing, decoding the images and building the mesh data in the job.
+        Uploading, // The scene is published. Creating the GPU resources at the frame boundaries.
+        Completed,
+        Cancelled,
+        Failed
+    };
+
+    // Asynchronous model load requested by ModelLoaderSystem::LoadModel().
+    // The objects are added to the scene as their meshes are uploaded, and use the placeholder material until all of their textures arrive.
+    class ModelLoadRequest
+    {
+    public:
+        ModelLoadRequest(const ModelPathInfo& pathInfo, const MeshMetadata& meshMeta);
+        ~ModelLoadRequest();
+
+        ModelLoadRequest(const ModelLoadRequest& other) = delete;
+        ModelLoadRequest& operator=(const ModelLoadRequest& rhs) = delete;
+
+        ModelLoadState GetState() const { return mState; }
+        bool IsFinished() const { return mState == ModelLoadState::Completed || mState == ModelLoadState::Cancelled || mState == ModelLoadState::Failed; }
+        // 0 ~ 1. The first half is the processing in the job and the second half is the upload.
+        float GetProgress() const { return mProgress.load(std::memory_order_relaxed); }
+
+        // The job stops at the next step and the remaining uploads are skipped. The objects already in the scene are kept.
+        void Cancel() { mIsCancelled.store(true, std::memory_order_relaxed); }
+        bool IsCancelled() const { return mIsCancelled.load(std::memory_order_relaxed); }
+
+        const ModelPathInfo& GetPathInfo() const { return mPathInfo; }
+        // nullptr until the processing is finished.
+        SharedPtr<Scene> GetScene() const { return mScene; }
+
+        double GetElapsedTimeMS() const { return mElapsedTimeMS; }
+        // Maximum frame time while the request is not finished. It shows how much the load hitches the frames.
+        double GetMaxFrameTimeMS() const { return mMaxFrameTimeMS; }
+
+    private:
+        friend class ModelLoaderSystem;
+
+        void SetProgress(float progress) { mProgress.store(progress, std::memory_order_relaxed); }
+
+        ModelPathInfo mPathInfo;
+        MeshMetadata mMeshMeta;
+
+        ModelLoadState mState = ModelLoadState::Processing;
+        std::atomic<float> mProgress = 0.0f;
+        std::atomic<bool> mIsCancelled = false;
+
+        JobHandle mJobHandle;
+        // Written in the job. Read in the main thread after the job is finished.
+        UniquePtr<ModelLoadData> mLoadData;
+
+        SharedPtr<Scene> mScene;
+        SharedPtr<Material> mPlaceholderMaterial;
+        Vector<std::pair<SceneObject*, int>> mPublishedObjects; // (Object, Mesh index)
+        Vector<int> mNumRemainingTexturesPerMaterials;
+        Uint64 mNumUploadedMeshes = 0;
+        Uint64 mNumUploadedTextures = 0;
+
+        Uint64 mStartTime;
+        double mElapsedTimeMS = 0.0;
+        double mMaxFrameTimeMS = 0.0;
+    };
+
+    // Time of each stage in the load job. Only measured in glTF.
+    struct ModelLoadTimings
+    {
+        double parseTimeMS = 0.0;
+        double materialTimeMS = 0.0;
+        double imageDecodeTimeMS = 0.0;
+        double meshTimeMS = 0.0;
+    };
+
     class ModelLoaderSystem
     {
     public:
@@ -38,16 +117,35 @@ namespace cube
         static void Initialize();
         static void Shutdown();
 
+        static void OnLoop(double deltaTimeSec);
         static void OnLoopImGUIContent();
 
-        static SharedPtr<Scene> LoadModel(const ModelPathInfo& pathInfo);
+        // Start loading in the job system. The request is updated in OnLoop().
+        static SharedPtr<ModelLoadRequest> LoadModel(const ModelPathInfo& pathInfo);
+        static bool IsLoading();
+
+        // Load the data of the glTF model in the job system without creating the GPU resources. Return false if it is failed.
+        // It does not need the engine, so the load benchmark calls it directly.
+        CUBE_CORE_EXPORT static bool LoadModelData_glTF(const ModelPathInfo& pathInfo, JobSystem& jobSystem, ModelLoadTimings& outTimings);
 
     private:
         static void LoadModelList();
         static void LoadCurrentModelAndSet(bool resetTransform = true);
+        // Return the index in mModelPathList from <type>_<index>. -1 if it is invalid.
+        static int FindModelIndexFromParam(AnsiStringView paramName, AnsiStringView param);
+
+        // The primitives and the images are processed in parallel in the job system.
+        static UniquePtr<ModelLoadData> LoadModel_glTF(const ModelPathInfo& pathInfo, ModelLoadRequest& request, JobSystem& jobSystem);
+        static UniquePtr<ModelLoadData> LoadModel_Obj(const ModelPathInfo& pathInfo, ModelLoadRequest& request);
 
-        static SharedPtr<Scene> LoadModel_glTF(const ModelPathInfo& pathInfo);
-        static SharedPtr<Scene> LoadModel_Obj(const ModelPathInfo& pathInfo);
+        // Return true if the request is finished.
+        static bool UpdateLoadRequest(ModelLoadRequest& request, Uint64 uploadEndTime);
+        static void PublishScene(ModelLoadRequest& request);
+        static void PublishSceneObject(ModelLoadRequest& request, int objectIndex, const SharedPtr<Mesh>& mesh);
+        static void SetSceneObjectMaterials(ModelLoadRequest& request, SceneObject& object, int meshIndex);
+        static void UploadMesh(ModelLoadRequest& request, int meshIndex);
+        // Return true if any material got all of its textures.
+        static bool UploadTexture(ModelLoadRequest& request, int textureIndex);
 
         static MeshMetadata GetMeshMetadata();
 
@@ -61,5 +159,10 @@ namespace cube
         static Float3 mModelRotation;
         static float mModelScale;
         static bool mUseFloat16Vertices;
+
+        static Vector<SharedPtr<ModelLoadRequest>> mLoadRequests;
+        static SharedPtr<ModelLoadRequest> mCurrentLoadRequest;
+        static bool mIsCurrentScenePublished;
+        static float mUploadTimeBudgetMS;
     };
 } // namespace cube
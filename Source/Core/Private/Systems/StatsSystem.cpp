@@ -5,6 +5,9 @@
 
 #include "Engine.h"
 #include "Allocator/FrameAllocator.h"
+#include "Allocator/TLSFAllocator.h"
+#include "Logger.h"
+#include "MemoryTracker.h"
 #include "Renderer/Renderer.h"
 
 namespace cube
@@ -30,6 +33,13 @@ namespace cube
     Array<float, StatsSystem::NUM_STATS_HISTORY * 2> StatsSystem::mPhysicalVRAMMiBHistory;
     Array<float, StatsSystem::NUM_STATS_HISTORY * 2> StatsSystem::mLogicalVRAMMiBHistory;
 
+    Array<MemoryTagStats, NUM_MEMORY_TAGS> StatsSystem::mMemoryTagStats;
+    TLSFAllocatorStats StatsSystem::mAssetHeapStats;
+    FrameAllocatorStats StatsSystem::mFrameAllocatorStats;
+
+    RGBuilderStats StatsSystem::mRGBuilderStats;
+    FrustumCullingStats StatsSystem::mFrustumCullingStats;
+
     gapi::TimestampRangeList StatsSystem::mTimestampRanges;
     bool StatsSystem::mShowTimestampWindow = false;
 
@@ -118,6 +128,77 @@ namespace cube
             }
         }
 
+        if (ImGui::CollapsingHeader("Memory", ImGuiTreeNodeFlags_DefaultOpen))
+        {
+            constexpr double MiB = 1024 * 1024;
+
+            if (ImGui::BeginTable("##Memory tags", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingStretchProp))
+            {
+                ImGui::TableSetupColumn("Tag");
+                ImGui::TableSetupColumn("Current (MiB)");
+                ImGui::TableSetupColumn("Peak (MiB)");
+                ImGui::TableSetupColumn("Allocations");
+                ImGui::TableHeadersRow();
+
+                for (int i = 0; i < NUM_MEMORY_TAGS; ++i)
+                {
+                    const MemoryTagStats& tagStats = mMemoryTagStats[i];
+
+                    ImGui::TableNextRow();
+                    ImGui::TableNextColumn();
+                    ImGui::TextUnformatted(MemoryTagToString(static_cast<MemoryTag>(i)));
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.2f", tagStats.currentSize / MiB);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.2f", tagStats.peakSize / MiB);
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%llu", static_cast<unsigned long long>(tagStats.numAllocations));
+                }
+
+                ImGui::EndTable();
+            }
+
+            ImGui::Text("Asset heap: %.2f / %.2f MiB (Peak: %.2f MiB, Pools: %u)",
+                mAssetHeapStats.usedSize / MiB, mAssetHeapStats.reservedSize / MiB, mAssetHeapStats.peakUsedSize / MiB, mAssetHeapStats.numPools);
+            ImGui::Text("Asset heap fragmentation: %.1f%% (Largest free block: %.2f MiB)",
+                mAssetHeapStats.GetFragmentation() * 100.0, mAssetHeapStats.largestFreeBlockSize / MiB);
+            ImGui::Text("Frame allocator: %.2f / %.2f MiB (High-water mark: %.2f MiB)",
+                mFrameAllocatorStats.lastFrameUsedSize / MiB, mFrameAllocatorStats.blockSize / MiB, mFrameAllocatorStats.highWaterMark / MiB);
+
+            if (ImGui::Button("Dump memory report"))
+            {
+                CUBE_LOG(Info, Memory, "{0}", MemoryTracker::GetReport());
+            }
+        }
+
+        if (ImGui::CollapsingHeader("Render Graph", ImGuiTreeNodeFlags_DefaultOpen))
+        {
+            const double naiveTransientMiB = static_cast<double>(mRGBuilderStats.naiveTransientMemorySize) / (1024 * 1024);
+            const double plannedTransientMiB = static_cast<double>(mRGBuilderStats.plannedTransientMemorySize) / (1024 * 1024);
+            ImGui::Text("Passes: %u (Culled: %u)", mRGBuilderStats.numPasses, mRGBuilderStats.numCulledPasses);
+            ImGui::Text("Recording segments: %u", mRGBuilderStats.numRecordingSegments);
+            ImGui::Text("Mesh draws: %u (Instances: %u)", mRGBuilderStats.numMeshDraws, mRGBuilderStats.numMeshInstances);
+            if (mRGBuilderStats.numCompileCacheLookups > 0)
+            {
+                const double compileCacheHitRate = static_cast<double>(mRGBuilderStats.numCompileCacheHits) / mRGBuilderStats.numCompileCacheLookups * 100.0;
+                ImGui::Text("Compile cache: %s (Hit rate: %.1f%%)", mRGBuilderStats.isCompileCacheHit ? "Hit" : "Miss", compileCacheHitRate);
+            }
+            ImGui::Text("Async compute passes: %u (Queue syncs: %u)", mRGBuilderStats.numAsyncComputePasses, mRGBuilderStats.numQueueSyncs);
+            ImGui::Text("Transient resources: %u", mRGBuilderStats.numTransientResources);
+            ImGui::Text("Transient memory: %.2f MiB (Naive: %.2f MiB)", plannedTransientMiB, naiveTransientMiB);
+            ImGui::Text("Aliasing barriers: %u", mRGBuilderStats.numAliasingBarriers);
+            ImGui::Text("Transitions: %u (Split: %u)", mRGBuilderStats.numTransitions, mRGBuilderStats.numSplitTransitions);
+            ImGui::Text("Skipped rollbacks: %u", mRGBuilderStats.numSkippedRollbacks);
+        }
+
+        if (ImGui::CollapsingHeader("Culling", ImGuiTreeNodeFlags_DefaultOpen))
+        {
+            ImGui::Text("Objects: %u (Visible: %u, Culled: %u)",
+                mFrustumCullingStats.numObjects, mFrustumCullingStats.numVisibleObjects, mFrustumCullingStats.numCulledObjects);
+            ImGui::Text("Tested BVH nodes: %llu", static_cast<unsigned long long>(mFrustumCullingStats.numTestedBVHNodes));
+            ImGui::Text("Culling time: %.3f ms", mFrustumCullingStats.cullingTimeMS);
+        }
+
         ImGui::Separator();
 
         if (ImGui::Button("Show Timestamps"))
@@ -190,6 +271,17 @@ namespace cube
             mMaxFPS = std::max(mMaxFPS, sampleFPS);
         }
 
+        // Memory
+        for (int i = 0; i < NUM_MEMORY_TAGS; ++i)
+        {
+            mMemoryTagStats[i] = MemoryTracker::GetStats(static_cast<MemoryTag>(i));
+        }
+        mAssetHeapStats = GetAssetHeapAllocator().GetStats();
+        mFrameAllocatorStats = GetMyThreadFrameAllocator().GetStats();
+
+        mRGBuilderStats = Engine::GetRenderer()->GetLastRGBuilderStats();
+        mFrustumCullingStats = Engine::GetRenderer()->GetLastFrustumCullingStats();
+
         mTimestampRanges = Engine::GetRenderer()->GetGAPI().GetLastTimestampRangeList();
     }
 } // namespace cube
@@ -2,10 +2,16 @@
 
 #include "CoreHeader.h"
 
+#include "Allocator/FrameAllocator.h"
+#include "Allocator/TLSFAllocator.h"
 #include "GAPI_Timestamp.h"
+#include "MemoryTracker.h"
+#include "Renderer/RenderGraphTypes.h"
 
 namespace cube
 {
+    struct FrustumCullingStats;
+
     class StatsSystem
     {
     public:
@@ -45,6 +51,13 @@ namespace cube
         static Array<float, NUM_STATS_HISTORY * 2> mPhysicalVRAMMiBHistory;
         static Array<float, NUM_STATS_HISTORY * 2> mLogicalVRAMMiBHistory;
 
+        static Array<MemoryTagStats, NUM_MEMORY_TAGS> mMemoryTagStats;
+        static TLSFAllocatorStats mAssetHeapStats;
+        static FrameAllocatorStats mFrameAllocatorStats;
+
+        static RGBuilderStats mRGBuilderStats;
+        static FrustumCullingStats mFrustumCullingStats;
+
         static gapi::TimestampRangeList mTimestampRanges;
         static bool mShowTimestampWindow;
     };
@@ -3,6 +3,7 @@
 #include "CoreHeader.h"
 
 #include "CubeString.h"
+#include "FlatHashMap.h"
 
 #ifndef CUBE_FRAME_ALLOCATOR_TRACK_ALLOCATION
 #define CUBE_FRAME_ALLOCATOR_TRACK_ALLOCATION _DEBUG
@@ -13,6 +14,21 @@ namespace cube
     class FrameAllocator;
 
     CUBE_CORE_EXPORT FrameAllocator& GetMyThreadFrameAllocator();
+    // Frame allocator of the job fiber running in the current thread. GetMyThreadFrameAllocator() returns it instead of the thread's one,
+    // so the allocations of a job are kept when its fiber is resumed in another thread. (nullptr: Use the thread's one)
+    CUBE_CORE_EXPORT void SetCurrentFiberFrameAllocator(FrameAllocator* allocator);
+
+    struct FrameAllocatorStats
+    {
+        // Size of the primary block. It grows to the high-water mark at DiscardAllocations().
+        Uint64 blockSize = 0;
+        // Size used in the last discarded frame. (Including the alignment gaps)
+        Uint64 lastFrameUsedSize = 0;
+        Uint64 highWaterMark = 0;
+        Uint32 numLastFrameAdditionalBlocks = 0;
+        // Number of times the primary block was resized.
+        Uint32 numBlockGrowths = 0;
+    };
 
     class CUBE_CORE_EXPORT FrameAllocator
     {
@@ -35,24 +51,19 @@ namespace cube
                 other.mStartPtr = nullptr;
                 other.mCurrentPtr = nullptr;
             }
-            MemoryBlock& operator=(MemoryBlock&& rhs) noexcept
-            {
-                mSize = rhs.mSize;
-                mStartPtr = rhs.mStartPtr;
-                mCurrentPtr = rhs.mCurrentPtr;
-
-                rhs.mSize = 0;
-                rhs.mStartPtr = nullptr;
-                rhs.mCurrentPtr = nullptr;
-
-                return *this;
-            }
+            MemoryBlock& operator=(MemoryBlock&& rhs) noexcept;
 
             void* Allocate(Uint64 size);
             void* AllocateAligned(Uint64 size, Uint64 alignment);
 
             void DiscardAllocations();
 
+            Uint64 GetSize() const { return mSize; }
+            Uint64 GetUsedSize() const { return (Uint64)mCurrentPtr - (Uint64)mStartPtr; }
+
+            void* GetCurrentPtr() const { return mCurrentPtr; }
+            void RewindTo(void* ptr);
+
         private:
             Uint64 mSize;
 
@@ -61,6 +72,13 @@ namespace cube
         };
 
     public:
+        // Size stored in front of each allocation. (Allocated size for the tracking)
+#ifdef CUBE_FRAME_ALLOCATOR_TRACK_ALLOCATION
+        static constexpr Uint64 ALLOCATION_HEADER_SIZE = sizeof(Uint64);
+#else
+        static constexpr Uint64 ALLOCATION_HEADER_SIZE = 0;
+#endif
+
         FrameAllocator();
         ~FrameAllocator();
 
@@ -78,20 +96,51 @@ namespace cube
         void* AllocateAligned(Uint64 size, Uint64 alignment);
         void FreeAligned(void* ptr);
 
+        // The primary block is resized to the high-water mark if the additional blocks were used in the frame,
+        // so the next frame fits in one block.
         void DiscardAllocations();
 
+        const FrameAllocatorStats& GetStats() const { return mStats; }
+
+        // Position of the allocator. All allocations after it can be released at once with RewindTo().
+        struct Marker
+        {
+            int numAdditionalBlocks = 0;
+            void* currentPtr = nullptr;
+#ifdef CUBE_FRAME_ALLOCATOR_TRACK_ALLOCATION
+            Uint64 allocatedSize = 0;
+            Uint64 frameIndex = 0;
+#endif
+        };
+        Marker GetMarker() const;
+        // Release all allocations after the marker. They should be freed before. (Checked with tracking allocation)
+        // The marker should be taken in the same frame and not be rewound over by the outer marker.
+        void RewindTo(const Marker& marker);
+
     private:
         void EnsureInitialization();
+        // Allocate in the current block. If it is full, move to the new additional block.
+        template <typename AllocateFunction>
+        void* AllocateInCurrentBlock(Uint64 requiredSize, AllocateFunction allocateFunction);
         void AllocateAdditionalBlock(Uint64 size);
+        Uint64 GetUsedSize() const;
 
         bool mInitialized;
         Uint64 mBlockSize;
         MemoryBlock mMemoryBlock;
 
+        // Additional blocks grow geometrically. Only the last one has free space.
         Vector<MemoryBlock> mAdditionalMemBlocks;
+        MemoryBlock* mCurrentMemBlock;
+
+        FrameAllocatorStats mStats;
+        // Largest used size before RewindTo() in this frame.
+        Uint64 mFramePeakUsedSize = 0;
+        Uint32 mNumFrameAdditionalBlocks = 0;
 
 #ifdef CUBE_FRAME_ALLOCATOR_TRACK_ALLOCATION
         Uint64 mAllocatedSize = 0;
+        Uint64 mFrameIndex = 0;
         const char* mDebugName;
 #endif
 
@@ -138,6 +187,28 @@ namespace cube
         StdAllocator<char> mStdAllocator;
     };
 
+    // Release all allocations of the frame allocator in the scope at the end of it.
+    // The scratch data in the scope should be destroyed before the end, so declare the scope before them.
+    class FrameScratchScope
+    {
+    public:
+        FrameScratchScope(FrameAllocator& allocator = GetMyThreadFrameAllocator()) :
+            mAllocator(allocator),
+            mMarker(allocator.GetMarker())
+        {}
+        ~FrameScratchScope()
+        {
+            mAllocator.RewindTo(mMarker);
+        }
+
+        FrameScratchScope(const FrameScratchScope& other) = delete;
+        FrameScratchScope& operator=(const FrameScratchScope& rhs) = delete;
+
+    private:
+        FrameAllocator& mAllocator;
+        FrameAllocator::Marker mMarker;
+    };
+
     template <typename T1, typename T2>
     bool operator==(const FrameAllocator::StdAllocator<T1>& lhs, const FrameAllocator::StdAllocator<T2>& rhs) noexcept
     {
@@ -178,4 +249,10 @@ namespace cube
 
     template <typename Key, typename Value>
     using FrameHashMap = std::unordered_map<Key, Value, std::hash<Key>, std::equal_to<Key>, FrameAllocator::StdAllocator<std::pair<const Key, Value>>>;
+
+    template <typename Key, typename Value>
+    using FrameFlatHashMap = FlatHashMap<Key, Value, std::hash<Key>, std::equal_to<Key>, FrameAllocator::StdAllocator<std::pair<const Key, Value>>>;
+
+    template <typename Key>
+    using FrameFlatHashSet = FlatHashSet<Key, std::hash<Key>, std::equal_to<Key>, FrameAllocator::StdAllocator<Key>>;
 } // namespace cube
@@ -0,0 +1,161 @@
+#pragma once
+
+#include "CoreHeader.h"
+
+#include <atomic>
+#include <mutex>
+
+#include "Allocator/FrameAllocator.h"
+#include "CubeString.h"
+
+namespace cube
+{
+    class SharedFrameAllocator;
+
+    CUBE_CORE_EXPORT SharedFrameAllocator& GetSharedFrameAllocator();
+
+    // Frame allocator which can be used in any thread.
+    // Each thread bumps its own chunk, and the chunks are handed out from one memory block with an atomic offset,
+    // so the allocation does not take any lock unless the block is full.
+    // All chunks are recycled at once in DiscardAllocations(). It should be called while no other thread uses the allocator.
+    // The engine initializes the global one and discards it at the beginning of each frame. (ex: Data produced in the jobs of the frame)
+    class CUBE_CORE_EXPORT SharedFrameAllocator
+    {
+    public:
+        SharedFrameAllocator();
+        ~SharedFrameAllocator();
+
+        SharedFrameAllocator(const SharedFrameAllocator& other) = delete;
+        SharedFrameAllocator& operator=(const SharedFrameAllocator& rhs) = delete;
+
+        void Initialize(const char* debugName, Uint64 blockSize = 16 * 1024 * 1024, Uint64 chunkSize = 64 * 1024); // 16 MiB / 64 KiB
+        void Shutdown();
+
+        bool IsInitialized() const { return mInitialized.load(std::memory_order_acquire); }
+
+        void* Allocate(Uint64 size);
+        void Free(void* ptr);
+
+        void* AllocateAligned(Uint64 size, Uint64 alignment);
+        void FreeAligned(void* ptr);
+
+        void DiscardAllocations();
+
+        // Size handed out from the memory block in this frame. (Chunks and large allocations)
+        Uint64 GetUsedBlockSize() const { return std::min(mBlockOffset.load(std::memory_order_relaxed), mBlockSize); }
+        // Allocations which did not fit in the memory block in this frame. They take the lock.
+        Uint32 GetNumOverflowAllocations() const { return mNumOverflowAllocations.load(std::memory_order_relaxed); }
+
+    private:
+        // Chunk which the thread bumps. It is valid only in the allocator and the generation it was taken.
+        struct ThreadChunk
+        {
+            const SharedFrameAllocator* owner = nullptr;
+            Uint64 generation = 0;
+            Uint8* current = nullptr;
+            Uint8* end = nullptr;
+        };
+
+        void EnsureInitialization();
+
+        Uint8* AllocateInChunk(ThreadChunk& chunk, Uint64 size, Uint64 alignment);
+        // Hand out the memory from the block. It falls back to AllocateOverflow() if the block is full.
+        Uint8* AllocateFromBlock(Uint64 size);
+        Uint8* AllocateOverflow(Uint64 size);
+
+        // It can be initialized in any thread by EnsureInitialization().
+        std::atomic<bool> mInitialized;
+        std::mutex mInitializeMutex;
+        Uint64 mBlockSize;
+        Uint64 mChunkSize;
+        Uint8* mBlockStartPtr;
+
+        std::atomic<Uint64> mBlockOffset;
+        // Changed in every DiscardAllocations() so the chunks taken before are not used anymore.
+        std::atomic<Uint64> mGeneration;
+
+        std::mutex mOverflowMutex;
+        Vector<void*> mOverflowBlocks;
+        std::atomic<Uint32> mNumOverflowAllocations;
+
+#ifdef CUBE_FRAME_ALLOCATOR_TRACK_ALLOCATION
+        std::atomic<Uint64> mAllocatedSize = 0;
+        const char* mDebugName;
+#endif
+
+        // Class for Std
+    public:
+        template <typename T>
+        class StdAllocator
+        {
+        public:
+            using value_type = T;
+
+            StdAllocator(const char* pName = nullptr) :
+                mpAllocator(&GetSharedFrameAllocator())
+            {}
+            StdAllocator(SharedFrameAllocator& allocator) :
+                mpAllocator(&allocator)
+            {}
+            template <typename U>
+            StdAllocator(const StdAllocator<U>& other) noexcept :
+                mpAllocator(other.mpAllocator)
+            {}
+
+            T* allocate(size_t n, int flags = 0)
+            {
+                return (T*)mpAllocator->AllocateAligned(sizeof(T) * n, alignof(T));
+            }
+
+            void deallocate(void* p, size_t n)
+            {
+                mpAllocator->FreeAligned(p);
+            }
+
+        private:
+            template <typename U>
+            friend class StdAllocator;
+
+            SharedFrameAllocator* mpAllocator;
+        };
+    };
+
+    template <typename T1, typename T2>
+    bool operator==(const SharedFrameAllocator::StdAllocator<T1>& lhs, const SharedFrameAllocator::StdAllocator<T2>& rhs) noexcept
+    {
+        return true;
+    }
+    template <typename T1, typename T2>
+    bool operator!=(const SharedFrameAllocator::StdAllocator<T1>& lhs, const SharedFrameAllocator::StdAllocator<T2>& rhs) noexcept
+    {
+        return false;
+    }
+
+    // Define strings with shared frame allocator.
+    // Unlike the frame strings, they can be passed to other threads in the frame.
+    template <typename Char>
+    using TSharedFrameString = std::basic_string<Char, std::char_traits<Char>, SharedFrameAllocator::StdAllocator<Char>>;
+
+    using SharedFrameAnsiString = TSharedFrameString<AnsiCharacter>;
+    using SharedFrameU8String = TSharedFrameString<U8Character>;
+    using SharedFrameU16String = TSharedFrameString<U16Character>;
+    using SharedFrameU32String = TSharedFrameString<U32Character>;
+
+#if defined(CUBE_DEFAULT_STRING_UTF8)
+    using SharedFrameString = SharedFrameU8String;
+#elif defined(CUBE_DEFAULT_STRING_UTF16)
+    using SharedFrameString = SharedFrameU16String;
+#elif defined(CUBE_DEFAULT_STRING_UTF32)
+    using SharedFrameString = SharedFrameU32String;
+#endif
+
+    // Define STL containers with shared frame allocator
+    template <typename T>
+    using SharedFrameVector = std::vector<T, SharedFrameAllocator::StdAllocator<T>>;
+
+    template <typename Key, typename Value>
+    using SharedFrameMap = std::map<Key, Value, std::less<Key>, SharedFrameAllocator::StdAllocator<std::pair<const Key, Value>>>;
+
+    template <typename Key, typename Value>
+    using SharedFrameHashMap = std::unordered_map<Key, Value, std::hash<Key>, std::equal_to<Key>, SharedFrameAllocator::StdAllocator<std::pair<const Key, Value>>>;
+} // namespace cube
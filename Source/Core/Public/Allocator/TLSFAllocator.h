@@ -0,0 +1,149 @@
+#pragma once
+
+#include "CoreHeader.h"
+
+#include <mutex>
+
+#include "Allocator.h"
+
+namespace cube
+{
+    class TLSFAllocator;
+
+    // Heap for the long-lived asset data. (Mesh data, texture data, ...)
+    CUBE_CORE_EXPORT TLSFAllocator& GetAssetHeapAllocator();
+
+    struct TLSFAllocatorStats
+    {
+        Uint32 numPools = 0;
+        Uint64 reservedSize = 0;
+
+        Uint64 numAllocations = 0;
+        Uint64 usedSize = 0;
+        Uint64 peakUsedSize = 0;
+
+        Uint64 freeSize = 0;
+        Uint64 largestFreeBlockSize = 0;
+
+        // 0: all free memory is in one block, 1: the free memory is split into many small blocks
+        double GetFragmentation() const
+        {
+            return freeSize > 0 ? 1.0 - static_cast<double>(largestFreeBlockSize) / static_cast<double>(freeSize) : 0.0;
+        }
+    };
+
+    // General-purpose allocator with the two-level segregated fit (TLSF).
+    // The free blocks are kept in the lists by the size classes and found with the bitmaps,
+    // so both of the allocation and the free are O(1). The adjacent free blocks are merged in the free.
+    // The memory is taken from the OS in the large pools, and a new pool is added when no free block fits.
+    class CUBE_CORE_EXPORT TLSFAllocator : public IAllocator
+    {
+    public:
+        TLSFAllocator();
+        ~TLSFAllocator() override;
+
+        TLSFAllocator(const TLSFAllocator& other) = delete;
+        TLSFAllocator& operator=(const TLSFAllocator& rhs) = delete;
+
+        // useVirtualMemory: Take the pools directly from the OS pages instead of the process heap.
+        void Initialize(const char* debugName, Uint64 poolSize = 64 * 1024 * 1024, bool useVirtualMemory = false); // 64 MiB
+        void Shutdown();
+
+        bool IsInitialized() const { return mInitialized; }
+
+        void* Allocate(SizeType n) override;
+        void Free(void* ptr, SizeType n) override;
+
+        void* AllocateTagged(SizeType n, MemoryTag tag) override;
+        void FreeTagged(void* ptr, SizeType n, MemoryTag tag) override;
+
+        // The tag is stored in the block, so FreeAligned() does not need it.
+        void* AllocateAligned(Uint64 size, Uint64 alignment, MemoryTag tag = MemoryTag::Untagged);
+        void FreeAligned(void* ptr);
+
+        TLSFAllocatorStats GetStats() const;
+        const char* GetDebugName() const { return mDebugName; }
+
+    private:
+        static constexpr Uint64 ALIGN_SIZE_LOG2 = 4;
+        static constexpr Uint64 ALIGN_SIZE = 1 << ALIGN_SIZE_LOG2;
+
+        // Number of the second-level lists in each first-level. (Log2)
+        static constexpr Uint64 SL_INDEX_COUNT_LOG2 = 5;
+        static constexpr Uint64 SL_INDEX_COUNT = 1 << SL_INDEX_COUNT_LOG2;
+        // Blocks smaller than SMALL_BLOCK_SIZE are in the first-level 0 with the linear size classes.
+        static constexpr Uint64 FL_INDEX_SHIFT = SL_INDEX_COUNT_LOG2 + ALIGN_SIZE_LOG2;
+        static constexpr Uint64 SMALL_BLOCK_SIZE = 1 << FL_INDEX_SHIFT;
+        // Max block size is 2^FL_INDEX_MAX - 1. (1 TiB)
+        static constexpr Uint64 FL_INDEX_MAX = 40;
+        static constexpr Uint64 FL_INDEX_COUNT = FL_INDEX_MAX - FL_INDEX_SHIFT + 1;
+
+        struct BlockHeader
+        {
+            BlockHeader* prevPhysBlock; // nullptr in the first block of the pool
+            Uint64 sizeAndFlags; // Memory tag (bit 56~63) | size of the payload | free flag (bit 0)
+
+            // Only in the free blocks. They are overlapped with the payload.
+            BlockHeader* nextFree;
+            BlockHeader* prevFree;
+
+            Uint64 GetSize() const { return sizeAndFlags & SIZE_MASK; }
+            void SetSize(Uint64 size) { sizeAndFlags = size | (sizeAndFlags & ~SIZE_MASK); }
+            bool IsFree() const { return sizeAndFlags & FREE_FLAG; }
+            void SetFree(bool free) { sizeAndFlags = free ? (sizeAndFlags | FREE_FLAG) : (sizeAndFlags & ~FREE_FLAG); }
+            MemoryTag GetTag() const { return static_cast<MemoryTag>(sizeAndFlags >> TAG_SHIFT); }
+            void SetTag(MemoryTag tag) { sizeAndFlags = (sizeAndFlags & ~(0xFFull << TAG_SHIFT)) | (static_cast<Uint64>(tag) << TAG_SHIFT); }
+
+            Uint8* GetPayload() { return (Uint8*)this + BLOCK_HEADER_OVERHEAD; }
+            // The last block of the pool is the sentinel with size 0, so it is always valid in non-sentinel blocks.
+            BlockHeader* GetNextPhysBlock() { return (BlockHeader*)(GetPayload() + GetSize()); }
+
+            static BlockHeader* FromPayload(void* ptr) { return (BlockHeader*)((Uint8*)ptr - BLOCK_HEADER_OVERHEAD); }
+
+            static constexpr Uint64 FREE_FLAG = 1;
+            static constexpr Uint64 TAG_SHIFT = 56;
+            static constexpr Uint64 SIZE_MASK = ((1ull << TAG_SHIFT) - 1) & ~FREE_FLAG;
+        };
+        static constexpr Uint64 BLOCK_HEADER_OVERHEAD = offsetof(BlockHeader, nextFree);
+        // The payload should hold the free list links.
+        static constexpr Uint64 MIN_BLOCK_SIZE = sizeof(BlockHeader) - BLOCK_HEADER_OVERHEAD;
+
+        struct Pool
+        {
+            void* memory;
+            Uint64 size;
+        };
+
+        void EnsureInitialization();
+
+        bool AddPool(Uint64 minBlockSize);
+
+        static void MappingInsert(Uint64 size, Uint32& outFL, Uint32& outSL);
+        static void MappingSearch(Uint64 size, Uint32& outFL, Uint32& outSL);
+
+        BlockHeader* FindFreeBlock(Uint64 size);
+        void InsertFreeBlock(BlockHeader* block);
+        void RemoveFreeBlock(BlockHeader* block);
+
+        // Split the block to the block with the size and the remaining free block. Return the remaining block.
+        BlockHeader* SplitBlock(BlockHeader* block, Uint64 size);
+        // Merge the next block into the block.
+        void MergeBlock(BlockHeader* block, BlockHeader* next);
+
+        bool mInitialized;
+        bool mUseVirtualMemory;
+        Uint64 mPoolSize;
+        const char* mDebugName;
+
+        mutable std::mutex mMutex;
+        Vector<Pool> mPools;
+
+        Uint32 mFLBitmap;
+        Uint32 mSLBitmaps[FL_INDEX_COUNT];
+        BlockHeader* mFreeLists[FL_INDEX_COUNT][SL_INDEX_COUNT];
+
+        Uint64 mNumAllocations;
+        Uint64 mUsedSize;
+        Uint64 mPeakUsedSize;
+    };
+} // namespace cube
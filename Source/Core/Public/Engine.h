@@ -9,6 +9,7 @@
 
 namespace cube
 {
+    class JobSystem;
     class Renderer;
     class Scene;
 
@@ -37,6 +38,8 @@ namespace cube
 
         static Renderer* GetRenderer() { return mRenderer.get(); }
 
+        CUBE_CORE_EXPORT static JobSystem& GetJobSystem();
+
         CUBE_CORE_EXPORT static const platform::FilePath& GetRootDirectoryPath() { return mRootDirectoryPath; }
         CUBE_CORE_EXPORT static const platform::FilePath& GetShaderDirectoryPath() { return mShaderDirectoryPath; }
 
@@ -63,6 +66,7 @@ namespace cube
         static EventFunction<void(Uint32, Uint32)> mOnResizeEventFunc;
 
         static UniquePtr<Renderer> mRenderer;
+        static UniquePtr<JobSystem> mJobSystem;
         static bool mDrawImGUI;
 
         static ImGUIContext mImGUIContext;
@@ -2,19 +2,44 @@
 
 #include "CoreHeader.h"
 
+#include "Allocator/FrameAllocator.h"
+#include "GAPI_CommandList.h"
+#include "GAPI_Pipeline.h"
 #include "GAPI_Texture.h"
 #include "ShaderParameter.h"
 
 namespace cube
 {
+    class GAPI;
+    class Material;
+    class Mesh;
     class RGBuilder;
 
     // ===== Resources =====
 
+    // Concrete type of RGResource. It is used to cast and dispatch without RTTI.
+    enum class RGResourceKind : Uint8
+    {
+        Buffer,
+        BufferSRV,
+        BufferUAV,
+        Texture,
+        TextureSRV,
+        TextureUAV,
+        TextureRTV,
+        TextureDSV,
+        ShaderParameterList
+    };
+
     class RGResource
     {
     public:
+        static bool IsKindOf(RGResourceKind kind) { return true; }
+
+        RGResourceKind GetKind() const { return mKind; }
+
         bool IsTransient() const { return mIsTransient; }
+        bool IsOutput() const { return mIsOutput; }
 
         StringView GetDebugName() const { return mDebugName; }
 
@@ -37,10 +62,12 @@ namespace cube
     protected:
         friend class RGBuilder;
 
-        RGResource(int index, StringView debugName);
+        RGResource(int index, RGResourceKind kind, StringView debugName);
         virtual ~RGResource() = default;
 
+        RGResourceKind mKind;
         bool mIsTransient;
+        bool mIsOutput;
 
         int mIndex;
         int mBeginPass;
@@ -69,11 +96,16 @@ namespace cube
             return RGResourceHandler<RGResourceUpcastType>(static_cast<RGResourceUpcastType*>(mResource));
         }
 
+        // Returns invalid handler if the resource is not RGResourceCastType.
         template <typename RGResourceCastType>
             requires std::derived_from<RGResourceCastType, RGResource>
         RGResourceHandler<RGResourceCastType> Cast() const
         {
-            return RGResourceHandler<RGResourceCastType>(dynamic_cast<RGResourceCastType*>(mResource));
+            if (mResource == nullptr || !RGResourceCastType::IsKindOf(mResource->GetKind()))
+            {
+                return {};
+            }
+            return RGResourceHandler<RGResourceCastType>(static_cast<RGResourceCastType*>(mResource));
         }
 
         bool IsValid() const { return (mResource != nullptr); }
@@ -107,6 +139,8 @@ namespace cube
     class RGBuffer : public RGResource
     {
     public:
+        static bool IsKindOf(RGResourceKind kind) { return kind == RGResourceKind::Buffer; }
+
         virtual void CreateResource(GAPI& gapi) override;
         virtual bool IsResourceCreated() const override { return mBuffer != nullptr; }
 
@@ -123,12 +157,22 @@ namespace cube
 
         SharedPtr<gapi::Buffer> mBuffer;
         gapi::BufferInfo mBufferInfo;
+        gapi::TransientMemory mPlacedMemory;
     };
     using RGBufferHandle = RGResourceHandler<RGBuffer>;
 
     class RGBufferView : public RGResource
     {
     public:
+        static bool IsKindOf(RGResourceKind kind) { return kind == RGResourceKind::BufferSRV || kind == RGResourceKind::BufferUAV; }
+
+        virtual void UpdateUsePassIndex(int passIndex) override
+        {
+            RGResource::UpdateUsePassIndex(passIndex);
+
+            mRGBuffer->UpdateUsePassIndex(passIndex);
+        }
+
         Uint64 GetViewHashKey() const
         {
             return mViewHashKey;
@@ -153,6 +197,8 @@ namespace cube
     class RGBufferSRV : public RGBufferView
     {
     public:
+        static bool IsKindOf(RGResourceKind kind) { return kind == RGResourceKind::BufferSRV; }
+
         SharedPtr<gapi::BufferSRV> GetSRV() const { return mSRV; }
 
         virtual void CreateResource(GAPI& gapi) override;
@@ -171,6 +217,8 @@ namespace cube
     class RGBufferUAV : public RGBufferView
     {
     public:
+        static bool IsKindOf(RGResourceKind kind) { return kind == RGResourceKind::BufferUAV; }
+
         SharedPtr<gapi::BufferUAV> GetUAV() const { return mUAV; }
 
         virtual void CreateResource(GAPI& gapi) override;
@@ -191,6 +239,8 @@ namespace cube
     class RGTexture : public RGResource
     {
     public:
+        static bool IsKindOf(RGResourceKind kind) { return kind == RGResourceKind::Texture; }
+
         SharedPtr<gapi::Texture> GetGAPITexture() const { return mTexture; }
 
         virtual void CreateResource(GAPI& gapi) override;
@@ -214,12 +264,18 @@ namespace cube
 
         SharedPtr<gapi::Texture> mTexture;
         gapi::TextureInfo mTextureInfo;
+        gapi::TransientMemory mPlacedMemory;
     };
     using RGTextureHandle = RGResourceHandler<RGTexture>;
 
     class RGTextureView : public RGResource
     {
     public:
+        static bool IsKindOf(RGResourceKind kind)
+        {
+            return kind == RGResourceKind::TextureSRV || kind == RGResourceKind::TextureUAV || kind == RGResourceKind::TextureRTV || kind == RGResourceKind::TextureDSV;
+        }
+
         virtual void UpdateUsePassIndex(int passIndex) override
         {
             RGResource::UpdateUsePassIndex(passIndex);
@@ -264,6 +320,8 @@ namespace cube
     class RGTextureSRV : public RGTextureView
     {
     public:
+        static bool IsKindOf(RGResourceKind kind) { return kind == RGResourceKind::TextureSRV; }
+
         SharedPtr<gapi::TextureSRV> GetSRV() const { return mSRV; }
 
         virtual void CreateResource(GAPI& gapi) override;
@@ -283,6 +341,8 @@ namespace cube
     class RGTextureUAV : public RGTextureView
     {
     public:
+        static bool IsKindOf(RGResourceKind kind) { return kind == RGResourceKind::TextureUAV; }
+
         SharedPtr<gapi::TextureUAV> GetUAV() const { return mUAV; }
 
         virtual void CreateResource(GAPI& gapi) override;
@@ -302,6 +362,8 @@ namespace cube
     class RGTextureRTV : public RGTextureView
     {
     public:
+        static bool IsKindOf(RGResourceKind kind) { return kind == RGResourceKind::TextureRTV; }
+
         SharedPtr<gapi::TextureRTV> GetRTV() const { return mRTV; }
 
         virtual void CreateResource(GAPI& gapi) override;
@@ -321,6 +383,8 @@ namespace cube
     class RGTextureDSV : public RGTextureView
     {
     public:
+        static bool IsKindOf(RGResourceKind kind) { return kind == RGResourceKind::TextureDSV; }
+
         SharedPtr<gapi::TextureDSV> GetDSV() const { return mDSV; }
 
         virtual void CreateResource(GAPI& gapi) override;
@@ -341,6 +405,9 @@ namespace cube
 
     class RGShaderParameterListBase : public RGResource
     {
+    public:
+        static bool IsKindOf(RGResourceKind kind) { return kind == RGResourceKind::ShaderParameterList; }
+
     protected:
         friend class RGBuilder;
 
@@ -359,6 +426,9 @@ namespace cube
     class RGShaderParameterList : public RGShaderParameterListBase
     {
     public:
+        // The kind does not have the type of the list, so it cannot be casted from RGResource.
+        static bool IsKindOf(RGResourceKind kind) = delete;
+
         ShaderParameterListType* Get() { return mCastedPtr; }
 
     private:
@@ -376,6 +446,283 @@ namespace cube
         requires std::derived_from<ShaderParameterListType, ShaderParameterList>
     using RGShaderParameterListHandle = RGResourceHandler<RGShaderParameterList<ShaderParameterListType>>;
 
+    // ===== Stats =====
+
+    struct RGBuilderStats
+    {
+        Uint32 numPasses = 0;
+        // Passes which do not contribute to any registered or output resource.
+        Uint32 numCulledPasses = 0;
+
+        Uint32 numTransientResources = 0;
+        // Sum of all transient resource sizes, as if each one had its own allocation.
+        Uint64 naiveTransientMemorySize = 0;
+        // Size actually allocated after aliasing the transient resources which are not alive at the same time.
+        Uint64 plannedTransientMemorySize = 0;
+        Uint32 numAliasingBarriers = 0;
+
+        // Transitions issued in the passes and at the end. A split transition is counted once.
+        Uint32 numTransitions = 0;
+        Uint32 numSplitTransitions = 0;
+        // Registered textures kept in the read state instead of the rollback to Common.
+        Uint32 numSkippedRollbacks = 0;
+
+        // Command lists the passes were recorded into. (1 if recorded sequentially)
+        Uint32 numRecordingSegments = 0;
+
+        // Instanced draws in AddDrawMeshPass, and the sub mesh instances drawn by them.
+        Uint32 numMeshDraws = 0;
+        Uint32 numMeshInstances = 0;
+
+        Uint32 numAsyncComputePasses = 0;
+        // GPU waits between the graphics and the async compute queues.
+        Uint32 numQueueSyncs = 0;
+
+        // The compile results were replayed from RGCompileCache.
+        bool isCompileCacheHit = false;
+        // Total lookups / hits of the used RGCompileCache. (0 if it is not used)
+        Uint32 numCompileCacheLookups = 0;
+        Uint32 numCompileCacheHits = 0;
+    };
+
+    // ===== State cache =====
+
+    // States of registered textures left by the previous RGBuilder.
+    // The next RGBuilder starts from these states, so read-only textures (ex: material textures)
+    // do not need to be transitioned to Common and back in every frame.
+    // Code which transitions the textures outside of RGBuilder should consume the state first.
+    class CUBE_CORE_EXPORT RGTextureStateCache
+    {
+    public:
+        // Returns Common if the state is not stored.
+        gapi::ResourceStateFlags ConsumeState(const SharedPtr<gapi::Texture>& texture);
+        // Same as ConsumeState but the state is kept.
+        gapi::ResourceStateFlags GetState(const SharedPtr<gapi::Texture>& texture) const;
+        void StoreState(const SharedPtr<gapi::Texture>& texture, gapi::ResourceStateFlags state);
+
+        void RemoveExpiredStates();
+        void Clear() { mStates.clear(); }
+
+    private:
+        struct TextureState
+        {
+            WeakPtr<gapi::Texture> texture;
+            gapi::ResourceStateFlags state;
+        };
+        HashMap<gapi::Texture*, TextureState> mStates;
+    };
+
+    // ===== Async compute =====
+
+    // Pass information used to schedule the async compute passes.
+    // It does not depend on the GPU, so the schedule can be built and checked without a device.
+    struct RGAsyncComputePassInfo
+    {
+        bool isCulled = false;
+        // The pass only uses compute / copy commands and asks to run in the async compute queue.
+        bool requestsAsyncCompute = false;
+        // False if the pass depends on the command list states set in the previous pass. (ex: draw after binding index buffer)
+        // The graphics queue cannot begin to wait before it.
+        bool canBeginSegment = true;
+        // Resources used in the pass. Views should be mapped to their texture / buffer.
+        ConstArrayView<int> resources;
+    };
+
+    // The waiting queue waits before waitPass until the other queue finishes signalPass.
+    struct RGAsyncComputeSyncPoint
+    {
+        gapi::CommandListType waitingQueue;
+        int signalPass;
+        int waitPass; // The number of passes if it waits at the end of the graph.
+    };
+
+    template <template <typename> typename VectorType>
+    struct TRGAsyncComputePlan
+    {
+        using SyncPoint = RGAsyncComputeSyncPoint;
+
+        VectorType<bool> isAsyncCompute; // Index: pass index
+        VectorType<SyncPoint> syncPoints; // Sorted by waitPass
+
+        Uint32 GetNumAsyncComputePasses() const { return static_cast<Uint32>(std::count(isAsyncCompute.begin(), isAsyncCompute.end(), true)); }
+    };
+
+    using RGAsyncComputePlan = TRGAsyncComputePlan<Vector>;
+    // Used in RGBuilder not to allocate the plan in the heap in every frame.
+    using RGFrameAsyncComputePlan = TRGAsyncComputePlan<FrameVector>;
+
+    // Move the passes requesting async compute to the compute queue and find the sync points between the queues.
+    // - A pass stays in the graphics queue if there is no graphics pass before it to overlap with.
+    // - The compute queue waits for the last graphics pass before the async pass, so the async pass only overlaps
+    //   the graphics passes after it.
+    // - The graphics queue waits for the async pass before the first graphics pass which uses any of its resources.
+    //   If the pass cannot begin a segment, the wait is moved to the previous graphics pass.
+    // - A wait already covered by the previous wait in the same queue is skipped.
+    // The scratch data is allocated in the frame allocator of the calling thread.
+    CUBE_CORE_EXPORT void ScheduleAsyncCompute(ConstArrayView<RGAsyncComputePassInfo> passes, RGAsyncComputePlan& outPlan);
+    CUBE_CORE_EXPORT void ScheduleAsyncCompute(ConstArrayView<RGAsyncComputePassInfo> passes, RGFrameAsyncComputePlan& outPlan);
+
+    // ===== Mesh draw grouping =====
+
+    // Draw information used to group the mesh draws into the instanced draws.
+    // Only the identities of the mesh and the materials are compared, so the grouping can be checked without a device.
+    struct RGDrawMeshGroupingInfo
+    {
+        const Mesh* mesh;
+        gapi::RasterizerState rasterizerState;
+        gapi::DepthStencilState depthStencilState;
+        ConstArrayView<const Material*> materials; // Resolved material of each sub mesh
+    };
+
+    struct RGDrawMeshGroup
+    {
+        Uint32 firstDrawIndex; // The group is drawn with the mesh, the states and the materials of this draw.
+        Uint32 instanceOffset;
+        Uint32 numInstances;
+    };
+
+    // Group the draws with the same mesh, states and materials.
+    // The groups are in the order of their first draws, and the instances of each group are contiguous in the order of the draws.
+    // outInstanceIndices[i] is the index of the draw i in the instance buffer.
+    // The scratch data is allocated in the frame allocator of the calling thread.
+    CUBE_CORE_EXPORT void GroupDrawMeshes(ConstArrayView<RGDrawMeshGroupingInfo> draws, FrameVector<RGDrawMeshGroup>& outGroups, FrameVector<Uint32>& outInstanceIndices);
+
+    // ===== Command list pool =====
+
+    // Command lists which RGBuilder records the segments into.
+    // They are created on demand and can be acquired again after ReleaseAll(). (All acquired command lists are submitted)
+    class CUBE_CORE_EXPORT RGCommandListPool
+    {
+    public:
+        RGCommandListPool() = default;
+        ~RGCommandListPool() = default;
+
+        RGCommandListPool(const RGCommandListPool& other) = delete;
+        RGCommandListPool& operator=(const RGCommandListPool& rhs) = delete;
+
+        void Initialize(GAPI& gapi);
+        void Shutdown();
+
+        gapi::CommandList& Acquire(gapi::CommandListType type);
+        void ReleaseAll();
+
+    private:
+        GAPI* mGAPI = nullptr;
+
+        struct TypePool
+        {
+            Vector<SharedPtr<gapi::CommandList>> commandLists;
+            Uint32 numAcquired = 0;
+        };
+        Array<TypePool, 2> mTypePools; // Index: gapi::CommandListType
+    };
+
+    // ===== Transient memory =====
+
+    // Range of the transient memory where a transient resource is placed.
+    struct RGTransientAllocation
+    {
+        int rgResourceIndex;
+        int beginPass;
+        int endPass;
+
+        Uint64 size;
+        Uint64 alignment;
+        Uint64 offset; // Offset in the transient memory of RGBuilder
+
+        // Set if the memory was used by other resources in the previous passes.
+        bool needAliasingBarrier = false;
+        // The resource which used the memory before. (-1 if it is not only one)
+        int aliasedResourceIndex = -1;
+    };
+
+    // Place the transient resources (rgResourceIndex, lifetime, size and alignment are set) in one memory and return its size.
+    // - Larger resources are placed first at the lowest offset which does not overlap the resources alive at the same time.
+    // - A resource placed in the memory used by the other resources before needs the aliasing barrier.
+    // The allocations are sorted in the placed order. It does not depend on the GPU, so the placement can be checked without a device.
+    CUBE_CORE_EXPORT Uint64 PlaceTransientAllocations(ArrayView<RGTransientAllocation> allocations);
+
+    // ===== Compile cache =====
+
+    // Compile results of the last RGBuilder executed with it. (culling, async compute schedule, transient placement,
+    // recording segments and transitions)
+    // They refer to the passes and resources by their indices, so the next RGBuilder with the same structural hash
+    // replays them and only patches the GAPI resources of its own RG resources.
+    class CUBE_CORE_EXPORT RGCompileCache
+    {
+    public:
+        RGCompileCache() = default;
+        ~RGCompileCache() = default;
+
+        RGCompileCache(const RGCompileCache& other) = delete;
+        RGCompileCache& operator=(const RGCompileCache& rhs) = delete;
+
+        void Clear();
+
+        Uint32 GetNumLookups() const { return mNumLookups; }
+        Uint32 GetNumHits() const { return mNumHits; }
+
+    private:
+        friend class RGBuilder;
+
+        struct PassResult
+        {
+            bool isCulled;
+            gapi::CommandListType queueType;
+            int asyncSignalPass;
+            int asyncWaitPass;
+            int segmentIndex;
+        };
+
+        struct ResourceLifetime
+        {
+            int beginPass;
+            int endPass;
+        };
+
+        struct SegmentResult
+        {
+            int beginPass;
+            int endPass;
+            gapi::CommandListType queueType;
+            int nextSegmentIndex;
+            Vector<int> waitSegments;
+        };
+
+        struct TransitionResult
+        {
+            int passIndex; // -1 if it is in the last pass
+            bool isPostTransition;
+            int rgResourceIndex; // RG texture / buffer which is transitioned
+            gapi::TransitionState transition; // Buffer / texture is not set
+        };
+
+        struct TextureStateResult
+        {
+            int rgResourceIndex;
+            gapi::ResourceStateFlags state;
+        };
+
+        bool mIsValid = false;
+        Uint64 mStructuralHash = 0;
+
+        Vector<PassResult> mPasses;
+        Vector<ResourceLifetime> mResourceLifetimes; // Index: RG resource index
+        RGAsyncComputePlan mAsyncComputePlan;
+        Vector<RGTransientAllocation> mTransientAllocations;
+        Uint64 mTransientMemorySize = 0;
+        Uint64 mTransientMemoryAlignment = 1;
+        Vector<SegmentResult> mSegments;
+        Vector<TransitionResult> mTransitions;
+        // Registered textures whose states are consumed from / stored to RGTextureStateCache.
+        Vector<int> mConsumedTextureStates;
+        Vector<TextureStateResult> mStoredTextureStates;
+        RGBuilderStats mStats;
+
+        Uint32 mNumLookups = 0;
+        Uint32 mNumHits = 0;
+    };
+
     // ===== ShaderParameterTypeInfo specializations for RG handles =====
 
     template <>
@@ -3,10 +3,12 @@
 #include "CoreHeader.h"
 
 #include "Checker.h"
+#include "FlatHashMap.h"
 #include "GAPI_Buffer.h"
 #include "GAPI_ShaderParameter.h"
 #include "GAPI_ShaderReflection.h"
 #include "Matrix.h"
+#include "Name.h"
 #include "Renderer/RenderTypes.h"
 
 #ifndef CUBE_CHECK_PARAMETERS
@@ -292,7 +294,7 @@ namespace cube
 
     struct ShaderParameterListInfo
     {
-        const Character* name;
+        Name name;
 
         Vector<ShaderParameterInfo> parameterInfos;
         Uint32 totalBufferSize;
@@ -389,7 +391,7 @@ private: \
 public: \
     static void InitializeParameterListInfo(const gapi::ShaderParameterHelper& shaderParemeterHelper, ShaderParameterListInfo& infos) \
     { \
-        infos.name = GetName(); \
+        infos.name = Name(GetName()); \
         ParameterIterHelperEnd::InitializeParameterInfo(infos); \
         shaderParemeterHelper.UpdateShaderParameterListInfo(infos); \
     } \
@@ -436,13 +438,13 @@ public: \
             static int cachedIndex = -1;
             if (cachedIndex == -1)
             {
-                cachedIndex = GetShaderParameterListInfoIndex(T::GetName());
+                cachedIndex = GetShaderParameterListInfoIndex(Name(T::GetName()));
                 CHECK_FORMAT(cachedIndex != -1, "Uninitialized shader parameter list type! ({0})", T::GetName());
             }
 
             return mShaderParameterListInfos[cachedIndex];
         }
-        static const ShaderParameterListInfo& GetShaderParameterListInfo(StringView parameterListTypeName)
+        static const ShaderParameterListInfo& GetShaderParameterListInfo(Name parameterListTypeName)
         {
             return mShaderParameterListInfos[GetShaderParameterListInfoIndex(parameterListTypeName)];
         }
@@ -450,7 +452,7 @@ public: \
     private:
         static void ProcessDeferredInitializingParameterListInfos(const gapi::ShaderParameterHelper& shaderParemeterHelper);
 
-        static int GetShaderParameterListInfoIndex(StringView parameterListTypeName);
+        static int GetShaderParameterListInfoIndex(Name parameterListTypeName);
 
         static constexpr int MAX_NUM_DEFERRED_INIT = 1024;
         static DeferredInitializingParameterListInfos mDeferredInitializingParameterListInfos[MAX_NUM_DEFERRED_INIT];
@@ -458,7 +460,7 @@ public: \
         static bool mIsDeferredInitOverflow;
 
         static Vector<ShaderParameterListInfo> mShaderParameterListInfos;
-        static Map<String, int> mShaderParameterListTypeNameToIndexMap;
+        static FlatHashMap<Name, int> mShaderParameterListTypeNameToIndexMap;
 
     public:
         ShaderParameterListManager() = default;
@@ -475,7 +477,16 @@ public: \
             requires std::derived_from<T, ShaderParameterList>
         SharedPtr<T> CreateShaderParameterList()
         {
-            SharedPtr<T> parameterList = std::make_shared<T>(*this);
+            return CreateShaderParameterList<T>(std::allocator<T>());
+        }
+
+        // The list and its control block are allocated with the allocator.
+        // (ex: Frame allocator for per-frame lists, PoolStdAllocator for lists created and released many times)
+        template <typename T, typename Allocator>
+            requires std::derived_from<T, ShaderParameterList>
+        SharedPtr<T> CreateShaderParameterList(const Allocator& allocator)
+        {
+            SharedPtr<T> parameterList = std::allocate_shared<T>(allocator, *this);
 
             AllocateShaderParameterList(parameterList.get(), GetShaderParameterListInfo<T>());
 
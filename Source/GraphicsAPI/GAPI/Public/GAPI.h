@@ -3,6 +3,7 @@
 #include "GAPIHeader.h"
 
 #include "CubeString.h"
+#include "GAPI_Resource.h"
 #include "GAPI_Timestamp.h"
 
 namespace cube
@@ -20,6 +21,7 @@ namespace cube
         struct ShaderCompileResult;
         class ShaderParameterHelper;
         class Buffer;
+        struct BufferInfo;
         struct BufferCreateInfo;
         class Texture;
         struct TextureInfo;
@@ -107,6 +109,11 @@ namespace cube
         virtual SharedPtr<gapi::Texture> CreateTexture(const gapi::TextureCreateInfo& createInfo) = 0;
         virtual SharedPtr<gapi::SwapChain> CreateSwapChain(const gapi::SwapChainCreateInfo& info) = 0;
 
+        // Used to place transient resources in the memory manually.
+        virtual gapi::TransientAllocationInfo GetTransientAllocationInfo(const gapi::BufferInfo& info) = 0;
+        virtual gapi::TransientAllocationInfo GetTransientAllocationInfo(const gapi::TextureInfo& info) = 0;
+        virtual gapi::TransientMemory AllocateTransientMemory(Uint64 size, Uint64 alignment) = 0;
+
         virtual gapi::TimestampRangeList GetLastTimestampRangeList() = 0;
         virtual gapi::VRAMStatus GetVRAMUsage() = 0;
 
@@ -45,6 +45,9 @@ namespace cube
             BufferInfo bufferInfo;
 
             StringView debugName;
+
+            // Only used in transient usage. If it is invalid, the memory is allocated automatically.
+            TransientMemory placedMemory = {};
         };
 
         class Buffer
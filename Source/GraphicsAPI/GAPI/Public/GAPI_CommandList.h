@@ -98,22 +98,59 @@ namespace cube
             SharedPtr<Buffer> buffer = nullptr;
             SharedPtr<Texture> texture = nullptr;
             Uint32 subresourceIndex = 0;
+            // Transition all subresources in subresourceRange instead of subresourceIndex.
+            bool useSubresourceRange = false;
+            SubresourceRange subresourceRange = {};
 
             ResourceStateFlags src;
             ResourceStateFlags dst;
+
+            // Split transition is issued as a begin and an end with the same parameters.
+            // The resource should not be used between them.
+            enum class SplitType
+            {
+                None,
+                Begin,
+                End
+            };
+            SplitType split = SplitType::None;
+        };
+
+        // Transient resources placed in the same memory need aliasing barrier before the new resource is used.
+        struct AliasingState
+        {
+            // Resource previously used in the memory. Can be null if it is unknown.
+            SharedPtr<Buffer> bufferBefore = nullptr;
+            SharedPtr<Texture> textureBefore = nullptr;
+
+            SharedPtr<Buffer> bufferAfter = nullptr;
+            SharedPtr<Texture> textureAfter = nullptr;
+        };
+
+        // Queue type which the command list is submitted to.
+        // Compute command lists only support compute, copy and the transitions between non-pixel states.
+        enum class CommandListType
+        {
+            Graphics,
+            Compute
         };
 
         struct CommandListCreateInfo
         {
+            CommandListType type = CommandListType::Graphics;
             StringView debugName;
         };
 
         class CommandList
         {
         public:
-            CommandList() = default;
+            CommandList(const CommandListCreateInfo& info) :
+                mType(info.type)
+            {}
             virtual ~CommandList() = default;
 
+            CommandListType GetType() const { return mType; }
+
             virtual void Begin() = 0;
             virtual void End() = 0;
             virtual void Reset() = 0;
@@ -143,6 +180,10 @@ namespace cube
 
             virtual void ResourceTransition(TransitionState state) = 0;
             virtual void ResourceTransition(ArrayView<const TransitionState> states) = 0;
+            virtual void AliasingBarrier(ArrayView<const AliasingState> states) = 0;
+            // Mark the contents of the render target / depth stencil texture as undefined.
+            // The aliased texture should be discarded or cleared before it is used. The texture should be in RenderTarget / DepthWrite.
+            virtual void DiscardResource(SharedPtr<Texture> texture) = 0;
 
             virtual void SetComputePipeline(SharedPtr<ComputePipeline> computePipeline) = 0;
             virtual void DispatchThreads(Uint32 numThreadsX, Uint32 numThreadsY, Uint32 numThreadsZ) = 0;
@@ -152,7 +193,14 @@ namespace cube
             virtual void BeginTimestamp(StringView name) = 0;
             virtual void EndTimestamp() = 0;
 
-            virtual void Submit(bool waitUntilFinished = false) = 0;
+            // Make the queue wait on the GPU until the other queue finishes the command list submitted with the fence value.
+            // It is applied in the next Submit.
+            virtual void WaitQueue(CommandListType queueType, Uint64 fenceValue) = 0;
+            // Returns the fence value of the queue which is signaled after the command list is finished.
+            virtual Uint64 Submit(bool waitUntilFinished = false) = 0;
+
+        protected:
+            CommandListType mType;
         };
     } // namespace gapi
 } // namespace cube
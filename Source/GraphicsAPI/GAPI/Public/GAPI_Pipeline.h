@@ -36,6 +36,8 @@ namespace cube
                 CounterClockwise
             };
             FrontFace frontFace = FrontFace::CounterClockwise;
+
+            bool operator==(const RasterizerState& rhs) const = default;
         };
 
         enum class BlendFactor
@@ -111,6 +113,8 @@ namespace cube
             StencilOperator failOp = StencilOperator::Zero;
             StencilOperator depthFailOp = StencilOperator::Zero;
             StencilOperator passOp = StencilOperator::Keep;
+
+            bool operator==(const StencilDesc& rhs) const = default;
         };
 
         struct DepthStencilState
@@ -123,6 +127,8 @@ namespace cube
             Uint8 stencilWriteMask = 0xff;
             StencilDesc stencilFrontFaceDesc;
             StencilDesc stencilBackFaceDesc;
+
+            bool operator==(const DepthStencilState& rhs) const = default;
         };
 
         enum class PrimitiveTopologyType
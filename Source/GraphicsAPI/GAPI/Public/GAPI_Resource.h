@@ -42,6 +42,23 @@ namespace cube
             }
         }
 
+        struct TransientAllocationInfo
+        {
+            Uint64 size = 0;
+            Uint64 alignment = 0;
+        };
+
+        // Memory range in the transient heap. Transient resources created with it are placed at the offset
+        // and can alias other resources in the same range, so the user should insert aliasing barriers.
+        struct TransientMemory
+        {
+            void* pHeap = nullptr;
+            Uint64 offset = 0;
+            Uint64 size = 0;
+
+            bool IsValid() const { return pHeap != nullptr; }
+        };
+
         enum class ResourceStateFlag
         {
             Common = 0,
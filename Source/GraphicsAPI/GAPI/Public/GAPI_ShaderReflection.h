@@ -3,6 +3,7 @@
 #include "GAPIHeader.h"
 
 #include "CubeString.h"
+#include "Name.h"
 
 namespace cube
 {
@@ -92,7 +93,7 @@ namespace cube
 
         struct ShaderParameterBlockReflection
         {
-            String typeName;
+            Name typeName;
             Uint32 index;
 
             Vector<ShaderParameterReflection> params;
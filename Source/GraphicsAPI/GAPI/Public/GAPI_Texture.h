@@ -56,6 +56,9 @@ namespace cube
             TextureInfo textureInfo;
 
             StringView debugName;
+
+            // Only used in transient usage. If it is invalid, the memory is allocated automatically.
+            TransientMemory placedMemory = {};
         };
 
         class Texture
@@ -4,6 +4,7 @@
 #include <slang-com-ptr.h>
 
 #include "Allocator/FrameAllocator.h"
+#include "Allocator/TLSFAllocator.h"
 #include "Checker.h"
 #include "Engine.h"
 #include "FileSystem.h"
@@ -273,7 +274,7 @@ namespace cube
             compileResult.AddWarning(Format<FrameString>(CUBE_T("Warning about getting the code.\n\n{0}\n"), (const char*)diagnosticBlob->getBufferPointer()));
         }
 
-        Blob resBlob((Byte*)code->getBufferPointer(), code->getBufferSize());
+        Blob resBlob((Byte*)code->getBufferPointer(), code->getBufferSize(), &GetAssetHeapAllocator(), MemoryTag::Shader);
 
         compileResult.isSuccess = true;
 
@@ -344,7 +345,7 @@ namespace cube
 
                 const char* parameterTypeName = parameterTypeLayout->getName();
                 Uint32 index = blockVariableLayout->getBindingIndex() + bindingOffset;
-                gapi::ShaderParameterBlockReflection& outBlockReflection = outReflection.blocks.emplace_back(String_Convert<String>(parameterTypeName), index);
+                gapi::ShaderParameterBlockReflection& outBlockReflection = outReflection.blocks.emplace_back(Name(String_Convert<String>(parameterTypeName)), index);
 
                 if (parameterTypeLayout->getKind() == TypeReflection::Kind::Struct)
                 {
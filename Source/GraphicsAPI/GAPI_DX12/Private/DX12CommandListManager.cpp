@@ -3,6 +3,7 @@
 #include "DX12APIObject.h"
 #include "DX12Device.h"
 #include "DX12Utility.h"
+#include "GAPI_DX12CommandList.h"
 
 namespace cube
 {
@@ -43,6 +44,13 @@ namespace cube
 
         mBoundObjectsInCommand.clear();
         mBoundObjectsInCommand.resize(newNumGPUSync);
+
+        {
+            std::unique_lock<std::mutex> lock(mAllocatorPoolMutex);
+
+            mAllocatorPools.clear();
+            mAllocatorPools.resize(newNumGPUSync);
+        }
     }
 
     void DX12CommandListManager::MoveToNextIndex(Uint64 nextGPUFrame)
@@ -51,6 +59,18 @@ namespace cube
 
         CHECK_HR(mAllocators[mCurrentIndex]->Reset());
         mBoundObjectsInCommand[mCurrentIndex].clear();
+
+        std::unique_lock<std::mutex> lock(mAllocatorPoolMutex);
+
+        for (AllocatorPool& pool : mAllocatorPools[mCurrentIndex])
+        {
+            pool.freeAllocators.clear();
+            for (ComPtr<ID3D12CommandAllocator>& allocator : pool.allocators)
+            {
+                CHECK_HR(allocator->Reset());
+                pool.freeAllocators.push_back(allocator.Get());
+            }
+        }
     }
 
     void DX12CommandListManager::ClearAll()
@@ -64,6 +84,48 @@ namespace cube
         {
             boundObjects.clear();
         }
+
+        std::unique_lock<std::mutex> lock(mAllocatorPoolMutex);
+
+        for (auto& pools : mAllocatorPools)
+        {
+            for (AllocatorPool& pool : pools)
+            {
+                pool.freeAllocators.clear();
+                for (ComPtr<ID3D12CommandAllocator>& allocator : pool.allocators)
+                {
+                    CHECK_HR(allocator->Reset());
+                    pool.freeAllocators.push_back(allocator.Get());
+                }
+            }
+        }
+    }
+
+    ID3D12CommandAllocator* DX12CommandListManager::AcquireAllocator(gapi::CommandListType type)
+    {
+        std::unique_lock<std::mutex> lock(mAllocatorPoolMutex);
+
+        AllocatorPool& pool = mAllocatorPools[mCurrentIndex][static_cast<int>(type)];
+        if (pool.freeAllocators.empty())
+        {
+            ComPtr<ID3D12CommandAllocator>& allocator = pool.allocators.emplace_back();
+            CHECK_HR(mDevice.GetDevice()->CreateCommandAllocator(gapi::ConvertToDX12CommandListType(type), IID_PPV_ARGS(&allocator)));
+            SET_DEBUG_NAME_FORMAT(allocator, "CommandListAllocator[{0}][{1}][{2}]", mCurrentIndex, static_cast<int>(type), pool.allocators.size() - 1);
+
+            return allocator.Get();
+        }
+
+        ID3D12CommandAllocator* allocator = pool.freeAllocators.back();
+        pool.freeAllocators.pop_back();
+
+        return allocator;
+    }
+
+    void DX12CommandListManager::ReleaseAllocator(gapi::CommandListType type, ID3D12CommandAllocator* allocator)
+    {
+        std::unique_lock<std::mutex> lock(mAllocatorPoolMutex);
+
+        mAllocatorPools[mCurrentIndex][static_cast<int>(type)].freeAllocators.push_back(allocator);
     }
 
     void DX12CommandListManager::AddBoundObjects(ArrayView<SharedPtr<DX12APIObject>> objects)
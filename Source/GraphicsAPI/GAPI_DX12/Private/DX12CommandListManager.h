@@ -2,7 +2,10 @@
 
 #include "DX12Header.h"
 
+#include <mutex>
+
 #include "DX12Fence.h"
+#include "GAPI_CommandList.h"
 
 namespace cube
 {
@@ -27,6 +30,11 @@ namespace cube
         void AddBoundObjects(ArrayView<SharedPtr<DX12APIObject>> objects);
         ID3D12CommandAllocator* GetCurrentAllocator() const { return mAllocators[mCurrentIndex].Get(); }
 
+        // Allocators for DX12CommandList. Each command list should have its own allocator while it is recorded
+        // so multiple command lists can be recorded in parallel. The allocator can be reused after the command list is closed.
+        // They are thread-safe. Allocators are pooled per command list type.
+        ID3D12CommandAllocator* AcquireAllocator(gapi::CommandListType type);
+        void ReleaseAllocator(gapi::CommandListType type, ID3D12CommandAllocator* allocator);
 
     private:
         DX12Device& mDevice;
@@ -34,6 +42,15 @@ namespace cube
         Uint32 mCurrentIndex;
 
         Vector<ComPtr<ID3D12CommandAllocator>> mAllocators;
+
+        struct AllocatorPool
+        {
+            Vector<ComPtr<ID3D12CommandAllocator>> allocators;
+            Vector<ID3D12CommandAllocator*> freeAllocators;
+        };
+        static constexpr int NUM_COMMAND_LIST_TYPES = 2;
+        Vector<Array<AllocatorPool, NUM_COMMAND_LIST_TYPES>> mAllocatorPools; // [GPU sync index][command list type]
+        std::mutex mAllocatorPoolMutex;
         Vector<Vector<SharedPtr<DX12APIObject>>> mBoundObjectsInCommand;
     };
 } // namespace cube
@@ -148,6 +148,9 @@ namespace cube
 
         waitFence.Shutdown();
 
+        DX12QueueManager& queueManager = GetQueueManager();
+        queueManager.WaitOnCPU(gapi::CommandListType::Compute, queueManager.GetLastFenceValue(gapi::CommandListType::Compute));
+
         GetCommandListManager().ClearAll();
     }
 } // namespace cube
@@ -55,6 +55,11 @@ namespace cube
         }
     }
 
+    void DX12Fence::WaitOnGPU(ID3D12CommandQueue* queue, DX12FenceValue fenceValue)
+    {
+        CHECK_HR(queue->Wait(mFence.Get(), fenceValue));
+    }
+
     DX12FenceValue DX12Fence::GetCompletedValue()
     {
         return mFence->GetCompletedValue();
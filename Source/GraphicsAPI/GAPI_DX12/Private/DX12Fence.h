@@ -19,6 +19,8 @@ namespace cube
 
         void Signal(ID3D12CommandQueue* queue, Uint64 fenceValue);
         void Wait(DX12FenceValue fenceValue);
+        // Make the queue wait until the fence reaches the value without blocking the CPU.
+        void WaitOnGPU(ID3D12CommandQueue* queue, DX12FenceValue fenceValue);
         DX12FenceValue GetCompletedValue();
 
     private:
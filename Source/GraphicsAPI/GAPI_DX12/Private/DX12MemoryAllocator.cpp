@@ -50,7 +50,8 @@ namespace cube
         }
     }
 
-    DX12Allocation DX12MemoryAllocator::Allocate(D3D12_HEAP_TYPE heapType, const D3D12_RESOURCE_DESC& desc, bool transient, const D3D12_CLEAR_VALUE* pOptimizedClearValue)
+    DX12Allocation DX12MemoryAllocator::Allocate(D3D12_HEAP_TYPE heapType, const D3D12_RESOURCE_DESC& desc, bool transient, const D3D12_CLEAR_VALUE* pOptimizedClearValue,
+        const gapi::TransientMemory& placedMemory)
     {
         DX12Allocation allocation;
         if (desc.Dimension == D3D12_RESOURCE_DIMENSION_BUFFER)
@@ -64,12 +65,7 @@ namespace cube
         allocation.heapType = heapType;
         allocation.isTransient = transient;
 
-        D3D12_RESOURCE_DESC newDesc = desc;
-        if (mDevice.IsTightAlignmentSupported())
-        {
-            newDesc.Alignment = 0;
-            newDesc.Flags |= D3D12_RESOURCE_FLAG_USE_TIGHT_ALIGNMENT;
-        }
+        D3D12_RESOURCE_DESC newDesc = GetAdjustedResourceDesc(desc);
 
         if (transient)
         {
@@ -79,10 +75,12 @@ namespace cube
                 allocation.heapType = D3D12_HEAP_TYPE_DEFAULT;
             }
 
-            AllocateFromTransient(allocation, newDesc, pOptimizedClearValue);
+            AllocateFromTransient(allocation, newDesc, pOptimizedClearValue, placedMemory);
         }
         else
         {
+            CHECK_FORMAT(!placedMemory.IsValid(), "Placed memory can be used only in transient resource.");
+
             D3D12MA::ALLOCATION_DESC allocationDesc = {};
             allocationDesc.HeapType = heapType;
 
@@ -119,16 +117,20 @@ namespace cube
         allocation.resource = nullptr;
     }
 
-    void DX12MemoryAllocator::AllocateFromTransient(DX12Allocation& inOutAllocation, const D3D12_RESOURCE_DESC& desc, const D3D12_CLEAR_VALUE* pOptimizedClearValue)
+    D3D12_RESOURCE_ALLOCATION_INFO DX12MemoryAllocator::GetResourceAllocationInfo(const D3D12_RESOURCE_DESC& desc) const
     {
-        const D3D12_RESOURCE_ALLOCATION_INFO allocationInfo = mDevice.GetDevice()->GetResourceAllocationInfo(0, 1, &desc);
+        const D3D12_RESOURCE_DESC adjustedDesc = GetAdjustedResourceDesc(desc);
+        return mDevice.GetDevice()->GetResourceAllocationInfo(0, 1, &adjustedDesc);
+    }
 
+    gapi::TransientMemory DX12MemoryAllocator::AllocateTransientMemory(Uint64 size, Uint64 alignment)
+    {
         TransientHeap* selectedHeap = nullptr;
         Uint64 alignedOffset = 0;
         for (TransientHeap& heap : mTransientHeaps)
         {
-            alignedOffset = Align(heap.currentOffset, allocationInfo.Alignment);
-            if (alignedOffset + allocationInfo.SizeInBytes <= heap.size)
+            alignedOffset = Align(heap.currentOffset, alignment);
+            if (alignedOffset + size <= heap.size)
             {
                 selectedHeap = &heap;
                 break;
@@ -136,12 +138,48 @@ namespace cube
         }
         if (!selectedHeap)
         {
-            selectedHeap = CreateNewTransientHeap(allocationInfo.SizeInBytes);
+            selectedHeap = CreateNewTransientHeap(size);
+            alignedOffset = 0;
         }
 
-        CHECK_HR(mDevice.GetDevice()->CreatePlacedResource(selectedHeap->d3d12Heap.Get(), alignedOffset, &desc, D3D12_RESOURCE_STATE_COMMON, pOptimizedClearValue, IID_PPV_ARGS(&inOutAllocation.resource)));
-        selectedHeap->currentOffset = alignedOffset + allocationInfo.SizeInBytes;
+        selectedHeap->currentOffset = alignedOffset + size;
         selectedHeap->lastUsedGPUFrame = mCurrentGPUFrame;
+
+        return {
+            .pHeap = selectedHeap->d3d12Heap.Get(),
+            .offset = alignedOffset,
+            .size = size
+        };
+    }
+
+    D3D12_RESOURCE_DESC DX12MemoryAllocator::GetAdjustedResourceDesc(const D3D12_RESOURCE_DESC& desc) const
+    {
+        D3D12_RESOURCE_DESC newDesc = desc;
+        if (mDevice.IsTightAlignmentSupported())
+        {
+            newDesc.Alignment = 0;
+            newDesc.Flags |= D3D12_RESOURCE_FLAG_USE_TIGHT_ALIGNMENT;
+        }
+        return newDesc;
+    }
+
+    void DX12MemoryAllocator::AllocateFromTransient(DX12Allocation& inOutAllocation, const D3D12_RESOURCE_DESC& desc, const D3D12_CLEAR_VALUE* pOptimizedClearValue, const gapi::TransientMemory& placedMemory)
+    {
+        const D3D12_RESOURCE_ALLOCATION_INFO allocationInfo = mDevice.GetDevice()->GetResourceAllocationInfo(0, 1, &desc);
+
+        gapi::TransientMemory memory = placedMemory;
+        if (memory.IsValid())
+        {
+            CHECK_FORMAT(memory.offset % allocationInfo.Alignment == 0, "Placed memory offset is not aligned. (offset: {0}, alignment: {1})", memory.offset, allocationInfo.Alignment);
+            CHECK_FORMAT(allocationInfo.SizeInBytes <= memory.size, "Placed memory is too small. (size: {0}, required: {1})", memory.size, allocationInfo.SizeInBytes);
+        }
+        else
+        {
+            memory = AllocateTransientMemory(allocationInfo.SizeInBytes, allocationInfo.Alignment);
+        }
+
+        ID3D12Heap* heap = static_cast<ID3D12Heap*>(memory.pHeap);
+        CHECK_HR(mDevice.GetDevice()->CreatePlacedResource(heap, memory.offset, &desc, D3D12_RESOURCE_STATE_COMMON, pOptimizedClearValue, IID_PPV_ARGS(&inOutAllocation.resource)));
     }
 
     DX12MemoryAllocator::TransientHeap* DX12MemoryAllocator::CreateNewTransientHeap(Uint64 size)
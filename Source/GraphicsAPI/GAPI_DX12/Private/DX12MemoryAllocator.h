@@ -6,6 +6,7 @@
 #include "D3D12MemAlloc.h"
 
 #include "DX12Utility.h"
+#include "GAPI_Resource.h"
 
 namespace cube
 {
@@ -83,11 +84,16 @@ namespace cube
         void SetNumGPUSync(Uint32 newNumGPUSync);
         void MoveToNextIndex(Uint64 nextGPUFrame);
 
-        DX12Allocation Allocate(D3D12_HEAP_TYPE heapType, const D3D12_RESOURCE_DESC& desc, bool transient = false, const D3D12_CLEAR_VALUE* pOptimizedClearValue = nullptr);
+        DX12Allocation Allocate(D3D12_HEAP_TYPE heapType, const D3D12_RESOURCE_DESC& desc, bool transient = false, const D3D12_CLEAR_VALUE* pOptimizedClearValue = nullptr,
+            const gapi::TransientMemory& placedMemory = {});
         void Free(DX12Allocation& allocation);
 
+        D3D12_RESOURCE_ALLOCATION_INFO GetResourceAllocationInfo(const D3D12_RESOURCE_DESC& desc) const;
+        gapi::TransientMemory AllocateTransientMemory(Uint64 size, Uint64 alignment);
+
     private:
-        void AllocateFromTransient(DX12Allocation& inOutAllocation, const D3D12_RESOURCE_DESC& desc, const D3D12_CLEAR_VALUE* pOptimizedClearValue = nullptr);
+        D3D12_RESOURCE_DESC GetAdjustedResourceDesc(const D3D12_RESOURCE_DESC& desc) const;
+        void AllocateFromTransient(DX12Allocation& inOutAllocation, const D3D12_RESOURCE_DESC& desc, const D3D12_CLEAR_VALUE* pOptimizedClearValue, const gapi::TransientMemory& placedMemory);
 
         DX12Device& mDevice;
 
@@ -97,6 +97,8 @@ namespace cube
 
     Uint32 DX12QueryManager::GetCurrentLastQueryIndexAndUse(Uint32 numUseQueries)
     {
+        std::unique_lock<std::mutex> lock(mQueryMutex);
+
         Uint32 res = mLastQueryIndices[mCurrentGPUSyncIndex];
 
         mLastQueryIndices[mCurrentGPUSyncIndex] += numUseQueries;
@@ -107,6 +109,8 @@ namespace cube
 
     void DX12QueryManager::AddTimestampRange(StringView name, Uint32 beginQueryIndex, Uint32 endQueryIndex)
     {
+        std::unique_lock<std::mutex> lock(mQueryMutex);
+
         mTimestampRanges[mCurrentGPUSyncIndex].push_back({
             .name = { name.begin(), name.end() },
             .beginQueryIndex = beginQueryIndex,
@@ -116,7 +120,11 @@ namespace cube
 
     void DX12QueryManager::ResolveQueryData(ID3D12GraphicsCommandList* commandList)
     {
-        const Uint32 numQueries = mLastQueryIndices[mCurrentGPUSyncIndex];
+        Uint32 numQueries;
+        {
+            std::unique_lock<std::mutex> lock(mQueryMutex);
+            numQueries = mLastQueryIndices[mCurrentGPUSyncIndex];
+        }
         const Uint64 bufferSubSize = sizeof(Uint64) * MAX_NUM_QUERY;
 
         commandList->ResolveQueryData(GetCurrentTimestampHeap(), D3D12_QUERY_TYPE_TIMESTAMP, 0, numQueries,
@@ -2,6 +2,8 @@
 
 #include "DX12Header.h"
 
+#include <mutex>
+
 #include "DX12Fence.h"
 #include "DX12MemoryAllocator.h"
 #include "GAPI_Timestamp.h"
@@ -31,6 +33,7 @@ namespace cube
 
         ID3D12QueryHeap* GetCurrentTimestampHeap() const { return mTimestampHeaps[mCurrentGPUSyncIndex].Get(); }
 
+        // Thread-safe to record timestamps in multiple command lists in parallel.
         Uint32 GetCurrentLastQueryIndexAndUse(Uint32 numUseQueries);
         void AddTimestampRange(StringView name, Uint32 beginQueryIndex, Uint32 endQueryIndex);
         void ResolveQueryData(ID3D12GraphicsCommandList* commandList);
@@ -56,5 +59,7 @@ namespace cube
             Uint32 endQueryIndex;
         };
         Vector<Vector<DX12TimestampRange>> mTimestampRanges;
+
+        std::mutex mQueryMutex;
     };
 } // namespace cube
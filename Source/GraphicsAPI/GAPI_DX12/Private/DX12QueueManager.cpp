@@ -6,7 +6,9 @@
 namespace cube
 {
     DX12QueueManager::DX12QueueManager(DX12Device& device) :
-        mDevice(device)
+        mDevice(device),
+        mMainQueue(device),
+        mComputeQueue(device)
     {
     }
 
@@ -15,17 +17,56 @@ namespace cube
         D3D12_COMMAND_QUEUE_DESC queueDesc = {};
         queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
         queueDesc.Type = D3D12_COMMAND_LIST_TYPE_DIRECT;
-        CHECK_HR(mDevice.GetDevice()->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&mMainQueue)));
-        SET_DEBUG_NAME(mMainQueue, CUBE_T("MainCommandQueue"));
+        CHECK_HR(mDevice.GetDevice()->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&mMainQueue.queue)));
+        SET_DEBUG_NAME(mMainQueue.queue, CUBE_T("MainCommandQueue"));
+        mMainQueue.fence.Initialize(CUBE_T("MainCommandQueueFence"));
+        mMainQueue.lastFenceValue = 0;
+
+        queueDesc.Type = D3D12_COMMAND_LIST_TYPE_COMPUTE;
+        CHECK_HR(mDevice.GetDevice()->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&mComputeQueue.queue)));
+        SET_DEBUG_NAME(mComputeQueue.queue, CUBE_T("ComputeCommandQueue"));
+        mComputeQueue.fence.Initialize(CUBE_T("ComputeCommandQueueFence"));
+        mComputeQueue.lastFenceValue = 0;
 
         queueDesc.Type = D3D12_COMMAND_LIST_TYPE_COPY;
         CHECK_HR(mDevice.GetDevice()->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&mCopyQueue)));
-        SET_DEBUG_NAME(mMainQueue, CUBE_T("CopyCommandQueue"));
+        SET_DEBUG_NAME(mCopyQueue, CUBE_T("CopyCommandQueue"));
     }
 
     void DX12QueueManager::Shutdown()
     {
         mCopyQueue = nullptr;
-        mMainQueue = nullptr;
+
+        mComputeQueue.fence.Shutdown();
+        mComputeQueue.queue = nullptr;
+
+        mMainQueue.fence.Shutdown();
+        mMainQueue.queue = nullptr;
+    }
+
+    DX12FenceValue DX12QueueManager::Signal(gapi::CommandListType type)
+    {
+        QueueInfo& queueInfo = GetQueueInfo(type);
+
+        queueInfo.lastFenceValue++;
+        queueInfo.fence.Signal(queueInfo.queue.Get(), queueInfo.lastFenceValue);
+
+        return queueInfo.lastFenceValue;
+    }
+
+    void DX12QueueManager::WaitOnGPU(gapi::CommandListType waitingType, gapi::CommandListType signaledType, DX12FenceValue fenceValue)
+    {
+        if (waitingType == signaledType)
+        {
+            // Command lists in the same queue are already executed in order.
+            return;
+        }
+
+        GetQueueInfo(signaledType).fence.WaitOnGPU(GetQueueInfo(waitingType).queue.Get(), fenceValue);
+    }
+
+    void DX12QueueManager::WaitOnCPU(gapi::CommandListType type, DX12FenceValue fenceValue)
+    {
+        GetQueueInfo(type).fence.Wait(fenceValue);
     }
 } // namespace cube
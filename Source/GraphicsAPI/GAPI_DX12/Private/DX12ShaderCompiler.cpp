@@ -2,6 +2,7 @@
 
 #include <dxcapi.h>
 
+#include "Allocator/TLSFAllocator.h"
 #include "DX12Device.h"
 #include "GAPI_Shader.h"
 #include "SlangHelper.h"
@@ -102,7 +103,7 @@ namespace cube
             dxcResult->GetResult(&shader);
 
             DX12ShaderCompilerResult result;
-            result.shader = Blob(shader->GetBufferPointer(), shader->GetBufferSize());
+            result.shader = Blob(shader->GetBufferPointer(), shader->GetBufferSize(), &GetAssetHeapAllocator(), MemoryTag::Shader);
 
             ComPtr<IDxcBlob> hashBlob;
             if (SUCCEEDED(dxcResult->GetOutput(DXC_OUT_SHADER_HASH, IID_PPV_ARGS(&hashBlob), nullptr)) && hashBlob)
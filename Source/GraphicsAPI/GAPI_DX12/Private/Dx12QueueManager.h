@@ -2,6 +2,9 @@
 
 #include "DX12Header.h"
 
+#include "DX12Fence.h"
+#include "GAPI_CommandList.h"
+
 namespace cube
 {
     class DX12Device;
@@ -17,13 +20,36 @@ namespace cube
         void Initialize();
         void Shutdown();
 
-        ID3D12CommandQueue* GetMainQueue() const { return mMainQueue.Get(); }
+        ID3D12CommandQueue* GetMainQueue() const { return mMainQueue.queue.Get(); }
+        ID3D12CommandQueue* GetComputeQueue() const { return mComputeQueue.queue.Get(); }
         ID3D12CommandQueue* GetCopyQueue() const { return mCopyQueue.Get(); }
+        ID3D12CommandQueue* GetQueue(gapi::CommandListType type) const { return GetQueueInfo(type).queue.Get(); }
+
+        // Each queue of the command list types has its own fence and the value is increased in every Signal().
+        DX12FenceValue Signal(gapi::CommandListType type);
+        DX12FenceValue GetLastFenceValue(gapi::CommandListType type) const { return GetQueueInfo(type).lastFenceValue; }
+        // The waiting queue waits on the GPU until the signaled queue reaches the fence value.
+        void WaitOnGPU(gapi::CommandListType waitingType, gapi::CommandListType signaledType, DX12FenceValue fenceValue);
+        void WaitOnCPU(gapi::CommandListType type, DX12FenceValue fenceValue);
 
     private:
+        struct QueueInfo
+        {
+            QueueInfo(DX12Device& device) :
+                fence(device)
+            {}
+
+            ComPtr<ID3D12CommandQueue> queue;
+            DX12Fence fence;
+            DX12FenceValue lastFenceValue = 0;
+        };
+        QueueInfo& GetQueueInfo(gapi::CommandListType type) { return (type == gapi::CommandListType::Compute) ? mComputeQueue : mMainQueue; }
+        const QueueInfo& GetQueueInfo(gapi::CommandListType type) const { return (type == gapi::CommandListType::Compute) ? mComputeQueue : mMainQueue; }
+
         DX12Device& mDevice;
 
-        ComPtr<ID3D12CommandQueue> mMainQueue;
+        QueueInfo mMainQueue;
+        QueueInfo mComputeQueue;
         ComPtr<ID3D12CommandQueue> mCopyQueue;
     };
 } // namespace cube
@@ -280,6 +280,27 @@ namespace cube
         return std::make_shared<gapi::DX12SwapChain>(mFactory.Get(), *mMainDevice, info);
     }
 
+    gapi::TransientAllocationInfo GAPI_DX12::GetTransientAllocationInfo(const gapi::BufferInfo& info)
+    {
+        const D3D12_RESOURCE_DESC desc = gapi::DX12Buffer::CreateD3D12ResourceDesc(info);
+        const D3D12_RESOURCE_ALLOCATION_INFO allocationInfo = mMainDevice->GetMemoryAllocator().GetResourceAllocationInfo(desc);
+
+        return { .size = allocationInfo.SizeInBytes, .alignment = allocationInfo.Alignment };
+    }
+
+    gapi::TransientAllocationInfo GAPI_DX12::GetTransientAllocationInfo(const gapi::TextureInfo& info)
+    {
+        const D3D12_RESOURCE_DESC desc = gapi::DX12Texture::CreateD3D12ResourceDesc(info, gapi::ResourceUsage::Transient);
+        const D3D12_RESOURCE_ALLOCATION_INFO allocationInfo = mMainDevice->GetMemoryAllocator().GetResourceAllocationInfo(desc);
+
+        return { .size = allocationInfo.SizeInBytes, .alignment = allocationInfo.Alignment };
+    }
+
+    gapi::TransientMemory GAPI_DX12::AllocateTransientMemory(Uint64 size, Uint64 alignment)
+    {
+        return mMainDevice->GetMemoryAllocator().AllocateTransientMemory(size, alignment);
+    }
+
     gapi::TimestampRangeList GAPI_DX12::GetLastTimestampRangeList()
     {
         return mMainDevice->GetQueryManager().GetLastTimestampRangeList();
@@ -7,6 +7,31 @@ namespace cube
 {
     namespace gapi
     {
+        D3D12_RESOURCE_DESC DX12Buffer::CreateD3D12ResourceDesc(const BufferInfo& info)
+        {
+            D3D12_RESOURCE_FLAGS flags = D3D12_RESOURCE_FLAG_NONE;
+            if (info.flags.IsSet(BufferFlag::UAV))
+            {
+                flags |= D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
+            }
+
+            return {
+                .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
+                .Alignment = 0,
+                .Width = info.size,
+                .Height = 1,
+                .DepthOrArraySize = 1,
+                .MipLevels = 1,
+                .Format = DXGI_FORMAT_UNKNOWN,
+                .SampleDesc = {
+                    .Count = 1,
+                    .Quality = 0
+                },
+                .Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR,
+                .Flags = flags
+            };
+        }
+
         DX12Buffer::DX12Buffer(const BufferCreateInfo& info, DX12Device& device) :
             Buffer(info),
             mDevice(device)
@@ -30,27 +55,7 @@ namespace cube
                 }
             }
 
-            D3D12_RESOURCE_FLAGS flags = D3D12_RESOURCE_FLAG_NONE;
-            if (mInfo.flags.IsSet(BufferFlag::UAV))
-            {
-                flags |= D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
-            }
-
-            D3D12_RESOURCE_DESC desc = {
-                .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
-                .Alignment = 0,
-                .Width = mInfo.size,
-                .Height = 1,
-                .DepthOrArraySize = 1,
-                .MipLevels = 1,
-                .Format = DXGI_FORMAT_UNKNOWN,
-                .SampleDesc = {
-                    .Count = 1,
-                    .Quality = 0
-                },
-                .Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR,
-                .Flags = flags
-            };
+            D3D12_RESOURCE_DESC desc = CreateD3D12ResourceDesc(mInfo);
 
             D3D12_HEAP_TYPE heapType;
             switch (mUsage)
@@ -68,7 +73,7 @@ namespace cube
                 heapType = D3D12_HEAP_TYPE_UPLOAD; break;
             }
             const bool isTransient = (mUsage == ResourceUsage::Transient);
-            mAllocation = device.GetMemoryAllocator().Allocate(heapType, desc, isTransient);
+            mAllocation = device.GetMemoryAllocator().Allocate(heapType, desc, isTransient, nullptr, info.placedMemory);
             SET_DEBUG_NAME(mAllocation.resource, info.debugName);
 
             if (mUsage == ResourceUsage::GPUtoCPU)
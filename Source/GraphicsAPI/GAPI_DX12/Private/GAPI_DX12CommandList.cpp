@@ -16,6 +16,20 @@ namespace cube
 {
     namespace gapi
     {
+        D3D12_COMMAND_LIST_TYPE ConvertToDX12CommandListType(CommandListType type)
+        {
+            switch (type)
+            {
+            case CommandListType::Graphics:
+                return D3D12_COMMAND_LIST_TYPE_DIRECT;
+            case CommandListType::Compute:
+                return D3D12_COMMAND_LIST_TYPE_COMPUTE;
+            default:
+                NOT_IMPLEMENTED();
+            }
+            return D3D12_COMMAND_LIST_TYPE_DIRECT;
+        }
+
         D3D12_PRIMITIVE_TOPOLOGY ConvertToDX12PrimitiveTopology(PrimitiveTopology primitiveTopology)
         {
             switch (primitiveTopology)
@@ -37,12 +51,17 @@ namespace cube
         }
 
         DX12CommandList::DX12CommandList(DX12Device& device, const CommandListCreateInfo& info)
-            : mDevice(device)
+            : CommandList(info)
+            , mDevice(device)
             , mState(State::Closed)
         {
-            device.GetDevice()->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, mDevice.GetCommandListManager().GetCurrentAllocator(), nullptr, IID_PPV_ARGS(&mCommandList));
+            // The allocator of the same type is needed only while creating. It is acquired again in Reset().
+            DX12CommandListManager& commandListManager = mDevice.GetCommandListManager();
+            ID3D12CommandAllocator* allocator = commandListManager.AcquireAllocator(mType);
+            CHECK_HR(device.GetDevice()->CreateCommandList(0, ConvertToDX12CommandListType(mType), allocator, nullptr, IID_PPV_ARGS(&mCommandList)));
             SET_DEBUG_NAME(mCommandList, info.debugName);
             CHECK_HR(mCommandList->Close());
+            commandListManager.ReleaseAllocator(mType, allocator);
         }
 
         DX12CommandList::~DX12CommandList()
@@ -57,7 +76,10 @@ namespace cube
             ArrayView<ID3D12DescriptorHeap*> heaps = mDevice.GetDescriptorManager().GetD3D12ShaderVisibleHeaps();
             mCommandList->SetDescriptorHeaps(heaps.size(), heaps.data());
 
-            mCommandList->SetGraphicsRootSignature(mDevice.GetShaderParameterHelper().GetRootSignature());
+            if (mType == CommandListType::Graphics)
+            {
+                mCommandList->SetGraphicsRootSignature(mDevice.GetShaderParameterHelper().GetRootSignature());
+            }
             mCommandList->SetComputeRootSignature(mDevice.GetShaderParameterHelper().GetRootSignature());
 
             mHasQuery = false;
@@ -82,6 +104,9 @@ namespace cube
 
             CHECK_HR(mCommandList->Close());
             mState = State::Closed;
+
+            mDevice.GetCommandListManager().ReleaseAllocator(mType, mAllocator);
+            mAllocator = nullptr;
         }
 
         void DX12CommandList::Reset()
@@ -93,7 +118,8 @@ namespace cube
 
             CHECK(mState == State::Closed);
 
-            CHECK_HR(mCommandList->Reset(mDevice.GetCommandListManager().GetCurrentAllocator(), nullptr));
+            mAllocator = mDevice.GetCommandListManager().AcquireAllocator(mType);
+            CHECK_HR(mCommandList->Reset(mAllocator, nullptr));
             mHasQuery = false;
             mState = State::Initial;
         }
@@ -176,6 +202,7 @@ namespace cube
         {
             CHECK(IsWriting());
             CHECK(!IsInRenderPass());
+            CHECK_FORMAT(mType == CommandListType::Graphics, "Render pass is not supported in the compute command list.");
 
             FrameVector<D3D12_CPU_DESCRIPTOR_HANDLE> rtvHandles(colors.size());
             for (int i = 0; i < colors.size(); ++i)
@@ -281,7 +308,10 @@ namespace cube
             // Register space index is used in Slang's ParameterBlock.
             DX12ShaderParameterHelper& shaderParameterHelper = mDevice.GetShaderParameterHelper();
             CHECK(index < shaderParameterHelper.GetMaxNumSpace());
-            mCommandList->SetGraphicsRootConstantBufferView(index * shaderParameterHelper.GetMaxNumRegister(), gpuAddress);
+            if (mType == CommandListType::Graphics)
+            {
+                mCommandList->SetGraphicsRootConstantBufferView(index * shaderParameterHelper.GetMaxNumRegister(), gpuAddress);
+            }
             mCommandList->SetComputeRootConstantBufferView(index * shaderParameterHelper.GetMaxNumRegister(), gpuAddress);
 
             CUBE_DX12_BOUND_OBJECT(constantBuffer);
@@ -333,9 +363,19 @@ namespace cube
 
             for (const TransitionState& state : states)
             {
+                D3D12_RESOURCE_BARRIER_FLAGS flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+                if (state.split == TransitionState::SplitType::Begin)
+                {
+                    flags = D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY;
+                }
+                else if (state.split == TransitionState::SplitType::End)
+                {
+                    flags = D3D12_RESOURCE_BARRIER_FLAG_END_ONLY;
+                }
+
                 D3D12_RESOURCE_BARRIER barrier = {
                     .Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION,
-                    .Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE,
+                    .Flags = flags,
                     .Transition = {
                         .StateBefore = ConvertToDX12ResourceStates(state.src),
                         .StateAfter = ConvertToDX12ResourceStates(state.dst) }
@@ -361,8 +401,29 @@ namespace cube
                 {
                     const DX12Texture* dx12Texture = dynamic_cast<DX12Texture*>(state.texture.get());
                     barrier.Transition.pResource = dx12Texture->GetResource();
-                    barrier.Transition.Subresource = state.subresourceIndex;
-                    barriers.push_back(barrier);
+                    if (!state.useSubresourceRange)
+                    {
+                        barrier.Transition.Subresource = state.subresourceIndex;
+                        barriers.push_back(barrier);
+                    }
+                    else if (state.subresourceRange.mipLevels == state.texture->GetMipLevels() && state.subresourceRange.sliceSize == state.texture->GetNumSlices())
+                    {
+                        barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+                        barriers.push_back(barrier);
+                    }
+                    else
+                    {
+                        // Transition barriers only take one subresource or all of them, so the partial range is expanded to each subresource.
+                        const SubresourceRange& range = state.subresourceRange;
+                        for (Uint32 sliceIndex = range.firstSliceIndex; sliceIndex < range.firstSliceIndex + range.sliceSize; ++sliceIndex)
+                        {
+                            for (Uint32 mipLevel = range.firstMipLevel; mipLevel < range.firstMipLevel + range.mipLevels; ++mipLevel)
+                            {
+                                barrier.Transition.Subresource = state.texture->GetSubresourceIndex(sliceIndex, mipLevel);
+                                barriers.push_back(barrier);
+                            }
+                        }
+                    }
 
                     CUBE_DX12_BOUND_OBJECT(state.texture);
                     break;
@@ -379,6 +440,58 @@ namespace cube
             }
         }
 
+        void DX12CommandList::AliasingBarrier(ArrayView<const AliasingState> states)
+        {
+            CHECK(IsWriting());
+
+            auto GetD3D12Resource = [this](const SharedPtr<Buffer>& buffer, const SharedPtr<Texture>& texture) -> ID3D12Resource*
+            {
+                if (buffer)
+                {
+                    CUBE_DX12_BOUND_OBJECT(buffer);
+                    return dynamic_cast<DX12Buffer*>(buffer.get())->GetResource();
+                }
+                if (texture)
+                {
+                    CUBE_DX12_BOUND_OBJECT(texture);
+                    return dynamic_cast<DX12Texture*>(texture.get())->GetResource();
+                }
+                return nullptr;
+            };
+
+            FrameVector<D3D12_RESOURCE_BARRIER> barriers;
+            barriers.reserve(states.size());
+
+            for (const AliasingState& state : states)
+            {
+                barriers.push_back({
+                    .Type = D3D12_RESOURCE_BARRIER_TYPE_ALIASING,
+                    .Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE,
+                    .Aliasing = {
+                        .pResourceBefore = GetD3D12Resource(state.bufferBefore, state.textureBefore),
+                        .pResourceAfter = GetD3D12Resource(state.bufferAfter, state.textureAfter) }
+                });
+            }
+
+            if (!barriers.empty())
+            {
+                mCommandList->ResourceBarrier(barriers.size(), barriers.data());
+            }
+        }
+
+        void DX12CommandList::DiscardResource(SharedPtr<Texture> texture)
+        {
+            CHECK(IsWriting());
+
+            const DX12Texture* dx12Texture = dynamic_cast<DX12Texture*>(texture.get());
+            CHECK(dx12Texture);
+
+            // Placed render targets / depth stencils have to be initialized after the aliasing barrier to reset their compression metadata.
+            mCommandList->DiscardResource(dx12Texture->GetResource(), nullptr);
+
+            CUBE_DX12_BOUND_OBJECT(texture);
+        }
+
         void DX12CommandList::SetComputePipeline(SharedPtr<ComputePipeline> computePipeline)
         {
             CHECK(IsWriting());
@@ -456,26 +569,37 @@ namespace cube
             mHasQuery = true;
         }
 
-        void DX12CommandList::Submit(bool waitUntilFinished)
+        void DX12CommandList::WaitQueue(CommandListType queueType, Uint64 fenceValue)
+        {
+            CHECK(mState == State::Closed);
+
+            mQueueWaits.push_back({ queueType, fenceValue });
+        }
+
+        Uint64 DX12CommandList::Submit(bool waitUntilFinished)
         {
             CHECK(mState == State::Closed);
 
+            DX12QueueManager& queueManager = mDevice.GetQueueManager();
+            for (const QueueWait& queueWait : mQueueWaits)
+            {
+                queueManager.WaitOnGPU(mType, queueWait.queueType, queueWait.fenceValue);
+            }
+            mQueueWaits.clear();
+
             ID3D12CommandList* cmdLists[] = { mCommandList.Get() };
-            mDevice.GetQueueManager().GetMainQueue()->ExecuteCommandLists(1, cmdLists);
+            queueManager.GetQueue(mType)->ExecuteCommandLists(1, cmdLists);
+            const DX12FenceValue fenceValue = queueManager.Signal(mType);
 
             mDevice.GetCommandListManager().AddBoundObjects(mBoundObjects);
             mBoundObjects.clear();
 
             if (waitUntilFinished)
             {
-                DX12Fence waitFence(mDevice);
-                waitFence.Initialize(CUBE_T("Wait Submit CommandList Fence"));
-
-                waitFence.Signal(mDevice.GetQueueManager().GetMainQueue(), 1);
-                waitFence.Wait(1);
-
-                waitFence.Shutdown();
+                queueManager.WaitOnCPU(mType, fenceValue);
             }
+
+            return fenceValue;
         }
 
         void DX12CommandList::ProcessBeforeEnd()
@@ -7,12 +7,8 @@ namespace cube
 {
     namespace gapi
     {
-        DX12Texture::DX12Texture(const TextureCreateInfo& createInfo, DX12Device& device)
-            : Texture(createInfo),
-            mDevice(device)
+        D3D12_RESOURCE_DESC DX12Texture::CreateD3D12ResourceDesc(const TextureInfo& info, ResourceUsage usage)
         {
-            const TextureInfo& info = createInfo.textureInfo;
-
             CHECK_FORMAT(info.width >= 1, "Texture width must be at least 1. (width: {0})", info.width);
             CHECK_FORMAT(info.mipLevels >= 1, "Texture mipLevels must be at least 1. (mipLevels: {0})", info.mipLevels);
 
@@ -88,7 +84,7 @@ namespace cube
                 flags |= D3D12_RESOURCE_FLAG_ALLOW_DEPTH_STENCIL;
             }
 
-            D3D12_RESOURCE_DESC desc = {
+            return {
                 .Dimension = dimension,
                 .Alignment = 0,
                 .Width = info.width,
@@ -100,9 +96,17 @@ namespace cube
                     .Count = 1,
                     .Quality = 0
                 },
-                .Layout = (mUsage == ResourceUsage::GPUOnly || mUsage == ResourceUsage::Transient) ? D3D12_TEXTURE_LAYOUT_UNKNOWN : D3D12_TEXTURE_LAYOUT_ROW_MAJOR,
+                .Layout = (usage == ResourceUsage::GPUOnly || usage == ResourceUsage::Transient) ? D3D12_TEXTURE_LAYOUT_UNKNOWN : D3D12_TEXTURE_LAYOUT_ROW_MAJOR,
                 .Flags = flags
             };
+        }
+
+        DX12Texture::DX12Texture(const TextureCreateInfo& createInfo, DX12Device& device)
+            : Texture(createInfo),
+            mDevice(device)
+        {
+            const TextureInfo& info = createInfo.textureInfo;
+            D3D12_RESOURCE_DESC desc = CreateD3D12ResourceDesc(info, mUsage);
 
             const Uint32 numSlices = GetNumSlices();
             const Uint32 numSubresources = numSlices * info.mipLevels;
@@ -130,7 +134,7 @@ namespace cube
                 break;
             }
             const bool isTransient = (mUsage == ResourceUsage::Transient);
-            mAllocation = device.GetMemoryAllocator().Allocate(heapType, desc, isTransient);
+            mAllocation = device.GetMemoryAllocator().Allocate(heapType, desc, isTransient, nullptr, createInfo.placedMemory);
             mResource = mAllocation.resource;
             SET_DEBUG_NAME(mAllocation.resource, createInfo.debugName);
         }
@@ -33,6 +33,8 @@ namespace cube
 
             void CopyToReadbackBuffer(ID3D12GraphicsCommandList* commandList);
 
+            static D3D12_RESOURCE_DESC CreateD3D12ResourceDesc(const BufferInfo& info);
+
         private:
             DX12Device& mDevice;
 
@@ -22,6 +22,8 @@ namespace cube
         class Sampler;
         class Texture;
 
+        D3D12_COMMAND_LIST_TYPE ConvertToDX12CommandListType(CommandListType type);
+
         class DX12CommandList : public CommandList, public DX12APIObject
         {
         public:
@@ -57,6 +59,8 @@ namespace cube
 
             void ResourceTransition(TransitionState state) override;
             void ResourceTransition(ArrayView<const TransitionState> states) override;
+            void AliasingBarrier(ArrayView<const AliasingState> states) override;
+            void DiscardResource(SharedPtr<Texture> texture) override;
 
             void SetComputePipeline(SharedPtr<ComputePipeline> computePipeline) override;
             virtual void DispatchThreads(Uint32 numThreadsX, Uint32 numThreadsY, Uint32 numThreadsZ) override;
@@ -66,7 +70,8 @@ namespace cube
             virtual void BeginTimestamp(StringView name) override;
             virtual void EndTimestamp() override;
 
-            void Submit(bool waitUntilFinished) override;
+            void WaitQueue(CommandListType queueType, Uint64 fenceValue) override;
+            Uint64 Submit(bool waitUntilFinished) override;
 
             bool IsWriting() const { return mState == State::Writing; }
             bool IsInRenderPass() const { return mIsInRenderPass; }
@@ -84,10 +89,19 @@ namespace cube
             DX12Device& mDevice;
 
             ComPtr<ID3D12GraphicsCommandList> mCommandList;
+            // Acquired in Reset() and released in End().
+            ID3D12CommandAllocator* mAllocator = nullptr;
             State mState;
 
             Vector<SharedPtr<DX12APIObject>> mBoundObjects;
 
+            struct QueueWait
+            {
+                CommandListType queueType;
+                Uint64 fenceValue;
+            };
+            Vector<QueueWait> mQueueWaits; // Applied in Submit()
+
             Uint32 mComputeThreadGroupSizeX;
             Uint32 mComputeThreadGroupSizeY;
             Uint32 mComputeThreadGroupSizeZ;
@@ -31,6 +31,8 @@ namespace cube
 
             ID3D12Resource* GetResource() const { return mResource; }
 
+            static D3D12_RESOURCE_DESC CreateD3D12ResourceDesc(const TextureInfo& info, ResourceUsage usage);
+
         protected:
             // From existing resource (ex: swapchain backbuffer)
             DX12Texture(const TextureCreateInfo& createInfo, ID3D12Resource* resource, DX12Device& device);
@@ -216,6 +216,27 @@ namespace cube
         return std::make_shared<gapi::MetalSwapChain>(*mMainDevice, mImGUIView, info);
     }
 
+    gapi::TransientAllocationInfo GAPI_Metal::GetTransientAllocationInfo(const gapi::BufferInfo& info)
+    {
+        MTLSizeAndAlign sizeAndAlign = [mMainDevice->GetMTLDevice() heapBufferSizeAndAlignWithLength:info.size options:MTLResourceStorageModePrivate];
+
+        return { .size = sizeAndAlign.size, .alignment = sizeAndAlign.align };
+    }
+
+    gapi::TransientAllocationInfo GAPI_Metal::GetTransientAllocationInfo(const gapi::TextureInfo& info)
+    { @autoreleasepool {
+        // Only used to create the texture descriptor.
+        gapi::MetalTexture texture({ .usage = gapi::ResourceUsage::Transient, .textureInfo = info }, *mMainDevice, true);
+        MTLSizeAndAlign sizeAndAlign = [mMainDevice->GetMTLDevice() heapTextureSizeAndAlignWithDescriptor:texture.CreateMTLTextureDescriptor()];
+
+        return { .size = sizeAndAlign.size, .alignment = sizeAndAlign.align };
+    }}
+
+    gapi::TransientMemory GAPI_Metal::AllocateTransientMemory(Uint64 size, Uint64 alignment)
+    {
+        return mMainDevice->GetTransientHeapManager().AllocatePlacementMemory(size, alignment);
+    }
+
     gapi::TimestampRangeList GAPI_Metal::GetLastTimestampRangeList()
     {
         return mMainDevice->GetTimestampManager().GetLastTimestampRangeList();
@@ -38,7 +38,15 @@ namespace cube
 
             if (info.usage == ResourceUsage::Transient)
             {
-                mBuffer = [device.GetTransientHeapManager().GetMTLHeap(MTLSizeAndAlign(mInfo.size, 0)) newBufferWithLength:mInfo.size options:mMTLResourceOptions];
+                if (info.placedMemory.IsValid())
+                {
+                    id<MTLHeap> placementHeap = (__bridge id<MTLHeap>)info.placedMemory.pHeap;
+                    mBuffer = [placementHeap newBufferWithLength:mInfo.size options:mMTLResourceOptions offset:info.placedMemory.offset];
+                }
+                else
+                {
+                    mBuffer = [device.GetTransientHeapManager().GetMTLHeap(MTLSizeAndAlign(mInfo.size, 0)) newBufferWithLength:mInfo.size options:mMTLResourceOptions];
+                }
             }
             else
             {
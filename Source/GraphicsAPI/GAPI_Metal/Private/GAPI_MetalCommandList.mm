@@ -172,7 +172,8 @@ namespace cube
         }
 
         MetalCommandList::MetalCommandList(const CommandListCreateInfo& info, MetalDevice& device)
-            : mTimestampManager(device.GetTimestampManager())
+            : CommandList(info)
+            , mTimestampManager(device.GetTimestampManager())
             , mIsWriting(false)
             , mRenderEncoder(nil)
             , mComputeEncoder(nil)
@@ -494,6 +495,18 @@ namespace cube
             // Metal automatically translate resource state.
         }
 
+        void MetalCommandList::AliasingBarrier(ArrayView<const AliasingState> states)
+        {
+            CHECK(IsWriting());
+            // Transient heaps use tracked hazard mode, so Metal automatically synchronizes aliased resources.
+        }
+
+        void MetalCommandList::DiscardResource(SharedPtr<Texture> texture)
+        {
+            CHECK(IsWriting());
+            // Metal does not need to initialize the aliased textures. The contents are defined by the load action.
+        }
+
         void MetalCommandList::SetComputePipeline(SharedPtr<ComputePipeline> computePipeline)
         {
             CHECK(IsWriting());
@@ -581,7 +594,13 @@ namespace cube
             }
         }
 
-        void MetalCommandList::Submit(bool waitUntilFinished)
+        void MetalCommandList::WaitQueue(CommandListType queueType, Uint64 fenceValue)
+        {
+            // Compute command lists are also committed to the main queue and executed in the submitted order,
+            // so there is nothing to wait.
+        }
+
+        Uint64 MetalCommandList::Submit(bool waitUntilFinished)
         {
             CHECK(!IsWriting());
 
@@ -591,6 +610,8 @@ namespace cube
                 [mCommandBuffer waitUntilCompleted];
             }
             mCommandBuffer = nil;
+
+            return 0;
         }
 
         void MetalCommandList::UseResourceInternal(id<MTLResource> resource, MTLResourceUsage usage)
@@ -96,38 +96,20 @@ namespace cube
                 return;
             }
 
-            MTLResourceOptions resourceOptions = MTLResourceStorageModeShared;
-            switch (mUsage)
-            {
-            case ResourceUsage::GPUOnly:
-            case ResourceUsage::CPUtoGPU:
-            case ResourceUsage::GPUtoCPU:
-                resourceOptions = MTLResourceStorageModeShared;
-                break;
-            case ResourceUsage::Transient:
-                resourceOptions = MTLResourceStorageModePrivate;
-                break;
-            default:
-                NOT_IMPLEMENTED();
-                break;
-            }
-
-            MTLTextureDescriptor* desc = [[MTLTextureDescriptor alloc] init];
-            desc.textureType = mMTLTextureType;
-            desc.pixelFormat = mMTLPixelFormat;
-            desc.width = info.width;
-            desc.height = info.height;
-            desc.depth = info.depth;
-            desc.mipmapLevelCount = info.mipLevels;
-            desc.arrayLength = info.arraySize; // arraySize is already in cube/array units
-            desc.resourceOptions = resourceOptions;
-            desc.usage = mMTLTextureUsage;
-            desc.allowGPUOptimizedContents = (mUsage != ResourceUsage::GPUtoCPU);
+            MTLTextureDescriptor* desc = CreateMTLTextureDescriptor();
 
             if (mUsage == ResourceUsage::Transient)
             {
-                MTLSizeAndAlign sizeAndAlign = [device.GetMTLDevice() heapTextureSizeAndAlignWithDescriptor:desc];
-                mMTLTexture = [device.GetTransientHeapManager().GetMTLHeap(sizeAndAlign) newTextureWithDescriptor:desc];
+                if (createInfo.placedMemory.IsValid())
+                {
+                    id<MTLHeap> placementHeap = (__bridge id<MTLHeap>)createInfo.placedMemory.pHeap;
+                    mMTLTexture = [placementHeap newTextureWithDescriptor:desc offset:createInfo.placedMemory.offset];
+                }
+                else
+                {
+                    MTLSizeAndAlign sizeAndAlign = [device.GetMTLDevice() heapTextureSizeAndAlignWithDescriptor:desc];
+                    mMTLTexture = [device.GetTransientHeapManager().GetMTLHeap(sizeAndAlign) newTextureWithDescriptor:desc];
+                }
             }
             else
             {
@@ -164,6 +146,39 @@ namespace cube
             mTotalSize = offset;
         }}
 
+        MTLTextureDescriptor* MetalTexture::CreateMTLTextureDescriptor() const
+        {
+            MTLResourceOptions resourceOptions = MTLResourceStorageModeShared;
+            switch (mUsage)
+            {
+            case ResourceUsage::GPUOnly:
+            case ResourceUsage::CPUtoGPU:
+            case ResourceUsage::GPUtoCPU:
+                resourceOptions = MTLResourceStorageModeShared;
+                break;
+            case ResourceUsage::Transient:
+                resourceOptions = MTLResourceStorageModePrivate;
+                break;
+            default:
+                NOT_IMPLEMENTED();
+                break;
+            }
+
+            MTLTextureDescriptor* desc = [[MTLTextureDescriptor alloc] init];
+            desc.textureType = mMTLTextureType;
+            desc.pixelFormat = mMTLPixelFormat;
+            desc.width = mInfo.width;
+            desc.height = mInfo.height;
+            desc.depth = mInfo.depth;
+            desc.mipmapLevelCount = mInfo.mipLevels;
+            desc.arrayLength = mInfo.arraySize; // arraySize is already in cube/array units
+            desc.resourceOptions = resourceOptions;
+            desc.usage = mMTLTextureUsage;
+            desc.allowGPUOptimizedContents = (mUsage != ResourceUsage::GPUtoCPU);
+
+            return desc;
+        }
+
         MetalTexture::~MetalTexture()
         {
             mMTLTexture = nil;
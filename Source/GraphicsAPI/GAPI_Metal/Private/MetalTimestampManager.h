@@ -2,6 +2,8 @@
 
 #include "MetalHeader.h"
 
+#include <mutex>
+
 #include "GAPI_Timestamp.h"
 
 namespace cube
@@ -33,6 +35,7 @@ namespace cube
         gapi::TimestampRangeList GetLastTimestampRangeList() const { return mLastTimestampRangeList; }
 
         id<MTLCounterSampleBuffer> GetCurrentCounterSampleBuffer() const { return mCounterSampleBuffers[mCurrentGPUSyncIndex]; }
+        // Thread-safe to record timestamps in multiple command lists in parallel.
         Uint32 GetCurrentLastSampleIndexAndUse(Uint32 numUseSample);
         void AddTimestampRange(StringView name, Uint32 beginSampleIndex, Uint32 endSampleIndex);
 
@@ -58,5 +61,7 @@ namespace cube
             Uint32 endSampleIndex;
         };
         Vector<Vector<MetalTimestampRange>> mTimestampRanges;
+
+        std::mutex mSampleMutex;
     };
 } // namespace cube
@@ -108,6 +108,8 @@ namespace cube
             return 0;
         }
 
+        std::unique_lock<std::mutex> lock(mSampleMutex);
+
         Uint32 res = mLastSampleIndices[mCurrentGPUSyncIndex];
 
         mLastSampleIndices[mCurrentGPUSyncIndex] += numUseSample;
@@ -123,6 +125,8 @@ namespace cube
             return;
         }
 
+        std::unique_lock<std::mutex> lock(mSampleMutex);
+
         mTimestampRanges[mCurrentGPUSyncIndex].push_back({
             .name = { name.begin(), name.end() },
             .beginSampleIndex = beginSampleIndex,
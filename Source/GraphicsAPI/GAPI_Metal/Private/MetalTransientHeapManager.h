@@ -2,6 +2,8 @@
 
 #include "MetalHeader.h"
 
+#include "GAPI_Resource.h"
+
 namespace cube
 {
     class MetalDevice;
@@ -22,6 +24,7 @@ namespace cube
         void MoveToNextIndex(Uint64 nextGPUFrame);
 
         id<MTLHeap> GetMTLHeap(MTLSizeAndAlign sizeAndAlign);
+        gapi::TransientMemory AllocatePlacementMemory(Uint64 size, Uint64 alignment);
 
     private:
         MetalDevice& mDevice;
@@ -39,5 +42,18 @@ namespace cube
         void ClearUnusedTransientHeaps();
 
         Vector<TransientHeap> mTransientHeaps;
+
+        // Placement heaps are used to alias transient resources in the same frame.
+        struct PlacementHeap
+        {
+            id<MTLHeap> mtlHeap;
+            Uint64 size;
+            Uint64 currentOffset;
+            Uint64 lastUsedGPUFrame;
+        };
+        PlacementHeap* CreateNewPlacementHeap(Uint64 size);
+        void ClearUnusedPlacementHeaps();
+
+        Vector<PlacementHeap> mPlacementHeaps;
     };
 } // namespace cube
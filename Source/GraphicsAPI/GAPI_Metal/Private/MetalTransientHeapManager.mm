@@ -32,6 +32,11 @@ namespace cube
             heap.mtlHeap = nil;
         }
         mTransientHeaps.clear();
+        for (PlacementHeap& heap : mPlacementHeaps)
+        {
+            heap.mtlHeap = nil;
+        }
+        mPlacementHeaps.clear();
     }
 
     void MetalTransientHeapManager::SetNumGPUSync(Uint32 newNumGPUSync)
@@ -43,6 +48,12 @@ namespace cube
     {
         mCurrentGPUFrame = nextGPUFrame;
         ClearUnusedTransientHeaps();
+        ClearUnusedPlacementHeaps();
+
+        for (PlacementHeap& heap : mPlacementHeaps)
+        {
+            heap.currentOffset = 0;
+        }
     }
 
     id<MTLHeap> MetalTransientHeapManager::GetMTLHeap(MTLSizeAndAlign sizeAndAlign)
@@ -66,6 +77,35 @@ namespace cube
         return selectedHeap->mtlHeap;
     }
 
+    gapi::TransientMemory MetalTransientHeapManager::AllocatePlacementMemory(Uint64 size, Uint64 alignment)
+    {
+        PlacementHeap* selectedHeap = nullptr;
+        Uint64 alignedOffset = 0;
+        for (PlacementHeap& heap : mPlacementHeaps)
+        {
+            alignedOffset = Align(heap.currentOffset, alignment);
+            if (alignedOffset + size <= heap.size)
+            {
+                selectedHeap = &heap;
+                break;
+            }
+        }
+        if (!selectedHeap)
+        {
+            selectedHeap = CreateNewPlacementHeap(Align(size, alignment));
+            alignedOffset = 0;
+        }
+
+        selectedHeap->currentOffset = alignedOffset + size;
+        selectedHeap->lastUsedGPUFrame = mCurrentGPUFrame;
+
+        return {
+            .pHeap = (__bridge void*)selectedHeap->mtlHeap,
+            .offset = alignedOffset,
+            .size = size
+        };
+    }
+
     MetalTransientHeapManager::TransientHeap* MetalTransientHeapManager::CreateNewHeap(Uint64 size)
     {
         const Uint64 newSize = std::max(size, DEFAULT_TRANSIENT_HEAP_SIZE);
@@ -87,6 +127,29 @@ namespace cube
         return &mTransientHeaps.back();
     }
 
+    MetalTransientHeapManager::PlacementHeap* MetalTransientHeapManager::CreateNewPlacementHeap(Uint64 size)
+    {
+        const Uint64 newSize = std::max(size, DEFAULT_TRANSIENT_HEAP_SIZE);
+
+        MTLHeapDescriptor* desc = [MTLHeapDescriptor new];
+        desc.type = MTLHeapTypePlacement;
+        desc.storageMode = MTLStorageModePrivate;
+        desc.size = newSize;
+        desc.hazardTrackingMode = MTLHazardTrackingModeTracked;
+
+        id<MTLHeap> newHeap = [mDevice.GetMTLDevice() newHeapWithDescriptor:desc];
+        CHECK(newHeap);
+
+        mPlacementHeaps.push_back({
+            .mtlHeap = newHeap,
+            .size = newSize,
+            .currentOffset = 0,
+            .lastUsedGPUFrame = mCurrentGPUFrame
+        });
+
+        return &mPlacementHeaps.back();
+    }
+
     void MetalTransientHeapManager::ClearUnusedTransientHeaps()
     {
         if (mCurrentGPUFrame < mNumGPUSync)
@@ -111,4 +174,25 @@ namespace cube
             }
         }
     }
+
+    void MetalTransientHeapManager::ClearUnusedPlacementHeaps()
+    {
+        if (mCurrentGPUFrame < mNumGPUSync)
+        {
+            return;
+        }
+
+        for (int i = static_cast<int>(mPlacementHeaps.size()) - 1; i >= 0; --i)
+        {
+            if (mPlacementHeaps[i].lastUsedGPUFrame <= mCurrentGPUFrame - mNumGPUSync)
+            {
+                const int lastIndex = static_cast<int>(mPlacementHeaps.size()) - 1;
+                if (lastIndex > i)
+                {
+                    mPlacementHeaps[i] = std::move(mPlacementHeaps[lastIndex]);
+                }
+                mPlacementHeaps.pop_back();
+            }
+        }
+    }
 } // namespace cube
@@ -51,6 +51,10 @@ namespace cube
         virtual SharedPtr<gapi::Texture> CreateTexture(const gapi::TextureCreateInfo& info) override;
         virtual SharedPtr<gapi::SwapChain> CreateSwapChain(const gapi::SwapChainCreateInfo& info) override;
 
+        virtual gapi::TransientAllocationInfo GetTransientAllocationInfo(const gapi::BufferInfo& info) override;
+        virtual gapi::TransientAllocationInfo GetTransientAllocationInfo(const gapi::TextureInfo& info) override;
+        virtual gapi::TransientMemory AllocateTransientMemory(Uint64 size, Uint64 alignment) override;
+
         virtual gapi::TimestampRangeList GetLastTimestampRangeList() override;
         virtual gapi::VRAMStatus GetVRAMUsage() override;
 
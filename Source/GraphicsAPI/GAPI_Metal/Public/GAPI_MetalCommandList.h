@@ -83,6 +83,8 @@ namespace cube
 
             virtual void ResourceTransition(TransitionState state) override;
             virtual void ResourceTransition(ArrayView<const TransitionState> states) override;
+            virtual void AliasingBarrier(ArrayView<const AliasingState> states) override;
+            virtual void DiscardResource(SharedPtr<Texture> texture) override;
 
             virtual void SetComputePipeline(SharedPtr<ComputePipeline> computePipeline) override;
             virtual void DispatchThreads(Uint32 numThreadsX, Uint32 numThreadsY, Uint32 numThreadsZ) override;
@@ -92,7 +94,8 @@ namespace cube
             virtual void BeginTimestamp(StringView name) override;
             virtual void EndTimestamp() override;
 
-            virtual void Submit(bool waitUntilFinished) override;
+            virtual void WaitQueue(CommandListType queueType, Uint64 fenceValue) override;
+            virtual Uint64 Submit(bool waitUntilFinished) override;
 
         private:
             void UseResourceInternal(id<MTLResource> resource, MTLResourceUsage usage);
@@ -29,6 +29,8 @@ namespace cube
             MTLTextureType GetMTLTextureType() const { return mMTLTextureType; }
             MTLTextureUsage GetMTLTextureUsage() const { return mMTLTextureUsage; }
 
+            MTLTextureDescriptor* CreateMTLTextureDescriptor() const;
+
         protected:
             MetalDevice& mDevice;
 
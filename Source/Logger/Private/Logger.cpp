@@ -3,6 +3,8 @@
 #include <chrono>
 #include <fmt/chrono.h>
 
+#include "MemoryTracker.h"
+
 namespace cube
 {
     IAllocator* Logger::mCurrentAllocator = nullptr;
@@ -16,11 +18,13 @@ namespace cube
     public:
         void* Allocate(SizeType n) override
         {
+            MemoryTracker::OnAllocate(MemoryTag::Logger, n);
             return malloc(n);
         }
 
         void Free(void* ptr, SizeType n) override
         {
+            MemoryTracker::OnFree(MemoryTag::Logger, n);
             free(ptr);
         }
     };
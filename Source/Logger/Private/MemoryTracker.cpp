@@ -0,0 +1,70 @@
+#include "MemoryTracker.h"
+
+#include <atomic>
+
+#include "Format.h"
+
+namespace cube
+{
+    namespace
+    {
+        struct MemoryTagCounters
+        {
+            std::atomic<Uint64> currentSize = 0;
+            std::atomic<Uint64> peakSize = 0;
+            std::atomic<Uint64> numAllocations = 0;
+            std::atomic<Uint64> numTotalAllocations = 0;
+        };
+        MemoryTagCounters gMemoryTagCounters[NUM_MEMORY_TAGS];
+    } // namespace
+
+    void MemoryTracker::OnAllocate(MemoryTag tag, Uint64 size)
+    {
+        MemoryTagCounters& counters = gMemoryTagCounters[static_cast<int>(tag)];
+
+        const Uint64 currentSize = counters.currentSize.fetch_add(size, std::memory_order_relaxed) + size;
+        counters.numAllocations.fetch_add(1, std::memory_order_relaxed);
+        counters.numTotalAllocations.fetch_add(1, std::memory_order_relaxed);
+
+        Uint64 peakSize = counters.peakSize.load(std::memory_order_relaxed);
+        while (currentSize > peakSize && !counters.peakSize.compare_exchange_weak(peakSize, currentSize, std::memory_order_relaxed))
+        {
+        }
+    }
+
+    void MemoryTracker::OnFree(MemoryTag tag, Uint64 size)
+    {
+        MemoryTagCounters& counters = gMemoryTagCounters[static_cast<int>(tag)];
+
+        counters.currentSize.fetch_sub(size, std::memory_order_relaxed);
+        counters.numAllocations.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    MemoryTagStats MemoryTracker::GetStats(MemoryTag tag)
+    {
+        const MemoryTagCounters& counters = gMemoryTagCounters[static_cast<int>(tag)];
+
+        return {
+            .currentSize = counters.currentSize.load(std::memory_order_relaxed),
+            .peakSize = counters.peakSize.load(std::memory_order_relaxed),
+            .numAllocations = counters.numAllocations.load(std::memory_order_relaxed),
+            .numTotalAllocations = counters.numTotalAllocations.load(std::memory_order_relaxed)
+        };
+    }
+
+    String MemoryTracker::GetReport()
+    {
+        String report = CUBE_T("Memory report (MiB)\n");
+        report += Format<String>(CUBE_T("{0:<16}{1:>12}{2:>12}{3:>12}{4:>14}\n"), "Tag", "Current", "Peak", "Allocations", "Total allocs");
+        for (int i = 0; i < NUM_MEMORY_TAGS; ++i)
+        {
+            const MemoryTag tag = static_cast<MemoryTag>(i);
+            const MemoryTagStats stats = GetStats(tag);
+            report += Format<String>(CUBE_T("{0:<16}{1:>12.2f}{2:>12.2f}{3:>12}{4:>14}\n"), MemoryTagToString(tag),
+                static_cast<double>(stats.currentSize) / (1024 * 1024), static_cast<double>(stats.peakSize) / (1024 * 1024),
+                stats.numAllocations, stats.numTotalAllocations);
+        }
+
+        return report;
+    }
+} // namespace cube
@@ -0,0 +1,202 @@
+#include "Name.h"
+
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
+
+#include "Checker.h"
+#include "FlatHashMap.h"
+
+namespace cube
+{
+    namespace
+    {
+        struct NameEntry
+        {
+            StringView str;
+            U8StringView u8Str;
+        };
+
+        struct NameKey
+        {
+            Uint64 hash;
+            StringView str;
+        };
+        struct NameKeyHash
+        {
+            SizeType operator()(const NameKey& key) const { return key.hash; }
+        };
+        struct NameKeyEqual
+        {
+            bool operator()(const NameKey& lhs, const NameKey& rhs) const { return lhs.hash == rhs.hash && lhs.str == rhs.str; }
+        };
+
+        // The lookup is split into the shards with the reader-writer locks, so the existing names are found concurrently.
+        // The entries are in the fixed-size chunks which are never moved, so an id is converted to the entry without a lock.
+        class NameTable
+        {
+        public:
+            NameTable() :
+                mNumNames(0),
+                mCurrentStringBlock(nullptr),
+                mCurrentStringBlockOffset(STRING_BLOCK_SIZE)
+            {
+                for (std::atomic<NameEntry*>& chunk : mChunks)
+                {
+                    chunk.store(nullptr, std::memory_order_relaxed);
+                }
+
+                // Id 0 is the empty string.
+                std::unique_lock<std::mutex> lock(mAddMutex);
+                AddEntry({});
+            }
+
+            Uint32 FindOrAdd(StringView str, Uint64 hash)
+            {
+                if (str.empty())
+                {
+                    return 0;
+                }
+
+                Shard& shard = mShards[hash % NUM_SHARDS];
+                const NameKey key = { .hash = hash, .str = str };
+                {
+                    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+                    if (auto findIt = shard.ids.find(key); findIt != shard.ids.end())
+                    {
+                        return findIt->second;
+                    }
+                }
+
+                std::unique_lock<std::shared_mutex> lock(shard.mutex);
+                // Added by another thread between the locks
+                if (auto findIt = shard.ids.find(key); findIt != shard.ids.end())
+                {
+                    return findIt->second;
+                }
+
+                std::unique_lock<std::mutex> addLock(mAddMutex);
+                const Uint32 id = AddEntry(str);
+                shard.ids.insert({ { .hash = hash, .str = GetEntry(id).str }, id });
+
+                return id;
+            }
+
+            const NameEntry& GetEntry(Uint32 id) const
+            {
+                const NameEntry* chunk = mChunks[id >> CHUNK_SIZE_LOG2].load(std::memory_order_acquire);
+                return chunk[id & (CHUNK_SIZE - 1)];
+            }
+
+            Uint32 GetNumNames() const
+            {
+                return mNumNames.load(std::memory_order_relaxed);
+            }
+
+        private:
+            static constexpr int NUM_SHARDS = 16;
+            static constexpr Uint32 CHUNK_SIZE_LOG2 = 12;
+            static constexpr Uint32 CHUNK_SIZE = 1 << CHUNK_SIZE_LOG2;
+            static constexpr Uint32 MAX_NUM_CHUNKS = 1024; // 4M names
+            static constexpr Uint64 STRING_BLOCK_SIZE = 64 * 1024;
+
+            // mAddMutex should be locked.
+            Uint32 AddEntry(StringView str)
+            {
+                const Uint32 id = mNumNames.load(std::memory_order_relaxed);
+                const Uint32 chunkIndex = id >> CHUNK_SIZE_LOG2;
+                CHECK_FORMAT(chunkIndex < MAX_NUM_CHUNKS, "Too many names. (Max: {0})", MAX_NUM_CHUNKS * CHUNK_SIZE);
+
+                NameEntry* chunk = mChunks[chunkIndex].load(std::memory_order_relaxed);
+                if (chunk == nullptr)
+                {
+                    chunk = new NameEntry[CHUNK_SIZE];
+                    mChunks[chunkIndex].store(chunk, std::memory_order_release);
+                }
+
+                const U8String u8Str = String_Convert<U8String>(str);
+                chunk[id & (CHUNK_SIZE - 1)] = {
+                    .str = StoreString(str),
+                    .u8Str = StoreString(U8StringView(u8Str))
+                };
+                mNumNames.store(id + 1, std::memory_order_relaxed);
+
+                return id;
+            }
+
+            // Copy the string with the null terminator into the string blocks.
+            template <typename Char>
+            std::basic_string_view<Char> StoreString(std::basic_string_view<Char> str)
+            {
+                const Uint64 size = (str.size() + 1) * sizeof(Char);
+                Uint8* dst = nullptr;
+                if (size > STRING_BLOCK_SIZE / 4)
+                {
+                    dst = new Uint8[size];
+                }
+                else
+                {
+                    mCurrentStringBlockOffset = (mCurrentStringBlockOffset + alignof(Char) - 1) & ~(alignof(Char) - 1);
+                    if (mCurrentStringBlockOffset + size > STRING_BLOCK_SIZE)
+                    {
+                        mCurrentStringBlock = new Uint8[STRING_BLOCK_SIZE];
+                        mCurrentStringBlockOffset = 0;
+                    }
+                    dst = mCurrentStringBlock + mCurrentStringBlockOffset;
+                    mCurrentStringBlockOffset += size;
+                }
+
+                Char* dstStr = reinterpret_cast<Char*>(dst);
+                // The empty string of the invalid name has no data.
+                if (!str.empty())
+                {
+                    memcpy(dstStr, str.data(), str.size() * sizeof(Char));
+                }
+                dstStr[str.size()] = 0;
+
+                return { dstStr, str.size() };
+            }
+
+            struct Shard
+            {
+                std::shared_mutex mutex;
+                FlatHashMap<NameKey, Uint32, NameKeyHash, NameKeyEqual> ids;
+            };
+            Shard mShards[NUM_SHARDS];
+
+            std::mutex mAddMutex;
+            std::atomic<NameEntry*> mChunks[MAX_NUM_CHUNKS];
+            std::atomic<Uint32> mNumNames;
+
+            Uint8* mCurrentStringBlock;
+            Uint64 mCurrentStringBlockOffset;
+        };
+
+        NameTable& GetNameTable()
+        {
+            // Never destroyed, so the names can be used in the static destruction.
+            static NameTable* table = new NameTable();
+            return *table;
+        }
+    } // namespace
+
+    StringView Name::ToString() const
+    {
+        return GetNameTable().GetEntry(mId).str;
+    }
+
+    U8StringView Name::ToU8String() const
+    {
+        return GetNameTable().GetEntry(mId).u8Str;
+    }
+
+    Uint32 Name::GetNumNames()
+    {
+        return GetNameTable().GetNumNames();
+    }
+
+    Uint32 Name::FindOrAdd(StringView str, Uint64 hash)
+    {
+        return GetNameTable().FindOrAdd(str, hash);
+    }
+} // namespace cube
@@ -43,7 +43,7 @@ namespace cube
 
             void deallocate(T* p, size_t n)
             {
-                Logger::mCurrentAllocator->Free(p, n);
+                Logger::mCurrentAllocator->Free(p, sizeof(T) * n);
             }
         };
 
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "LoggerHeader.h"
+
+#include "CubeString.h"
+#include "MemoryTag.h"
+
+namespace cube
+{
+    struct MemoryTagStats
+    {
+        Uint64 currentSize = 0;
+        Uint64 peakSize = 0;
+        Uint64 numAllocations = 0; // Currently alive
+        Uint64 numTotalAllocations = 0;
+    };
+
+    // Lock-free counters of the CPU memory by the memory tags.
+    // It is in the logger module because it is the lowest shared module, so all modules report to the same counters.
+    class MemoryTracker
+    {
+    public:
+        MemoryTracker() = delete;
+        ~MemoryTracker() = delete;
+
+        CUBE_LOGGER_EXPORT static void OnAllocate(MemoryTag tag, Uint64 size);
+        CUBE_LOGGER_EXPORT static void OnFree(MemoryTag tag, Uint64 size);
+
+        CUBE_LOGGER_EXPORT static MemoryTagStats GetStats(MemoryTag tag);
+
+        // Text report of all tags. (For the headless runs)
+        CUBE_LOGGER_EXPORT static String GetReport();
+    };
+} // namespace cube
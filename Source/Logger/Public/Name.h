@@ -0,0 +1,86 @@
+#pragma once
+
+#include "LoggerHeader.h"
+
+#include "CubeString.h"
+#include "Format.h"
+
+namespace cube
+{
+    // FNV-1a 64-bit of the code units. It is constexpr, so the hash of the literals is calculated in the compile time.
+    constexpr Uint64 CalculateNameHash(StringView str)
+    {
+        Uint64 h = 0xcbf29ce484222325ULL;
+        for (const Character c : str)
+        {
+            h ^= static_cast<Uint64>(c);
+            h *= 0x100000001b3ULL;
+        }
+        return h;
+    }
+
+    // Interned string. Same strings have the same 32-bit id, so the comparison and the hash are O(1).
+    // The strings are stored once in the global name table with both of the default string and UTF-8, and never released.
+    // The ids must be identical across the DLLs, so the name table lives in the logger module.
+    class Name
+    {
+    public:
+        Name() = default;
+        explicit Name(StringView str) :
+            Name(str, CalculateNameHash(str))
+        {}
+        // The hash should be CalculateNameHash(str). (CUBE_NAME calculates it in the compile time)
+        Name(StringView str, Uint64 hash) :
+            mId(FindOrAdd(str, hash))
+        {}
+
+        Uint32 GetId() const { return mId; }
+        // The empty string
+        bool IsNone() const { return mId == 0; }
+
+        // The strings are null-terminated.
+        CUBE_LOGGER_EXPORT StringView ToString() const;
+        CUBE_LOGGER_EXPORT U8StringView ToU8String() const;
+
+        bool operator==(const Name& rhs) const = default;
+        // Order of the ids, not the alphabetical order.
+        bool operator<(const Name& rhs) const { return mId < rhs.mId; }
+
+        CUBE_LOGGER_EXPORT static Uint32 GetNumNames();
+
+    private:
+        CUBE_LOGGER_EXPORT static Uint32 FindOrAdd(StringView str, Uint64 hash);
+
+        Uint32 mId = 0;
+    };
+
+    // Name of the literal. The hash is calculated in the compile time and the table is looked up only at the first call.
+#define CUBE_NAME(text) \
+    ([]() -> const cube::Name& \
+    { \
+        static const cube::Name name(CUBE_T(text), std::integral_constant<cube::Uint64, cube::CalculateNameHash(CUBE_T(text))>::value); \
+        return name; \
+    }())
+} // namespace cube
+
+template <>
+struct std::hash<cube::Name>
+{
+    std::size_t operator()(const cube::Name& name) const noexcept
+    {
+        return name.GetId();
+    }
+};
+
+namespace fmt
+{
+    template <typename Char>
+    struct formatter<cube::Name, Char> : cube::cube_formatter<Char>
+    {
+        template <typename FormatContext>
+        auto format(const cube::Name& name, FormatContext& ctx) const
+        {
+            return cube::cube_formatter<Char>::cube_format(ctx, CUBE_T("{0}"), name.ToString());
+        }
+    };
+} // namespace fmt
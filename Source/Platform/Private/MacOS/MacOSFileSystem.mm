@@ -296,6 +296,19 @@ namespace cube
             mCurrentOffset += bufferSize;
         }}
 
+        void MacOSFile::Truncate()
+        { @autoreleasepool {
+            NSError* error;
+            if (![mFileHandle truncateAtOffset:mCurrentOffset error:&error])
+            {
+                CHECK_FORMAT(false, "Failed to truncate the file. ({})", [[error localizedDescription] UTF8String]);
+            }
+            else
+            {
+                mSize = mCurrentOffset;
+            }
+        }}
+
         bool MacOSFileSystem::IsExist(const FilePath& path)
         { @autoreleasepool {
             return [[NSFileManager defaultManager] fileExistsAtPath:path.GetNativePath()];
@@ -3,7 +3,9 @@
 #include "MacOS/MacOSPlatform.h"
 
 #include <MacTypes.h>
+#include <malloc/malloc.h>
 #include <mach/mach.h>
+#include <sys/mman.h>
 #include <Carbon/Carbon.h>
 #include <unistd.h>
 
@@ -14,6 +16,7 @@
 #include "MacOS/MacOSLoggerSubprocess.h"
 #include "MacOS/MacOSString.h"
 #include "MacOS/MacOSUtility.h"
+#include "MemoryTracker.h"
 
 namespace cube
 {
@@ -467,13 +470,22 @@ namespace cube
             });
         }
 
-        void* MacOSPlatform::Allocate(Uint64 size)
+        void* MacOSPlatform::Allocate(Uint64 size, MemoryTag tag)
         {
-            return malloc(size);
+            void* ptr = malloc(size);
+            if (ptr)
+            {
+                MemoryTracker::OnAllocate(tag, malloc_size(ptr));
+            }
+            return ptr;
         }
 
-        void MacOSPlatform::Free(void* ptr)
+        void MacOSPlatform::Free(void* ptr, MemoryTag tag)
         {
+            if (ptr)
+            {
+                MemoryTracker::OnFree(tag, malloc_size(ptr));
+            }
             free(ptr);
         }
 
@@ -487,6 +499,17 @@ namespace cube
             free(ptr);
         }
 
+        void* MacOSPlatform::AllocateVirtualMemory(Uint64 size)
+        {
+            void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            return ptr != MAP_FAILED ? ptr : nullptr;
+        }
+
+        void MacOSPlatform::FreeVirtualMemory(void* ptr, Uint64 size)
+        {
+            munmap(ptr, size);
+        }
+
         void MacOSPlatform::SetEngineInitializeFunction(std::function<void()> function)
         {
             mEngineInitializeFunction = function;
@@ -235,6 +235,12 @@ namespace cube
             CHECK_FORMAT(res, "Failed to write the file. (ErrorCode: {0})", GetLastError());
         }
 
+        void WindowsFile::Truncate()
+        {
+            BOOL res = SetEndOfFile(mFileHandle);
+            CHECK_FORMAT(res, "Failed to truncate the file. (ErrorCode: {0})", GetLastError());
+        }
+
         bool WindowsFileSystem::IsExist(const FilePath& path)
         {
             DWORD res = GetFileAttributes(path.GetNativePath().data());
@@ -6,6 +6,7 @@
 #include <iostream>
 
 #include "Checker.h"
+#include "MemoryTracker.h"
 #include "Windows/WindowsDebug.h"
 #include "Windows/WindowsDLib.h"
 
@@ -123,13 +124,22 @@ namespace cube
             }
         }
 
-        void* WindowsPlatform::Allocate(Uint64 size)
+        void* WindowsPlatform::Allocate(Uint64 size, MemoryTag tag)
         {
-            return malloc(size);
+            void* ptr = malloc(size);
+            if (ptr)
+            {
+                MemoryTracker::OnAllocate(tag, _msize(ptr));
+            }
+            return ptr;
         }
 
-        void WindowsPlatform::Free(void* ptr)
+        void WindowsPlatform::Free(void* ptr, MemoryTag tag)
         {
+            if (ptr)
+            {
+                MemoryTracker::OnFree(tag, _msize(ptr));
+            }
             free(ptr);
         }
 
@@ -143,6 +153,16 @@ namespace cube
             _aligned_free(ptr);
         }
 
+        void* WindowsPlatform::AllocateVirtualMemory(Uint64 size)
+        {
+            return VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+        }
+
+        void WindowsPlatform::FreeVirtualMemory(void* ptr, Uint64 size)
+        {
+            VirtualFree(ptr, 0, MEM_RELEASE);
+        }
+
         void WindowsPlatform::SetEngineInitializeFunction(std::function<void()> function)
         {
             // Do nothing. Windows run loop in main thread.
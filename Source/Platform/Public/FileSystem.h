@@ -59,6 +59,8 @@ namespace cube
 
             Uint64 Read(void* pReadBuffer, Uint64 bufferSizeToRead) { NOT_IMPLEMENTED() return 0; }
             void Write(void* pWriteBuffer, Uint64 bufferSize) { NOT_IMPLEMENTED() }
+            // Remove the contents after the file pointer.
+            void Truncate() { NOT_IMPLEMENTED() }
 
         protected:
             friend class BaseFileSystem;
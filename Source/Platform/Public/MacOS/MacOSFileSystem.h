@@ -74,6 +74,7 @@ namespace cube
 
             Uint64 Read(void* pReadBuffer, Uint64 bufferSizeToRead);
             void Write(void* pWriteBuffer, Uint64 bufferSize);
+            void Truncate();
             // === Base member functions ===
 
 #ifdef __OBJC__
@@ -48,10 +48,12 @@ namespace cube
             static void ShowWindow();
             static void ChangeWindowTitle(StringView title);
 
-            static void* Allocate(Uint64 size);
-            static void Free(void* ptr);
+            static void* Allocate(Uint64 size, MemoryTag tag = MemoryTag::Untagged);
+            static void Free(void* ptr, MemoryTag tag = MemoryTag::Untagged);
             static void* AllocateAligned(Uint64 size, Uint64 alignment);
             static void FreeAligned(void* ptr);
+            static void* AllocateVirtualMemory(Uint64 size);
+            static void FreeVirtualMemory(void* ptr, Uint64 size);
 
             static void SetEngineInitializeFunction(std::function<void()> function);
             static void SetEngineShutdownFunction(std::function<void()> function);
@@ -7,6 +7,7 @@
 #include "Event.h"
 #include "FileSystem.h"
 #include "KeyCode.h"
+#include "MemoryTag.h"
 #include "Mouse.h"
 
 namespace cube
@@ -28,10 +29,14 @@ namespace cube
             static void ShowWindow() { NOT_IMPLEMENTED() }
             static void ChangeWindowTitle(StringView title) { NOT_IMPLEMENTED() }
 
-            static void* Allocate(Uint64 size) { NOT_IMPLEMENTED() return nullptr; }
-            static void Free(void* ptr) { NOT_IMPLEMENTED() }
+            // The allocation is counted to the tag in MemoryTracker. Free it with the same tag.
+            static void* Allocate(Uint64 size, MemoryTag tag = MemoryTag::Untagged) { NOT_IMPLEMENTED() return nullptr; }
+            static void Free(void* ptr, MemoryTag tag = MemoryTag::Untagged) { NOT_IMPLEMENTED() }
             static void* AllocateAligned(Uint64 size, Uint64 alignment) { NOT_IMPLEMENTED() return nullptr; }
             static void FreeAligned(void* ptr) { NOT_IMPLEMENTED() }
+            // Reserve and commit the pages directly from the OS. (For the large memory regions)
+            static void* AllocateVirtualMemory(Uint64 size) { NOT_IMPLEMENTED() return nullptr; }
+            static void FreeVirtualMemory(void* ptr, Uint64 size) { NOT_IMPLEMENTED() }
 
             static void SetEngineInitializeFunction(std::function<void()> function) { NOT_IMPLEMENTED() }
             static void SetEngineShutdownFunction(std::function<void()> function) { NOT_IMPLEMENTED() }
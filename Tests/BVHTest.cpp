@@ -0,0 +1,239 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+
+#include "BVH.h"
+#include "BoundingVolumeTestHelper.h"
+#include "CubeMath.h"
+#include "JobSystem.h"
+#include "MatrixUtility.h"
+
+using namespace cube;
+
+static Vector<AABB> MakeRandomBoxes(int numBoxes, float range, Uint32 seed)
+{
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> centerDist(-range, range);
+    std::uniform_real_distribution<float> extentDist(0.1f, 5.0f);
+
+    Vector<AABB> boxes;
+    boxes.reserve(numBoxes);
+    for (int i = 0; i < numBoxes; ++i)
+    {
+        boxes.push_back(MakeBox({ centerDist(random), centerDist(random), centerDist(random) }, { extentDist(random), extentDist(random), extentDist(random) }));
+    }
+    return boxes;
+}
+
+static Vector<Uint32> QueryFrustumSorted(const BVH& bvh, const Frustum& frustum)
+{
+    Vector<Uint32> ids;
+    bvh.QueryFrustum(frustum, ids);
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+static Vector<Uint32> BruteForceFrustum(const Vector<AABB>& boxes, const Frustum& frustum)
+{
+    Vector<Uint32> ids;
+    for (Uint32 i = 0; i < boxes.size(); ++i)
+    {
+        if (frustum.Intersects(boxes[i]))
+        {
+            ids.push_back(i);
+        }
+    }
+    return ids;
+}
+
+// ===== Build / Query =====
+
+TEST(BVHTest, Empty)
+{
+    BVH bvh;
+    bvh.Build({});
+    EXPECT_EQ(bvh.GetNumItems(), 0u);
+    EXPECT_FALSE(bvh.GetBounds().IsValid());
+
+    Vector<Uint32> ids;
+    EXPECT_EQ(bvh.QueryFrustum(MakeTestFrustum(), ids), 0u);
+    EXPECT_TRUE(ids.empty());
+
+    BVH::RayHit hit;
+    EXPECT_FALSE(bvh.Raycast({ .origin = { 0.0f, 0.0f, 0.0f }, .direction = { 0.0f, 0.0f, -1.0f } }, hit));
+}
+
+TEST(BVHTest, BuildSkipsInvalidBounds)
+{
+    Vector<AABB> boxes = MakeRandomBoxes(100, 100.0f, 1);
+    boxes[10] = AABB();
+    boxes[50] = AABB();
+
+    BVH bvh;
+    bvh.Build(boxes);
+    EXPECT_EQ(bvh.GetNumItems(), 98u);
+    EXPECT_EQ(bvh.GetNumNodes(), 2 * 98u - 1);
+    EXPECT_FALSE(bvh.Contains(10));
+    EXPECT_FALSE(bvh.Contains(50));
+    EXPECT_TRUE(bvh.Contains(11));
+
+    AABB allBounds;
+    for (const AABB& box : boxes)
+    {
+        allBounds.Merge(box);
+    }
+    EXPECT_EQ(bvh.GetBounds().min, allBounds.min);
+    EXPECT_EQ(bvh.GetBounds().max, allBounds.max);
+}
+
+TEST(BVHTest, QueryFrustumMatchesBruteForce)
+{
+    Vector<AABB> boxes = MakeRandomBoxes(5000, 300.0f, 1234);
+    // Same positions
+    for (int i = 0; i < 100; ++i)
+    {
+        boxes.push_back(MakeBox({ 0.0f, 0.0f, -50.0f }, { 1.0f, 1.0f, 1.0f }));
+    }
+
+    BVH bvh;
+    bvh.Build(boxes);
+
+    const Frustum frustum = MakeTestFrustum();
+    const Vector<Uint32> expected = BruteForceFrustum(boxes, frustum);
+    EXPECT_GT(expected.size(), 0u);
+    EXPECT_EQ(QueryFrustumSorted(bvh, frustum), expected);
+
+    // Rotated camera
+    Matrix view = MatrixUtility::GetLookAt(Vector3(10.0f, 20.0f, 30.0f), Vector3(200.0f, -10.0f, 0.0f), Vector3(0.0f, 1.0f, 0.0f));
+    Matrix projection = MatrixUtility::GetPerspectiveFov(Math::Deg2Rad(45.0f), 1.0f, 200.0f, 0.1f);
+    const Frustum rotatedFrustum = Frustum::FromViewProjection(view * projection);
+    EXPECT_EQ(QueryFrustumSorted(bvh, rotatedFrustum), BruteForceFrustum(boxes, rotatedFrustum));
+}
+
+TEST(BVHTest, QueryFrustumAcceptsInsideSubtrees)
+{
+    // All boxes are in front of the camera.
+    Vector<AABB> boxes;
+    for (int i = 0; i < 1024; ++i)
+    {
+        boxes.push_back(MakeBox({ (i % 32) * 0.1f - 1.6f, (i / 32) * 0.1f - 1.6f, -50.0f }, { 0.01f, 0.01f, 0.01f }));
+    }
+
+    BVH bvh;
+    bvh.Build(boxes);
+
+    Vector<Uint32> ids;
+    const Uint64 numTestedNodes = bvh.QueryFrustum(MakeTestFrustum(), ids);
+    EXPECT_EQ(ids.size(), boxes.size());
+    // Only the root is tested.
+    EXPECT_EQ(numTestedNodes, 1u);
+}
+
+TEST(BVHTest, RayQueries)
+{
+    const Vector<AABB> boxes = MakeRandomBoxes(3000, 100.0f, 42);
+    BVH bvh;
+    bvh.Build(boxes);
+
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    for (int i = 0; i < 200; ++i)
+    {
+        const Ray ray = {
+            .origin = { dist(random) * 150.0f, dist(random) * 150.0f, dist(random) * 150.0f },
+            .direction = { dist(random), dist(random), dist(random) },
+            .maxDistance = i % 2 == 0 ? FLT_MAX : 100.0f
+        };
+
+        Vector<Uint32> expectedIds;
+        BVH::RayHit expectedHit;
+        for (Uint32 id = 0; id < boxes.size(); ++id)
+        {
+            float distance;
+            if (boxes[id].IntersectsRay(ray, distance))
+            {
+                expectedIds.push_back(id);
+                if (distance < expectedHit.distance)
+                {
+                    expectedHit = { .itemId = id, .distance = distance };
+                }
+            }
+        }
+
+        Vector<Uint32> ids;
+        bvh.QueryRay(ray, ids);
+        std::sort(ids.begin(), ids.end());
+        EXPECT_EQ(ids, expectedIds) << "ray=" << i;
+
+        BVH::RayHit hit;
+        const bool isHit = bvh.Raycast(ray, hit);
+        EXPECT_EQ(isHit, !expectedIds.empty()) << "ray=" << i;
+        if (isHit)
+        {
+            EXPECT_FLOAT_EQ(hit.distance, expectedHit.distance) << "ray=" << i;
+        }
+    }
+}
+
+TEST(BVHTest, ParallelBuild)
+{
+    const Vector<AABB> boxes = MakeRandomBoxes(50000, 1000.0f, 99);
+
+    BVH serialBVH;
+    serialBVH.Build(boxes);
+
+    for (bool useFibers : { false, true })
+    {
+        JobSystem jobSystem;
+        jobSystem.Initialize({ .numWorkerThreads = 4, .useFibers = useFibers });
+
+        BVH parallelBVH;
+        parallelBVH.Build(boxes, &jobSystem);
+        EXPECT_EQ(parallelBVH.GetNumNodes(), serialBVH.GetNumNodes());
+        EXPECT_FLOAT_EQ(parallelBVH.GetSAHCost(), serialBVH.GetSAHCost());
+
+        const Frustum frustum = MakeTestFrustum();
+        EXPECT_EQ(QueryFrustumSorted(parallelBVH, frustum), BruteForceFrustum(boxes, frustum));
+
+        jobSystem.Shutdown();
+    }
+}
+
+// ===== Insert / Refit =====
+
+TEST(BVHTest, InsertAndRefit)
+{
+    Vector<AABB> boxes = MakeRandomBoxes(2000, 300.0f, 5);
+
+    BVH bvh;
+    for (Uint32 i = 0; i < boxes.size(); ++i)
+    {
+        bvh.Insert(i, boxes[i]);
+    }
+    EXPECT_EQ(bvh.GetNumItems(), boxes.size());
+    EXPECT_EQ(bvh.GetNumNodes(), 2 * boxes.size() - 1);
+
+    const Frustum frustum = MakeTestFrustum();
+    EXPECT_EQ(QueryFrustumSorted(bvh, frustum), BruteForceFrustum(boxes, frustum));
+
+    // Move some of the boxes into / out of the frustum.
+    std::mt19937 random(11);
+    std::uniform_real_distribution<float> dist(-300.0f, 300.0f);
+    for (Uint32 i = 0; i < boxes.size(); i += 7)
+    {
+        boxes[i] = MakeBox({ dist(random) * 0.1f, dist(random) * 0.1f, -std::abs(dist(random)) }, { 1.0f, 1.0f, 1.0f });
+        bvh.UpdateItem(i, boxes[i]);
+    }
+    bvh.Refit();
+    EXPECT_EQ(QueryFrustumSorted(bvh, frustum), BruteForceFrustum(boxes, frustum));
+
+    // Inserting after the build
+    BVH builtBVH;
+    builtBVH.Build(ArrayView<const AABB>(boxes).subspan(0, 1000));
+    for (Uint32 i = 1000; i < boxes.size(); ++i)
+    {
+        builtBVH.Insert(i, boxes[i]);
+    }
+    EXPECT_EQ(QueryFrustumSorted(builtBVH, frustum), BruteForceFrustum(boxes, frustum));
+}
@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+#include "BVH.h"
+#include "BoundingVolumeTestHelper.h"
+#include "JobSystem.h"
+
+using namespace cube;
+
+static Vector<AABB> MakeRandomBoxes(int numBoxes, float range, Uint32 seed)
+{
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> centerDist(-range, range);
+    std::uniform_real_distribution<float> extentDist(0.1f, 5.0f);
+
+    Vector<AABB> boxes;
+    boxes.reserve(numBoxes);
+    for (int i = 0; i < numBoxes; ++i)
+    {
+        boxes.push_back(MakeBox({ centerDist(random), centerDist(random), centerDist(random) }, { extentDist(random), extentDist(random), extentDist(random) }));
+    }
+    return boxes;
+}
+
+TEST(BVHBenchmark, BuildAndQuery)
+{
+    using Clock = std::chrono::steady_clock;
+    constexpr int numRounds = 20;
+
+    const Frustum frustum = MakeTestFrustum();
+
+    JobSystem jobSystem;
+    jobSystem.Initialize({});
+
+    for (int numBoxes : { 10000, 100000 })
+    {
+        // Same density, so more boxes mean a larger scene.
+        const Vector<AABB> boxes = MakeRandomBoxes(numBoxes, 50.0f * std::cbrt(static_cast<float>(numBoxes)), 1234);
+
+        auto start = Clock::now();
+        BVH bvh;
+        bvh.Build(boxes);
+        const double serialBuildTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        start = Clock::now();
+        bvh.Build(boxes, &jobSystem);
+        const double parallelBuildTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        AABBBatch batch;
+        batch.Reserve(numBoxes);
+        for (const AABB& box : boxes)
+        {
+            batch.Add(box);
+        }
+        Vector<Uint8> isVisible(numBoxes);
+        Uint64 flatVisible = 0;
+        start = Clock::now();
+        for (int round = 0; round < numRounds; ++round)
+        {
+            flatVisible += frustum.CullAABBs(batch, isVisible);
+        }
+        const double flatTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / numRounds;
+
+        Vector<Uint32> ids;
+        ids.reserve(numBoxes);
+        Uint64 bvhVisible = 0;
+        Uint64 numTestedNodes = 0;
+        start = Clock::now();
+        for (int round = 0; round < numRounds; ++round)
+        {
+            ids.clear();
+            numTestedNodes += bvh.QueryFrustum(frustum, ids);
+            bvhVisible += ids.size();
+        }
+        const double bvhTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / numRounds;
+        EXPECT_EQ(bvhVisible, flatVisible);
+
+        constexpr int numRays = 10000;
+        std::mt19937 random(7);
+        std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+        Uint64 numHits = 0;
+        start = Clock::now();
+        for (int i = 0; i < numRays; ++i)
+        {
+            BVH::RayHit hit;
+            numHits += bvh.Raycast({ .origin = { 0.0f, 0.0f, 0.0f }, .direction = { dist(random), dist(random), dist(random) } }, hit) ? 1 : 0;
+        }
+        const double rayTime = std::chrono::duration<double, std::micro>(Clock::now() - start).count() / numRays;
+
+        std::cout << numBoxes << " boxes: build " << serialBuildTime << " ms / parallel " << parallelBuildTime << " ms (SAH cost: " << bvh.GetSAHCost() << ")" << std::endl;
+        std::cout << "    frustum: flat " << flatTime << " ms / BVH " << bvhTime << " ms (Visible: " << bvhVisible / numRounds << ", Tested nodes: " << numTestedNodes / numRounds << ")" << std::endl;
+        std::cout << "    raycast: " << rayTime << " us (Hits: " << numHits << " / " << numRays << ")" << std::endl;
+    }
+
+    jobSystem.Shutdown();
+}
@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+
+#include "BoundingVolume.h"
+#include "BoundingVolumeTestHelper.h"
+
+using namespace cube;
+
+TEST(BoundingVolumeBenchmark, CullAABBs)
+{
+    using Clock = std::chrono::steady_clock;
+    constexpr int numBoxes = 100000;
+    constexpr int numRounds = 100;
+
+    Frustum frustum = MakeTestFrustum();
+
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> centerDist(-500.0f, 500.0f);
+    std::uniform_real_distribution<float> extentDist(0.1f, 5.0f);
+
+    Vector<AABB> boxes;
+    AABBBatch batch;
+    batch.Reserve(numBoxes);
+    for (int i = 0; i < numBoxes; ++i)
+    {
+        AABB box = MakeBox({ centerDist(random), centerDist(random), centerDist(random) }, { extentDist(random), extentDist(random), extentDist(random) });
+        boxes.push_back(box);
+        batch.Add(box);
+    }
+    Vector<Uint8> isVisible(numBoxes);
+
+    // One box at a time vs the batched SIMD test
+    Uint64 scalarVisible = 0;
+    auto start = Clock::now();
+    for (int round = 0; round < numRounds; ++round)
+    {
+        for (int i = 0; i < numBoxes; ++i)
+        {
+            isVisible[i] = frustum.Intersects(boxes[i]) ? 1 : 0;
+            scalarVisible += isVisible[i];
+        }
+    }
+    const double scalarTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / numRounds;
+
+    Uint64 batchVisible = 0;
+    start = Clock::now();
+    for (int round = 0; round < numRounds; ++round)
+    {
+        batchVisible += frustum.CullAABBs(batch, isVisible);
+    }
+    const double batchTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count() / numRounds;
+
+    EXPECT_EQ(scalarVisible, batchVisible);
+    std::cout << numBoxes << " boxes: scalar " << scalarTime << " ms / batched " << batchTime << " ms (Visible: " << batchVisible / numRounds << ")" << std::endl;
+}
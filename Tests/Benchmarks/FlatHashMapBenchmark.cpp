@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+
+#include "FlatHashMap.h"
+
+using namespace cube;
+
+TEST(FlatHashMapBenchmark, InsertLookupClear)
+{
+    using Clock = std::chrono::steady_clock;
+    constexpr int numKeys = 2000;
+    constexpr int numRounds = 200;
+
+    Vector<Uint64> keys(numKeys);
+    Vector<Uint64> missingKeys(numKeys);
+    std::mt19937_64 random(1234);
+    for (int i = 0; i < numKeys; ++i)
+    {
+        keys[i] = random();
+        missingKeys[i] = random();
+    }
+
+    // Insert the keys, look up the existing and the missing keys, and clear. (Same as the caches reset every frame)
+    auto measure = [&](auto& map, const char* name)
+    {
+        double insertTime = 0.0;
+        double lookupTime = 0.0;
+        double missTime = 0.0;
+        double clearTime = 0.0;
+        Uint64 sum = 0;
+        for (int round = 0; round < numRounds; ++round)
+        {
+            auto start = Clock::now();
+            for (int i = 0; i < numKeys; ++i)
+            {
+                map.insert({ keys[i], i });
+            }
+            auto end = Clock::now();
+            insertTime += std::chrono::duration<double, std::milli>(end - start).count();
+
+            start = Clock::now();
+            for (Uint64 key : keys)
+            {
+                sum += map.find(key)->second;
+            }
+            end = Clock::now();
+            lookupTime += std::chrono::duration<double, std::milli>(end - start).count();
+
+            start = Clock::now();
+            for (Uint64 key : missingKeys)
+            {
+                sum += map.find(key) == map.end() ? 1 : 0;
+            }
+            end = Clock::now();
+            missTime += std::chrono::duration<double, std::milli>(end - start).count();
+
+            start = Clock::now();
+            map.clear();
+            end = Clock::now();
+            clearTime += std::chrono::duration<double, std::milli>(end - start).count();
+        }
+
+        std::cout << name << ": insert " << insertTime << " ms / lookup " << lookupTime << " ms / miss " << missTime << " ms / clear " << clearTime << " ms (" << sum << ")" << std::endl;
+    };
+
+    FlatHashMap<Uint64, Uint64> flatHashMap;
+    HashMap<Uint64, Uint64> hashMap;
+    Map<Uint64, Uint64> map;
+    measure(flatHashMap, "FlatHashMap");
+    measure(hashMap, "HashMap");
+    measure(map, "Map");
+}
@@ -0,0 +1,57 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <thread>
+
+#include "JobSystem.h"
+
+using namespace cube;
+
+TEST(JobSystemBenchmark, ParallelForScaling)
+{
+    using Clock = std::chrono::steady_clock;
+    constexpr Uint64 numItems = 1 << 20;
+    constexpr int numRounds = 5;
+
+    Vector<float> values(numItems);
+    auto measure = [&](Uint32 numThreads)
+    {
+        JobSystem jobSystem;
+        jobSystem.Initialize({ .numWorkerThreads = std::max(numThreads, 1u) - 1 });
+
+        double bestTime = 0.0;
+        for (int round = 0; round < numRounds; ++round)
+        {
+            const auto start = Clock::now();
+            jobSystem.ParallelFor(0, numItems, 1024, [&values](Uint64 i)
+            {
+                float v = static_cast<float>(i);
+                for (int j = 0; j < 32; ++j)
+                {
+                    v = std::sqrt(v * v + 1.0f);
+                }
+                values[i] = v;
+            });
+            const double time = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+            bestTime = round == 0 ? time : std::min(bestTime, time);
+        }
+        jobSystem.Shutdown();
+        return bestTime;
+    };
+
+    const Uint32 numCores = std::max(std::thread::hardware_concurrency(), 1u);
+    Vector<Uint32> threadCounts = { 1, 2, 4, 8 };
+    if (numCores != 1 && numCores != 2 && numCores != 4 && numCores != 8)
+    {
+        threadCounts.push_back(numCores);
+    }
+
+    const double baseTime = measure(1);
+    for (Uint32 numThreads : threadCounts)
+    {
+        const double time = numThreads == 1 ? baseTime : measure(numThreads);
+        std::cout << "ParallelFor with " << numThreads << " threads: " << time << " ms (x" << baseTime / time << ")" << std::endl;
+    }
+}
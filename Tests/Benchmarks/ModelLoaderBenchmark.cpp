@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <thread>
+
+#include "Allocator/FrameAllocator.h"
+#include "JobSystem.h"
+#include "Logger.h"
+#include "Systems/ModelLoaderSystem.h"
+
+using namespace cube;
+
+// Load the glTF model with 1, 2, 4, ... threads and all cores without the engine and the window. The GPU resources are not created.
+// It needs a model, so it is disabled. Run with --gtest_also_run_disabled_tests and CUBE_BENCHMARK_GLTF_PATH=<Path of the .gltf / .glb>.
+TEST(ModelLoaderBenchmark, DISABLED_LoadGLTF)
+{
+    const char* path = std::getenv("CUBE_BENCHMARK_GLTF_PATH");
+    if (path == nullptr)
+    {
+        GTEST_SKIP() << "CUBE_BENCHMARK_GLTF_PATH is not set.";
+    }
+
+    Logger::Init(nullptr);
+    GetMyThreadFrameAllocator().Initialize("Benchmark frame allocator");
+
+    const ModelPathInfo pathInfo = {
+        .type = ModelType::glTF,
+        .name = path,
+        .path = platform::FilePath(AnsiStringView(path))
+    };
+
+    using Clock = std::chrono::steady_clock;
+    constexpr int numRounds = 3;
+
+    const Uint32 numCores = std::max(std::thread::hardware_concurrency(), 1u);
+    Vector<Uint32> threadCounts;
+    for (Uint32 numThreads = 1; numThreads < numCores; numThreads *= 2)
+    {
+        threadCounts.push_back(numThreads);
+    }
+    threadCounts.push_back(numCores);
+
+    double singleThreadTime = 0.0;
+    for (Uint32 numThreads : threadCounts)
+    {
+        JobSystem jobSystem;
+        jobSystem.Initialize({
+            .numWorkerThreads = numThreads - 1, // The benchmark thread also runs the jobs while waiting.
+            .onWorkerThreadBegin = [](Uint32) { GetMyThreadFrameAllocator().Initialize("Benchmark job worker thread frame allocator"); },
+            .onWorkerThreadEnd = [](Uint32) { GetMyThreadFrameAllocator().Shutdown(); },
+            .onJobFinished = []() { GetMyThreadFrameAllocator().DiscardAllocations(); }
+        });
+
+        double bestTime = std::numeric_limits<double>::max();
+        ModelLoadTimings bestTimings;
+        for (int round = 0; round < numRounds; ++round)
+        {
+            ModelLoadTimings timings;
+            const auto start = Clock::now();
+            if (!ModelLoaderSystem::LoadModelData_glTF(pathInfo, jobSystem, timings))
+            {
+                ADD_FAILURE() << "Failed to load " << path;
+                jobSystem.Shutdown();
+                GetMyThreadFrameAllocator().Shutdown();
+                return;
+            }
+            const double time = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+            if (time < bestTime)
+            {
+                bestTime = time;
+                bestTimings = timings;
+            }
+            GetMyThreadFrameAllocator().DiscardAllocations();
+        }
+        jobSystem.Shutdown();
+
+        if (numThreads == 1)
+        {
+            singleThreadTime = bestTime;
+        }
+        std::cout << numThreads << " threads: " << bestTime << " ms (x" << singleThreadTime / bestTime << ")"
+            << " / Parse: " << bestTimings.parseTimeMS << " ms / Materials: " << bestTimings.materialTimeMS << " ms"
+            << " / Image decode: " << bestTimings.imageDecodeTimeMS << " ms / Meshes: " << bestTimings.meshTimeMS << " ms" << std::endl;
+    }
+
+    GetMyThreadFrameAllocator().Shutdown();
+}
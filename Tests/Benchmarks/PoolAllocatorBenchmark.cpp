@@ -0,0 +1,51 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+
+#include "PoolAllocator.h"
+
+using namespace cube;
+
+struct PoolBenchmarkObject
+{
+    Uint64 id;
+    float values[6];
+
+    PoolBenchmarkObject(Uint64 inId) :
+        id(inId)
+    {
+        for (float& v : values)
+        {
+            v = static_cast<float>(inId);
+        }
+    }
+};
+
+TEST(PoolAllocatorBenchmark, AllocateShared)
+{
+    using Clock = std::chrono::steady_clock;
+    constexpr int numObjects = 100000;
+
+    Vector<SharedPtr<PoolBenchmarkObject>> objects;
+    objects.reserve(numObjects);
+
+    auto measure = [&objects](auto createFunc)
+    {
+        const auto start = Clock::now();
+        for (int round = 0; round < 4; ++round)
+        {
+            for (int i = 0; i < numObjects; ++i)
+            {
+                objects.push_back(createFunc(i));
+            }
+            objects.clear();
+        }
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    };
+
+    const double poolTime = measure([](int i) { return std::allocate_shared<PoolBenchmarkObject>(PoolStdAllocator<PoolBenchmarkObject>(), i); });
+    const double heapTime = measure([](int i) { return std::make_shared<PoolBenchmarkObject>(i); });
+
+    std::cout << "allocate_shared with PoolStdAllocator: " << poolTime << " ms / make_shared: " << heapTime << " ms" << std::endl;
+}
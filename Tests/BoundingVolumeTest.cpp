@@ -0,0 +1,136 @@
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "BoundingVolume.h"
+#include "BoundingVolumeTestHelper.h"
+#include "CubeMath.h"
+#include "MatrixUtility.h"
+
+using namespace cube;
+
+constexpr float kEps = 1e-4f;
+
+// ===== AABB =====
+
+TEST(BoundingVolumeTest, AABBMerge)
+{
+    AABB box;
+    EXPECT_FALSE(box.IsValid());
+
+    box.Merge(Float3{ 1.0f, -2.0f, 3.0f });
+    EXPECT_TRUE(box.IsValid());
+    EXPECT_EQ(box.min, (Float3{ 1.0f, -2.0f, 3.0f }));
+    EXPECT_EQ(box.max, (Float3{ 1.0f, -2.0f, 3.0f }));
+
+    box.Merge(Float3{ -1.0f, 2.0f, 0.0f });
+    EXPECT_EQ(box.min, (Float3{ -1.0f, -2.0f, 0.0f }));
+    EXPECT_EQ(box.max, (Float3{ 1.0f, 2.0f, 3.0f }));
+    EXPECT_EQ(box.GetCenter(), (Float3{ 0.0f, 0.0f, 1.5f }));
+    EXPECT_EQ(box.GetExtent(), (Float3{ 1.0f, 2.0f, 1.5f }));
+
+    AABB other = MakeBox({ 10.0f, 0.0f, 0.0f }, { 1.0f, 1.0f, 1.0f });
+    box.Merge(other);
+    EXPECT_EQ(box.min, (Float3{ -1.0f, -2.0f, -1.0f }));
+    EXPECT_EQ(box.max, (Float3{ 11.0f, 2.0f, 3.0f }));
+}
+
+TEST(BoundingVolumeTest, AABBTransformed)
+{
+    AABB box = MakeBox({ 1.0f, 0.0f, 0.0f }, { 1.0f, 2.0f, 3.0f });
+
+    // Scale + translation
+    Matrix m = MatrixUtility::GetScale(2.0f, 2.0f, 2.0f) * MatrixUtility::GetTranslation(0.0f, 5.0f, 0.0f);
+    AABB transformed = box.Transformed(m);
+    EXPECT_NEAR(transformed.min.x, 0.0f, kEps);
+    EXPECT_NEAR(transformed.min.y, 1.0f, kEps);
+    EXPECT_NEAR(transformed.min.z, -6.0f, kEps);
+    EXPECT_NEAR(transformed.max.x, 4.0f, kEps);
+    EXPECT_NEAR(transformed.max.y, 9.0f, kEps);
+    EXPECT_NEAR(transformed.max.z, 6.0f, kEps);
+
+    // 90 degrees around Y swaps the X / Z extents.
+    AABB rotated = MakeBox({ 0.0f, 0.0f, 0.0f }, { 1.0f, 2.0f, 3.0f }).Transformed(MatrixUtility::GetRotationY(Math::Deg2Rad(90.0f)));
+    EXPECT_NEAR(rotated.max.x, 3.0f, kEps);
+    EXPECT_NEAR(rotated.max.y, 2.0f, kEps);
+    EXPECT_NEAR(rotated.max.z, 1.0f, kEps);
+    EXPECT_NEAR(rotated.min.x, -3.0f, kEps);
+
+    // Invalid box stays invalid.
+    EXPECT_FALSE(AABB().Transformed(m).IsValid());
+}
+
+// ===== Frustum =====
+
+TEST(BoundingVolumeTest, FrustumPlanes)
+{
+    Frustum frustum = MakeTestFrustum();
+    for (int i = 0; i < Frustum::NUM_PLANES; ++i)
+    {
+        const Float4& plane = frustum.GetPlane(i);
+        EXPECT_NEAR(plane.x * plane.x + plane.y * plane.y + plane.z * plane.z, 1.0f, kEps) << "plane=" << i;
+
+        // The point in front of the camera is inside of all planes.
+        EXPECT_GT(plane.x * 0.0f + plane.y * 0.0f + plane.z * -10.0f + plane.w, 0.0f) << "plane=" << i;
+    }
+}
+
+TEST(BoundingVolumeTest, FrustumIntersects)
+{
+    Frustum frustum = MakeTestFrustum();
+
+    EXPECT_TRUE(frustum.Intersects(MakeBox({ 0.0f, 0.0f, -10.0f }, { 1.0f, 1.0f, 1.0f })));
+    // Behind the camera
+    EXPECT_FALSE(frustum.Intersects(MakeBox({ 0.0f, 0.0f, 10.0f }, { 1.0f, 1.0f, 1.0f })));
+    // Beyond the far plane
+    EXPECT_FALSE(frustum.Intersects(MakeBox({ 0.0f, 0.0f, -2000.0f }, { 1.0f, 1.0f, 1.0f })));
+    // Far to the side
+    EXPECT_FALSE(frustum.Intersects(MakeBox({ 100.0f, 0.0f, -10.0f }, { 1.0f, 1.0f, 1.0f })));
+    EXPECT_FALSE(frustum.Intersects(MakeBox({ 0.0f, -100.0f, -10.0f }, { 1.0f, 1.0f, 1.0f })));
+    // Crossing the camera
+    EXPECT_TRUE(frustum.Intersects(MakeBox({ 0.0f, 0.0f, 0.0f }, { 5.0f, 5.0f, 5.0f })));
+
+    EXPECT_TRUE(frustum.Intersects(Sphere{ .center = { 0.0f, 0.0f, -10.0f }, .radius = 1.0f }));
+    EXPECT_FALSE(frustum.Intersects(Sphere{ .center = { 0.0f, 0.0f, 10.0f }, .radius = 1.0f }));
+    EXPECT_TRUE(frustum.Intersects(Sphere{ .center = { 0.0f, 0.0f, 10.0f }, .radius = 20.0f }));
+}
+
+TEST(BoundingVolumeTest, CullAABBsMatchesIntersects)
+{
+    Frustum frustum = MakeTestFrustum();
+
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> centerDist(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> extentDist(0.1f, 5.0f);
+
+    // Not a multiple of 8, so the remaining boxes are tested too.
+    constexpr int numBoxes = 1003;
+    Vector<AABB> boxes;
+    AABBBatch batch;
+    batch.Reserve(numBoxes);
+    for (int i = 0; i < numBoxes; ++i)
+    {
+        AABB box = MakeBox({ centerDist(random), centerDist(random), centerDist(random) }, { extentDist(random), extentDist(random), extentDist(random) });
+        boxes.push_back(box);
+        batch.Add(box);
+    }
+    EXPECT_EQ(batch.GetSize(), numBoxes);
+
+    Vector<Uint8> isVisible(numBoxes, 2);
+    const Uint64 numVisible = frustum.CullAABBs(batch, isVisible);
+
+    Uint64 expectedNumVisible = 0;
+    for (int i = 0; i < numBoxes; ++i)
+    {
+        const bool expected = frustum.Intersects(boxes[i]);
+        EXPECT_EQ(isVisible[i], expected ? 1 : 0) << "box=" << i;
+        expectedNumVisible += expected ? 1 : 0;
+    }
+    EXPECT_EQ(numVisible, expectedNumVisible);
+    EXPECT_GT(numVisible, 0u);
+    EXPECT_LT(numVisible, static_cast<Uint64>(numBoxes));
+
+    batch.Clear();
+    EXPECT_EQ(batch.GetSize(), 0u);
+    EXPECT_EQ(frustum.CullAABBs(batch, isVisible), 0u);
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "BoundingVolume.h"
+#include "CubeMath.h"
+#include "MatrixUtility.h"
+
+namespace cube
+{
+    // Camera at the origin looking at -Z. Same projection as CameraSystem. (Reversed depth)
+    inline Frustum MakeTestFrustum()
+    {
+        Matrix view = MatrixUtility::GetLookAt(Vector3(0.0f, 0.0f, 0.0f), Vector3(0.0f, 0.0f, -1.0f), Vector3(0.0f, 1.0f, 0.0f));
+        Matrix projection = MatrixUtility::GetPerspectiveFov(Math::Deg2Rad(60.0f), 1.5f, 1000.0f, 0.1f);
+        return Frustum::FromViewProjection(view * projection);
+    }
+
+    inline AABB MakeBox(const Float3& center, const Float3& extent)
+    {
+        return { .min = center - extent, .max = center + extent };
+    }
+} // namespace cube
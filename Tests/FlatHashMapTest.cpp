@@ -0,0 +1,183 @@
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "CubeString.h"
+#include "FlatHashMap.h"
+
+using namespace cube;
+
+// ===== FlatHashMap Tests =====
+
+TEST(FlatHashMapTest, InsertFindErase)
+{
+    FlatHashMap<Uint64, int> map;
+    EXPECT_TRUE(map.empty());
+    EXPECT_EQ(map.find(1), map.end());
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        auto [it, inserted] = map.insert({ static_cast<Uint64>(i), i * 2 });
+        EXPECT_TRUE(inserted);
+        EXPECT_EQ(it->second, i * 2);
+    }
+    EXPECT_EQ(map.size(), 1000u);
+
+    // Inserting the existing key does not overwrite.
+    auto [it, inserted] = map.insert({ 10, -1 });
+    EXPECT_FALSE(inserted);
+    EXPECT_EQ(it->second, 20);
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        auto findIt = map.find(i);
+        ASSERT_NE(findIt, map.end());
+        EXPECT_EQ(findIt->second, i * 2);
+    }
+    EXPECT_EQ(map.find(1000), map.end());
+
+    for (int i = 0; i < 1000; i += 2)
+    {
+        EXPECT_EQ(map.erase(i), 1u);
+    }
+    EXPECT_EQ(map.erase(0), 0u);
+    EXPECT_EQ(map.size(), 500u);
+    for (int i = 0; i < 1000; ++i)
+    {
+        EXPECT_EQ(map.contains(i), i % 2 == 1);
+    }
+
+    map[5] = 100;
+    map[2000] = 1;
+    EXPECT_EQ(map[5], 100);
+    EXPECT_EQ(map.size(), 501u);
+}
+
+TEST(FlatHashMapTest, EraseWhileIterating)
+{
+    FlatHashMap<Uint64, SharedPtr<int>> map;
+    for (int i = 0; i < 300; ++i)
+    {
+        map[i] = std::make_shared<int>(i);
+    }
+
+    int numVisited = 0;
+    for (auto it = map.begin(); it != map.end();)
+    {
+        numVisited++;
+        if (*it->second % 3 == 0)
+        {
+            it = map.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+    EXPECT_EQ(numVisited, 300);
+    EXPECT_EQ(map.size(), 200u);
+
+    int numLeft = 0;
+    for (const auto& [key, value] : map)
+    {
+        EXPECT_NE(key % 3, 0u);
+        EXPECT_EQ(static_cast<Uint64>(*value), key);
+        numLeft++;
+    }
+    EXPECT_EQ(numLeft, 200);
+}
+
+TEST(FlatHashMapTest, ClearKeepsCapacity)
+{
+    FlatHashMap<Uint64, int> map;
+    map.reserve(100);
+    const SizeType capacity = map.capacity();
+    EXPECT_GE(capacity, 100u);
+
+    for (int frame = 0; frame < 10; ++frame)
+    {
+        for (int i = 0; i < 100; ++i)
+        {
+            map[frame * 1000 + i] = i;
+        }
+        EXPECT_EQ(map.size(), 100u);
+        map.clear();
+        EXPECT_TRUE(map.empty());
+        EXPECT_EQ(map.begin(), map.end());
+    }
+    EXPECT_EQ(map.capacity(), capacity);
+}
+
+TEST(FlatHashMapTest, RandomOperationsMatchStdMap)
+{
+    FlatHashMap<Uint64, Uint64> map;
+    HashMap<Uint64, Uint64> expected;
+
+    std::mt19937_64 random(1234);
+    for (int i = 0; i < 100000; ++i)
+    {
+        // Small key range to make many tombstones.
+        const Uint64 key = random() % 2000;
+        switch (random() % 3)
+        {
+        case 0:
+            map[key] = i;
+            expected[key] = i;
+            break;
+        case 1:
+            EXPECT_EQ(map.erase(key), expected.erase(key));
+            break;
+        case 2:
+        {
+            auto findIt = map.find(key);
+            auto expectedIt = expected.find(key);
+            ASSERT_EQ(findIt == map.end(), expectedIt == expected.end());
+            if (expectedIt != expected.end())
+            {
+                EXPECT_EQ(findIt->second, expectedIt->second);
+            }
+            break;
+        }
+        }
+    }
+    EXPECT_EQ(map.size(), expected.size());
+
+    // Copy and move keep all elements.
+    FlatHashMap<Uint64, Uint64> copied = map;
+    FlatHashMap<Uint64, Uint64> moved = std::move(map);
+    EXPECT_TRUE(map.empty());
+    for (const auto& [key, value] : expected)
+    {
+        EXPECT_EQ(copied.find(key)->second, value);
+        EXPECT_EQ(moved.find(key)->second, value);
+    }
+}
+
+TEST(FlatHashMapTest, StringKeyWithTransparentHash)
+{
+    FlatHashMap<String, int, TStringHash<Character>, std::equal_to<>> map;
+    map.insert({ CUBE_T("Alpha"), 1 });
+    map.insert({ CUBE_T("Beta"), 2 });
+
+    // Lookup with StringView without the temporary string
+    const StringView view = CUBE_T("Beta");
+    auto findIt = map.find(view);
+    ASSERT_NE(findIt, map.end());
+    EXPECT_EQ(findIt->second, 2);
+    EXPECT_FALSE(map.contains(StringView(CUBE_T("Gamma"))));
+}
+
+TEST(FlatHashMapTest, FlatHashSet)
+{
+    FlatHashSet<int> set;
+    for (int i = 0; i < 100; ++i)
+    {
+        set.insert(i % 10);
+    }
+    EXPECT_EQ(set.size(), 10u);
+    EXPECT_TRUE(set.contains(9));
+    EXPECT_FALSE(set.contains(10));
+
+    set.erase(9);
+    EXPECT_FALSE(set.contains(9));
+}
@@ -0,0 +1,141 @@
+#include <gtest/gtest.h>
+
+#include "Allocator/FrameAllocator.h"
+#include "Logger.h"
+
+using namespace cube;
+
+// ===== FrameAllocator Tests =====
+
+TEST(FrameAllocatorTest, AllocationsFitInBlock)
+{
+    FrameAllocator allocator;
+    allocator.Initialize("Test frame allocator", 64 * 1024);
+
+    void* a = allocator.Allocate(100);
+    void* b = allocator.AllocateAligned(100, 64);
+    EXPECT_NE(a, b);
+    EXPECT_EQ(reinterpret_cast<Uint64>(b) % 64, 0u);
+
+    allocator.Free(a);
+    allocator.FreeAligned(b);
+    allocator.DiscardAllocations();
+
+    const FrameAllocatorStats& stats = allocator.GetStats();
+    EXPECT_EQ(stats.blockSize, 64u * 1024);
+    EXPECT_EQ(stats.numLastFrameAdditionalBlocks, 0u);
+    EXPECT_EQ(stats.numBlockGrowths, 0u);
+    EXPECT_GE(stats.lastFrameUsedSize, 200u);
+    EXPECT_EQ(stats.highWaterMark, stats.lastFrameUsedSize);
+
+    allocator.Shutdown();
+}
+
+TEST(FrameAllocatorTest, BlockGrowsToHighWaterMark)
+{
+    // The overflow warning is written with the default logger allocator.
+    Logger::Init(nullptr);
+
+    FrameAllocator allocator;
+    allocator.Initialize("Test frame allocator", 64 * 1024);
+
+    // Many reallocations like a growing FrameVector.
+    FrameVector<Uint64> values{ FrameAllocator::StdAllocator<Uint64>(allocator) };
+    for (Uint64 i = 0; i < 100000; ++i)
+    {
+        values.push_back(i);
+    }
+    for (Uint64 i = 0; i < values.size(); ++i)
+    {
+        ASSERT_EQ(values[i], i);
+    }
+    values = FrameVector<Uint64>{ FrameAllocator::StdAllocator<Uint64>(allocator) };
+    allocator.DiscardAllocations();
+
+    const FrameAllocatorStats& stats = allocator.GetStats();
+    EXPECT_GT(stats.numLastFrameAdditionalBlocks, 0u);
+    // Additional blocks grow geometrically, so they are only a few.
+    EXPECT_LT(stats.numLastFrameAdditionalBlocks, 16u);
+    EXPECT_EQ(stats.numBlockGrowths, 1u);
+    EXPECT_GE(stats.blockSize, stats.highWaterMark);
+
+    // The same frame fits in one block now.
+    for (Uint64 i = 0; i < 100000; ++i)
+    {
+        values.push_back(i);
+    }
+    values = FrameVector<Uint64>{ FrameAllocator::StdAllocator<Uint64>(allocator) };
+    allocator.DiscardAllocations();
+
+    EXPECT_EQ(stats.numLastFrameAdditionalBlocks, 0u);
+    EXPECT_EQ(stats.numBlockGrowths, 1u);
+
+    allocator.Shutdown();
+}
+
+TEST(FrameAllocatorTest, RewindReleasesAllocationsAfterMarker)
+{
+    FrameAllocator allocator;
+    allocator.Initialize("Test frame allocator", 64 * 1024);
+
+    void* before = allocator.Allocate(100);
+
+    void* firstInScope = nullptr;
+    {
+        FrameScratchScope scope(allocator);
+
+        firstInScope = allocator.Allocate(1000);
+        {
+            FrameScratchScope nestedScope(allocator);
+
+            void* nested = allocator.Allocate(2000);
+            allocator.Free(nested);
+        }
+        // The nested scope released its allocation.
+        void* afterNested = allocator.Allocate(10);
+        EXPECT_EQ(static_cast<Uint8*>(afterNested), static_cast<Uint8*>(firstInScope) + 1000 + FrameAllocator::ALLOCATION_HEADER_SIZE);
+
+        allocator.Free(afterNested);
+        allocator.Free(firstInScope);
+    }
+
+    // The memory of the scope is reused.
+    void* after = allocator.Allocate(1000);
+    EXPECT_EQ(after, firstInScope);
+
+    allocator.Free(after);
+    allocator.Free(before);
+    allocator.DiscardAllocations();
+
+    // The peak in the scopes is counted in the high-water mark.
+    EXPECT_GE(allocator.GetStats().lastFrameUsedSize, 3100u);
+
+    allocator.Shutdown();
+}
+
+TEST(FrameAllocatorTest, RewindReleasesAdditionalBlocks)
+{
+    // The overflow warning is written with the default logger allocator.
+    Logger::Init(nullptr);
+
+    FrameAllocator allocator;
+    allocator.Initialize("Test frame allocator", 64 * 1024);
+
+    for (int i = 0; i < 4; ++i)
+    {
+        FrameScratchScope scope(allocator);
+
+        void* large = allocator.Allocate(256 * 1024);
+        memset(large, i, 256 * 1024);
+        allocator.Free(large);
+    }
+    allocator.DiscardAllocations();
+
+    // Additional blocks were needed in the frame, so the primary block grows.
+    const FrameAllocatorStats& stats = allocator.GetStats();
+    EXPECT_EQ(stats.numLastFrameAdditionalBlocks, 4u);
+    EXPECT_EQ(stats.numBlockGrowths, 1u);
+    EXPECT_GE(stats.blockSize, 256u * 1024);
+
+    allocator.Shutdown();
+}
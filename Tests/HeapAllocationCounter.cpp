@@ -0,0 +1,96 @@
+#include "HeapAllocationCounter.h"
+
+#include <cstdlib>
+#include <new>
+
+namespace cube
+{
+    namespace
+    {
+        // Trivially initialized, so it is safe to use in operator new of any thread.
+        thread_local ScopedHeapAllocationCounter* tlsCurrentCounter = nullptr;
+
+        void* AllocateHeap(std::size_t size)
+        {
+            ScopedHeapAllocationCounter::OnAllocate();
+
+            void* ptr = std::malloc(size > 0 ? size : 1);
+            if (ptr == nullptr)
+            {
+                throw std::bad_alloc();
+            }
+            return ptr;
+        }
+
+        void* AllocateHeapAligned(std::size_t size, std::size_t alignment)
+        {
+            ScopedHeapAllocationCounter::OnAllocate();
+
+#if defined(_WIN32)
+            void* ptr = _aligned_malloc(size > 0 ? size : 1, alignment);
+#else
+            // aligned_alloc requires the size to be a multiple of the alignment.
+            const std::size_t alignedSize = (size + alignment - 1) / alignment * alignment;
+            void* ptr = std::aligned_alloc(alignment, alignedSize > 0 ? alignedSize : alignment);
+#endif
+            if (ptr == nullptr)
+            {
+                throw std::bad_alloc();
+            }
+            return ptr;
+        }
+
+        void FreeHeapAligned(void* ptr)
+        {
+#if defined(_WIN32)
+            _aligned_free(ptr);
+#else
+            std::free(ptr);
+#endif
+        }
+    } // namespace
+
+    ScopedHeapAllocationCounter::ScopedHeapAllocationCounter()
+        : mPrevious(tlsCurrentCounter)
+    {
+        tlsCurrentCounter = this;
+    }
+
+    ScopedHeapAllocationCounter::~ScopedHeapAllocationCounter()
+    {
+        tlsCurrentCounter = mPrevious;
+    }
+
+    void ScopedHeapAllocationCounter::OnAllocate()
+    {
+        for (ScopedHeapAllocationCounter* counter = tlsCurrentCounter; counter != nullptr; counter = counter->mPrevious)
+        {
+            counter->mNumAllocations++;
+        }
+    }
+} // namespace cube
+
+// All forms are replaced because the runtime may not forward them to each other. (ex: sanitizers)
+void* operator new(std::size_t size) { return cube::AllocateHeap(size); }
+void* operator new[](std::size_t size) { return cube::AllocateHeap(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { try { return cube::AllocateHeap(size); } catch (...) { return nullptr; } }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { try { return cube::AllocateHeap(size); } catch (...) { return nullptr; } }
+
+void* operator new(std::size_t size, std::align_val_t alignment) { return cube::AllocateHeapAligned(size, static_cast<std::size_t>(alignment)); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return cube::AllocateHeapAligned(size, static_cast<std::size_t>(alignment)); }
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { try { return cube::AllocateHeapAligned(size, static_cast<std::size_t>(alignment)); } catch (...) { return nullptr; } }
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { try { return cube::AllocateHeapAligned(size, static_cast<std::size_t>(alignment)); } catch (...) { return nullptr; } }
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+
+void operator delete(void* ptr, std::align_val_t) noexcept { cube::FreeHeapAligned(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { cube::FreeHeapAligned(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { cube::FreeHeapAligned(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { cube::FreeHeapAligned(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { cube::FreeHeapAligned(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { cube::FreeHeapAligned(ptr); }
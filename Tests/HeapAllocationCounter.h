@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Types.h"
+
+namespace cube
+{
+    // Counts the global heap allocations (operator new) of the current thread while it is alive.
+    // The global operator new / delete are replaced in the test executable to count them, so allocations
+    // in the shared libraries are only visible on the platforms that resolve them globally. (Not in Windows DLLs)
+    class ScopedHeapAllocationCounter
+    {
+    public:
+        ScopedHeapAllocationCounter();
+        ~ScopedHeapAllocationCounter();
+
+        ScopedHeapAllocationCounter(const ScopedHeapAllocationCounter& other) = delete;
+        ScopedHeapAllocationCounter& operator=(const ScopedHeapAllocationCounter& rhs) = delete;
+
+        Uint64 GetNumAllocations() const { return mNumAllocations; }
+
+        // Called in the replaced operator new.
+        static void OnAllocate();
+
+    private:
+        ScopedHeapAllocationCounter* mPrevious;
+        Uint64 mNumAllocations = 0;
+    };
+} // namespace cube
@@ -0,0 +1,363 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <iostream>
+
+#include "JobSystem.h"
+
+using namespace cube;
+
+// ===== JobSystem Tests =====
+
+TEST(JobSystemTest, ScheduleAndWait)
+{
+    JobSystem jobSystem;
+    jobSystem.Initialize({ .numWorkerThreads = 4 });
+
+    std::atomic<int> sum = 0;
+    Vector<JobHandle> handles;
+    for (int i = 1; i <= 1000; ++i)
+    {
+        handles.push_back(jobSystem.Schedule([&sum, i]() { sum.fetch_add(i); }));
+    }
+    for (const JobHandle& handle : handles)
+    {
+        jobSystem.Wait(handle);
+        EXPECT_TRUE(handle.IsFinished());
+    }
+    EXPECT_EQ(sum.load(), 1000 * 1001 / 2);
+
+    // Large callables are stored outside of the job.
+    Array<Uint64, 32> values = {};
+    values[31] = 7;
+    Uint64 result = 0;
+    jobSystem.Wait(jobSystem.Schedule([values, &result]() { result = values[31]; }));
+    EXPECT_EQ(result, 7u);
+
+    // The empty handle is always finished.
+    JobHandle empty;
+    EXPECT_FALSE(empty.IsValid());
+    EXPECT_TRUE(empty.IsFinished());
+    jobSystem.Wait(empty);
+
+    jobSystem.Shutdown();
+}
+
+TEST(JobSystemTest, Dependencies)
+{
+    JobSystem jobSystem;
+    jobSystem.Initialize({ .numWorkerThreads = 4 });
+
+    for (int iteration = 0; iteration < 100; ++iteration)
+    {
+        // a, b -> c -> d
+        std::atomic<int> order = 0;
+        int aOrder = -1, bOrder = -1, cOrder = -1, dOrder = -1;
+        JobHandle a = jobSystem.Schedule([&]() { aOrder = order.fetch_add(1); });
+        JobHandle b = jobSystem.Schedule([&]() { bOrder = order.fetch_add(1); });
+        const JobHandle abDependencies[] = { a, b };
+        JobHandle c = jobSystem.Schedule([&]() { cOrder = order.fetch_add(1); }, abDependencies);
+        JobHandle d = jobSystem.Schedule([&]() { dOrder = order.fetch_add(1); }, { &c, 1 });
+
+        jobSystem.Wait(d);
+        EXPECT_TRUE(a.IsFinished());
+        EXPECT_TRUE(b.IsFinished());
+        EXPECT_TRUE(c.IsFinished());
+        EXPECT_LT(aOrder, cOrder);
+        EXPECT_LT(bOrder, cOrder);
+        EXPECT_EQ(cOrder, 2);
+        EXPECT_EQ(dOrder, 3);
+    }
+
+    // Dependency on the finished job
+    JobHandle finished = jobSystem.Schedule([]() {});
+    jobSystem.Wait(finished);
+    bool isRun = false;
+    jobSystem.Wait(jobSystem.Schedule([&isRun]() { isRun = true; }, { &finished, 1 }));
+    EXPECT_TRUE(isRun);
+
+    jobSystem.Shutdown();
+}
+
+TEST(JobSystemTest, NestedWait)
+{
+    JobSystem jobSystem;
+    jobSystem.Initialize({ .numWorkerThreads = 2 });
+
+    // Each job waits for its children while running the other jobs, so it does not deadlock with the few workers.
+    std::atomic<int> numLeaves = 0;
+    std::function<void(int)> spawn = [&](int depth)
+    {
+        if (depth == 0)
+        {
+            numLeaves.fetch_add(1);
+            return;
+        }
+        JobHandle left = jobSystem.Schedule([&spawn, depth]() { spawn(depth - 1); });
+        JobHandle right = jobSystem.Schedule([&spawn, depth]() { spawn(depth - 1); });
+        jobSystem.Wait(left);
+        jobSystem.Wait(right);
+    };
+    jobSystem.Wait(jobSystem.Schedule([&spawn]() { spawn(10); }));
+    EXPECT_EQ(numLeaves.load(), 1 << 10);
+
+    jobSystem.Shutdown();
+}
+
+TEST(JobSystemTest, ParallelFor)
+{
+    JobSystem jobSystem;
+    jobSystem.Initialize({ .numWorkerThreads = 4 });
+
+    Vector<int> values(10007, 0);
+    jobSystem.ParallelFor(0, values.size(), 64, [&values](Uint64 i) { values[i] += static_cast<int>(i); });
+    for (Uint64 i = 0; i < values.size(); ++i)
+    {
+        EXPECT_EQ(values[i], static_cast<int>(i));
+    }
+
+    // Empty range and the range smaller than the grain
+    int numCalls = 0;
+    jobSystem.ParallelFor(5, 5, 1, [&numCalls](Uint64) { numCalls++; });
+    EXPECT_EQ(numCalls, 0);
+    jobSystem.ParallelFor(0, 3, 16, [&numCalls](Uint64) { numCalls++; });
+    EXPECT_EQ(numCalls, 3);
+
+    // ParallelFor inside the jobs
+    std::atomic<Uint64> sum = 0;
+    jobSystem.ParallelFor(0, 8, 1, [&jobSystem, &sum](Uint64)
+    {
+        jobSystem.ParallelFor(0, 1000, 10, [&sum](Uint64 i) { sum.fetch_add(i); });
+    });
+    EXPECT_EQ(sum.load(), 8u * (999u * 1000u / 2));
+
+    // No worker threads
+    JobSystem singleThreadJobSystem;
+    singleThreadJobSystem.Initialize({ .numWorkerThreads = 0 });
+    Uint64 singleSum = 0;
+    singleThreadJobSystem.ParallelFor(0, 100, 7, [&singleSum](Uint64 i) { singleSum += i; });
+    EXPECT_EQ(singleSum, 4950u);
+    singleThreadJobSystem.Shutdown();
+
+    jobSystem.Shutdown();
+}
+
+TEST(JobSystemTest, WorkerThreadCallbacks)
+{
+    constexpr Uint32 numWorkerThreads = 3;
+
+    std::atomic<int> numBegins = 0;
+    std::atomic<int> numEnds = 0;
+    std::atomic<int> numJobsFinished = 0;
+    thread_local int thlWorkerState = 0;
+
+    JobSystem jobSystem;
+    jobSystem.Initialize({
+        .numWorkerThreads = numWorkerThreads,
+        .onWorkerThreadBegin = [&](Uint32) { thlWorkerState = 1; numBegins.fetch_add(1); },
+        .onWorkerThreadEnd = [&](Uint32) { thlWorkerState = 0; numEnds.fetch_add(1); },
+        .onJobFinished = [&]() { numJobsFinished.fetch_add(1); }
+    });
+    EXPECT_EQ(jobSystem.GetNumWorkerThreads(), numWorkerThreads);
+    EXPECT_EQ(jobSystem.GetCurrentWorkerIndex(), -1);
+
+    // The jobs in the workers see the state initialized in the begin callback.
+    std::atomic<int> numJobsInWorkers = 0;
+    std::atomic<int> numInitializedWorkerJobs = 0;
+    jobSystem.ParallelFor(0, 1000, 1, [&](Uint64)
+    {
+        if (jobSystem.GetCurrentWorkerIndex() != -1)
+        {
+            numJobsInWorkers.fetch_add(1);
+            numInitializedWorkerJobs.fetch_add(thlWorkerState);
+        }
+    });
+    EXPECT_EQ(numInitializedWorkerJobs.load(), numJobsInWorkers.load());
+    EXPECT_LE(numJobsFinished.load(), numJobsInWorkers.load());
+
+    jobSystem.Shutdown();
+    EXPECT_EQ(numBegins.load(), static_cast<int>(numWorkerThreads));
+    EXPECT_EQ(numEnds.load(), static_cast<int>(numWorkerThreads));
+}
+
+// ===== Fiber Tests =====
+
+TEST(JobSystemTest, FiberWaitParksFiber)
+{
+    JobSystem jobSystem;
+    jobSystem.Initialize({ .numWorkerThreads = 2, .useFibers = true });
+    EXPECT_TRUE(jobSystem.IsUsingFibers());
+
+    // Each job waits for its child. The waiting fibers are parked, so two workers run all of them.
+    constexpr int numJobs = 100000;
+    std::atomic<int> numFinished = 0;
+    std::atomic<int> numChildren = 0;
+    JobHandle root = jobSystem.Schedule([&]()
+    {
+        jobSystem.ParallelFor(0, numJobs, 64, [&](Uint64)
+        {
+            JobHandle child = jobSystem.Schedule([&numChildren]() { numChildren.fetch_add(1, std::memory_order_relaxed); });
+            jobSystem.Wait(child);
+            numFinished.fetch_add(1, std::memory_order_relaxed);
+        });
+    });
+    // Wait without helping, so all jobs run in the fibers of the workers.
+    while (!root.IsFinished())
+    {
+        std::this_thread::yield();
+    }
+
+    EXPECT_EQ(numFinished.load(), numJobs);
+    EXPECT_EQ(numChildren.load(), numJobs);
+    // The resumed fibers run before the new jobs, so only a few fibers are created.
+    EXPECT_LE(jobSystem.GetNumFibers(), 64u);
+    std::cout << "Fibers created for " << numJobs << " waiting jobs: " << jobSystem.GetNumFibers() << std::endl;
+
+    jobSystem.Shutdown();
+}
+
+TEST(JobSystemTest, FiberManyParkedFibers)
+{
+    JobSystem jobSystem;
+    jobSystem.Initialize({ .numWorkerThreads = 2, .useFibers = true, .fiberStackSize = 32 * 1024 });
+
+    // The gate blocks a worker, and the other worker parks all of the waiters. The fiber pool grows for them.
+    constexpr int numWaiters = 2000;
+    std::atomic<bool> isGateOpened = false;
+    JobHandle gate = jobSystem.Schedule([&isGateOpened]()
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        isGateOpened.store(true);
+    });
+
+    std::atomic<int> numOpenedAfterWait = 0;
+    Vector<JobHandle> waiters;
+    for (int i = 0; i < numWaiters; ++i)
+    {
+        waiters.push_back(jobSystem.Schedule([&]()
+        {
+            jobSystem.Wait(gate);
+            numOpenedAfterWait.fetch_add(isGateOpened.load() ? 1 : 0);
+        }));
+    }
+    for (const JobHandle& waiter : waiters)
+    {
+        jobSystem.Wait(waiter);
+    }
+
+    EXPECT_EQ(numOpenedAfterWait.load(), numWaiters);
+    EXPECT_GT(jobSystem.GetNumFibers(), 1u);
+
+    jobSystem.Shutdown();
+}
+
+namespace
+{
+    NO_INLINE Uint64 RecurseUntil(Uint64 depth, Uint64 maxDepth)
+    {
+        volatile Uint8 buffer[1024];
+        buffer[0] = static_cast<Uint8>(depth);
+        return depth < maxDepth ? RecurseUntil(depth + 1, maxDepth) + buffer[0] : buffer[0];
+    }
+} // namespace
+
+TEST(JobSystemTest, FiberStackOverflowHitsGuardPage)
+{
+    // The job system has the threads, so the death test runs the test again in a new process.
+    GTEST_FLAG_SET(death_test_style, "threadsafe");
+
+    EXPECT_DEATH({
+        JobSystem jobSystem;
+        jobSystem.Initialize({ .numWorkerThreads = 1, .useFibers = true, .fiberStackSize = 32 * 1024 });
+        // About 1 MiB of the stack frames. Wait without helping, so the job runs in the fiber of the worker.
+        JobHandle job = jobSystem.Schedule([]() { RecurseUntil(0, 1024); });
+        while (!job.IsFinished())
+        {
+            std::this_thread::yield();
+        }
+        jobSystem.Shutdown();
+    }, "");
+}
+
+namespace
+{
+    // Current fiber-local data of the thread, same as the frame allocator of the engine.
+    thread_local void* thlCurrentFiberData = nullptr;
+
+    // The address of the thread-local variable should not be cached across Wait() because the fiber can be in another thread after it.
+    // The volatile read keeps the compiler from merging the calls.
+    NO_INLINE void*& GetCurrentFiberData()
+    {
+        void** volatile data = &thlCurrentFiberData;
+        return *data;
+    }
+} // namespace
+
+TEST(JobSystemTest, FiberLocalData)
+{
+    std::atomic<int> numCreated = 0;
+    std::atomic<int> numDestroyed = 0;
+
+    JobSystem jobSystem;
+    jobSystem.Initialize({
+        .numWorkerThreads = 4,
+        .useFibers = true,
+        .createFiberLocalData = [&numCreated]() -> void* { return new int(numCreated.fetch_add(1)); },
+        .destroyFiberLocalData = [&numDestroyed](void* data) { delete static_cast<int*>(data); numDestroyed.fetch_add(1); },
+        .onFiberSwitched = [](void* data) { GetCurrentFiberData() = data; }
+    });
+
+    // The data is kept across the wait even if the fiber is resumed in another thread.
+    std::atomic<int> numMismatches = 0;
+    std::atomic<int> numMigrations = 0;
+    jobSystem.ParallelFor(0, 10000, 1, [&](Uint64)
+    {
+        void* dataBefore = GetCurrentFiberData();
+        const Int32 workerBefore = jobSystem.GetCurrentWorkerIndex();
+
+        jobSystem.Wait(jobSystem.Schedule([]() {}));
+
+        if (GetCurrentFiberData() != dataBefore)
+        {
+            numMismatches.fetch_add(1);
+        }
+        if (jobSystem.GetCurrentWorkerIndex() != workerBefore)
+        {
+            numMigrations.fetch_add(1);
+        }
+    });
+    EXPECT_EQ(numMismatches.load(), 0);
+    std::cout << "Jobs resumed in another thread: " << numMigrations.load() << std::endl;
+
+    jobSystem.Shutdown();
+    EXPECT_EQ(numDestroyed.load(), numCreated.load());
+}
+
+TEST(JobSystemTest, FiberYield)
+{
+    // Only one worker. The polling job yields, so the job which sets the flag can run in the same thread.
+    JobSystem jobSystem;
+    jobSystem.Initialize({ .numWorkerThreads = 1, .useFibers = true });
+
+    std::atomic<bool> flag = false;
+    int numYields = 0;
+    JobHandle poller = jobSystem.Schedule([&]()
+    {
+        JobHandle setter = jobSystem.Schedule([&flag]() { flag.store(true); });
+        while (!flag.load())
+        {
+            numYields++;
+            jobSystem.YieldCurrentJob();
+        }
+    });
+
+    // Wait in the non-worker thread without helping, so only the worker runs the jobs.
+    while (!poller.IsFinished())
+    {
+        std::this_thread::yield();
+    }
+    EXPECT_TRUE(flag.load());
+    EXPECT_GE(numYields, 1);
+
+    jobSystem.Shutdown();
+}
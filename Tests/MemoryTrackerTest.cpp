@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+
+#include "Allocator/TLSFAllocator.h"
+#include "Blob.h"
+#include "MemoryTracker.h"
+
+using namespace cube;
+
+// ===== MemoryTracker Tests =====
+
+TEST(MemoryTrackerTest, CountsCurrentAndPeak)
+{
+    const MemoryTagStats before = MemoryTracker::GetStats(MemoryTag::Untagged);
+
+    MemoryTracker::OnAllocate(MemoryTag::Untagged, 1000);
+    MemoryTracker::OnAllocate(MemoryTag::Untagged, 500);
+    MemoryTracker::OnFree(MemoryTag::Untagged, 1000);
+
+    const MemoryTagStats after = MemoryTracker::GetStats(MemoryTag::Untagged);
+    EXPECT_EQ(after.currentSize, before.currentSize + 500);
+    EXPECT_GE(after.peakSize, before.currentSize + 1500);
+    EXPECT_EQ(after.numAllocations, before.numAllocations + 1);
+    EXPECT_EQ(after.numTotalAllocations, before.numTotalAllocations + 2);
+
+    MemoryTracker::OnFree(MemoryTag::Untagged, 500);
+    EXPECT_EQ(MemoryTracker::GetStats(MemoryTag::Untagged).currentSize, before.currentSize);
+}
+
+TEST(MemoryTrackerTest, TaggedBlobIsAttributed)
+{
+    TLSFAllocator allocator;
+    allocator.Initialize("Test TLSF allocator", 1024 * 1024);
+
+    const MemoryTagStats before = MemoryTracker::GetStats(MemoryTag::Mesh);
+    {
+        Blob blob(4096, &allocator, MemoryTag::Mesh);
+
+        const MemoryTagStats during = MemoryTracker::GetStats(MemoryTag::Mesh);
+        EXPECT_GE(during.currentSize, before.currentSize + 4096);
+        EXPECT_EQ(during.numAllocations, before.numAllocations + 1);
+    }
+    const MemoryTagStats after = MemoryTracker::GetStats(MemoryTag::Mesh);
+    EXPECT_EQ(after.currentSize, before.currentSize);
+    EXPECT_EQ(after.numAllocations, before.numAllocations);
+
+    EXPECT_NE(MemoryTracker::GetReport().find(CUBE_T("Mesh")), String::npos);
+
+    allocator.Shutdown();
+}
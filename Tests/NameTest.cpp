@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include "FlatHashMap.h"
+#include "Name.h"
+
+using namespace cube;
+
+// ===== Name Tests =====
+
+TEST(NameTest, SameStringHasSameId)
+{
+    const Name a(CUBE_T("NameTest_Alpha"));
+    const Name b(String(CUBE_T("NameTest_Alpha")));
+    const Name c(CUBE_T("NameTest_Beta"));
+
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(a.GetId(), b.GetId());
+    EXPECT_NE(a, c);
+    EXPECT_EQ(a.ToString(), StringView(CUBE_T("NameTest_Alpha")));
+    EXPECT_EQ(a.ToU8String(), U8StringView(u8"NameTest_Alpha"));
+    // Null-terminated
+    EXPECT_EQ(a.ToString().data()[a.ToString().size()], 0);
+
+    const Name none;
+    EXPECT_TRUE(none.IsNone());
+    EXPECT_TRUE(Name(StringView()).IsNone());
+    EXPECT_TRUE(none.ToString().empty());
+}
+
+TEST(NameTest, LiteralName)
+{
+    static_assert(CalculateNameHash(CUBE_T("NameTest_Literal")) != CalculateNameHash(CUBE_T("NameTest_Literal2")));
+
+    const Name literal = CUBE_NAME("NameTest_Literal");
+    EXPECT_EQ(literal, Name(CUBE_T("NameTest_Literal")));
+
+    FlatHashMap<Name, int> map;
+    map[literal] = 1;
+    EXPECT_EQ(map.find(Name(CUBE_T("NameTest_Literal")))->second, 1);
+}
+
+TEST(NameTest, ConcurrentIntern)
+{
+    constexpr int numThreads = 8;
+    constexpr int numNames = 2000;
+
+    Vector<Vector<Uint32>> ids(numThreads);
+    Vector<std::thread> threads;
+    for (int threadIndex = 0; threadIndex < numThreads; ++threadIndex)
+    {
+        threads.emplace_back([&ids, threadIndex]()
+        {
+            for (int i = 0; i < numNames; ++i)
+            {
+                const String str = Format<String>(CUBE_T("NameTest_Concurrent_{0}"), i);
+                ids[threadIndex].push_back(Name(str).GetId());
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    // All threads got the same ids.
+    for (int threadIndex = 1; threadIndex < numThreads; ++threadIndex)
+    {
+        EXPECT_EQ(ids[threadIndex], ids[0]);
+    }
+    for (int i = 0; i < numNames; ++i)
+    {
+        const Name name(Format<String>(CUBE_T("NameTest_Concurrent_{0}"), i));
+        EXPECT_EQ(name.GetId(), ids[0][i]);
+        EXPECT_EQ(name.ToString(), Format<String>(CUBE_T("NameTest_Concurrent_{0}"), i));
+    }
+}
@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include "PoolAllocator.h"
+
+using namespace cube;
+
+struct PoolTestObject
+{
+    Uint64 id;
+    float values[6];
+
+    PoolTestObject(Uint64 inId) :
+        id(inId)
+    {
+        for (float& v : values)
+        {
+            v = static_cast<float>(inId);
+        }
+    }
+};
+
+// ===== PoolAllocator Tests =====
+
+TEST(PoolAllocatorTest, FreedSlotIsReused)
+{
+    PoolAllocator<PoolTestObject> pool;
+
+    PoolTestObject* a = pool.New(1);
+    PoolTestObject* b = pool.New(2);
+    EXPECT_NE(a, b);
+    EXPECT_EQ(a->id, 1u);
+    EXPECT_EQ(b->id, 2u);
+    EXPECT_EQ(reinterpret_cast<Uint64>(a) % alignof(PoolTestObject), 0u);
+
+    pool.Delete(a);
+    PoolTestObject* c = pool.New(3);
+    EXPECT_EQ(c, a);
+    EXPECT_EQ(c->id, 3u);
+
+    pool.Delete(b);
+    pool.Delete(c);
+
+    const PoolAllocatorStats stats = pool.GetStats();
+    EXPECT_EQ(stats.numSlabs, 1u);
+    EXPECT_EQ(stats.numAllocated, 0u);
+    EXPECT_EQ(stats.numFree, stats.numElementsPerSlab);
+}
+
+TEST(PoolAllocatorTest, StatsReportFragmentation)
+{
+    PoolAllocator<PoolTestObject> pool({ .slabSize = 4 * 1024 });
+
+    Vector<PoolTestObject*> objects;
+    const Uint64 numElementsPerSlab = pool.GetStats().numElementsPerSlab;
+    for (Uint64 i = 0; i < numElementsPerSlab * 4; ++i)
+    {
+        objects.push_back(pool.New(i));
+    }
+    EXPECT_EQ(pool.GetStats().numSlabs, 4u);
+    EXPECT_EQ(pool.GetStats().slabOccupancyHistogram[3], 4u);
+
+    // Free all objects in the first two slabs, and every other object in the rest.
+    for (Uint64 i = 0; i < objects.size(); ++i)
+    {
+        if (i < numElementsPerSlab * 2 || i % 2 == 0)
+        {
+            pool.Delete(objects[i]);
+            objects[i] = nullptr;
+        }
+    }
+
+    PoolAllocatorStats stats = pool.GetStats();
+    EXPECT_EQ(stats.numEmptySlabs, 2u);
+    EXPECT_EQ(stats.slabOccupancyHistogram[1] + stats.slabOccupancyHistogram[2], 2u);
+    EXPECT_EQ(stats.numAllocated, numElementsPerSlab);
+    EXPECT_LT(stats.GetUtilization(), 0.5);
+
+    pool.ReleaseEmptySlabs();
+    stats = pool.GetStats();
+    EXPECT_EQ(stats.numSlabs, 2u);
+    EXPECT_EQ(stats.numEmptySlabs, 0u);
+    EXPECT_EQ(stats.numAllocated, numElementsPerSlab);
+
+    // The remaining free slots are still valid.
+    for (Uint64 i = 0; i < objects.size(); ++i)
+    {
+        if (objects[i] == nullptr)
+        {
+            objects[i] = pool.New(i);
+        }
+    }
+    EXPECT_EQ(pool.GetStats().numSlabs, 4u);
+
+    for (PoolTestObject* object : objects)
+    {
+        pool.Delete(object);
+    }
+}
+
+TEST(PoolAllocatorTest, ConcurrentAllocations)
+{
+    constexpr int numThreads = 8;
+    constexpr int numObjectsPerThread = 10000;
+
+    PoolAllocator<PoolTestObject> pool({ .useThreadCache = true });
+
+    Vector<std::thread> threads;
+    for (int threadIndex = 0; threadIndex < numThreads; ++threadIndex)
+    {
+        threads.emplace_back([&pool, threadIndex]()
+        {
+            Vector<PoolTestObject*> objects;
+            for (int round = 0; round < 4; ++round)
+            {
+                for (int i = 0; i < numObjectsPerThread; ++i)
+                {
+                    objects.push_back(pool.New(threadIndex * numObjectsPerThread + i));
+                }
+                for (int i = 0; i < numObjectsPerThread; ++i)
+                {
+                    ASSERT_EQ(objects[i]->id, static_cast<Uint64>(threadIndex * numObjectsPerThread + i));
+                    pool.Delete(objects[i]);
+                }
+                objects.clear();
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    // Only the slots in the thread caches can be left as allocated.
+    const PoolAllocatorStats stats = pool.GetStats();
+    EXPECT_LE(stats.numAllocated, static_cast<Uint64>(numThreads) * 32);
+}
+
+TEST(PoolAllocatorTest, AllocateSharedWithPoolStdAllocator)
+{
+    WeakPtr<PoolTestObject> weak;
+    {
+        SharedPtr<PoolTestObject> object = std::allocate_shared<PoolTestObject>(PoolStdAllocator<PoolTestObject>(), 10);
+        EXPECT_EQ(object->id, 10u);
+        weak = object;
+    }
+    EXPECT_TRUE(weak.expired());
+
+    // Larger than the size classes falls back to the global heap.
+    struct LargeObject
+    {
+        Uint8 data[1024];
+    };
+    SharedPtr<LargeObject> large = std::allocate_shared<LargeObject>(PoolStdAllocator<LargeObject>());
+    memset(large->data, 1, sizeof(large->data));
+}
@@ -0,0 +1,764 @@
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <random>
+#include <regex>
+#include <sstream>
+
+#include "HeapAllocationCounter.h"
+#include "JobSystem.h"
+#include "Renderer/RenderGraphTypes.h"
+#include "RenderGraphTestHelper.h"
+
+using namespace cube;
+
+static RGTransientAllocation MakeAllocation(int rgResourceIndex, int beginPass, int endPass, Uint64 size, Uint64 alignment = 1)
+{
+    return {
+        .rgResourceIndex = rgResourceIndex,
+        .beginPass = beginPass,
+        .endPass = endPass,
+        .size = size,
+        .alignment = alignment,
+        .offset = 0
+    };
+}
+
+// Largest sum of the sizes alive in the same pass. No placement can be smaller than it.
+static Uint64 CalculatePeakAliveSize(const Vector<RGTransientAllocation>& allocations)
+{
+    int numPasses = 0;
+    for (const RGTransientAllocation& allocation : allocations)
+    {
+        numPasses = std::max(numPasses, allocation.endPass + 1);
+    }
+
+    Uint64 peakSize = 0;
+    for (int passIndex = 0; passIndex < numPasses; ++passIndex)
+    {
+        Uint64 aliveSize = 0;
+        for (const RGTransientAllocation& allocation : allocations)
+        {
+            if (allocation.beginPass <= passIndex && passIndex <= allocation.endPass)
+            {
+                aliveSize += allocation.size;
+            }
+        }
+        peakSize = std::max(peakSize, aliveSize);
+    }
+    return peakSize;
+}
+
+static const RGTransientAllocation& FindAllocation(const Vector<RGTransientAllocation>& allocations, int rgResourceIndex)
+{
+    auto findIt = std::find_if(allocations.begin(), allocations.end(), [rgResourceIndex](const RGTransientAllocation& allocation)
+    {
+        return allocation.rgResourceIndex == rgResourceIndex;
+    });
+    EXPECT_NE(findIt, allocations.end());
+    return *findIt;
+}
+
+// ===== Transient memory =====
+
+TEST(RenderGraphTest, TransientPlacementReachesPeakAliveSize)
+{
+    InitializeThreadFrameAllocator();
+
+    constexpr Uint64 MiB = 1024 * 1024;
+
+    // 0: [0, 1] 4 MiB, 1: [2, 3] 4 MiB, 2: [0, 3] 2 MiB, 3: [1, 2] 1 MiB
+    Vector<RGTransientAllocation> allocations = {
+        MakeAllocation(0, 0, 1, 4 * MiB),
+        MakeAllocation(1, 2, 3, 4 * MiB),
+        MakeAllocation(2, 0, 3, 2 * MiB),
+        MakeAllocation(3, 1, 2, 1 * MiB)
+    };
+    const Uint64 peakAliveSize = CalculatePeakAliveSize(allocations);
+    EXPECT_EQ(peakAliveSize, 7 * MiB);
+
+    const Uint64 totalSize = PlaceTransientAllocations(allocations);
+    EXPECT_EQ(totalSize, peakAliveSize);
+
+    // 1 reuses the memory of 0 after it ends.
+    const RGTransientAllocation& first = FindAllocation(allocations, 0);
+    const RGTransientAllocation& second = FindAllocation(allocations, 1);
+    EXPECT_EQ(second.offset, first.offset);
+    EXPECT_FALSE(first.needAliasingBarrier);
+    EXPECT_TRUE(second.needAliasingBarrier);
+    EXPECT_EQ(second.aliasedResourceIndex, 0);
+
+    EXPECT_FALSE(FindAllocation(allocations, 2).needAliasingBarrier);
+    EXPECT_FALSE(FindAllocation(allocations, 3).needAliasingBarrier);
+}
+
+TEST(RenderGraphTest, TransientPlacementKeepsAliveResourcesApart)
+{
+    InitializeThreadFrameAllocator();
+
+    std::mt19937 random(1234);
+    std::uniform_int_distribution<int> passDist(0, 63);
+    std::uniform_int_distribution<int> lengthDist(0, 16);
+    std::uniform_int_distribution<int> sizeDist(1, 64);
+    std::uniform_int_distribution<int> alignmentShiftDist(0, 4);
+
+    constexpr Uint64 KiB = 1024;
+    Vector<RGTransientAllocation> allocations;
+    for (int i = 0; i < 256; ++i)
+    {
+        const int beginPass = passDist(random);
+        const Uint64 alignment = (64 * KiB) << alignmentShiftDist(random);
+        allocations.push_back(MakeAllocation(i, beginPass, beginPass + lengthDist(random), sizeDist(random) * 64 * KiB, alignment));
+    }
+    const Uint64 peakAliveSize = CalculatePeakAliveSize(allocations);
+
+    const Uint64 totalSize = PlaceTransientAllocations(allocations);
+
+    Uint64 naiveSize = 0;
+    for (const RGTransientAllocation& allocation : allocations)
+    {
+        naiveSize += allocation.size;
+        EXPECT_EQ(allocation.offset % allocation.alignment, 0u);
+        EXPECT_LE(allocation.offset + allocation.size, totalSize);
+    }
+    EXPECT_GE(totalSize, peakAliveSize);
+    EXPECT_LT(totalSize, naiveSize);
+
+    for (const RGTransientAllocation& current : allocations)
+    {
+        int numAliasedResources = 0;
+        int aliasedResourceIndex = -1;
+        for (const RGTransientAllocation& other : allocations)
+        {
+            if (&current == &other)
+            {
+                continue;
+            }
+
+            const bool isLifetimeOverlap = current.beginPass <= other.endPass && other.beginPass <= current.endPass;
+            const bool isMemoryOverlap = current.offset < other.offset + other.size && other.offset < current.offset + current.size;
+            EXPECT_FALSE(isLifetimeOverlap && isMemoryOverlap) << "Resource " << current.rgResourceIndex << " and " << other.rgResourceIndex << " are alive in the same memory.";
+
+            if (isMemoryOverlap && other.endPass < current.beginPass)
+            {
+                numAliasedResources++;
+                aliasedResourceIndex = other.rgResourceIndex;
+            }
+        }
+
+        EXPECT_EQ(current.needAliasingBarrier, numAliasedResources > 0);
+        EXPECT_EQ(current.aliasedResourceIndex, (numAliasedResources == 1) ? aliasedResourceIndex : -1);
+    }
+}
+
+// ===== Pass culling =====
+
+TEST(RenderGraphTest, CullPassWritingDeadTransient)
+{
+    InitializeThreadFrameAllocator();
+
+    MockGAPI gapi;
+    RGTextureStateCache textureStateCache;
+    SharedPtr<gapi::CommandList> commandList = gapi.CreateCommandList({});
+
+    RGBuilder builder(gapi, textureStateCache);
+    RGTextureUAVHandle dead = builder.CreateUAV(builder.CreateTexture(MakeTextureInfo(gapi::TextureFlag::UAV), CUBE_T("Dead")));
+    RGTextureUAVHandle registered = builder.CreateUAV(builder.RegisterTexture(CreateRegisteredTexture(gapi, gapi::TextureFlag::UAV, CUBE_T("Registered"))));
+    builder.AddPass(CUBE_NAME("WriteDead"), DispatchPass, [dead](RGBuilder& builder) { builder.UseResource(dead); });
+    builder.AddPass(CUBE_NAME("WriteRegistered"), DispatchPass, [registered](RGBuilder& builder) { builder.UseResource(registered); });
+    builder.ExecuteAndSubmit(*commandList);
+
+    EXPECT_EQ(builder.GetStats().numPasses, 2u);
+    EXPECT_EQ(builder.GetStats().numCulledPasses, 1u);
+    // The dead transient texture is not created either.
+    EXPECT_EQ(builder.GetStats().numTransientResources, 0u);
+    EXPECT_FALSE(HasCommand(gapi.submittedCommands, CUBE_T("BeginEvent WriteDead")));
+    EXPECT_TRUE(HasCommand(gapi.submittedCommands, CUBE_T("BeginEvent WriteRegistered")));
+}
+
+TEST(RenderGraphTest, KeepPassWritingOutput)
+{
+    InitializeThreadFrameAllocator();
+
+    MockGAPI gapi;
+    RGTextureStateCache textureStateCache;
+    SharedPtr<gapi::CommandList> commandList = gapi.CreateCommandList({});
+
+    RGBuilder builder(gapi, textureStateCache);
+    RGTextureHandle temp = builder.CreateTexture(MakeTextureInfo(gapi::TextureFlag::UAV), CUBE_T("Temp"));
+    RGTextureHandle result = builder.CreateTexture(MakeTextureInfo(gapi::TextureFlag::UAV), CUBE_T("Result"));
+    builder.MarkAsOutput(result);
+    RGTextureUAVHandle tempUAV = builder.CreateUAV(temp);
+    RGTextureSRVHandle tempSRV = builder.CreateSRV(temp);
+    RGTextureUAVHandle resultUAV = builder.CreateUAV(result);
+    builder.AddPass(CUBE_NAME("WriteTemp"), DispatchPass, [tempUAV](RGBuilder& builder) { builder.UseResource(tempUAV); });
+    builder.AddPass(CUBE_NAME("WriteResult"), DispatchPass, [tempSRV, resultUAV](RGBuilder& builder)
+    {
+        builder.UseResource(tempSRV);
+        builder.UseResource(resultUAV);
+    });
+    builder.ExecuteAndSubmit(*commandList);
+
+    // The output keeps its writer, and the writer keeps the producer of its input.
+    EXPECT_EQ(builder.GetStats().numCulledPasses, 0u);
+    EXPECT_EQ(builder.GetStats().numTransientResources, 2u);
+    EXPECT_TRUE(HasCommand(gapi.submittedCommands, CUBE_T("BeginEvent WriteTemp")));
+    EXPECT_TRUE(HasCommand(gapi.submittedCommands, CUBE_T("BeginEvent WriteResult")));
+}
+
+TEST(RenderGraphTest, CullRenderPassAsWhole)
+{
+    InitializeThreadFrameAllocator();
+
+    MockGAPI gapi;
+    RGTextureStateCache textureStateCache;
+    SharedPtr<gapi::CommandList> commandList = gapi.CreateCommandList({});
+
+    RGBuilder builder(gapi, textureStateCache);
+    RGTextureRTVHandle dead = builder.CreateRTV(builder.CreateTexture(MakeTextureInfo(gapi::TextureFlag::RenderTarget), CUBE_T("Dead")));
+    RGTextureRTVHandle registered = builder.CreateRTV(builder.RegisterTexture(CreateRegisteredTexture(gapi, gapi::TextureFlag::RenderTarget, CUBE_T("Registered"))));
+
+    // The pass without any write is culled with the render pass writing only the dead texture.
+    builder.BeginRenderPass({ .colors = { { .color = dead } } });
+    builder.AddPass(CUBE_NAME("DrawDead"), [](gapi::CommandList& commandList) { commandList.Draw(3, 0); });
+    builder.EndRenderPass();
+
+    builder.BeginRenderPass({ .colors = { { .color = registered } } });
+    builder.AddPass(CUBE_NAME("DrawRegistered"), [](gapi::CommandList& commandList) { commandList.Draw(3, 0); });
+    builder.EndRenderPass();
+    builder.ExecuteAndSubmit(*commandList);
+
+    // Culled: ##BeginRenderPass, DrawDead, ##EndRenderPass
+    EXPECT_EQ(builder.GetStats().numPasses, 6u);
+    EXPECT_EQ(builder.GetStats().numCulledPasses, 3u);
+    EXPECT_EQ(builder.GetStats().numTransientResources, 0u);
+    EXPECT_FALSE(HasCommand(gapi.submittedCommands, CUBE_T("BeginEvent DrawDead")));
+    EXPECT_TRUE(HasCommand(gapi.submittedCommands, CUBE_T("BeginEvent DrawRegistered")));
+    EXPECT_EQ(CountCommands(gapi.submittedCommands, CUBE_T("BeginRenderPass")), 1);
+    EXPECT_EQ(CountCommands(gapi.submittedCommands, CUBE_T("EndRenderPass")), 1);
+}
+
+TEST(RenderGraphTest, KeepPassWithoutWrite)
+{
+    InitializeThreadFrameAllocator();
+
+    MockGAPI gapi;
+    RGTextureStateCache textureStateCache;
+    SharedPtr<gapi::CommandList> commandList = gapi.CreateCommandList({});
+
+    RGBuilder builder(gapi, textureStateCache);
+    RGTextureHandle temp = builder.CreateTexture(MakeTextureInfo(gapi::TextureFlag::UAV), CUBE_T("Temp"));
+    RGTextureUAVHandle tempUAV = builder.CreateUAV(temp);
+    RGTextureSRVHandle tempSRV = builder.CreateSRV(temp);
+    builder.AddPass(CUBE_NAME("WriteTemp"), DispatchPass, [tempUAV](RGBuilder& builder) { builder.UseResource(tempUAV); });
+    // The side effects of the passes only reading or using nothing are unknown, so they are kept with their inputs.
+    builder.AddPass(CUBE_NAME("ReadTemp"), DispatchPass, [tempSRV](RGBuilder& builder) { builder.UseResource(tempSRV); });
+    builder.AddPass(CUBE_NAME("NoResource"), DispatchPass);
+    builder.ExecuteAndSubmit(*commandList);
+
+    EXPECT_EQ(builder.GetStats().numCulledPasses, 0u);
+    EXPECT_TRUE(HasCommand(gapi.submittedCommands, CUBE_T("BeginEvent WriteTemp")));
+    EXPECT_TRUE(HasCommand(gapi.submittedCommands, CUBE_T("BeginEvent ReadTemp")));
+    EXPECT_TRUE(HasCommand(gapi.submittedCommands, CUBE_T("BeginEvent NoResource")));
+}
+
+// ===== Transitions =====
+
+TEST(RenderGraphTest, SubresourceStatesSplitAndMerge)
+{
+    InitializeThreadFrameAllocator();
+
+    MockGAPI gapi;
+    RGTextureStateCache textureStateCache;
+    SharedPtr<gapi::CommandList> commandList = gapi.CreateCommandList({});
+
+    constexpr Uint32 numMipLevels = 4;
+    RGBuilder builder(gapi, textureStateCache);
+    RGTextureHandle mips = builder.RegisterTexture(CreateRegisteredTexture(gapi, gapi::TextureFlag::UAV, CUBE_T("Mips"), numMipLevels));
+    builder.AddPass(CUBE_NAME("Clear"), DispatchPass, [mips](RGBuilder& builder) { builder.UseResource(mips, {}, gapi::ResourceStateFlag::CopyDst); });
+    // Generate the mips. The states of the mips diverge.
+    for (Uint32 mipLevel = 1; mipLevel < numMipLevels; ++mipLevel)
+    {
+        RGTextureSRVHandle src = builder.CreateSRV(mips, { .subresourceRange = { .firstMipLevel = mipLevel - 1, .mipLevels = 1 } });
+        RGTextureUAVHandle dst = builder.CreateUAV(mips, { .subresourceRange = { .firstMipLevel = mipLevel } });
+        builder.AddPass(CUBE_NAME("Downsample"), DispatchPass, [src, dst](RGBuilder& builder)
+        {
+            builder.UseResource(src);
+            builder.UseResource(dst);
+        });
+    }
+    // Only the last mip is not readable yet. All mips are in the same state after it.
+    RGTextureSRVHandle all = builder.CreateSRV(mips);
+    builder.AddPass(CUBE_NAME("ReadAll"), DispatchPass, [all](RGBuilder& builder) { builder.UseResource(all); });
+    builder.AddPass(CUBE_NAME("CopyAll"), DispatchPass, [mips](RGBuilder& builder) { builder.UseResource(mips, {}, gapi::ResourceStateFlag::CopyDst); });
+    builder.ExecuteAndSubmit(*commandList);
+
+    auto MakeTransition = [](const Character* subresource, gapi::ResourceStateFlags src, gapi::ResourceStateFlags dst)
+    {
+        return Format<String>(CUBE_T("Transition Mips {0} {1}->{2}"), subresource, src.GetBits(), dst.GetBits());
+    };
+    const gapi::ResourceStateFlags common = gapi::ResourceStateFlag::Common;
+    const gapi::ResourceStateFlags copyDst = gapi::ResourceStateFlag::CopyDst;
+    const gapi::ResourceStateFlags uav = gapi::ResourceStateFlag::UAV;
+    const gapi::ResourceStateFlags srv = gapi::ResourceStateFlag::SRV_Pixel | gapi::ResourceStateFlag::SRV_NonPixel;
+    const Vector<String> expected = {
+        MakeTransition(CUBE_T("Mip0+4,Slice0+1"), common, copyDst),
+        MakeTransition(CUBE_T("Mip0+1,Slice0+1"), copyDst, srv),
+        MakeTransition(CUBE_T("Mip1+1,Slice0+1"), copyDst, uav),
+        MakeTransition(CUBE_T("Mip1+1,Slice0+1"), uav, srv),
+        MakeTransition(CUBE_T("Mip2+1,Slice0+1"), copyDst, uav),
+        MakeTransition(CUBE_T("Mip2+1,Slice0+1"), uav, srv),
+        MakeTransition(CUBE_T("Mip3+1,Slice0+1"), copyDst, uav),
+        // Only the subresource in the different state is transitioned.
+        MakeTransition(CUBE_T("Sub3"), uav, srv),
+        // Merged back, so the whole texture is transitioned at once.
+        MakeTransition(CUBE_T("Mip0+4,Slice0+1"), srv, copyDst),
+        MakeTransition(CUBE_T("Mip0+4,Slice0+1"), copyDst, common)
+    };
+    EXPECT_EQ(FilterCommands(gapi.submittedCommands, CUBE_T("Transition")), expected);
+    EXPECT_EQ(builder.GetStats().numTransitions, expected.size());
+}
+
+TEST(RenderGraphTest, CollapseSubresourceTransitions)
+{
+    InitializeThreadFrameAllocator();
+
+    MockGAPI gapi;
+    RGTextureStateCache textureStateCache;
+    SharedPtr<gapi::CommandList> commandList = gapi.CreateCommandList({});
+
+    // 4 mips x 3 slices
+    RGBuilder builder(gapi, textureStateCache);
+    RGTextureHandle array = builder.RegisterTexture(CreateRegisteredTexture(gapi, gapi::TextureFlag::UAV, CUBE_T("Array"), 4, 3));
+    builder.AddPass(CUBE_NAME("WriteMips"), DispatchPass, [array](RGBuilder& builder) { builder.UseResource(array, { .firstMipLevel = 1 }, gapi::ResourceStateFlag::UAV); });
+    // Mip 0 and the other mips are in the different states in every slice.
+    builder.AddPass(CUBE_NAME("ReadAll"), DispatchPass, [array](RGBuilder& builder) { builder.UseResource(array, {}, gapi::ResourceStateFlag::SRV_NonPixel); });
+    builder.AddPass(CUBE_NAME("WriteFirstSlices"), DispatchPass, [array](RGBuilder& builder) { builder.UseResource(array, { .mipLevels = 1, .sliceSize = 2 }, gapi::ResourceStateFlag::UAV); });
+    builder.ExecuteAndSubmit(*commandList);
+
+    auto MakeTransition = [](const Character* subresource, gapi::ResourceStateFlags src, gapi::ResourceStateFlags dst)
+    {
+        return Format<String>(CUBE_T("Transition Array {0} {1}->{2}"), subresource, src.GetBits(), dst.GetBits());
+    };
+    const gapi::ResourceStateFlags common = gapi::ResourceStateFlag::Common;
+    const gapi::ResourceStateFlags uav = gapi::ResourceStateFlag::UAV;
+    const gapi::ResourceStateFlags srv = gapi::ResourceStateFlag::SRV_Pixel | gapi::ResourceStateFlag::SRV_NonPixel;
+    const Vector<String> expected = {
+        MakeTransition(CUBE_T("Mip1+3,Slice0+3"), common, uav),
+        // One transition per run of the same states instead of one per subresource (12)
+        MakeTransition(CUBE_T("Mip0+1,Slice0+3"), common, srv),
+        MakeTransition(CUBE_T("Mip1+3,Slice0+3"), uav, srv),
+        MakeTransition(CUBE_T("Mip0+1,Slice0+2"), srv, uav),
+        // Rollback. The last slice has the different runs from the first slices.
+        MakeTransition(CUBE_T("Mip0+1,Slice0+2"), uav, common),
+        MakeTransition(CUBE_T("Mip1+3,Slice0+2"), srv, common),
+        MakeTransition(CUBE_T("Mip0+4,Slice2+1"), srv, common)
+    };
+    EXPECT_EQ(FilterCommands(gapi.submittedCommands, CUBE_T("Transition")), expected);
+    EXPECT_EQ(CountCommands(gapi.submittedCommands, CUBE_T("Transition")), 7);
+    EXPECT_EQ(builder.GetStats().numTransitions, 7u);
+}
+
+// ===== Compile cache =====
+
+TEST(RenderGraphTest, CompileCacheMissesOnBufferUsageChange)
+{
+    InitializeThreadFrameAllocator();
+
+    MockGAPI gapi;
+    RGTextureStateCache textureStateCache;
+    RGCommandListPool commandListPool;
+    commandListPool.Initialize(gapi);
+    RGCompileCache compileCache;
+
+    auto CreateBuffer = [&gapi](gapi::ResourceUsage usage)
+    {
+        return gapi.CreateBuffer({
+            .usage = usage,
+            .bufferInfo = MakeBufferInfo(256),
+            .debugName = CUBE_T("Buffer")
+        });
+    };
+    auto ExecuteFrame = [&](SharedPtr<gapi::Buffer> buffer)
+    {
+        RGBuilder builder(gapi, textureStateCache);
+        RGBufferSRVHandle srv = builder.CreateSRV(builder.RegisterBuffer(buffer));
+        builder.AddPass(CUBE_NAME("Read"), DispatchPass, [srv](RGBuilder& builder) { builder.UseResource(srv); });
+        builder.ExecuteAndSubmit(commandListPool, nullptr, &compileCache);
+
+        return builder.GetStats();
+    };
+
+    // Same structure with the different buffers
+    EXPECT_FALSE(ExecuteFrame(CreateBuffer(gapi::ResourceUsage::GPUOnly)).isCompileCacheHit);
+    EXPECT_EQ(CountCommands(gapi.submittedCommands, CUBE_T("Transition Buffer")), 2);
+    EXPECT_TRUE(ExecuteFrame(CreateBuffer(gapi::ResourceUsage::GPUOnly)).isCompileCacheHit);
+
+    // Same infos but CPUtoGPU buffers are not transitioned, so the cached transitions cannot be used.
+    gapi.submittedCommands.clear();
+    EXPECT_FALSE(ExecuteFrame(CreateBuffer(gapi::ResourceUsage::CPUtoGPU)).isCompileCacheHit);
+    EXPECT_EQ(CountCommands(gapi.submittedCommands, CUBE_T("Transition Buffer")), 0);
+    EXPECT_TRUE(ExecuteFrame(CreateBuffer(gapi::ResourceUsage::CPUtoGPU)).isCompileCacheHit);
+    EXPECT_EQ(CountCommands(gapi.submittedCommands, CUBE_T("Transition Buffer")), 0);
+
+    EXPECT_EQ(compileCache.GetNumLookups(), 4u);
+    EXPECT_EQ(compileCache.GetNumHits(), 2u);
+
+    commandListPool.Shutdown();
+}
+
+// ===== Dump =====
+
+static AnsiString ReadSnapshot(const char* fileName)
+{
+    std::ifstream file(AnsiString(CUBE_TESTS_SNAPSHOT_DIR) + "/" + fileName, std::ios::binary);
+    EXPECT_TRUE(file.is_open()) << "Cannot open the snapshot " << fileName;
+
+    std::stringstream stream;
+    stream << file.rdbuf();
+    return stream.str();
+}
+
+TEST(RenderGraphTest, DumpMatchesSnapshot)
+{
+    InitializeThreadFrameAllocator();
+
+    MockGAPI gapi;
+    RGTextureStateCache textureStateCache;
+    SharedPtr<gapi::CommandList> commandList = gapi.CreateCommandList({});
+
+    RGBuilder builder(gapi, textureStateCache);
+    RGTextureHandle output = builder.RegisterTexture(CreateRegisteredTexture(gapi, gapi::TextureFlag::UAV, CUBE_T("Output")));
+    RGTextureHandle temp = builder.CreateTexture(MakeTextureInfo(gapi::TextureFlag::UAV, 64, 64), CUBE_T("Temp"));
+    RGBufferHandle buffer = builder.CreateBuffer(MakeBufferInfo(1024), CUBE_T("Buffer"));
+    RGTextureHandle dead = builder.CreateTexture(MakeTextureInfo(gapi::TextureFlag::UAV, 64, 64), CUBE_T("Dead"));
+    RGTextureUAVHandle tempUAV = builder.CreateUAV(temp);
+    RGTextureSRVHandle tempSRV = builder.CreateSRV(temp);
+    RGBufferUAVHandle bufferUAV = builder.CreateUAV(buffer);
+    RGTextureUAVHandle deadUAV = builder.CreateUAV(dead);
+    RGTextureUAVHandle outputUAV = builder.CreateUAV(output);
+    builder.AddPass(CUBE_NAME("WriteTemp"), DispatchPass, [tempUAV, bufferUAV](RGBuilder& builder)
+    {
+        builder.UseResource(tempUAV);
+        builder.UseResource(bufferUAV);
+    });
+    builder.AddPass(CUBE_NAME("WriteDead"), DispatchPass, [deadUAV](RGBuilder& builder) { builder.UseResource(deadUAV); });
+    builder.AddPass(CUBE_NAME("Resolve"), DispatchPass, [tempSRV, outputUAV](RGBuilder& builder)
+    {
+        builder.UseResource(tempSRV);
+        builder.UseResource(outputUAV);
+    });
+
+    AnsiString json;
+    AnsiString dot;
+    builder.RequestDump(&json, &dot);
+    builder.ExecuteAndSubmit(*commandList);
+
+    // The record times are measured in every run.
+    json = std::regex_replace(json, std::regex("\"recordTimeUs\": [0-9.]+"), "\"recordTimeUs\": 0");
+    dot = std::regex_replace(dot, std::regex("cpu: [0-9.]+ us"), "cpu: 0 us");
+
+    EXPECT_EQ(json, ReadSnapshot("RenderGraphDump.json"));
+    EXPECT_EQ(dot, ReadSnapshot("RenderGraphDump.dot"));
+}
+
+// ===== Async compute =====
+
+static void ExpectSyncPoint(const RGAsyncComputeSyncPoint& syncPoint, gapi::CommandListType waitingQueue, int signalPass, int waitPass)
+{
+    EXPECT_EQ(syncPoint.waitingQueue, waitingQueue);
+    EXPECT_EQ(syncPoint.signalPass, signalPass);
+    EXPECT_EQ(syncPoint.waitPass, waitPass);
+}
+
+TEST(RenderGraphTest, AsyncComputeProducerConsumedByGraphics)
+{
+    InitializeThreadFrameAllocator();
+
+    const Vector<int> resources0 = { 0 };
+    const Vector<int> resources1 = { 1 };
+    const Vector<int> resources2 = { 2 };
+    const Vector<RGAsyncComputePassInfo> passes = {
+        // No graphics pass before it to overlap with, so it stays in the graphics queue.
+        { .requestsAsyncCompute = true, .resources = resources0 },
+        // Producer of the resource 1
+        { .requestsAsyncCompute = true, .resources = resources1 },
+        { .resources = resources2 },
+        // Consumer of the resource 1
+        { .resources = resources1 }
+    };
+
+    RGAsyncComputePlan plan;
+    ScheduleAsyncCompute(passes, plan);
+
+    EXPECT_EQ(plan.isAsyncCompute, Vector<bool>({ false, true, false, false }));
+    EXPECT_EQ(plan.GetNumAsyncComputePasses(), 1u);
+    ASSERT_EQ(plan.syncPoints.size(), 2u);
+    // The producer waits for the last graphics pass before it, and the consumer waits for the producer.
+    ExpectSyncPoint(plan.syncPoints[0], gapi::CommandListType::Compute, 0, 1);
+    ExpectSyncPoint(plan.syncPoints[1], gapi::CommandListType::Graphics, 1, 3);
+
+    // The wait cannot be placed before a pass which continues the previous pass, so it is moved to the previous graphics pass.
+    Vector<RGAsyncComputePassInfo> continuedPasses = passes;
+    continuedPasses[3].canBeginSegment = false;
+    ScheduleAsyncCompute(continuedPasses, plan);
+
+    ASSERT_EQ(plan.syncPoints.size(), 2u);
+    ExpectSyncPoint(plan.syncPoints[1], gapi::CommandListType::Graphics, 1, 2);
+}
+
+TEST(RenderGraphTest, AsyncComputeBackToBackChain)
+{
+    InitializeThreadFrameAllocator();
+
+    const Vector<int> resources0 = { 0 };
+    const Vector<int> resources1 = { 1 };
+    const Vector<int> resources12 = { 1, 2 };
+    const Vector<int> resources2 = { 2 };
+    const Vector<int> resources3 = { 3 };
+    const Vector<RGAsyncComputePassInfo> passes = {
+        { .resources = resources0 },
+        // Chain of the compute passes. The second one consumes the first one in the compute queue.
+        { .requestsAsyncCompute = true, .resources = resources1 },
+        { .requestsAsyncCompute = true, .resources = resources12 },
+        { .resources = resources3 },
+        // Consumer of the last compute pass
+        { .resources = resources2 },
+        // Culled pass does not make the wait.
+        { .isCulled = true, .resources = resources1 }
+    };
+
+    RGAsyncComputePlan plan;
+    ScheduleAsyncCompute(passes, plan);
+
+    EXPECT_EQ(plan.isAsyncCompute, Vector<bool>({ false, true, true, false, false, false }));
+    EXPECT_EQ(plan.GetNumAsyncComputePasses(), 2u);
+    // The compute queue waits once for the chain, and the graphics queue waits once for the last pass of it.
+    // The wait for the first compute pass at the end of the graph is covered by it.
+    ASSERT_EQ(plan.syncPoints.size(), 2u);
+    ExpectSyncPoint(plan.syncPoints[0], gapi::CommandListType::Compute, 0, 1);
+    ExpectSyncPoint(plan.syncPoints[1], gapi::CommandListType::Graphics, 2, 4);
+}
+
+// ===== Mesh draw grouping =====
+
+static void ExpectDrawMeshGroup(const RGDrawMeshGroup& group, Uint32 firstDrawIndex, Uint32 instanceOffset, Uint32 numInstances)
+{
+    EXPECT_EQ(group.firstDrawIndex, firstDrawIndex);
+    EXPECT_EQ(group.instanceOffset, instanceOffset);
+    EXPECT_EQ(group.numInstances, numInstances);
+}
+
+TEST(RenderGraphTest, GroupDrawMeshesIntoInstances)
+{
+    InitializeThreadFrameAllocator();
+
+    // Only the identities are compared, so the addresses of the placeholders are used as the meshes and the materials.
+    Uint64 placeholders[4];
+    const Mesh* meshA = reinterpret_cast<const Mesh*>(&placeholders[0]);
+    const Mesh* meshB = reinterpret_cast<const Mesh*>(&placeholders[1]);
+    const Material* materialA = reinterpret_cast<const Material*>(&placeholders[2]);
+    const Material* materialB = reinterpret_cast<const Material*>(&placeholders[3]);
+
+    const Vector<const Material*> materialsAB = { materialA, materialB };
+    // Same materials in another array
+    const Vector<const Material*> otherMaterialsAB = { materialA, materialB };
+    const Vector<const Material*> materialsBA = { materialB, materialA };
+    const gapi::RasterizerState lineRasterizerState = { .fillMode = gapi::RasterizerState::FillMode::Line };
+
+    const Vector<RGDrawMeshGroupingInfo> draws = {
+        { .mesh = meshA, .materials = materialsAB },
+        { .mesh = meshB, .materials = materialsAB },
+        { .mesh = meshA, .materials = otherMaterialsAB },
+        // Different order of the sub mesh materials
+        { .mesh = meshA, .materials = materialsBA },
+        { .mesh = meshA, .rasterizerState = lineRasterizerState, .materials = materialsAB },
+        { .mesh = meshA, .materials = materialsAB },
+        { .mesh = meshB, .materials = materialsAB }
+    };
+
+    FrameVector<RGDrawMeshGroup> groups;
+    FrameVector<Uint32> instanceIndices;
+    GroupDrawMeshes(draws, groups, instanceIndices);
+
+    // The groups are in the order of their first draws, and their instances are contiguous.
+    ASSERT_EQ(groups.size(), 4u);
+    ExpectDrawMeshGroup(groups[0], 0, 0, 3);
+    ExpectDrawMeshGroup(groups[1], 1, 3, 2);
+    ExpectDrawMeshGroup(groups[2], 3, 5, 1);
+    ExpectDrawMeshGroup(groups[3], 4, 6, 1);
+    EXPECT_EQ(Vector<Uint32>(instanceIndices.begin(), instanceIndices.end()), Vector<Uint32>({ 0, 3, 1, 5, 6, 2, 4 }));
+
+    GroupDrawMeshes({}, groups, instanceIndices);
+    EXPECT_TRUE(groups.empty());
+    EXPECT_TRUE(instanceIndices.empty());
+}
+
+// ===== Parallel recording =====
+
+// Build the same graph and record it with the command list pool.
+// Returns the submitted commands without the ones added per segment (Begin / End, timestamps, queue waits, submits).
+static Vector<String> RecordGraphWithPool(JobSystem* jobSystem, RGBuilderStats& outStats)
+{
+    MockGAPI gapi;
+    RGTextureStateCache textureStateCache;
+    RGCommandListPool commandListPool;
+    commandListPool.Initialize(gapi);
+
+    SharedPtr<gapi::Texture> output = CreateRegisteredTexture(gapi, gapi::TextureFlag::UAV, CUBE_T("Output"), 4);
+    {
+        RGBuilder builder(gapi, textureStateCache);
+        RGTextureHandle rgOutput = builder.RegisterTexture(output);
+        // Each transient texture is written and read by two passes, so the later ones alias the earlier ones.
+        for (Uint32 i = 0; i < 256; i += 2)
+        {
+            RGTextureHandle temp = builder.CreateTexture(MakeTextureInfo(gapi::TextureFlag::UAV), Format<String>(CUBE_T("Temp{0}"), i / 2));
+            builder.AddPass(CUBE_NAME("WriteTemp"), [i](gapi::CommandList& commandList) { commandList.DispatchThreads(i, 1, 1); },
+                [temp, rgOutput, i](RGBuilder& builder)
+                {
+                    builder.UseResource(temp, {}, gapi::ResourceStateFlag::UAV);
+                    builder.UseResource(rgOutput, { .firstMipLevel = i % 4, .mipLevels = 1 }, gapi::ResourceStateFlag::SRV_NonPixel);
+                });
+            builder.AddPass(CUBE_NAME("ReadTemp"), [i](gapi::CommandList& commandList) { commandList.DispatchThreads(i + 1, 1, 1); },
+                [temp, rgOutput, i](RGBuilder& builder)
+                {
+                    builder.UseResource(temp, {}, gapi::ResourceStateFlag::SRV_NonPixel);
+                    builder.UseResource(rgOutput, { .firstMipLevel = i % 4, .mipLevels = 1 }, gapi::ResourceStateFlag::UAV);
+                });
+        }
+        builder.ExecuteAndSubmit(commandListPool, jobSystem, nullptr);
+        outStats = builder.GetStats();
+    }
+    commandListPool.Shutdown();
+
+    Vector<String> commands;
+    for (const String& command : gapi.submittedCommands)
+    {
+        const StringView commandView = command;
+        if (commandView == CUBE_T("Begin") || commandView == CUBE_T("End") || commandView == CUBE_T("Submit") || commandView == CUBE_T("EndTimestamp")
+            || commandView.starts_with(CUBE_T("BeginTimestamp")) || commandView.starts_with(CUBE_T("WaitQueue")))
+        {
+            continue;
+        }
+        commands.push_back(command);
+    }
+    return commands;
+}
+
+TEST(RenderGraphTest, ParallelRecordingMatchesSerial)
+{
+    InitializeThreadFrameAllocator();
+
+    RGBuilderStats serialStats;
+    const Vector<String> serialCommands = RecordGraphWithPool(nullptr, serialStats);
+    EXPECT_EQ(serialStats.numRecordingSegments, 1u);
+
+    JobSystem jobSystem;
+    jobSystem.Initialize({
+        .numWorkerThreads = 3,
+        .onWorkerThreadBegin = [](Uint32 workerIndex) { GetMyThreadFrameAllocator().Initialize("Render graph test worker frame allocator"); },
+        .onWorkerThreadEnd = [](Uint32 workerIndex) { GetMyThreadFrameAllocator().Shutdown(); }
+    });
+    RGBuilderStats parallelStats;
+    const Vector<String> parallelCommands = RecordGraphWithPool(&jobSystem, parallelStats);
+    jobSystem.Shutdown();
+
+    EXPECT_GT(parallelStats.numRecordingSegments, 1u);
+    EXPECT_EQ(parallelStats.numTransitions, serialStats.numTransitions);
+    EXPECT_EQ(parallelStats.numAliasingBarriers, serialStats.numAliasingBarriers);
+    // Same passes and barriers in the same order
+    EXPECT_EQ(CountCommands(serialCommands, CUBE_T("DispatchThreads")), 256);
+    EXPECT_GT(CountCommands(serialCommands, CUBE_T("Aliasing")), 0);
+    EXPECT_EQ(parallelCommands, serialCommands);
+}
+
+// ===== Resource cast =====
+
+TEST(RenderGraphTest, CastByResourceKind)
+{
+    InitializeThreadFrameAllocator();
+
+    MockGAPI gapi;
+    RGTextureStateCache textureStateCache;
+
+    RGBuilder builder(gapi, textureStateCache);
+    RGTextureHandle texture = builder.CreateTexture(MakeTextureInfo(gapi::TextureFlag::UAV), CUBE_T("Texture"));
+    RGBufferHandle buffer = builder.CreateBuffer(MakeBufferInfo(256), CUBE_T("Buffer"));
+    const RGResourceHandle textureResource = texture;
+    const RGResourceHandle srvResource = builder.CreateSRV(texture);
+    const RGResourceHandle uavResource = builder.CreateUAV(texture);
+    const RGResourceHandle bufferResource = buffer;
+    const RGResourceHandle bufferUAVResource = builder.CreateUAV(buffer);
+
+    // Matching kinds, including the base classes of the views
+    EXPECT_EQ(textureResource.Cast<RGTexture>(), texture);
+    EXPECT_TRUE(srvResource.Cast<RGTextureSRV>().IsValid());
+    EXPECT_TRUE(srvResource.Cast<RGTextureView>().IsValid());
+    EXPECT_TRUE(uavResource.Cast<RGTextureView>().IsValid());
+    EXPECT_EQ(bufferResource.Cast<RGBuffer>(), buffer);
+    EXPECT_TRUE(bufferUAVResource.Cast<RGBufferView>().IsValid());
+    EXPECT_TRUE(textureResource.Cast<RGResource>().IsValid());
+
+    // Mismatched kinds
+    EXPECT_FALSE(textureResource.Cast<RGBuffer>().IsValid());
+    EXPECT_FALSE(textureResource.Cast<RGTextureView>().IsValid());
+    EXPECT_FALSE(srvResource.Cast<RGTextureUAV>().IsValid());
+    EXPECT_FALSE(srvResource.Cast<RGTexture>().IsValid());
+    EXPECT_FALSE(uavResource.Cast<RGTextureSRV>().IsValid());
+    EXPECT_FALSE(uavResource.Cast<RGBufferView>().IsValid());
+    EXPECT_FALSE(bufferResource.Cast<RGTexture>().IsValid());
+    EXPECT_FALSE(bufferUAVResource.Cast<RGBufferSRV>().IsValid());
+    EXPECT_FALSE(bufferUAVResource.Cast<RGTextureUAV>().IsValid());
+    EXPECT_FALSE(bufferUAVResource.Cast<RGShaderParameterListBase>().IsValid());
+
+    // Invalid handle
+    EXPECT_FALSE(RGResourceHandle().Cast<RGTexture>().IsValid());
+}
+
+// ===== Heap allocations =====
+
+TEST(RenderGraphTest, NoHeapAllocationInSteadyStateFrame)
+{
+    InitializeThreadFrameAllocator();
+
+    MockGAPI gapi;
+    // The mock command list records the strings in the heap.
+    gapi.recordCommands = false;
+    RGTextureStateCache textureStateCache;
+    SharedPtr<gapi::CommandList> commandList = gapi.CreateCommandList({});
+    SharedPtr<gapi::Texture> textureA = CreateRegisteredTexture(gapi, gapi::TextureFlag::UAV, CUBE_T("A"));
+    SharedPtr<gapi::Texture> textureB = CreateRegisteredTexture(gapi, gapi::TextureFlag::UAV, CUBE_T("B"));
+
+    // GAPI views and transient resources are created in the heap by GAPI, so only the registered textures are used.
+    constexpr int NUM_PASSES = 10000;
+    auto BuildAndExecuteFrame = [&]()
+    {
+        RGBuilder builder(gapi, textureStateCache);
+        RGTextureHandle a = builder.RegisterTexture(textureA);
+        RGTextureHandle b = builder.RegisterTexture(textureB);
+        for (int i = 0; i < NUM_PASSES; i += 2)
+        {
+            // Swap the written and the read texture in every pass to make the transitions.
+            builder.AddPass(CUBE_NAME("WriteA"), DispatchPass, [a, b](RGBuilder& builder)
+            {
+                builder.UseResource(a, {}, gapi::ResourceStateFlag::UAV);
+                builder.UseResource(b, {}, gapi::ResourceStateFlag::SRV_NonPixel);
+            });
+            builder.AddPass(CUBE_NAME("WriteB"), DispatchPass, [a, b](RGBuilder& builder)
+            {
+                builder.UseResource(a, {}, gapi::ResourceStateFlag::SRV_NonPixel);
+                builder.UseResource(b, {}, gapi::ResourceStateFlag::UAV);
+            });
+        }
+        builder.ExecuteAndSubmit(*commandList);
+    };
+
+    // The first frame fills the texture state cache and grows the block of the frame allocator.
+    BuildAndExecuteFrame();
+    GetMyThreadFrameAllocator().DiscardAllocations();
+
+    ScopedHeapAllocationCounter counter;
+    BuildAndExecuteFrame();
+    GetMyThreadFrameAllocator().DiscardAllocations();
+    EXPECT_EQ(counter.GetNumAllocations(), 0u);
+}
@@ -0,0 +1,346 @@
+#pragma once
+
+#include "Allocator/FrameAllocator.h"
+#include "Format.h"
+#include "GAPI.h"
+#include "GAPI_Buffer.h"
+#include "GAPI_CommandList.h"
+#include "GAPI_ShaderParameter.h"
+#include "GAPI_Texture.h"
+#include "Logger.h"
+#include "Renderer/RenderGraph.h"
+
+namespace cube
+{
+    // ===== Mock GAPI =====
+    // GAPI without the device to run RGBuilder in the tests.
+    // The resources only keep their infos, and the command lists record each command as a string.
+
+    class MockGAPI;
+
+    class MockBuffer : public gapi::Buffer, public std::enable_shared_from_this<MockBuffer>
+    {
+    public:
+        MockBuffer(const gapi::BufferCreateInfo& info) :
+            gapi::Buffer(info)
+        {
+            SetDebugName(info.debugName);
+        }
+
+        SharedPtr<gapi::BufferSRV> CreateSRV(const gapi::BufferSRVCreateInfo& createInfo) override { return std::make_shared<gapi::BufferSRV>(createInfo, shared_from_this()); }
+        SharedPtr<gapi::BufferUAV> CreateUAV(const gapi::BufferUAVCreateInfo& createInfo) override { return std::make_shared<gapi::BufferUAV>(createInfo, shared_from_this()); }
+
+        void* Map() override { return nullptr; }
+        void Unmap() override {}
+    };
+
+    class MockTexture : public gapi::Texture, public std::enable_shared_from_this<MockTexture>
+    {
+    public:
+        MockTexture(const gapi::TextureCreateInfo& createInfo) :
+            gapi::Texture(createInfo)
+        {
+            mSubresourceLayouts.resize(GetNumSlices() * mInfo.mipLevels, { .offset = 0, .rowPitch = 0 });
+        }
+
+        void* Map() override { return nullptr; }
+        void Unmap() override {}
+
+        SharedPtr<gapi::TextureSRV> CreateSRV(const gapi::TextureSRVCreateInfo& createInfo) override { return std::make_shared<gapi::TextureSRV>(createInfo, shared_from_this()); }
+        SharedPtr<gapi::TextureUAV> CreateUAV(const gapi::TextureUAVCreateInfo& createInfo) override { return std::make_shared<gapi::TextureUAV>(createInfo, shared_from_this()); }
+        SharedPtr<gapi::TextureRTV> CreateRTV(const gapi::TextureRTVCreateInfo& createInfo) override { return std::make_shared<gapi::TextureRTV>(createInfo, shared_from_this()); }
+        SharedPtr<gapi::TextureDSV> CreateDSV(const gapi::TextureDSVCreateInfo& createInfo) override { return std::make_shared<gapi::TextureDSV>(createInfo, shared_from_this()); }
+    };
+
+    class MockShaderParameterHelper : public gapi::ShaderParameterHelper
+    {
+    public:
+        void UpdateShaderParameterListInfo(ShaderParameterListInfo& inOutParameterListInfo) const override {}
+        void WriteParametersToGPUBuffer(SharedPtr<gapi::Buffer> buffer, const ShaderParameterListInfo& parameterListInfo, const void* pParameterList) const override {}
+
+        const Vector<Vector<gapi::ShaderParameterReflection::Type>>& GetCompatibleShaderParameterReflectionTypeMap() const override { return mCompatibleTypeMap; }
+
+    private:
+        Vector<Vector<gapi::ShaderParameterReflection::Type>> mCompatibleTypeMap;
+    };
+
+    // Commands are recorded as "<Command> <arguments>". Transitions are recorded as
+    // "Transition <debug name> <subresource> <src bits>-><dst bits>" with " Begin" / " End" for the split transitions.
+    class MockCommandList : public gapi::CommandList
+    {
+    public:
+        MockCommandList(const gapi::CommandListCreateInfo& info, MockGAPI& gapi) :
+            gapi::CommandList(info),
+            mGAPI(gapi)
+        {}
+
+        void Begin() override { Record(CUBE_T("Begin")); }
+        void End() override { Record(CUBE_T("End")); }
+        void Reset() override { mCommands.clear(); }
+
+        void BeginEvent(StringView name) override { Record(CUBE_T("BeginEvent {0}"), name); }
+        void EndEvent() override { Record(CUBE_T("EndEvent")); }
+
+        void SetViewports(ConstArrayView<gapi::Viewport> viewports) override { Record(CUBE_T("SetViewports")); }
+        void SetScissors(ConstArrayView<gapi::ScissorRect> scissors) override { Record(CUBE_T("SetScissors")); }
+        void SetPrimitiveTopology(gapi::PrimitiveTopology primitiveTopology) override { Record(CUBE_T("SetPrimitiveTopology")); }
+
+        void SetGraphicsPipeline(SharedPtr<gapi::GraphicsPipeline> graphicsPipeline) override { Record(CUBE_T("SetGraphicsPipeline")); }
+
+        void BeginRenderPass(ArrayView<const gapi::ColorAttachment> colors, gapi::DepthStencilAttachment depthStencil) override { Record(CUBE_T("BeginRenderPass {0}"), colors.size()); }
+        void EndRenderPass() override { Record(CUBE_T("EndRenderPass")); }
+
+        void BindIndexBuffer(SharedPtr<gapi::Buffer> buffer, Uint32 offset) override { Record(CUBE_T("BindIndexBuffer")); }
+
+        void Draw(Uint32 numVertices, Uint32 baseVertex, Uint32 numInstances, Uint32 baseInstance) override { Record(CUBE_T("Draw")); }
+        void DrawIndexed(Uint32 numIndices, Uint32 baseIndex, Uint32 baseVertex, Uint32 numInstances, Uint32 baseInstance) override { Record(CUBE_T("DrawIndexed")); }
+
+        void SetConstantBuffer(Uint32 index, SharedPtr<gapi::BufferSRV> constantBuffer) override { Record(CUBE_T("SetConstantBuffer")); }
+        void UseResource(SharedPtr<gapi::BufferSRV> srv) override {}
+        void UseResource(SharedPtr<gapi::BufferUAV> uav) override {}
+        void UseResource(SharedPtr<gapi::TextureSRV> srv) override {}
+        void UseResource(SharedPtr<gapi::TextureUAV> uav) override {}
+
+        void ResourceTransition(gapi::TransitionState state) override { RecordTransition(state); }
+        void ResourceTransition(ArrayView<const gapi::TransitionState> states) override
+        {
+            for (const gapi::TransitionState& state : states)
+            {
+                RecordTransition(state);
+            }
+        }
+        void AliasingBarrier(ArrayView<const gapi::AliasingState> states) override
+        {
+            for (const gapi::AliasingState& state : states)
+            {
+                Record(CUBE_T("Aliasing {0}"), state.textureAfter ? state.textureAfter->GetDebugName() : state.bufferAfter->GetDebugName());
+            }
+        }
+
+        void DiscardResource(SharedPtr<gapi::Texture> texture) override { Record(CUBE_T("Discard {0}"), texture->GetDebugName()); }
+
+        void SetComputePipeline(SharedPtr<gapi::ComputePipeline> computePipeline) override { Record(CUBE_T("SetComputePipeline")); }
+        void DispatchThreads(Uint32 numThreadsX, Uint32 numThreadsY, Uint32 numThreadsZ) override { Record(CUBE_T("DispatchThreads {0} {1} {2}"), numThreadsX, numThreadsY, numThreadsZ); }
+
+        void CopyTexture(SharedPtr<gapi::Texture> srcTexture, SharedPtr<gapi::Texture> dstTexture) override
+        {
+            Record(CUBE_T("CopyTexture {0} {1}"), srcTexture->GetDebugName(), dstTexture->GetDebugName());
+        }
+
+        void BeginTimestamp(StringView name) override { Record(CUBE_T("BeginTimestamp {0}"), name); }
+        void EndTimestamp() override { Record(CUBE_T("EndTimestamp")); }
+
+        void WaitQueue(gapi::CommandListType queueType, Uint64 fenceValue) override
+        {
+            Record(CUBE_T("WaitQueue {0} {1}"), queueType == gapi::CommandListType::Graphics ? CUBE_T("Graphics") : CUBE_T("Compute"), fenceValue);
+        }
+
+        Uint64 Submit(bool waitUntilFinished = false) override;
+
+    private:
+        bool IsRecording() const;
+
+        template <typename... Args>
+        void Record(StringView format, const Args&... args)
+        {
+            if (IsRecording())
+            {
+                mCommands.push_back(Format<String>(format, args...));
+            }
+        }
+
+        void RecordTransition(const gapi::TransitionState& state)
+        {
+            if (!IsRecording())
+            {
+                return;
+            }
+
+            const StringView debugName = (state.resourceType == gapi::TransitionState::ResourceType::Texture) ? state.texture->GetDebugName() : state.buffer->GetDebugName();
+            const String subresource = state.useSubresourceRange
+                ? Format<String>(CUBE_T("Mip{0}+{1},Slice{2}+{3}"), state.subresourceRange.firstMipLevel, state.subresourceRange.mipLevels, state.subresourceRange.firstSliceIndex, state.subresourceRange.sliceSize)
+                : Format<String>(CUBE_T("Sub{0}"), state.subresourceIndex);
+            const Character* split = CUBE_T("");
+            if (state.split == gapi::TransitionState::SplitType::Begin)
+            {
+                split = CUBE_T(" Begin");
+            }
+            else if (state.split == gapi::TransitionState::SplitType::End)
+            {
+                split = CUBE_T(" End");
+            }
+
+            Record(CUBE_T("Transition {0} {1} {2}->{3}{4}"), debugName, subresource, state.src.GetBits(), state.dst.GetBits(), split);
+        }
+
+        MockGAPI& mGAPI;
+        Vector<String> mCommands;
+    };
+
+    class MockGAPI : public GAPI
+    {
+    public:
+        // Transient allocations are aligned to it like the placed resources in DX12.
+        static constexpr Uint64 TRANSIENT_ALIGNMENT = 64 * 1024;
+
+        void Initialize(const GAPIInitInfo& initInfo) override {}
+        void Shutdown(const ImGUIContext& imGUIInfo) override {}
+
+        void SetNumGPUSync(Uint32 newNumGPUSync) override {}
+
+        void OnBeforeRender() override {}
+        void OnAfterRender() override {}
+        void OnBeforePresent(gapi::Texture* backbuffer) override {}
+        void OnAfterPresent() override {}
+
+        void BeginRenderingFrame() override {}
+        void EndRenderingFrame() override {}
+        void WaitAllGPUSync() override {}
+
+        const gapi::ShaderParameterHelper& GetShaderParameterHelper() const override { return mShaderParameterHelper; }
+
+        SharedPtr<gapi::Buffer> CreateBuffer(const gapi::BufferCreateInfo& info) override { return std::make_shared<MockBuffer>(info); }
+        SharedPtr<gapi::CommandList> CreateCommandList(const gapi::CommandListCreateInfo& info) override { return std::make_shared<MockCommandList>(info, *this); }
+        SharedPtr<gapi::Fence> CreateFence(const gapi::FenceCreateInfo& info) override { return nullptr; }
+        SharedPtr<gapi::GraphicsPipeline> CreateGraphicsPipeline(const gapi::GraphicsPipelineCreateInfo& info) override { return nullptr; }
+        SharedPtr<gapi::ComputePipeline> CreateComputePipeline(const gapi::ComputePipelineCreateInfo& info) override { return nullptr; }
+        SharedPtr<gapi::Sampler> CreateSampler(const gapi::SamplerCreateInfo& info) override { return nullptr; }
+        SharedPtr<gapi::Shader> CreateShader(const gapi::ShaderCreateInfo& info) override { return nullptr; }
+        SharedPtr<gapi::Texture> CreateTexture(const gapi::TextureCreateInfo& createInfo) override { return std::make_shared<MockTexture>(createInfo); }
+        SharedPtr<gapi::SwapChain> CreateSwapChain(const gapi::SwapChainCreateInfo& info) override { return nullptr; }
+
+        gapi::TransientAllocationInfo GetTransientAllocationInfo(const gapi::BufferInfo& info) override
+        {
+            return { .size = AlignTransientSize(info.size), .alignment = TRANSIENT_ALIGNMENT };
+        }
+        gapi::TransientAllocationInfo GetTransientAllocationInfo(const gapi::TextureInfo& info) override
+        {
+            // 4 bytes per texel in every mip level. Enough to compare the sizes in the tests.
+            const Uint64 size = static_cast<Uint64>(info.width) * info.height * info.depth * info.arraySize * info.mipLevels * 4;
+            return { .size = AlignTransientSize(size), .alignment = TRANSIENT_ALIGNMENT };
+        }
+        gapi::TransientMemory AllocateTransientMemory(Uint64 size, Uint64 alignment) override
+        {
+            transientMemorySizes.push_back(size);
+            return { .pHeap = &mTransientHeap, .offset = 0, .size = size };
+        }
+
+        gapi::TimestampRangeList GetLastTimestampRangeList() override { return {}; }
+        gapi::VRAMStatus GetVRAMUsage() override { return {}; }
+
+        // Commands of the submitted command lists in the submission order. Each submission ends with "Submit".
+        Vector<String> submittedCommands;
+        // Sizes requested in AllocateTransientMemory.
+        Vector<Uint64> transientMemorySizes;
+        Uint64 lastFenceValue = 0;
+        // Set to false not to record the commands. (Used to count the heap allocations of RGBuilder only)
+        bool recordCommands = true;
+
+    private:
+        static Uint64 AlignTransientSize(Uint64 size) { return (size + TRANSIENT_ALIGNMENT - 1) / TRANSIENT_ALIGNMENT * TRANSIENT_ALIGNMENT; }
+
+        MockShaderParameterHelper mShaderParameterHelper;
+        int mTransientHeap = 0;
+    };
+
+    inline Uint64 MockCommandList::Submit(bool waitUntilFinished)
+    {
+        if (IsRecording())
+        {
+            mGAPI.submittedCommands.insert(mGAPI.submittedCommands.end(), mCommands.begin(), mCommands.end());
+            mGAPI.submittedCommands.push_back(CUBE_T("Submit"));
+        }
+        mCommands.clear();
+
+        return ++mGAPI.lastFenceValue;
+    }
+
+    inline bool MockCommandList::IsRecording() const
+    {
+        return mGAPI.recordCommands;
+    }
+
+    // ===== Helpers =====
+
+    // RGBuilder allocates the per-frame data in the frame allocator of the calling thread.
+    // Initialize it explicitly because the auto-initialization writes the warning with the logger.
+    inline void InitializeThreadFrameAllocator()
+    {
+        Logger::Init(nullptr);
+
+        FrameAllocator& allocator = GetMyThreadFrameAllocator();
+        if (!allocator.IsInitialized())
+        {
+            allocator.Initialize("Render graph test frame allocator");
+        }
+    }
+
+    inline int CountCommands(const Vector<String>& commands, StringView prefix)
+    {
+        int count = 0;
+        for (const String& command : commands)
+        {
+            if (StringView(command).starts_with(prefix))
+            {
+                count++;
+            }
+        }
+        return count;
+    }
+
+    inline Vector<String> FilterCommands(const Vector<String>& commands, StringView prefix)
+    {
+        Vector<String> filtered;
+        for (const String& command : commands)
+        {
+            if (StringView(command).starts_with(prefix))
+            {
+                filtered.push_back(command);
+            }
+        }
+        return filtered;
+    }
+
+    inline bool HasCommand(const Vector<String>& commands, StringView command)
+    {
+        return std::find(commands.begin(), commands.end(), command) != commands.end();
+    }
+
+    inline gapi::TextureInfo MakeTextureInfo(gapi::TextureFlags flags, Uint32 width = 256, Uint32 height = 256, Uint32 mipLevels = 1, Uint32 arraySize = 1)
+    {
+        return {
+            .format = gapi::ElementFormat::RGBA8_UNorm,
+            .type = (arraySize > 1) ? gapi::TextureType::Texture2DArray : gapi::TextureType::Texture2D,
+            .flags = flags,
+            .width = width,
+            .height = height,
+            .depth = 1,
+            .arraySize = arraySize,
+            .mipLevels = mipLevels
+        };
+    }
+
+    inline SharedPtr<gapi::Texture> CreateRegisteredTexture(GAPI& gapi, gapi::TextureFlags flags, StringView debugName, Uint32 mipLevels = 1, Uint32 arraySize = 1)
+    {
+        return gapi.CreateTexture({
+            .usage = gapi::ResourceUsage::GPUOnly,
+            .textureInfo = MakeTextureInfo(flags, 256, 256, mipLevels, arraySize),
+            .debugName = debugName
+        });
+    }
+
+    inline gapi::BufferInfo MakeBufferInfo(Uint64 size)
+    {
+        return {
+            .type = gapi::BufferType::Structured,
+            .size = size,
+            .stride = 16,
+            .flags = gapi::BufferFlag::UAV
+        };
+    }
+
+    inline void DispatchPass(gapi::CommandList& commandList)
+    {
+        commandList.DispatchThreads(1, 1, 1);
+    }
+} // namespace cube
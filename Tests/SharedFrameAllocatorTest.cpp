@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include "Allocator/SharedFrameAllocator.h"
+#include "Logger.h"
+
+using namespace cube;
+
+constexpr int kNumThreads = 8;
+constexpr int kNumAllocationsPerThread = 4096;
+
+struct Allocation
+{
+    Uint8* ptr;
+    Uint64 size;
+    Uint64 alignment;
+};
+
+// Allocate from all threads at once and fill each allocation with the thread index.
+static void AllocateInThreads(SharedFrameAllocator& allocator, Vector<Vector<Allocation>>& outAllocations)
+{
+    outAllocations.assign(kNumThreads, {});
+
+    Vector<std::thread> threads;
+    for (int threadIndex = 0; threadIndex < kNumThreads; ++threadIndex)
+    {
+        threads.emplace_back([&allocator, &outAllocations, threadIndex]()
+        {
+            Vector<Allocation>& allocations = outAllocations[threadIndex];
+            allocations.reserve(kNumAllocationsPerThread);
+            for (int i = 0; i < kNumAllocationsPerThread; ++i)
+            {
+                const Uint64 size = 1 + (i * 37 + threadIndex * 11) % 200;
+                const Uint64 alignment = 1ull << (i % 7);
+
+                Uint8* ptr = (Uint8*)allocator.AllocateAligned(size, alignment);
+                memset(ptr, threadIndex + 1, size);
+                allocations.push_back({ ptr, size, alignment });
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+}
+
+// ===== SharedFrameAllocator Tests =====
+
+TEST(SharedFrameAllocatorTest, ConcurrentAllocationsDoNotOverlap)
+{
+    SharedFrameAllocator allocator;
+    allocator.Initialize("Test shared frame allocator", 16 * 1024 * 1024, 16 * 1024);
+
+    Vector<Vector<Allocation>> allocations;
+    AllocateInThreads(allocator, allocations);
+
+    for (int threadIndex = 0; threadIndex < kNumThreads; ++threadIndex)
+    {
+        for (const Allocation& allocation : allocations[threadIndex])
+        {
+            EXPECT_EQ(reinterpret_cast<Uint64>(allocation.ptr) % allocation.alignment, 0u);
+            for (Uint64 i = 0; i < allocation.size; ++i)
+            {
+                ASSERT_EQ(allocation.ptr[i], threadIndex + 1);
+            }
+            allocator.FreeAligned(allocation.ptr);
+        }
+    }
+
+    // Every allocation took the lock-free path.
+    EXPECT_EQ(allocator.GetNumOverflowAllocations(), 0u);
+
+    allocator.DiscardAllocations();
+    allocator.Shutdown();
+}
+
+TEST(SharedFrameAllocatorTest, DiscardRecyclesAllChunks)
+{
+    SharedFrameAllocator allocator;
+    allocator.Initialize("Test shared frame allocator", 16 * 1024 * 1024, 16 * 1024);
+
+    Uint64 firstFrameUsedSize = 0;
+    for (int frame = 0; frame < 4; ++frame)
+    {
+        Vector<Vector<Allocation>> allocations;
+        AllocateInThreads(allocator, allocations);
+
+        // The chunks are handed out from the beginning again, so the used size does not grow.
+        const Uint64 usedSize = allocator.GetUsedBlockSize();
+        if (frame == 0)
+        {
+            firstFrameUsedSize = usedSize;
+        }
+        EXPECT_LE(usedSize, firstFrameUsedSize + kNumThreads * 16 * 1024);
+        EXPECT_EQ(allocator.GetNumOverflowAllocations(), 0u);
+
+        for (const Vector<Allocation>& threadAllocations : allocations)
+        {
+            for (const Allocation& allocation : threadAllocations)
+            {
+                allocator.FreeAligned(allocation.ptr);
+            }
+        }
+        allocator.DiscardAllocations();
+        EXPECT_EQ(allocator.GetUsedBlockSize(), 0u);
+    }
+
+    allocator.Shutdown();
+}
+
+TEST(SharedFrameAllocatorTest, OverflowWhenBlockIsFull)
+{
+    // The overflow warning is written with the default logger allocator.
+    Logger::Init(nullptr);
+
+    SharedFrameAllocator allocator;
+    allocator.Initialize("Test shared frame allocator", 64 * 1024, 16 * 1024);
+
+    Vector<void*> ptrs;
+    for (int i = 0; i < 16; ++i)
+    {
+        void* ptr = allocator.Allocate(8 * 1024);
+        ASSERT_NE(ptr, nullptr);
+        memset(ptr, i, 8 * 1024);
+        ptrs.push_back(ptr);
+    }
+    EXPECT_GT(allocator.GetNumOverflowAllocations(), 0u);
+
+    for (void* ptr : ptrs)
+    {
+        allocator.Free(ptr);
+    }
+    allocator.DiscardAllocations();
+    EXPECT_EQ(allocator.GetNumOverflowAllocations(), 0u);
+
+    allocator.Shutdown();
+}
+
+TEST(SharedFrameAllocatorTest, ContainerCrossesThreads)
+{
+    SharedFrameAllocator allocator;
+    allocator.Initialize("Test shared frame allocator", 16 * 1024 * 1024, 16 * 1024);
+
+    {
+        SharedFrameVector<int> values{ SharedFrameAllocator::StdAllocator<int>(allocator) };
+        std::thread worker([&values]()
+        {
+            for (int i = 0; i < 10000; ++i)
+            {
+                values.push_back(i);
+            }
+        });
+        worker.join();
+
+        // Grow and free in the other thread than the one which allocated.
+        for (int i = 10000; i < 20000; ++i)
+        {
+            values.push_back(i);
+        }
+        ASSERT_EQ(values.size(), 20000u);
+        for (int i = 0; i < 20000; ++i)
+        {
+            ASSERT_EQ(values[i], i);
+        }
+    }
+
+    allocator.DiscardAllocations();
+    allocator.Shutdown();
+}
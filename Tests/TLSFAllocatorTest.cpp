@@ -0,0 +1,152 @@
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "Allocator/TLSFAllocator.h"
+#include "Blob.h"
+#include "Logger.h"
+
+using namespace cube;
+
+// ===== TLSFAllocator Tests =====
+
+TEST(TLSFAllocatorTest, AllocateAndFree)
+{
+    TLSFAllocator allocator;
+    allocator.Initialize("Test TLSF allocator", 1024 * 1024);
+
+    void* a = allocator.Allocate(100);
+    void* b = allocator.AllocateAligned(1000, 256);
+    void* c = allocator.Allocate(1);
+    EXPECT_EQ(reinterpret_cast<Uint64>(a) % 16, 0u);
+    EXPECT_EQ(reinterpret_cast<Uint64>(b) % 256, 0u);
+    EXPECT_EQ(reinterpret_cast<Uint64>(c) % 16, 0u);
+    memset(a, 1, 100);
+    memset(b, 2, 1000);
+    memset(c, 3, 1);
+
+    TLSFAllocatorStats stats = allocator.GetStats();
+    EXPECT_EQ(stats.numPools, 1u);
+    EXPECT_EQ(stats.numAllocations, 3u);
+    EXPECT_GE(stats.usedSize, 1101u);
+
+    allocator.Free(a, 100);
+    allocator.FreeAligned(b);
+    allocator.Free(c, 1);
+
+    // All blocks are merged back into one.
+    stats = allocator.GetStats();
+    EXPECT_EQ(stats.numAllocations, 0u);
+    EXPECT_EQ(stats.usedSize, 0u);
+    EXPECT_GE(stats.peakUsedSize, 1101u);
+    EXPECT_EQ(stats.largestFreeBlockSize, stats.freeSize);
+    EXPECT_EQ(stats.GetFragmentation(), 0.0);
+
+    allocator.Shutdown();
+}
+
+TEST(TLSFAllocatorTest, AddPoolWhenFull)
+{
+    TLSFAllocator allocator;
+    allocator.Initialize("Test TLSF allocator", 64 * 1024);
+
+    void* small = allocator.Allocate(32 * 1024);
+    // Larger than the pool size
+    void* large = allocator.Allocate(1024 * 1024);
+    ASSERT_NE(large, nullptr);
+    memset(large, 1, 1024 * 1024);
+
+    const TLSFAllocatorStats stats = allocator.GetStats();
+    EXPECT_EQ(stats.numPools, 2u);
+    EXPECT_GE(stats.reservedSize, 64u * 1024 + 1024 * 1024);
+
+    allocator.Free(small, 32 * 1024);
+    allocator.Free(large, 1024 * 1024);
+    allocator.Shutdown();
+}
+
+TEST(TLSFAllocatorTest, RandomAllocationsKeepData)
+{
+    TLSFAllocator allocator;
+    allocator.Initialize("Test TLSF allocator", 4 * 1024 * 1024);
+
+    struct Allocation
+    {
+        Uint8* ptr;
+        Uint64 size;
+        Uint8 value;
+    };
+    Vector<Allocation> allocations;
+
+    std::mt19937 random(1234);
+    for (int i = 0; i < 20000; ++i)
+    {
+        if (allocations.empty() || random() % 3 != 0)
+        {
+            const Uint64 size = 1 + random() % (random() % 8 == 0 ? 64 * 1024 : 512);
+            const Uint64 alignment = 1ull << (random() % 9);
+            const Uint8 value = static_cast<Uint8>(i);
+
+            Uint8* ptr = (Uint8*)allocator.AllocateAligned(size, alignment);
+            ASSERT_EQ(reinterpret_cast<Uint64>(ptr) % alignment, 0u);
+            memset(ptr, value, size);
+            allocations.push_back({ ptr, size, value });
+        }
+        else
+        {
+            const Uint64 index = random() % allocations.size();
+            const Allocation allocation = allocations[index];
+            for (Uint64 j = 0; j < allocation.size; ++j)
+            {
+                ASSERT_EQ(allocation.ptr[j], allocation.value);
+            }
+            allocator.FreeAligned(allocation.ptr);
+
+            allocations[index] = allocations.back();
+            allocations.pop_back();
+        }
+    }
+
+    for (const Allocation& allocation : allocations)
+    {
+        for (Uint64 j = 0; j < allocation.size; ++j)
+        {
+            ASSERT_EQ(allocation.ptr[j], allocation.value);
+        }
+        allocator.FreeAligned(allocation.ptr);
+    }
+
+    // Every freed block is merged, so each pool has one free block.
+    const TLSFAllocatorStats stats = allocator.GetStats();
+    EXPECT_EQ(stats.numAllocations, 0u);
+    EXPECT_EQ(stats.usedSize, 0u);
+    if (stats.numPools == 1)
+    {
+        EXPECT_EQ(stats.GetFragmentation(), 0.0);
+    }
+
+    allocator.Shutdown();
+}
+
+TEST(TLSFAllocatorTest, BlobWithAllocator)
+{
+    TLSFAllocator allocator;
+    allocator.Initialize("Test TLSF allocator", 1024 * 1024);
+
+    {
+        Blob blob(1000, &allocator);
+        memset(blob.GetData(), 7, blob.GetSize());
+
+        // The copy uses the same allocator.
+        Blob copied = blob;
+        EXPECT_EQ(copied.GetAllocator(), &allocator);
+        EXPECT_EQ(static_cast<Uint8*>(copied.GetData())[999], 7);
+        EXPECT_EQ(allocator.GetStats().numAllocations, 2u);
+
+        Blob moved = std::move(blob);
+        EXPECT_EQ(allocator.GetStats().numAllocations, 2u);
+    }
+    EXPECT_EQ(allocator.GetStats().numAllocations, 0u);
+
+    allocator.Shutdown();
+}